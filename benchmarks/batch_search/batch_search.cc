@@ -0,0 +1,103 @@
+/**
+ * @file
+ *
+ * @brief Throughput benchmark of the batch searches: resolves a list of
+ * queries against a server answering each request after a fixed delay
+ * standing for the round trip to the API. The queries are searched one at a
+ * time, in a loop of blocking searches, and then as a batch with several
+ * bounds of searches in flight; the searches per second are reported. Must
+ * be run from the repository root.
+ */
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/latency_stats.h"
+#include "common/payloads.h"
+#include "common/redirecting_curl.h"
+#include "common/stand_in_server.h"
+#include "private/searcher.h"
+
+using spotify_lib::CurlOptions;
+using spotify_lib::MusicInfo;
+using spotify_lib::Searcher;
+using spotify_lib::bench::Millis;
+using spotify_lib::bench::RedirectingCurl;
+using spotify_lib::bench::SearchPayload;
+using spotify_lib::bench::StandInRequest;
+using spotify_lib::bench::StandInResponse;
+using spotify_lib::bench::StandInServer;
+
+using std::chrono::milliseconds;
+using std::chrono::steady_clock;
+
+int main(int argc, char *argv[]) {
+  std::size_t queries = argc > 1 ? std::atoi(argv[1]) : 400;
+  const milliseconds kRoundTrip{argc > 2 ? std::atoi(argv[2]) : 20};
+  const std::string kBody = SearchPayload(10);
+
+  StandInServer server{[&](const StandInRequest &) {
+    return StandInResponse{200, kBody, {}, kRoundTrip};
+  }};
+
+  CurlOptions options;
+
+  options.ca_info = server.CaFile();
+  options.cache_bytes = 0;
+  options.coalesce = false;
+  options.max_idle_handles = 64;
+
+  auto curl = std::make_shared<RedirectingCurl>(server.BaseUri(), options);
+  Searcher searcher{curl};
+  std::vector<std::string> names;
+
+  for (std::size_t i = 0; i < queries; i++) {
+    names.push_back("title " + std::to_string(i) + " artist");
+  }
+
+  /* a loop of blocking searches, the way the callers did before. */
+  {
+    std::size_t failures = 0;
+    auto start = steady_clock::now();
+
+    for (auto &name : names) {
+      try {
+        searcher.Search("token", name);
+      } catch (const std::exception &) {
+        failures++;
+      }
+    }
+
+    double elapsed = Millis(steady_clock::now() - start).count();
+
+    std::cout << "loop     : " << queries << " searches, " << failures
+              << " failed, " << queries * 1000 / elapsed << " searches/s"
+              << std::endl;
+  }
+
+  for (std::size_t in_flight : {4, 16, 64}) {
+    std::size_t failures = 0;
+    auto start = steady_clock::now();
+
+    searcher.SearchBatch(
+        names, [](std::size_t) { return std::string{"token"}; }, in_flight,
+        [&](std::size_t, std::exception_ptr error,
+            const std::vector<MusicInfo> &) {
+          if (error) {
+            failures++;
+          }
+        });
+
+    double elapsed = Millis(steady_clock::now() - start).count();
+
+    std::cout << "batch " << in_flight << (in_flight < 10 ? " " : "")
+              << ": " << queries << " searches, " << failures << " failed, "
+              << queries * 1000 / elapsed << " searches/s" << std::endl;
+  }
+
+  return 0;
+}
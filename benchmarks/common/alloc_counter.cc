@@ -0,0 +1,76 @@
+/**
+ * @file
+ *
+ * @brief Heap allocation counters implementation. The allocation functions of
+ * glibc are interposed, so linking this file into a benchmark counts every
+ * allocation of the process; only the threads which asked for it are
+ * accounted.
+ */
+#include "common/alloc_counter.h"
+
+#include <cstddef>
+
+extern "C" {
+void *__libc_malloc(std::size_t size);
+void *__libc_calloc(std::size_t nmemb, std::size_t size);
+void *__libc_realloc(void *ptr, std::size_t size);
+}
+
+namespace {
+
+__thread bool counting = false;
+__thread std::size_t calls = 0;
+__thread std::size_t bytes = 0;
+
+/**
+ * @brief Account an allocation of the calling thread.
+ *
+ * @param size Requested size.
+ */
+inline void Account(std::size_t size) {
+  if (counting) {
+    calls++;
+    bytes += size;
+  }
+}
+
+}  // namespace
+
+extern "C" {
+
+void *malloc(std::size_t size) {
+  Account(size);
+
+  return __libc_malloc(size);
+}
+
+void *calloc(std::size_t nmemb, std::size_t size) {
+  Account(nmemb * size);
+
+  return __libc_calloc(nmemb, size);
+}
+
+void *realloc(void *ptr, std::size_t size) {
+  Account(size);
+
+  return __libc_realloc(ptr, size);
+}
+}
+
+namespace spotify_lib {
+namespace bench {
+
+void StartCounting() {
+  calls = 0;
+  bytes = 0;
+  counting = true;
+}
+
+AllocStats StopCounting() {
+  counting = false;
+
+  return AllocStats{calls, bytes};
+}
+
+}  // namespace bench
+}  // namespace spotify_lib
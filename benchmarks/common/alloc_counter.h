@@ -0,0 +1,38 @@
+/**
+ * @file
+ *
+ * @brief Heap allocation counters used by the benchmarks.
+ */
+#ifndef ALLOC_COUNTER_H_
+#define ALLOC_COUNTER_H_
+
+#include <cstddef>
+
+namespace spotify_lib {
+namespace bench {
+
+/**
+ * @brief This structure holds the allocations made by a thread.
+ */
+struct AllocStats {
+  std::size_t calls;  //!< Calls to malloc, calloc and realloc.
+  std::size_t bytes;  //!< Bytes requested by these calls.
+};
+
+/**
+ * @brief Start counting the heap allocations made by the calling thread,
+ * including the ones made inside libcurl and jsoncpp.
+ */
+void StartCounting();
+
+/**
+ * @brief Stop counting the heap allocations of the calling thread.
+ *
+ * @return The allocations made since StartCounting.
+ */
+AllocStats StopCounting();
+
+}  // namespace bench
+}  // namespace spotify_lib
+
+#endif  // ALLOC_COUNTER_H_
@@ -0,0 +1,82 @@
+/**
+ * @file
+ *
+ * @brief Body encoders used by the benchmarks to reply compressed.
+ */
+#include "common/compression.h"
+
+#include <brotli/encode.h>
+#include <zlib.h>
+
+#include <cctype>
+#include <stdexcept>
+
+namespace spotify_lib {
+namespace bench {
+
+using std::runtime_error;
+using std::string;
+using std::vector;
+
+string Gzip(const string &body) {
+  z_stream stream = {};
+  string out(deflateBound(&stream, body.size()) + 32, '\0');
+
+  /* 16 added to the window bits selects the gzip framing. */
+  if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8,
+                   Z_DEFAULT_STRATEGY) != Z_OK) {
+    throw runtime_error("failed to set up gzip!");
+  }
+
+  stream.next_in = (Bytef *)body.data();
+  stream.avail_in = body.size();
+  stream.next_out = (Bytef *)&out[0];
+  stream.avail_out = out.size();
+
+  int ret = deflate(&stream, Z_FINISH);
+
+  out.resize(stream.total_out);
+  deflateEnd(&stream);
+
+  if (ret != Z_STREAM_END) {
+    throw runtime_error("failed to compress with gzip!");
+  }
+
+  return out;
+}
+
+string Brotli(const string &body) {
+  size_t size = BrotliEncoderMaxCompressedSize(body.size());
+  string out(size, '\0');
+
+  if (!BrotliEncoderCompress(BROTLI_DEFAULT_QUALITY, BROTLI_DEFAULT_WINDOW,
+                             BROTLI_MODE_TEXT, body.size(),
+                             (const uint8_t *)body.data(), &size,
+                             (uint8_t *)&out[0])) {
+    throw runtime_error("failed to compress with brotli!");
+  }
+
+  out.resize(size);
+
+  return out;
+}
+
+bool Accepts(const vector<string> &headers, const string &encoding) {
+  for (auto &header : headers) {
+    string lower = header;
+
+    for (auto &c : lower) {
+      c = std::tolower(c);
+    }
+
+    if (lower.compare(0, 16, "accept-encoding:") == 0 &&
+        lower.find(encoding, 16) != string::npos) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+}  // namespace bench
+}  // namespace spotify_lib
@@ -0,0 +1,47 @@
+/**
+ * @file
+ *
+ * @brief Body encoders used by the benchmarks to reply compressed.
+ */
+#ifndef COMPRESSION_H_
+#define COMPRESSION_H_
+
+#include <string>
+#include <vector>
+
+namespace spotify_lib {
+namespace bench {
+
+/**
+ * @brief Compress a body with gzip.
+ *
+ * @param body The body.
+ *
+ * @return The gzip stream.
+ */
+std::string Gzip(const std::string &body);
+
+/**
+ * @brief Compress a body with brotli.
+ *
+ * @param body The body.
+ *
+ * @return The brotli stream.
+ */
+std::string Brotli(const std::string &body);
+
+/**
+ * @brief Check whether a request accepts a given content encoding.
+ *
+ * @param headers Request headers.
+ * @param encoding The encoding, e.g. gzip.
+ *
+ * @return True when the encoding is listed in Accept-Encoding.
+ */
+bool Accepts(const std::vector<std::string> &headers,
+             const std::string &encoding);
+
+}  // namespace bench
+}  // namespace spotify_lib
+
+#endif  // COMPRESSION_H_
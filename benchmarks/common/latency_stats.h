@@ -0,0 +1,45 @@
+/**
+ * @file
+ *
+ * @brief Latency statistics helpers used by the benchmarks.
+ */
+#ifndef LATENCY_STATS_H_
+#define LATENCY_STATS_H_
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+namespace spotify_lib {
+namespace bench {
+
+/**
+ * @brief Duration type of the latency samples.
+ */
+using Millis = std::chrono::duration<double, std::milli>;
+
+/**
+ * @brief Compute a percentile of a set of samples.
+ *
+ * @param samples Latency samples (sorted in place).
+ * @param p Percentile, between 0 and 100.
+ *
+ * @return The percentile value in milliseconds.
+ */
+inline double Percentile(std::vector<double> &samples, double p) {
+  if (samples.empty()) {
+    return 0.0;
+  }
+
+  std::sort(samples.begin(), samples.end());
+
+  auto idx = static_cast<std::size_t>(p / 100.0 * (samples.size() - 1) + 0.5);
+
+  return samples[std::min(idx, samples.size() - 1)];
+}
+
+}  // namespace bench
+}  // namespace spotify_lib
+
+#endif  // LATENCY_STATS_H_
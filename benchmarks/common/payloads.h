@@ -0,0 +1,59 @@
+/**
+ * @file
+ *
+ * @brief Search payloads used by the benchmarks.
+ */
+#ifndef PAYLOADS_H_
+#define PAYLOADS_H_
+
+#include <cstddef>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include <json/json.h>
+
+namespace spotify_lib {
+namespace bench {
+
+/**
+ * @brief Build a search reply with a given number of tracks, replicating the
+ * tracks of a recorded reply. Must be run from the repository root.
+ *
+ * @param items Number of tracks in the reply.
+ *
+ * @return The reply serialized as the Spotify API does.
+ */
+inline std::string SearchPayload(std::size_t items) {
+  std::ifstream file{"tests/unit/mock/jsons/search_result_multiple.json"};
+  Json::Value recorded;
+
+  if (!file) {
+    throw std::runtime_error("run the benchmark from the repository root!");
+  }
+
+  file >> recorded;
+
+  Json::Value reply = recorded;
+  Json::Value &tracks = reply["tracks"]["items"];
+  const Json::Value &source = recorded["tracks"]["items"];
+
+  tracks = Json::Value{Json::arrayValue};
+
+  for (Json::ArrayIndex i = 0; i < items; i++) {
+    tracks.append(source[i % source.size()]);
+  }
+
+  reply["tracks"]["total"] = static_cast<Json::UInt64>(items);
+
+  Json::StreamWriterBuilder writer;
+
+  writer["indentation"] = "  ";
+
+  return Json::writeString(writer, reply);
+}
+
+}  // namespace bench
+}  // namespace spotify_lib
+
+#endif  // PAYLOADS_H_
@@ -0,0 +1,75 @@
+/**
+ * @file
+ *
+ * @brief Curl wrapper sending the Spotify requests to a local server.
+ */
+#ifndef REDIRECTING_CURL_H_
+#define REDIRECTING_CURL_H_
+
+#include <string>
+#include <vector>
+
+#include "private/curl_wrapper.h"
+#include "private/prepared_request.h"
+
+namespace spotify_lib {
+namespace bench {
+
+/**
+ * @class RedirectingCurl.
+ *
+ * @brief This class sends the GET requests made to the Spotify search host to
+ * another origin, e.g. a stand-in server, so that the benchmarks can run the
+ * library's components whose uris are fixed.
+ */
+class RedirectingCurl : public CurlWrapper {
+ public:
+  /**
+   * @brief Constructor.
+   *
+   * @param origin Origin the requests are sent to, e.g. https://localhost:4433.
+   * @param options Options of the wrapper.
+   */
+  RedirectingCurl(const std::string &origin, const CurlOptions &options)
+      : CurlWrapper{options}, origin_{origin} {}
+
+  Json::Value Get(const std::string &uri,
+                  const std::vector<std::string> &req_headers) const override {
+    return CurlWrapper::Get(Redirect(uri), req_headers);
+  }
+
+  Json::Value Get(const PreparedRequest &request) const override {
+    return Get(request.Uri(), request.HeaderLines());
+  }
+
+  void GetAsync(const std::string &uri,
+                const std::vector<std::string> &req_headers,
+                const JsonCallback &callback) const override {
+    CurlWrapper::GetAsync(Redirect(uri), req_headers, callback);
+  }
+
+ private:
+  /**
+   * @brief Replace the origin of an uri of the search host.
+   *
+   * @param uri The uri.
+   *
+   * @return The uri on the other origin.
+   */
+  std::string Redirect(const std::string &uri) const {
+    const std::string kOrigin{"https://lib.spotify.com"};
+
+    if (uri.compare(0, kOrigin.size(), kOrigin) != 0) {
+      return uri;
+    }
+
+    return origin_ + uri.substr(kOrigin.size());
+  }
+
+  std::string origin_;  //!< Origin the requests are sent to.
+};
+
+}  // namespace bench
+}  // namespace spotify_lib
+
+#endif  // REDIRECTING_CURL_H_
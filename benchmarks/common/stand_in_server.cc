@@ -0,0 +1,376 @@
+/**
+ * @file
+ *
+ * @brief Local HTTPS stand-in server class implementation.
+ */
+#include "common/stand_in_server.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <openssl/err.h>
+#include <openssl/pem.h>
+#include <openssl/x509v3.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+
+namespace spotify_lib {
+namespace bench {
+
+using std::lock_guard;
+using std::mutex;
+using std::runtime_error;
+using std::size_t;
+using std::string;
+using std::thread;
+using std::to_string;
+
+namespace {
+
+/**
+ * @brief Generate the self-signed certificate of the server and install it
+ * into the TLS context.
+ *
+ * @param ctx TLS context.
+ * @param ca_file Path where the certificate is written in PEM format.
+ * @param key_file Path where the private key is written in PEM format.
+ */
+void InstallCertificate(SSL_CTX* ctx, string* ca_file, string* key_file) {
+  EVP_PKEY* key = nullptr;
+  EVP_PKEY_CTX* key_ctx = EVP_PKEY_CTX_new_id(EVP_PKEY_EC, nullptr);
+
+  if (!key_ctx || EVP_PKEY_keygen_init(key_ctx) <= 0 ||
+      EVP_PKEY_CTX_set_ec_paramgen_curve_nid(key_ctx,
+                                             NID_X9_62_prime256v1) <= 0 ||
+      EVP_PKEY_keygen(key_ctx, &key) <= 0) {
+    EVP_PKEY_CTX_free(key_ctx);
+    throw runtime_error("failed to generate the server key!");
+  }
+
+  EVP_PKEY_CTX_free(key_ctx);
+
+  X509* cert = X509_new();
+  X509_NAME* name = X509_get_subject_name(cert);
+  X509V3_CTX v3_ctx;
+
+  X509_set_version(cert, 2);
+  ASN1_INTEGER_set(X509_get_serialNumber(cert), 1);
+  X509_gmtime_adj(X509_getm_notBefore(cert), -3600);
+  X509_gmtime_adj(X509_getm_notAfter(cert), 86400);
+  X509_set_pubkey(cert, key);
+  X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC,
+                             (const unsigned char*)"localhost", -1, -1, 0);
+  X509_set_issuer_name(cert, name);
+
+  X509V3_set_ctx_nodb(&v3_ctx);
+  X509V3_set_ctx(&v3_ctx, cert, cert, nullptr, nullptr, 0);
+
+  const struct {
+    int nid;
+    const char* value;
+  } kExtensions[] = {
+      {NID_basic_constraints, "critical,CA:TRUE"},
+      {NID_subject_alt_name,
+       "DNS:localhost,DNS:lib.spotify.com,DNS:api.spotify.com,"
+       "DNS:accounts.spotify.com,IP:127.0.0.1"}};
+
+  for (auto& e : kExtensions) {
+    X509_EXTENSION* ext =
+        X509V3_EXT_conf_nid(nullptr, &v3_ctx, e.nid, (char*)e.value);
+
+    X509_add_ext(cert, ext, -1);
+    X509_EXTENSION_free(ext);
+  }
+
+  X509_sign(cert, key, EVP_sha256());
+
+  char cert_path[] = "/tmp/stand_in_ca_XXXXXX";
+  char key_path[] = "/tmp/stand_in_key_XXXXXX";
+  int cert_fd = mkstemp(cert_path);
+  int key_fd = mkstemp(key_path);
+  FILE* cert_out = cert_fd >= 0 ? fdopen(cert_fd, "w") : nullptr;
+  FILE* key_out = key_fd >= 0 ? fdopen(key_fd, "w") : nullptr;
+
+  if (!cert_out || !key_out || !PEM_write_X509(cert_out, cert) ||
+      !PEM_write_PrivateKey(key_out, key, nullptr, nullptr, 0, nullptr,
+                            nullptr)) {
+    throw runtime_error("failed to write the server certificate!");
+  }
+
+  fclose(cert_out);
+  fclose(key_out);
+  *ca_file = cert_path;
+  *key_file = key_path;
+
+  SSL_CTX_use_certificate(ctx, cert);
+  SSL_CTX_use_PrivateKey(ctx, key);
+
+  X509_free(cert);
+  EVP_PKEY_free(key);
+}
+
+/**
+ * @brief Get the reason phrase of a status code.
+ *
+ * @param status HTTP status code.
+ *
+ * @return The reason phrase.
+ */
+const char* ReasonPhrase(int status) {
+  switch (status) {
+    case 200:
+      return "OK";
+    case 304:
+      return "Not Modified";
+    case 429:
+      return "Too Many Requests";
+    case 503:
+      return "Service Unavailable";
+    default:
+      return status < 400 ? "OK" : "Error";
+  }
+}
+
+/**
+ * @brief Send a reply, pacing it when a rate is given to emulate a slow link.
+ *
+ * @param ssl TLS connection.
+ * @param reply The reply.
+ * @param rate Bytes per second, zero for unlimited.
+ *
+ * @return False when the connection failed.
+ */
+bool Send(SSL* ssl, const string& reply, size_t rate) {
+  if (!rate) {
+    return SSL_write(ssl, reply.data(), reply.size()) > 0;
+  }
+
+  const size_t kSlice = 4096;
+  auto start = std::chrono::steady_clock::now();
+
+  for (size_t sent = 0; sent < reply.size(); sent += kSlice) {
+    size_t len = std::min(kSlice, reply.size() - sent);
+
+    if (SSL_write(ssl, reply.data() + sent, len) <= 0) {
+      return false;
+    }
+
+    std::this_thread::sleep_until(
+        start + std::chrono::microseconds{(sent + len) * 1000000 / rate});
+  }
+
+  return true;
+}
+
+}  // namespace
+
+StandInServer::StandInServer(const StandInHandler& handler)
+    : handler_{handler},
+      ctx_{SSL_CTX_new(TLS_server_method())},
+      listen_fd_{socket(AF_INET, SOCK_STREAM, 0)},
+      port_{0},
+      stop_{false},
+      connections_{0},
+      requests_{0},
+      resumed_{0} {
+  /* a client going away in the middle of a reply must not kill the process. */
+  signal(SIGPIPE, SIG_IGN);
+
+  if (!ctx_ || listen_fd_ < 0) {
+    throw runtime_error("failed to create the stand-in server!");
+  }
+
+  InstallCertificate(ctx_, &ca_file_, &key_file_);
+
+  int one = 1;
+  struct sockaddr_in addr = {};
+  socklen_t len = sizeof(addr);
+
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+  setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+  if (bind(listen_fd_, (struct sockaddr*)&addr, sizeof(addr)) < 0 ||
+      listen(listen_fd_, 512) < 0 ||
+      getsockname(listen_fd_, (struct sockaddr*)&addr, &len) < 0) {
+    throw runtime_error("failed to bind the stand-in server!");
+  }
+
+  port_ = ntohs(addr.sin_port);
+  acceptor_ = thread{&StandInServer::AcceptLoop, this};
+}
+
+StandInServer::~StandInServer() {
+  stop_ = true;
+
+  shutdown(listen_fd_, SHUT_RDWR);
+  acceptor_.join();
+  close(listen_fd_);
+
+  {
+    lock_guard<mutex> lock{mutex_};
+
+    for (auto fd : client_fds_) {
+      shutdown(fd, SHUT_RDWR);
+    }
+  }
+
+  for (auto& w : workers_) {
+    w.join();
+  }
+
+  SSL_CTX_free(ctx_);
+  remove(ca_file_.c_str());
+  remove(key_file_.c_str());
+}
+
+string StandInServer::BaseUri() const {
+  return "https://localhost:" + to_string(port_);
+}
+
+void StandInServer::AcceptLoop() {
+  while (!stop_) {
+    int fd = accept(listen_fd_, nullptr, nullptr);
+
+    if (fd < 0) {
+      continue;
+    }
+
+    int one = 1;
+
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    connections_++;
+
+    lock_guard<mutex> lock{mutex_};
+
+    client_fds_.push_back(fd);
+    workers_.emplace_back(&StandInServer::Serve, this, fd);
+  }
+}
+
+void StandInServer::Serve(int fd) {
+  SSL* ssl = SSL_new(ctx_);
+  string buffer;
+  char chunk[16384];
+
+  SSL_set_fd(ssl, fd);
+
+  bool handshake_ok = SSL_accept(ssl) > 0;
+
+  if (handshake_ok && SSL_session_reused(ssl)) {
+    resumed_++;
+  }
+
+  while (handshake_ok && !stop_) {
+    auto end = buffer.find("\r\n\r\n");
+
+    if (end == string::npos) {
+      int n = SSL_read(ssl, chunk, sizeof(chunk));
+
+      if (n <= 0) {
+        break;
+      }
+
+      buffer.append(chunk, n);
+      continue;
+    }
+
+    StandInRequest req;
+    size_t content_length = 0;
+    bool keep_alive = true;
+    size_t line_end = buffer.find("\r\n");
+    string line = buffer.substr(0, line_end);
+    size_t sp1 = line.find(' ');
+    size_t sp2 = line.find(' ', sp1 + 1);
+
+    req.method = line.substr(0, sp1);
+    req.target = line.substr(sp1 + 1, sp2 - sp1 - 1);
+
+    for (size_t pos = line_end + 2; pos < end;) {
+      size_t next = buffer.find("\r\n", pos);
+      string header = buffer.substr(pos, next - pos);
+      string lower = header;
+
+      for (auto& c : lower) {
+        c = tolower(c);
+      }
+
+      if (lower.compare(0, 15, "content-length:") == 0) {
+        content_length = strtoul(header.c_str() + 15, nullptr, 10);
+      } else if (lower == "connection: close") {
+        keep_alive = false;
+      }
+
+      req.headers.push_back(header);
+      pos = next + 2;
+    }
+
+    while (buffer.size() < end + 4 + content_length) {
+      int n = SSL_read(ssl, chunk, sizeof(chunk));
+
+      if (n <= 0) {
+        break;
+      }
+
+      buffer.append(chunk, n);
+    }
+
+    req.body = buffer.substr(end + 4, content_length);
+    buffer.erase(0, end + 4 + content_length);
+
+    StandInResponse resp = handler_(req);
+
+    if (resp.delay.count() > 0) {
+      std::this_thread::sleep_for(resp.delay);
+    }
+
+    string reply = "HTTP/1.1 " + to_string(resp.status) + " " +
+                   ReasonPhrase(resp.status) +
+                   "\r\nContent-Type: application/json\r\nContent-Length: " +
+                   to_string(resp.body.size()) + "\r\n";
+
+    for (auto& h : resp.headers) {
+      reply += h + "\r\n";
+    }
+
+    reply += "\r\n";
+
+    if (req.method != "HEAD") {
+      reply += resp.body;
+    }
+
+    requests_++;
+
+    if (!Send(ssl, reply, resp.rate) || !keep_alive) {
+      break;
+    }
+  }
+
+  if (handshake_ok) {
+    SSL_shutdown(ssl);
+  }
+
+  SSL_free(ssl);
+
+  {
+    lock_guard<mutex> lock{mutex_};
+
+    for (auto& f : client_fds_) {
+      if (f == fd) {
+        f = -1;
+      }
+    }
+  }
+
+  close(fd);
+}
+
+}  // namespace bench
+}  // namespace spotify_lib
@@ -0,0 +1,159 @@
+/**
+ * @file
+ *
+ * @brief Local HTTPS stand-in server class definition.
+ */
+#ifndef STAND_IN_SERVER_H_
+#define STAND_IN_SERVER_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <openssl/ssl.h>
+
+namespace spotify_lib {
+namespace bench {
+
+/**
+ * @brief This structure holds a request received by the stand-in server.
+ */
+struct StandInRequest {
+  std::string method;
+  std::string target;
+  std::vector<std::string> headers;
+  std::string body;
+};
+
+/**
+ * @brief This structure holds the reply of the stand-in server.
+ */
+struct StandInResponse {
+  int status;
+  std::string body;
+  std::vector<std::string> headers;
+  std::chrono::milliseconds delay;
+  std::size_t rate{0};  //!< Bytes per second sent, zero for unlimited.
+};
+
+/**
+ * @brief Request handler of the stand-in server.
+ */
+using StandInHandler = std::function<StandInResponse(const StandInRequest &)>;
+
+/**
+ * @class StandInServer.
+ *
+ * @brief This class implements a small HTTP/1.1 over TLS server listening on
+ * the loopback interface, used by the benchmarks in place of the Spotify
+ * hosts. It generates a self-signed certificate at startup, valid for
+ * localhost and the Spotify host names, and serves each connection in its own
+ * thread with keep-alive.
+ */
+class StandInServer {
+ public:
+  /**
+   * @brief Constructor.
+   *
+   * @param handler Request handler.
+   */
+  explicit StandInServer(const StandInHandler &handler);
+
+  /**
+   * @brief Destructor.
+   */
+  ~StandInServer();
+
+  StandInServer(const StandInServer &) = delete;
+  StandInServer &operator=(const StandInServer &) = delete;
+
+  /**
+   * @brief Get the base uri of the server.
+   *
+   * @return The base uri, e.g. https://localhost:4433.
+   */
+  std::string BaseUri() const;
+
+  /**
+   * @brief Get the listening port.
+   *
+   * @return The port.
+   */
+  int Port() const { return port_; }
+
+  /**
+   * @brief Get the path of the PEM file with the server certificate, to be
+   * used as CA bundle by the clients.
+   *
+   * @return The certificate path.
+   */
+  const std::string &CaFile() const { return ca_file_; }
+
+  /**
+   * @brief Get the path of the PEM file with the server private key, so other
+   * local servers can present the same certificate.
+   *
+   * @return The private key path.
+   */
+  const std::string &KeyFile() const { return key_file_; }
+
+  /**
+   * @brief Get the number of accepted connections.
+   *
+   * @return The number of connections.
+   */
+  std::size_t Connections() const { return connections_; }
+
+  /**
+   * @brief Get the number of connections which resumed a previous TLS session
+   * instead of doing a full handshake.
+   *
+   * @return The number of resumed sessions.
+   */
+  std::size_t ResumedSessions() const { return resumed_; }
+
+  /**
+   * @brief Get the number of served requests.
+   *
+   * @return The number of requests.
+   */
+  std::size_t Requests() const { return requests_; }
+
+ private:
+  /**
+   * @brief Accept the incoming connections.
+   */
+  void AcceptLoop();
+
+  /**
+   * @brief Serve the requests of a single connection.
+   *
+   * @param fd Connection socket.
+   */
+  void Serve(int fd);
+
+  StandInHandler handler_;             //!< Request handler.
+  SSL_CTX *ctx_;                       //!< TLS context.
+  int listen_fd_;                      //!< Listening socket.
+  int port_;                           //!< Listening port.
+  std::string ca_file_;                //!< Certificate file.
+  std::string key_file_;               //!< Private key file.
+  std::atomic<bool> stop_;             //!< Stop flag.
+  std::atomic<std::size_t> connections_;  //!< Accepted connections.
+  std::atomic<std::size_t> requests_;  //!< Served requests.
+  std::atomic<std::size_t> resumed_;   //!< Resumed TLS sessions.
+  std::mutex mutex_;                   //!< Protects the workers.
+  std::vector<int> client_fds_;        //!< Open connections.
+  std::vector<std::thread> workers_;   //!< Connection threads.
+  std::thread acceptor_;               //!< Accept thread.
+};
+
+}  // namespace bench
+}  // namespace spotify_lib
+
+#endif  // STAND_IN_SERVER_H_
@@ -0,0 +1,131 @@
+/**
+ * @file
+ *
+ * @brief Benchmark of the compressed transfers: fetches a search reply with
+ * and without compression, over an unlimited and a rate limited link, and
+ * reports the bytes on the wire and the latency of each request. The streamed
+ * requests check that the decompressed body reaches the streaming parser. Must
+ * be run from the repository root.
+ */
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "common/compression.h"
+#include "common/latency_stats.h"
+#include "common/payloads.h"
+#include "common/stand_in_server.h"
+#include "private/curl_wrapper.h"
+#include "private/json_stream_splitter.h"
+
+using spotify_lib::CurlOptions;
+using spotify_lib::CurlStats;
+using spotify_lib::CurlWrapper;
+using spotify_lib::JsonStreamSplitter;
+using spotify_lib::bench::Accepts;
+using spotify_lib::bench::Brotli;
+using spotify_lib::bench::Gzip;
+using spotify_lib::bench::Millis;
+using spotify_lib::bench::Percentile;
+using spotify_lib::bench::SearchPayload;
+using spotify_lib::bench::StandInRequest;
+using spotify_lib::bench::StandInResponse;
+using spotify_lib::bench::StandInServer;
+
+using std::chrono::milliseconds;
+using std::chrono::steady_clock;
+
+namespace {
+
+/**
+ * @brief Fetch the reply several times and report the costs.
+ *
+ * @param name Name of the scenario.
+ * @param encoding Encoding used by the server, empty for none.
+ * @param rate Link rate in bytes per second, zero for unlimited.
+ * @param requests Number of requests.
+ */
+void Run(const char *name, const std::string &encoding, std::size_t rate,
+         int requests) {
+  const std::string kBody = SearchPayload(100);
+  const std::string kGzip = Gzip(kBody);
+  const std::string kBrotli = Brotli(kBody);
+
+  StandInServer server{[&](const StandInRequest &req) {
+    if (encoding == "gzip" && Accepts(req.headers, "gzip")) {
+      return StandInResponse{
+          200, kGzip, {"Content-Encoding: gzip"}, milliseconds{0}, rate};
+    }
+
+    if (encoding == "br" && Accepts(req.headers, "br")) {
+      return StandInResponse{
+          200, kBrotli, {"Content-Encoding: br"}, milliseconds{0}, rate};
+    }
+
+    return StandInResponse{200, kBody, {}, milliseconds{0}, rate};
+  }};
+
+  CurlOptions options;
+
+  options.ca_info = server.CaFile();
+  options.compression = !encoding.empty();
+
+  CurlWrapper curl{options};
+  const std::string kUri{server.BaseUri() + "/v1/search?q=umbrella"};
+  const std::vector<std::string> kHeaders{"Authorization: Bearer token"};
+  std::vector<double> latencies;
+  std::size_t streamed_items = 0;
+
+  curl.Get(kUri, kHeaders);
+
+  CurlStats before = curl.Stats();
+
+  for (int i = 0; i < requests; i++) {
+    auto start = steady_clock::now();
+
+    if (i % 2) {
+      auto reply = curl.Get(kUri, kHeaders);
+    } else {
+      JsonStreamSplitter splitter{
+          {"tracks", "items"},
+          [&streamed_items](const char *, std::size_t) { streamed_items++; }};
+
+      curl.GetStream(kUri, kHeaders,
+                     [&splitter](const char *data, std::size_t size) {
+                       splitter.Feed(data, size);
+                     });
+    }
+
+    latencies.push_back(Millis(steady_clock::now() - start).count());
+  }
+
+  CurlStats after = curl.Stats();
+
+  std::cout << name << ": " << (after.wire_bytes - before.wire_bytes) / requests
+            << " bytes on the wire, "
+            << (after.body_bytes - before.body_bytes) / requests
+            << " body bytes per request, p50 " << Percentile(latencies, 50)
+            << " ms, " << streamed_items / ((requests + 1) / 2)
+            << " tracks per streamed reply" << std::endl;
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  int requests = argc > 1 ? std::atoi(argv[1]) : 20;
+  std::size_t rate = argc > 2 ? std::atol(argv[2]) : 4 * 1024 * 1024;
+
+  std::cout << "unlimited link" << std::endl;
+  Run("  identity", "", 0, requests);
+  Run("  gzip    ", "gzip", 0, requests);
+  Run("  br      ", "br", 0, requests);
+
+  std::cout << rate / 1024 << " KiB/s link" << std::endl;
+  Run("  identity", "", rate, requests);
+  Run("  gzip    ", "gzip", rate, requests);
+  Run("  br      ", "br", rate, requests);
+
+  return 0;
+}
@@ -0,0 +1,124 @@
+/**
+ * @file
+ *
+ * @brief Load spike benchmark of the concurrency limiter: N threads send
+ * searches back to back to a server which handles a few requests at once,
+ * slows down sharply past that and rejects the requests (503) once too many
+ * are in flight. The searches are run with the limiter disabled and enabled,
+ * and the latencies, the failures and the final window are reported. Must be
+ * run from the repository root.
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "common/latency_stats.h"
+#include "common/payloads.h"
+#include "common/stand_in_server.h"
+#include "private/curl_wrapper.h"
+
+using spotify_lib::CurlOptions;
+using spotify_lib::CurlWrapper;
+using spotify_lib::bench::Millis;
+using spotify_lib::bench::Percentile;
+using spotify_lib::bench::SearchPayload;
+using spotify_lib::bench::StandInRequest;
+using spotify_lib::bench::StandInResponse;
+using spotify_lib::bench::StandInServer;
+
+using std::chrono::milliseconds;
+using std::chrono::steady_clock;
+
+int main(int argc, char *argv[]) {
+  int threads = argc > 1 ? std::atoi(argv[1]) : 64;
+  int requests = argc > 2 ? std::atoi(argv[2]) : 20;
+  const std::string kBody = SearchPayload(10);
+  const int kCapacity = 8;
+
+  for (bool limited : {false, true}) {
+    std::atomic<int> active{0};
+    std::atomic<int> rejected{0};
+
+    /* each request past the capacity slows all of them down, quadratically,
+     * and past three times the capacity the server sheds them. */
+    StandInServer server{[&](const StandInRequest &) {
+      int load = ++active;
+
+      if (load > 3 * kCapacity) {
+        active--;
+        rejected++;
+        return StandInResponse{503, "{}", {}, milliseconds{0}};
+      }
+
+      double excess = std::max(1.0, static_cast<double>(load) / kCapacity);
+
+      std::this_thread::sleep_for(milliseconds{10} * excess * excess);
+      active--;
+
+      return StandInResponse{200, kBody, {}, milliseconds{0}};
+    }};
+
+    CurlOptions options;
+
+    options.ca_info = server.CaFile();
+    options.cache_bytes = 0;
+    options.coalesce = false;
+    options.max_idle_handles = threads;
+    options.limiter.initial_limit = limited ? kCapacity * 2 : 0;
+    options.limiter.max_queued = threads;
+
+    CurlWrapper curl{options};
+    const std::vector<std::string> kHeaders{"Authorization: Bearer token"};
+    std::atomic<int> failures{0};
+    std::vector<std::vector<double>> latencies(threads);
+    std::vector<std::thread> workers;
+    auto start = steady_clock::now();
+
+    for (int t = 0; t < threads; t++) {
+      workers.emplace_back([&, t] {
+        const std::string kUri{server.BaseUri() + "/v1/search?q=" +
+                               std::to_string(t)};
+
+        for (int r = 0; r < requests; r++) {
+          auto begin = steady_clock::now();
+
+          try {
+            curl.Get(kUri, kHeaders);
+            latencies[t].push_back(Millis(steady_clock::now() - begin).count());
+          } catch (const std::exception &) {
+            failures++;
+          }
+        }
+      });
+    }
+
+    for (auto &w : workers) {
+      w.join();
+    }
+
+    double elapsed = Millis(steady_clock::now() - start).count();
+    std::vector<double> all;
+
+    for (auto &l : latencies) {
+      all.insert(all.end(), l.begin(), l.end());
+    }
+
+    auto stats = curl.Stats();
+
+    std::cout << (limited ? "limited  " : "unlimited") << ": "
+              << threads * requests << " searches, " << failures
+              << " failed, " << rejected << " rejected by the server, "
+              << stats.retries << " retries, p50 " << Percentile(all, 50)
+              << " ms, p99 " << Percentile(all, 99) << " ms, "
+              << all.size() * 1000 / elapsed << " searches/s, final window "
+              << stats.limit << std::endl;
+  }
+
+  return 0;
+}
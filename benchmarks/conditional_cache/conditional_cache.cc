@@ -0,0 +1,85 @@
+/**
+ * @file
+ *
+ * @brief Benchmark of the response cache: repeats the same search against a
+ * server which tags its replies with an ETag, with the cache disabled and
+ * enabled, and reports the latency, the bytes on the wire and the cache hits.
+ * Must be run from the repository root.
+ */
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "common/latency_stats.h"
+#include "common/payloads.h"
+#include "common/stand_in_server.h"
+#include "private/curl_wrapper.h"
+
+using spotify_lib::CurlOptions;
+using spotify_lib::CurlStats;
+using spotify_lib::CurlWrapper;
+using spotify_lib::bench::Millis;
+using spotify_lib::bench::Percentile;
+using spotify_lib::bench::SearchPayload;
+using spotify_lib::bench::StandInRequest;
+using spotify_lib::bench::StandInResponse;
+using spotify_lib::bench::StandInServer;
+
+using std::chrono::milliseconds;
+using std::chrono::steady_clock;
+
+int main(int argc, char *argv[]) {
+  int requests = argc > 1 ? std::atoi(argv[1]) : 100;
+  const std::string kBody = SearchPayload(100);
+  const std::string kEtag{"\"v1\""};
+
+  StandInServer server{[&](const StandInRequest &req) {
+    for (auto &h : req.headers) {
+      if (h == "If-None-Match: " + kEtag) {
+        return StandInResponse{304, "", {"ETag: " + kEtag}, milliseconds{0}};
+      }
+    }
+
+    return StandInResponse{200, kBody, {"ETag: " + kEtag}, milliseconds{0}};
+  }};
+
+  const std::vector<std::size_t> kCacheSizes{0, 8 * 1024 * 1024};
+
+  for (auto cache_bytes : kCacheSizes) {
+    CurlOptions options;
+
+    options.ca_info = server.CaFile();
+    options.compression = false;
+    options.cache_bytes = cache_bytes;
+
+    CurlWrapper curl{options};
+    const std::string kUri{server.BaseUri() + "/v1/search?q=umbrella"};
+    const std::vector<std::string> kHeaders{"Authorization: Bearer token"};
+    std::vector<double> latencies;
+
+    curl.Get(kUri, kHeaders);
+
+    CurlStats before = curl.Stats();
+
+    for (int i = 0; i < requests; i++) {
+      auto start = steady_clock::now();
+      auto reply = curl.Get(kUri, kHeaders);
+
+      latencies.push_back(Millis(steady_clock::now() - start).count());
+    }
+
+    CurlStats after = curl.Stats();
+
+    std::cout << (cache_bytes ? "cache   " : "no cache") << ": p50 "
+              << Percentile(latencies, 50) << " ms, p99 "
+              << Percentile(latencies, 99) << " ms, "
+              << (after.wire_bytes - before.wire_bytes) / requests
+              << " bytes on the wire per request, "
+              << after.cache_hits - before.cache_hits << "/" << requests
+              << " served from the cache" << std::endl;
+  }
+
+  return 0;
+}
@@ -0,0 +1,105 @@
+/**
+ * @file
+ *
+ * @brief Benchmark of the curl handle pool: latency of concurrent requests
+ * against a local HTTPS stand-in with and without connection reuse.
+ */
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "common/latency_stats.h"
+#include "common/stand_in_server.h"
+#include "private/curl_wrapper.h"
+
+using spotify_lib::CurlOptions;
+using spotify_lib::CurlWrapper;
+using spotify_lib::bench::Millis;
+using spotify_lib::bench::Percentile;
+using spotify_lib::bench::StandInRequest;
+using spotify_lib::bench::StandInResponse;
+using spotify_lib::bench::StandInServer;
+
+using std::chrono::milliseconds;
+using std::chrono::steady_clock;
+
+namespace {
+
+/**
+ * @brief Run the requests from several threads sharing a single wrapper.
+ *
+ * @param server Stand-in server.
+ * @param label Name of the scenario.
+ * @param max_idle Idle handles kept by the wrapper.
+ * @param threads Number of threads.
+ * @param requests Requests issued by each thread.
+ */
+void Run(const StandInServer &server, const std::string &label,
+         std::size_t max_idle, int threads, int requests) {
+  CurlOptions options;
+
+  options.max_idle_handles = max_idle;
+  options.ca_info = server.CaFile();
+
+  CurlWrapper curl{options};
+  std::vector<double> samples;
+  std::mutex samples_mutex;
+  std::vector<std::thread> workers;
+  const std::string kUri{server.BaseUri() + "/v1/search?q=umbrella"};
+  const std::vector<std::string> kHeaders{"Authorization: Bearer token"};
+  auto connections = server.Connections();
+  auto start = steady_clock::now();
+
+  for (int t = 0; t < threads; t++) {
+    workers.emplace_back([&] {
+      std::vector<double> local;
+
+      for (int i = 0; i < requests; i++) {
+        auto begin = steady_clock::now();
+
+        curl.Get(kUri, kHeaders);
+        local.push_back(Millis(steady_clock::now() - begin).count());
+      }
+
+      std::lock_guard<std::mutex> lock{samples_mutex};
+
+      samples.insert(samples.end(), local.begin(), local.end());
+    });
+  }
+
+  for (auto &w : workers) {
+    w.join();
+  }
+
+  double elapsed = Millis(steady_clock::now() - start).count();
+
+  std::cout << label << ": p50 " << Percentile(samples, 50) << " ms, p99 "
+            << Percentile(samples, 99) << " ms, "
+            << samples.size() * 1000.0 / elapsed << " req/s, "
+            << server.Connections() - connections << " connections"
+            << std::endl;
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  int threads = argc > 1 ? std::atoi(argv[1]) : 4;
+  int requests = argc > 2 ? std::atoi(argv[2]) : 200;
+
+  StandInServer server{[](const StandInRequest &) {
+    return StandInResponse{200, "{\"tracks\":{\"items\":[]}}", {},
+                           milliseconds{0}};
+  }};
+
+  std::cout << threads << " threads x " << requests << " requests"
+            << std::endl;
+
+  Run(server, "without reuse", 0, threads, requests);
+  Run(server, "with reuse", threads, threads, requests);
+
+  return 0;
+}
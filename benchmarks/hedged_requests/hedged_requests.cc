@@ -0,0 +1,108 @@
+/**
+ * @file
+ *
+ * @brief Tail latency benchmark of the request hedging: N threads send
+ * searches to a server which answers most of them quickly and stalls on a few
+ * at random, with the hedging disabled and enabled. The latency percentiles
+ * and the requests reaching the server are reported. Must be run from the
+ * repository root.
+ */
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "common/latency_stats.h"
+#include "common/payloads.h"
+#include "common/stand_in_server.h"
+#include "private/curl_wrapper.h"
+
+using spotify_lib::CurlOptions;
+using spotify_lib::CurlWrapper;
+using spotify_lib::bench::Millis;
+using spotify_lib::bench::Percentile;
+using spotify_lib::bench::SearchPayload;
+using spotify_lib::bench::StandInRequest;
+using spotify_lib::bench::StandInResponse;
+using spotify_lib::bench::StandInServer;
+
+using std::chrono::milliseconds;
+using std::chrono::steady_clock;
+
+int main(int argc, char *argv[]) {
+  int threads = argc > 1 ? std::atoi(argv[1]) : 8;
+  int requests = argc > 2 ? std::atoi(argv[2]) : 150;
+  double slow_ratio = argc > 3 ? std::atof(argv[3]) : 0.03;
+  const std::string kBody = SearchPayload(10);
+
+  for (bool hedged : {false, true}) {
+    std::mutex mutex;
+    std::mt19937 random{42};
+    std::bernoulli_distribution stall{slow_ratio};
+
+    /* a few requests stall, e.g. a garbage collection or a busy shard. */
+    StandInServer server{[&](const StandInRequest &) {
+      bool slow;
+
+      {
+        std::lock_guard<std::mutex> lock{mutex};
+
+        slow = stall(random);
+      }
+
+      return StandInResponse{200, kBody, {},
+                             milliseconds{slow ? 200 : 5}};
+    }};
+
+    CurlOptions options;
+
+    options.ca_info = server.CaFile();
+    options.cache_bytes = 0;
+    options.coalesce = false;
+    options.max_idle_handles = 2 * threads;
+    options.hedge.enabled = hedged;
+
+    CurlWrapper curl{options};
+    const std::vector<std::string> kHeaders{"Authorization: Bearer token"};
+    std::vector<std::vector<double>> latencies(threads);
+    std::vector<std::thread> workers;
+
+    for (int t = 0; t < threads; t++) {
+      workers.emplace_back([&, t] {
+        const std::string kUri{server.BaseUri() + "/v1/search?q=" +
+                               std::to_string(t)};
+
+        for (int r = 0; r < requests; r++) {
+          auto begin = steady_clock::now();
+
+          curl.Get(kUri, kHeaders);
+          latencies[t].push_back(Millis(steady_clock::now() - begin).count());
+        }
+      });
+    }
+
+    for (auto &w : workers) {
+      w.join();
+    }
+
+    std::vector<double> all;
+
+    for (auto &l : latencies) {
+      all.insert(all.end(), l.begin(), l.end());
+    }
+
+    std::cout << (hedged ? "hedged  " : "unhedged") << ": "
+              << threads * requests << " searches, " << server.Requests()
+              << " requests on the server, " << curl.Stats().hedged
+              << " hedges, p50 " << Percentile(all, 50) << " ms, p90 "
+              << Percentile(all, 90) << " ms, p99 " << Percentile(all, 99)
+              << " ms, p99.9 " << Percentile(all, 99.9) << " ms" << std::endl;
+  }
+
+  return 0;
+}
@@ -0,0 +1,197 @@
+/**
+ * @file
+ *
+ * @brief Load test of the HTTP/2 mode: fans out concurrent requests through
+ * the curl wrapper over HTTP/1.1 (local stand-in server) and over HTTP/2
+ * (local nghttpd presenting the same certificate), comparing the number of
+ * opened connections and the throughput.
+ */
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "common/latency_stats.h"
+#include "common/stand_in_server.h"
+#include "private/curl_wrapper.h"
+
+using spotify_lib::CurlOptions;
+using spotify_lib::CurlWrapper;
+using spotify_lib::bench::Millis;
+using spotify_lib::bench::StandInRequest;
+using spotify_lib::bench::StandInResponse;
+using spotify_lib::bench::StandInServer;
+
+using std::chrono::milliseconds;
+using std::chrono::steady_clock;
+
+namespace {
+
+const char kBody[] =
+    "{\"tracks\":{\"items\":[{\"name\":\"Umbrella\",\"uri\":"
+    "\"spotify:track:49FYlytm3dAAraYgpoJZux\",\"duration_ms\":275986,"
+    "\"album\":{\"artists\":[{\"name\":\"Rihanna\"}]}}]}}";
+
+/**
+ * @brief Find a free port on the loopback interface.
+ *
+ * @return The port number.
+ */
+int FreePort() {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  struct sockaddr_in addr = {};
+  socklen_t len = sizeof(addr);
+
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  bind(fd, (struct sockaddr *)&addr, sizeof(addr));
+  getsockname(fd, (struct sockaddr *)&addr, &len);
+  close(fd);
+
+  return ntohs(addr.sin_port);
+}
+
+/**
+ * @brief Wait until a local port accepts connections.
+ *
+ * @param port Port number.
+ *
+ * @return True when the port is ready.
+ */
+bool WaitForPort(int port) {
+  for (int i = 0; i < 100; i++) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr = {};
+
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    bool ok = connect(fd, (struct sockaddr *)&addr, sizeof(addr)) == 0;
+
+    close(fd);
+
+    if (ok) {
+      return true;
+    }
+
+    std::this_thread::sleep_for(milliseconds{20});
+  }
+
+  return false;
+}
+
+/**
+ * @brief Fan out the requests through a single wrapper.
+ *
+ * @param label Name of the scenario.
+ * @param uri Requested uri.
+ * @param ca_file CA bundle of the server.
+ * @param http2 Whether the HTTP/2 mode is enabled.
+ * @param streams Maximum streams per connection.
+ * @param requests Number of concurrent requests.
+ */
+void Run(const std::string &label, const std::string &uri,
+         const std::string &ca_file, bool http2, long streams, int requests) {
+  CurlOptions options;
+
+  options.ca_info = ca_file;
+  options.http2 = http2;
+  options.max_concurrent_streams = streams;
+  options.max_idle_handles = requests;
+
+  CurlWrapper curl{options};
+  std::vector<std::future<Json::Value>> replies;
+  int failures = 0;
+  auto start = steady_clock::now();
+
+  for (int i = 0; i < requests; i++) {
+    replies.push_back(curl.GetAsync(uri, {"Authorization: Bearer token"}));
+  }
+
+  for (auto &r : replies) {
+    try {
+      r.get();
+    } catch (const std::exception &) {
+      failures++;
+    }
+  }
+
+  double elapsed = Millis(steady_clock::now() - start).count();
+  auto stats = curl.Stats();
+
+  std::cout << label << ": " << requests * 1000.0 / elapsed << " req/s, "
+            << stats.connections << " connections, " << failures
+            << " failures" << std::endl;
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  int requests = argc > 1 ? std::atoi(argv[1]) : 500;
+  long streams = argc > 2 ? std::atol(argv[2]) : 100;
+  std::string nghttpd = argc > 3 ? argv[3] : "nghttpd";
+
+  StandInServer server{[](const StandInRequest &) {
+    return StandInResponse{200, kBody, {}, milliseconds{0}};
+  }};
+
+  std::cout << requests << " concurrent requests" << std::endl;
+
+  Run("HTTP/1.1", server.BaseUri() + "/search", server.CaFile(), false, 0,
+      requests);
+
+  /* serve the same reply as a static file from a local HTTP/2 server. */
+  char htdocs[] = "/tmp/h2_htdocs_XXXXXX";
+
+  if (!mkdtemp(htdocs)) {
+    return 1;
+  }
+
+  std::string file = std::string{htdocs} + "/search";
+
+  std::ofstream{file} << kBody;
+
+  int port = FreePort();
+  pid_t pid = fork();
+
+  if (pid == 0) {
+    std::string docroot = std::string{"--htdocs="} + htdocs;
+    std::string port_str = std::to_string(port);
+
+    execlp(nghttpd.c_str(), nghttpd.c_str(), "-a", "127.0.0.1",
+           docroot.c_str(), port_str.c_str(), server.KeyFile().c_str(),
+           server.CaFile().c_str(), (char *)nullptr);
+    _exit(127);
+  }
+
+  if (pid > 0 && WaitForPort(port)) {
+    Run("HTTP/2", "https://localhost:" + std::to_string(port) + "/search",
+        server.CaFile(), true, streams, requests);
+  } else {
+    std::cout << "HTTP/2: skipped, " << nghttpd << " couldn't be started"
+              << std::endl;
+  }
+
+  if (pid > 0) {
+    kill(pid, SIGTERM);
+    waitpid(pid, nullptr, 0);
+  }
+
+  std::remove(file.c_str());
+  rmdir(htdocs);
+
+  return 0;
+}
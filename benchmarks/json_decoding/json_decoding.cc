@@ -0,0 +1,92 @@
+/**
+ * @file
+ *
+ * @brief Microbenchmark of the search decoders: decodes search replies of
+ * different sizes, built from the recorded replies, with the jsoncpp and the
+ * simdjson decoders, in memory. Must be run from the repository root.
+ */
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "common/alloc_counter.h"
+#include "common/latency_stats.h"
+#include "common/payloads.h"
+#include "private/curl_wrapper.h"
+#include "private/search_decoder.h"
+#include "private/simdjson_search_decoder.h"
+
+using spotify_lib::CurlWrapper;
+using spotify_lib::JsoncppSearchDecoder;
+using spotify_lib::SearchDecoder;
+using spotify_lib::SimdjsonSearchDecoder;
+using spotify_lib::bench::AllocStats;
+using spotify_lib::bench::Millis;
+using spotify_lib::bench::SearchPayload;
+using spotify_lib::bench::StartCounting;
+using spotify_lib::bench::StopCounting;
+
+using std::chrono::steady_clock;
+
+namespace {
+
+/**
+ * @brief Decode a reply several times and report the cost of each decoding.
+ *
+ * @param name Name of the decoder.
+ * @param decoder The decoder.
+ * @param body The reply.
+ * @param iterations Number of decodings.
+ */
+void Run(const char *name, const SearchDecoder &decoder,
+         const std::string &body, int iterations) {
+  std::size_t musics = 0;
+
+  /* warm up the decoder's storage. */
+  decoder.Decode(body);
+
+  StartCounting();
+
+  auto start = steady_clock::now();
+
+  for (int i = 0; i < iterations; i++) {
+    musics += decoder.Decode(body).size();
+  }
+
+  double elapsed = Millis(steady_clock::now() - start).count();
+  AllocStats allocs = StopCounting();
+
+  std::cout << "  " << name << ": " << elapsed * 1000 / iterations
+            << " us per reply, " << body.size() * iterations / elapsed / 1000
+            << " MB/s, " << allocs.calls / iterations
+            << " allocations per reply (" << musics / iterations
+            << " musics)" << std::endl;
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  int iterations = argc > 1 ? std::atoi(argv[1]) : 100;
+  const std::vector<std::size_t> kSizes{1, 10, 100, 1000};
+  JsoncppSearchDecoder jsoncpp;
+  SimdjsonSearchDecoder simdjson;
+
+  for (auto items : kSizes) {
+    std::string payload = SearchPayload(items);
+    std::string body;
+
+    /* same layout as the bodies returned by CurlWrapper::GetRaw. */
+    body.reserve(payload.size() + CurlWrapper::kRawPadding);
+    body.assign(payload);
+
+    std::cout << items << " tracks (" << body.size() / 1024 << " KiB)"
+              << std::endl;
+
+    Run("jsoncpp ", jsoncpp, body, iterations);
+    Run("simdjson", simdjson, body, iterations);
+  }
+
+  return 0;
+}
@@ -0,0 +1,111 @@
+/**
+ * @file
+ *
+ * @brief Benchmark of the paged searches: fetches every page of a search of
+ * 1000 results, in pages of 50, from a server answering each request after a
+ * fixed delay standing for the round trip to the API. The pages are requested
+ * one at a time and then pipelined with several bounds of pages in flight;
+ * the time of a whole search is reported, in round trips. Must be run from
+ * the repository root.
+ */
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <json/json.h>
+
+#include "common/latency_stats.h"
+#include "common/payloads.h"
+#include "common/redirecting_curl.h"
+#include "common/stand_in_server.h"
+#include "private/searcher.h"
+
+using spotify_lib::CurlOptions;
+using spotify_lib::MusicInfo;
+using spotify_lib::PagingOptions;
+using spotify_lib::Searcher;
+using spotify_lib::bench::Millis;
+using spotify_lib::bench::Percentile;
+using spotify_lib::bench::RedirectingCurl;
+using spotify_lib::bench::SearchPayload;
+using spotify_lib::bench::StandInRequest;
+using spotify_lib::bench::StandInResponse;
+using spotify_lib::bench::StandInServer;
+
+using std::chrono::milliseconds;
+using std::chrono::steady_clock;
+
+namespace {
+
+/**
+ * @brief Build a page of a search of 1000 results.
+ *
+ * @param items Results of the page.
+ *
+ * @return The reply body.
+ */
+std::string PagePayload(std::size_t items) {
+  Json::Value reply;
+  Json::CharReaderBuilder reader;
+  std::string errors;
+  std::istringstream body{SearchPayload(items)};
+
+  Json::parseFromStream(reader, body, &reply, &errors);
+  reply["tracks"]["total"] = 1000;
+
+  return Json::writeString(Json::StreamWriterBuilder{}, reply);
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  int runs = argc > 1 ? std::atoi(argv[1]) : 5;
+  const milliseconds kRoundTrip{argc > 2 ? std::atoi(argv[2]) : 50};
+  const std::string kBody = PagePayload(50);
+
+  StandInServer server{[&](const StandInRequest &) {
+    return StandInResponse{200, kBody, {}, kRoundTrip};
+  }};
+
+  CurlOptions options;
+
+  options.ca_info = server.CaFile();
+  options.cache_bytes = 0;
+  options.max_idle_handles = 32;
+
+  auto curl = std::make_shared<RedirectingCurl>(server.BaseUri(), options);
+  Searcher searcher{curl};
+
+  for (std::size_t in_flight : {1, 4, 8, 19}) {
+    PagingOptions paging;
+    std::vector<double> latencies;
+    std::size_t results = 0;
+
+    paging.max_in_flight = in_flight;
+
+    /* the first run opens the connections. */
+    for (int r = 0; r <= runs; r++) {
+      auto start = steady_clock::now();
+      auto musics = searcher.SearchPaged(
+          "token", "umbrella", paging,
+          [](std::size_t, const std::vector<MusicInfo> &) {});
+
+      if (r > 0) {
+        latencies.push_back(Millis(steady_clock::now() - start).count());
+        results = musics.size();
+      }
+    }
+
+    double p50 = Percentile(latencies, 50);
+
+    std::cout << in_flight << " pages in flight: " << results
+              << " results, p50 " << p50 << " ms ("
+              << p50 / kRoundTrip.count() << " round trips)" << std::endl;
+  }
+
+  return 0;
+}
@@ -0,0 +1,99 @@
+/**
+ * @file
+ *
+ * @brief Benchmark of the prepared requests: counts the heap allocations made
+ * by the requesting thread to send a search, with the uri and the headers
+ * built on each call and with a prepared request, and the time per request.
+ * The replies aren't parsed (GetRaw), so that only the request side is
+ * measured. Must be run from the repository root.
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "common/alloc_counter.h"
+#include "common/latency_stats.h"
+#include "common/stand_in_server.h"
+#include "private/curl_wrapper.h"
+#include "private/prepared_request.h"
+
+using spotify_lib::CurlOptions;
+using spotify_lib::CurlWrapper;
+using spotify_lib::PreparedRequest;
+using spotify_lib::bench::AllocStats;
+using spotify_lib::bench::Millis;
+using spotify_lib::bench::StandInRequest;
+using spotify_lib::bench::StandInResponse;
+using spotify_lib::bench::StandInServer;
+using spotify_lib::bench::StartCounting;
+using spotify_lib::bench::StopCounting;
+
+using std::chrono::milliseconds;
+using std::chrono::steady_clock;
+
+int main(int argc, char *argv[]) {
+  int requests = argc > 1 ? std::atoi(argv[1]) : 500;
+  const std::string kToken{"BQDfaX1g4J5SFRz0xhGxH-5Bv4XFGg1rXJ2vI5yQeXh"};
+  const std::string kName{"the umbrella"};
+
+  StandInServer server{[](const StandInRequest &) {
+    return StandInResponse{200, "{\"tracks\":{\"items\":[]}}", {},
+                           milliseconds{0}};
+  }};
+
+  CurlOptions options;
+
+  options.ca_info = server.CaFile();
+
+  CurlWrapper curl{options};
+  const std::string kBaseUri{server.BaseUri() + "/v1/search?q="};
+  PreparedRequest request{kBaseUri + "{}&type=track&limit=10",
+                          {"Authorization: Bearer {}"}};
+
+  for (bool prepared : {false, true}) {
+    /* sends a search the way Searcher does, with or without preparing it. */
+    auto search = [&] {
+      if (prepared) {
+        request.Bind(kName, kToken);
+        return curl.GetRaw(request);
+      }
+
+      std::string uri{kBaseUri + kName + "&type=track&limit=10"};
+
+      std::replace(uri.begin(), uri.end(), ' ', '+');
+
+      return curl.GetRaw(uri, {"Authorization: Bearer " + kToken});
+    };
+
+    /* warm up the connection and the buffers. */
+    for (int i = 0; i < 10; i++) {
+      search();
+    }
+
+    AllocStats total{0, 0};
+    auto start = steady_clock::now();
+
+    for (int i = 0; i < requests; i++) {
+      StartCounting();
+
+      auto reply = search();
+      auto stats = StopCounting();
+
+      total.calls += stats.calls;
+      total.bytes += stats.bytes;
+    }
+
+    double elapsed = Millis(steady_clock::now() - start).count();
+
+    std::cout << (prepared ? "prepared: " : "built:    ")
+              << static_cast<double>(total.calls) / requests
+              << " allocations, " << total.bytes / requests
+              << " bytes allocated, " << elapsed * 1000 / requests
+              << " us per request" << std::endl;
+  }
+
+  return 0;
+}
@@ -0,0 +1,117 @@
+/**
+ * @file
+ *
+ * @brief Contention benchmark of the request coalescing: N threads issue the
+ * same search at once, in several consecutive waves, with the coalescing disabled and
+ * enabled, and the requests reaching the server and the latencies are
+ * reported. Must be run from the repository root.
+ */
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "common/latency_stats.h"
+#include "common/payloads.h"
+#include "common/stand_in_server.h"
+#include "private/curl_wrapper.h"
+
+using spotify_lib::CurlOptions;
+using spotify_lib::CurlWrapper;
+using spotify_lib::bench::Millis;
+using spotify_lib::bench::Percentile;
+using spotify_lib::bench::SearchPayload;
+using spotify_lib::bench::StandInRequest;
+using spotify_lib::bench::StandInResponse;
+using spotify_lib::bench::StandInServer;
+
+using std::chrono::milliseconds;
+using std::chrono::steady_clock;
+
+int main(int argc, char *argv[]) {
+  int threads = argc > 1 ? std::atoi(argv[1]) : 32;
+  int waves = argc > 2 ? std::atoi(argv[2]) : 20;
+  const std::string kBody = SearchPayload(100);
+
+  for (bool coalesce : {false, true}) {
+    StandInServer server{[&kBody](const StandInRequest &) {
+      return StandInResponse{200, kBody, {}, milliseconds{20}};
+    }};
+
+    CurlOptions options;
+
+    options.ca_info = server.CaFile();
+    options.cache_bytes = 0;
+    options.coalesce = coalesce;
+    options.max_idle_handles = threads;
+
+    CurlWrapper curl{options};
+    const std::string kUri{server.BaseUri() + "/v1/search?q=umbrella"};
+    const std::vector<std::string> kHeaders{"Authorization: Bearer token"};
+    std::mutex mutex;
+    std::condition_variable wave_start;
+    std::condition_variable wave_end;
+    int wave = -1;
+    int done = 0;
+    std::vector<std::vector<double>> latencies(threads);
+    std::vector<std::thread> workers;
+
+    for (int t = 0; t < threads; t++) {
+      workers.emplace_back([&, t] {
+        for (int w = 0; w < waves; w++) {
+          {
+            std::unique_lock<std::mutex> lock{mutex};
+
+            wave_start.wait(lock, [&] { return wave >= w; });
+          }
+
+          auto start = steady_clock::now();
+
+          curl.Get(kUri, kHeaders);
+          latencies[t].push_back(Millis(steady_clock::now() - start).count());
+
+          std::lock_guard<std::mutex> lock{mutex};
+
+          done++;
+          wave_end.notify_one();
+        }
+      });
+    }
+
+    auto start = steady_clock::now();
+
+    /* each wave starts once every thread finished the previous one. */
+    for (int w = 0; w < waves; w++) {
+      std::unique_lock<std::mutex> lock{mutex};
+
+      wave = w;
+      done = 0;
+      wave_start.notify_all();
+      wave_end.wait(lock, [&] { return done == threads; });
+    }
+
+    for (auto &w : workers) {
+      w.join();
+    }
+
+    double elapsed = Millis(steady_clock::now() - start).count();
+    std::vector<double> all;
+
+    for (auto &l : latencies) {
+      all.insert(all.end(), l.begin(), l.end());
+    }
+
+    std::cout << (coalesce ? "coalesced  " : "independent") << ": "
+              << threads * waves << " searches, " << server.Requests()
+              << " requests on the server, " << curl.Stats().coalesced
+              << " coalesced, p50 " << Percentile(all, 50) << " ms, p99 "
+              << Percentile(all, 99) << " ms, " << elapsed << " ms total"
+              << std::endl;
+  }
+
+  return 0;
+}
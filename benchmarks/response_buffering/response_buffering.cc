@@ -0,0 +1,80 @@
+/**
+ * @file
+ *
+ * @brief Benchmark of the response buffering: counts the heap allocations
+ * made by the requesting thread for each request (transfer and parsing) with
+ * search replies of different sizes. Must be run from the repository root.
+ */
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "common/alloc_counter.h"
+#include "common/latency_stats.h"
+#include "common/payloads.h"
+#include "common/stand_in_server.h"
+#include "private/curl_wrapper.h"
+
+using spotify_lib::CurlOptions;
+using spotify_lib::CurlWrapper;
+using spotify_lib::bench::AllocStats;
+using spotify_lib::bench::Millis;
+using spotify_lib::bench::SearchPayload;
+using spotify_lib::bench::StandInRequest;
+using spotify_lib::bench::StandInResponse;
+using spotify_lib::bench::StandInServer;
+using spotify_lib::bench::StartCounting;
+using spotify_lib::bench::StopCounting;
+
+using std::chrono::milliseconds;
+using std::chrono::steady_clock;
+
+int main(int argc, char *argv[]) {
+  int requests = argc > 1 ? std::atoi(argv[1]) : 50;
+  const std::vector<std::size_t> kSizes{10, 100, 1000};
+
+  for (auto items : kSizes) {
+    const std::string kBody = SearchPayload(items);
+
+    StandInServer server{[&kBody](const StandInRequest &) {
+      return StandInResponse{200, kBody, {}, milliseconds{0}};
+    }};
+
+    CurlOptions options;
+
+    options.ca_info = server.CaFile();
+
+    CurlWrapper curl{options};
+    const std::string kUri{server.BaseUri() + "/v1/search?q=umbrella"};
+    const std::vector<std::string> kHeaders{"Authorization: Bearer token"};
+
+    /* warm up the connection and the buffers. */
+    for (int i = 0; i < 3; i++) {
+      curl.Get(kUri, kHeaders);
+    }
+
+    AllocStats total{0, 0};
+    auto start = steady_clock::now();
+
+    for (int i = 0; i < requests; i++) {
+      StartCounting();
+
+      auto reply = curl.Get(kUri, kHeaders);
+      auto stats = StopCounting();
+
+      total.calls += stats.calls;
+      total.bytes += stats.bytes;
+    }
+
+    double elapsed = Millis(steady_clock::now() - start).count();
+
+    std::cout << items << " tracks (" << kBody.size() / 1024
+              << " KiB): " << total.calls / requests << " allocations, "
+              << total.bytes / requests / 1024 << " KiB allocated, "
+              << elapsed / requests << " ms per request" << std::endl;
+  }
+
+  return 0;
+}
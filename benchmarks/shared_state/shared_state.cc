@@ -0,0 +1,81 @@
+/**
+ * @file
+ *
+ * @brief Benchmark of the shared DNS and TLS state: measures the first request
+ * of brand new curl wrappers (the cold path of a new component), each one with
+ * its own state or all of them with a single shared one.
+ */
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/latency_stats.h"
+#include "common/stand_in_server.h"
+#include "private/curl_share.h"
+#include "private/curl_wrapper.h"
+
+using spotify_lib::CurlOptions;
+using spotify_lib::CurlShare;
+using spotify_lib::CurlWrapper;
+using spotify_lib::bench::Millis;
+using spotify_lib::bench::Percentile;
+using spotify_lib::bench::StandInRequest;
+using spotify_lib::bench::StandInResponse;
+using spotify_lib::bench::StandInServer;
+
+using std::chrono::milliseconds;
+using std::chrono::steady_clock;
+
+namespace {
+
+/**
+ * @brief Run the first request of several brand new wrappers.
+ *
+ * @param name Name of the scenario.
+ * @param server The stand-in server.
+ * @param share Shared state, null for none.
+ * @param wrappers Number of wrappers.
+ */
+void Run(const char *name, const StandInServer &server,
+         const std::shared_ptr<CurlShare> &share, int wrappers) {
+  const std::string kUri{server.BaseUri() + "/v1/search?q=umbrella"};
+  const std::vector<std::string> kHeaders{"Authorization: Bearer token"};
+  std::vector<double> latencies;
+  auto resumed = server.ResumedSessions();
+
+  for (int i = 0; i < wrappers; i++) {
+    CurlOptions options;
+
+    options.ca_info = server.CaFile();
+    options.share = share;
+
+    CurlWrapper curl{options};
+    auto start = steady_clock::now();
+
+    curl.Get(kUri, kHeaders);
+    latencies.push_back(Millis(steady_clock::now() - start).count());
+  }
+
+  std::cout << name << ": first request p50 " << Percentile(latencies, 50)
+            << " ms, p99 " << Percentile(latencies, 99) << " ms, "
+            << server.ResumedSessions() - resumed << "/" << wrappers
+            << " TLS sessions resumed" << std::endl;
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  int wrappers = argc > 1 ? std::atoi(argv[1]) : 200;
+
+  StandInServer server{[](const StandInRequest &) {
+    return StandInResponse{200, "{}", {}, milliseconds{0}};
+  }};
+
+  Run("own state   ", server, nullptr, wrappers);
+  Run("shared state", server, std::make_shared<CurlShare>(), wrappers);
+
+  return 0;
+}
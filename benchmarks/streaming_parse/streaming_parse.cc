@@ -0,0 +1,146 @@
+/**
+ * @file
+ *
+ * @brief Benchmark of the streaming parse: compares the time to the first
+ * music and to the whole result of a search reply parsed after the transfer
+ * (Get) and while the body arrives (GetStream), for replies of different sizes.
+ * Must be run from the repository root.
+ */
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <json/json.h>
+
+#include "common/latency_stats.h"
+#include "common/payloads.h"
+#include "common/stand_in_server.h"
+#include "private/curl_wrapper.h"
+#include "private/json_stream_splitter.h"
+
+using spotify_lib::CurlOptions;
+using spotify_lib::CurlWrapper;
+using spotify_lib::JsonStreamSplitter;
+using spotify_lib::bench::Millis;
+using spotify_lib::bench::Percentile;
+using spotify_lib::bench::SearchPayload;
+using spotify_lib::bench::StandInRequest;
+using spotify_lib::bench::StandInResponse;
+using spotify_lib::bench::StandInServer;
+
+using std::chrono::milliseconds;
+using std::chrono::steady_clock;
+
+namespace {
+
+/**
+ * @brief Timings of a single search.
+ */
+struct Timings {
+  double first;  //!< Time to the first music, in ms.
+  double total;  //!< Time to the whole result, in ms.
+};
+
+/**
+ * @brief Search parsing the whole body after the transfer.
+ */
+Timings Buffered(const CurlWrapper &curl, const std::string &uri,
+                 const std::vector<std::string> &headers) {
+  auto start = steady_clock::now();
+  auto reply = curl.Get(uri, headers);
+  std::vector<std::string> names;
+
+  for (auto &item : reply["tracks"]["items"]) {
+    names.emplace_back(item["name"].asString());
+  }
+
+  double total = Millis(steady_clock::now() - start).count();
+
+  return Timings{total, total};
+}
+
+/**
+ * @brief Search parsing each music as soon as its entry arrives.
+ */
+Timings Streamed(const CurlWrapper &curl, const std::string &uri,
+                 const std::vector<std::string> &headers) {
+  auto start = steady_clock::now();
+  double first = -1;
+  std::vector<std::string> names;
+  Json::CharReaderBuilder builder;
+  std::unique_ptr<Json::CharReader> reader{builder.newCharReader()};
+
+  JsonStreamSplitter splitter{
+      {"tracks", "items"}, [&](const char *data, std::size_t size) {
+        Json::Value item;
+
+        reader->parse(data, data + size, &item, nullptr);
+        names.emplace_back(item["name"].asString());
+
+        if (first < 0) {
+          first = Millis(steady_clock::now() - start).count();
+        }
+      }};
+
+  curl.GetStream(uri, headers, [&splitter](const char *data, std::size_t size) {
+    splitter.Feed(data, size);
+  });
+
+  return Timings{first, Millis(steady_clock::now() - start).count()};
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  int requests = argc > 1 ? std::atoi(argv[1]) : 50;
+  const std::vector<std::size_t> kSizes{10, 100, 1000, 5000};
+
+  for (auto items : kSizes) {
+    const std::string kBody = SearchPayload(items);
+
+    StandInServer server{[&kBody](const StandInRequest &) {
+      return StandInResponse{200, kBody, {}, milliseconds{0}};
+    }};
+
+    CurlOptions options;
+
+    options.ca_info = server.CaFile();
+
+    CurlWrapper curl{options};
+    const std::string kUri{server.BaseUri() + "/v1/search?q=umbrella"};
+    const std::vector<std::string> kHeaders{"Authorization: Bearer token"};
+
+    /* warm up the connection and the buffers. */
+    for (int i = 0; i < 3; i++) {
+      Buffered(curl, kUri, kHeaders);
+      Streamed(curl, kUri, kHeaders);
+    }
+
+    std::vector<double> buffered_first, buffered_total;
+    std::vector<double> streamed_first, streamed_total;
+
+    for (int i = 0; i < requests; i++) {
+      auto buffered = Buffered(curl, kUri, kHeaders);
+      auto streamed = Streamed(curl, kUri, kHeaders);
+
+      buffered_first.push_back(buffered.first);
+      buffered_total.push_back(buffered.total);
+      streamed_first.push_back(streamed.first);
+      streamed_total.push_back(streamed.total);
+    }
+
+    std::cout << items << " tracks (" << kBody.size() / 1024 << " KiB)"
+              << std::endl
+              << "  buffered: first music p50 "
+              << Percentile(buffered_first, 50) << " ms, whole result p50 "
+              << Percentile(buffered_total, 50) << " ms" << std::endl
+              << "  streamed: first music p50 "
+              << Percentile(streamed_first, 50) << " ms, whole result p50 "
+              << Percentile(streamed_total, 50) << " ms" << std::endl;
+  }
+
+  return 0;
+}
@@ -0,0 +1,160 @@
+/**
+ * @file
+ *
+ * @brief Benchmark of the reads of the current access token from many
+ * threads, while a writer renews it every millisecond: the token slot against
+ * a mutex guarding the token, either copied or shared by reference count.
+ * Reports the time per read and the total read rate for each number of
+ * threads.
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "private/token_slot.h"
+
+using spotify_lib::CachedToken;
+using spotify_lib::TokenSlot;
+
+using std::chrono::hours;
+using std::chrono::milliseconds;
+using std::chrono::steady_clock;
+
+namespace {
+
+const std::string kToken{
+    "BQDfaX1g4J5SFRz0xhGxH-5Bv4XFGg1rXJ2vI5yQeXhx4Wq1mOJ6Y5hAs2Zb9nRk3P"};
+
+/**
+ * @brief Token guarded by a mutex, the way a caller-side cache would keep it.
+ */
+struct LockedToken {
+  std::mutex mutex;
+  std::shared_ptr<const std::string> token;
+};
+
+/**
+ * @brief Make a token, valid for an hour.
+ *
+ * @return The token.
+ */
+CachedToken MakeToken() {
+  auto now = steady_clock::now();
+
+  return CachedToken{"credentials", kToken, now + hours{1}, now + hours{1},
+                     false};
+}
+
+/**
+ * @brief Run the readers along with a writer renewing the token.
+ *
+ * @param threads Number of readers.
+ * @param reads Reads per reader.
+ * @param read Read of the token, returning its size.
+ * @param renew Renewal of the token.
+ *
+ * @return Nanoseconds per read, per reader.
+ */
+template <typename Read, typename Renew>
+double Run(int threads, int reads, Read read, Renew renew) {
+  std::atomic<bool> done{false};
+  std::atomic<std::size_t> sink{0};
+  std::vector<std::thread> readers;
+  std::thread writer{[&done, &renew] {
+    while (!done) {
+      renew();
+      std::this_thread::sleep_for(milliseconds{1});
+    }
+  }};
+  auto start = steady_clock::now();
+
+  for (int i = 0; i < threads; i++) {
+    readers.emplace_back([reads, &read, &sink] {
+      std::size_t size = 0;
+
+      for (int j = 0; j < reads; j++) {
+        size += read();
+      }
+
+      sink += size;
+    });
+  }
+
+  for (auto &reader : readers) {
+    reader.join();
+  }
+
+  auto elapsed = steady_clock::now() - start;
+
+  done = true;
+  writer.join();
+
+  if (sink != static_cast<std::size_t>(threads) * reads * kToken.size()) {
+    std::cerr << "unexpected token size" << std::endl;
+  }
+
+  return std::chrono::duration<double, std::nano>(elapsed).count() / reads;
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  int reads = argc > 1 ? std::atoi(argv[1]) : 2000000;
+  int max_threads =
+      std::max(4, static_cast<int>(std::thread::hardware_concurrency()));
+  TokenSlot slot;
+  LockedToken locked;
+
+  slot.Publish("id", "secret", MakeToken());
+  locked.token = std::make_shared<const std::string>(kToken);
+
+  for (int threads = 1; threads <= max_threads; threads *= 2) {
+    double copied = Run(
+        threads, reads,
+        [&locked] {
+          std::string token;
+          {
+            std::lock_guard<std::mutex> lock{locked.mutex};
+            token = *locked.token;
+          }
+          return token.size();
+        },
+        [&locked] {
+          auto token = std::make_shared<const std::string>(kToken);
+          std::lock_guard<std::mutex> lock{locked.mutex};
+          locked.token = token;
+        });
+    double shared = Run(
+        threads, reads,
+        [&locked] {
+          std::shared_ptr<const std::string> token;
+          {
+            std::lock_guard<std::mutex> lock{locked.mutex};
+            token = locked.token;
+          }
+          return token->size();
+        },
+        [&locked] {
+          auto token = std::make_shared<const std::string>(kToken);
+          std::lock_guard<std::mutex> lock{locked.mutex};
+          locked.token = token;
+        });
+    double slotted = Run(
+        threads, reads, [&slot] { return slot.Read().size(); },
+        [&slot] { slot.Renew(MakeToken()); });
+
+    std::cout << threads << " threads: mutex + copy " << copied
+              << " ns/read, mutex + shared_ptr " << shared
+              << " ns/read, token slot " << slotted << " ns/read ("
+              << threads * 1e3 / slotted << " M reads/s)" << std::endl;
+  }
+
+  return 0;
+}
@@ -0,0 +1,59 @@
+/**
+ * @file
+ *
+ * @brief Batch search listener class definition.
+ */
+#ifndef BATCH_SEARCH_LISTENER_H_
+#define BATCH_SEARCH_LISTENER_H_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "search_listener.h"
+
+namespace spotify_lib {
+
+/**
+ * @interface BatchSearchListener.
+ *
+ * @brief This class defines a interface for the events of a batch search,
+ * each one carrying the index of its query in the batch.
+ */
+class BatchSearchListener : public SearchListener {
+ public:
+  /**
+   * @brief Report the musics found for a query.
+   *
+   * @param index Index of the query.
+   * @param result List of matching results.
+   */
+  virtual void OnQueryFound(std::size_t index,
+                            const std::vector<MusicInfo>& result) const = 0;
+
+  /**
+   * @brief Indicates a error while searching a query.
+   *
+   * @param index Index of the query.
+   * @param msg The suitable error message.
+   */
+  virtual void OnQueryError(std::size_t index,
+                            const std::string& msg) const = 0;
+
+  /**
+   * @brief Not reported by the batch searches, each query being reported by
+   * OnQueryFound.
+   */
+  void OnPatternFound(
+      const std::vector<MusicInfo>& /* result */) const override {}
+
+  /**
+   * @brief Not reported by the batch searches, each failure being reported
+   * by OnQueryError.
+   */
+  void OnSearchError(const std::string& /* msg */) const override {}
+};
+
+}  // namespace spotify_lib
+
+#endif  // BATCH_SEARCH_LISTENER_H_
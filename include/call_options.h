@@ -0,0 +1,61 @@
+/**
+ * @file
+ *
+ * @brief Call options class definition.
+ */
+#ifndef CALL_OPTIONS_H_
+#define CALL_OPTIONS_H_
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+
+namespace spotify_lib {
+
+/**
+ * @class CancellationToken.
+ *
+ * @brief This class lets a caller give up on the calls it made with the
+ * token. It can be cancelled from any thread; the transfers in flight are
+ * aborted within a second, and the calls fail with an error.
+ */
+class CancellationToken {
+ public:
+  /**
+   * @brief Constructor.
+   */
+  CancellationToken() : cancelled_{false} {}
+
+  CancellationToken(const CancellationToken&) = delete;
+  CancellationToken& operator=(const CancellationToken&) = delete;
+
+  /**
+   * @brief Cancel the calls made with the token.
+   */
+  void Cancel() { cancelled_ = true; }
+
+  /**
+   * @brief Check whether the token was cancelled.
+   *
+   * @return true if so, false otherwise.
+   */
+  bool Cancelled() const { return cancelled_; }
+
+ private:
+  std::atomic<bool> cancelled_;  //!< Whether the token was cancelled.
+};
+
+/**
+ * @brief This structure holds the options of a single call. The deadline
+ * covers the whole call, retries included: the transfers are aborted once
+ * it's reached, and no retry is scheduled beyond it.
+ */
+struct CallOptions {
+  std::chrono::steady_clock::time_point deadline{
+      std::chrono::steady_clock::time_point::max()};  //!< End of the call.
+  std::shared_ptr<const CancellationToken> token;  //!< Cancellation, may be null.
+};
+
+}  // namespace spotify_lib
+
+#endif  // CALL_OPTIONS_H_
@@ -0,0 +1,99 @@
+/**
+ * @file
+ *
+ * @brief Event loop class definition.
+ */
+#ifndef EVENT_LOOP_H_
+#define EVENT_LOOP_H_
+
+#include <chrono>
+
+namespace spotify_lib {
+
+/**
+ * @interface EventHandler.
+ *
+ * @brief This class defines a interface for the I/O events, implemented by
+ * the library. Its methods must be called from the loop's thread, they start
+ * the transfers due and invoke the completions of the finished ones.
+ */
+class EventHandler {
+ public:
+  /**
+   * @brief Report the readiness of a watched socket.
+   *
+   * @param fd The socket.
+   * @param events Events which occurred (EventLoop::kRead, kWrite, kError).
+   */
+  virtual void OnSocket(int fd, int events) = 0;
+
+  /**
+   * @brief Report the expiry of the handler's timer, or a wake up.
+   */
+  virtual void OnTimeout() = 0;
+
+ protected:
+  /**
+   * @brief Destructor.
+   */
+  ~EventHandler() = default;
+};
+
+/**
+ * @interface EventLoop.
+ *
+ * @brief This class defines a interface for an external event loop (epoll,
+ * asio, ...) driving the I/O of the asynchronous calls, instead of the
+ * library's event thread. Except for Wake, the methods are called from the
+ * loop's thread, from within the handler's methods or the library calls.
+ */
+class EventLoop {
+ public:
+  /**
+   * @brief Socket events.
+   */
+  enum Events { kNone = 0, kRead = 1, kWrite = 2, kError = 4 };
+
+  /**
+   * @brief Destructor.
+   */
+  virtual ~EventLoop() = default;
+
+  /**
+   * @brief Watch a socket, replacing the events watched so far.
+   *
+   * @param handler Handler of the socket events.
+   * @param fd The socket.
+   * @param events Events to be watched (kRead, kWrite), kNone to stop.
+   */
+  virtual void Watch(EventHandler& handler, int fd, int events) = 0;
+
+  /**
+   * @brief Arm the handler's timer, replacing the previous one.
+   *
+   * @param handler Handler of the timer expiry.
+   * @param timeout Time until the expiry, negative to disarm the timer.
+   */
+  virtual void SetTimer(EventHandler& handler,
+                        std::chrono::milliseconds timeout) = 0;
+
+  /**
+   * @brief Have OnTimeout called from the loop's thread as soon as possible.
+   * Unlike the other methods, it may be called from any thread.
+   *
+   * @param handler Handler to be woken up.
+   */
+  virtual void Wake(EventHandler& handler) = 0;
+
+  /**
+   * @brief Forget a handler which is being destroyed: its timer and the wake
+   * ups not delivered yet must be dropped.
+   *
+   * @param handler The handler.
+   */
+  virtual void Detach(EventHandler& handler) = 0;
+};
+
+}  // namespace spotify_lib
+
+#endif  // EVENT_LOOP_H_
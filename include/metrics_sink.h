@@ -0,0 +1,78 @@
+/**
+ * @file
+ *
+ * @brief Metrics sink class definition.
+ */
+#ifndef METRICS_SINK_H_
+#define METRICS_SINK_H_
+
+#include <chrono>
+#include <cstddef>
+
+namespace spotify_lib {
+
+/**
+ * @brief This structure holds the timing breakdown of a finished request. The
+ * phases are consecutive, a reused connection has no name lookup, connect or
+ * TLS handshake. It also carries the state of the concurrency limiter once
+ * the request gave its slot back.
+ */
+struct RequestMetrics {
+  const char* operation;  //!< "auth", "search", "playlist", "warmup", or empty.
+  const char* method;     //!< HTTP method.
+  const char* uri;        //!< Last uri requested, after the redirects.
+  long status;            //!< HTTP status, zero if no reply was received.
+  bool failed;            //!< Whether the transfer itself failed.
+  bool reused;            //!< Whether an open connection was reused.
+  std::chrono::microseconds dns;         //!< Name lookup.
+  std::chrono::microseconds connect;     //!< TCP connect.
+  std::chrono::microseconds tls;         //!< TLS handshake.
+  std::chrono::microseconds first_byte;  //!< From sending to the first byte.
+  std::chrono::microseconds total;       //!< Whole transfer.
+  std::chrono::microseconds parse;       //!< Parsing of the json reply.
+  std::size_t bytes_in;                  //!< Received bytes, headers included.
+  std::size_t bytes_out;                 //!< Sent bytes, headers included.
+  std::size_t limit;    //!< Window of the requests in flight, zero if unbounded.
+  std::size_t queued;   //!< Requests waiting for the window.
+  std::size_t shed;     //!< Requests rejected so far with a full queue.
+};
+
+/**
+ * @interface MetricsSink.
+ *
+ * @brief This class defines a interface for the request metrics. The calls
+ * are made from the requesting threads and from the library's event thread,
+ * so they may be concurrent, and any exception thrown is ignored.
+ */
+class MetricsSink {
+ public:
+  /**
+   * @brief Destructor.
+   */
+  virtual ~MetricsSink() = default;
+
+  /**
+   * @brief Report a finished request, retries and hedges included. The
+   * strings are only valid during the call.
+   *
+   * @param metrics Timing breakdown of the request.
+   */
+  virtual void OnRequest(const RequestMetrics& metrics) = 0;
+
+  /**
+   * @brief Report a finished operation (Auth, Search, ...), from its call to
+   * its result, the requests and the decoding included.
+   *
+   * @param operation "auth", "search" or "playlist". The "warmup" requests,
+   * made in the background, are only reported by OnRequest.
+   * @param elapsed Duration of the operation.
+   * @param failed Whether the operation failed.
+   */
+  virtual void OnOperation(const char* /* operation */,
+                           std::chrono::microseconds /* elapsed */,
+                           bool /* failed */) {}
+};
+
+}  // namespace spotify_lib
+
+#endif  // METRICS_SINK_H_
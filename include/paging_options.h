@@ -0,0 +1,28 @@
+/**
+ * @file
+ *
+ * @brief Paging options definition.
+ */
+#ifndef PAGING_OPTIONS_H_
+#define PAGING_OPTIONS_H_
+
+#include <cstddef>
+
+namespace spotify_lib {
+
+/**
+ * @brief This structure holds the options of a paged search. The first page
+ * tells the number of results; the remaining pages are then requested at
+ * once, up to a bound, each completion sending the next one. The page size
+ * and the number of results are clamped to what the search API serves.
+ */
+struct PagingOptions {
+  std::size_t page_size{50};      //!< Results per page, up to 50.
+  std::size_t max_results{1000};  //!< Bound of the results, up to 1000.
+  std::size_t max_in_flight{8};   //!< Pages requested at once.
+  bool in_order{true};  //!< Report the pages by offset, or as they complete.
+};
+
+}  // namespace spotify_lib
+
+#endif  // PAGING_OPTIONS_H_
@@ -6,17 +6,45 @@
 #ifndef SPOTIFY_AUTH_H_
 #define SPOTIFY_AUTH_H_
 
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <functional>
 #include <string>
 #include <memory>
+#include <vector>
 
+#include "private/credential_pool.h"
 #include "private/curl_wrapper.h"
+#include "private/singleflight.h"
+#include "private/token_cache.h"
+#include "private/token_slot.h"
+#include "private/token_store.h"
 
 namespace spotify_lib {
 
+/**
+ * @brief Completion callback of the asynchronous authentications.
+ */
+using AuthCallback =
+    std::function<void(std::exception_ptr error, const std::string &token)>;
+
 /**
  * @class Authenticator.
  *
  * @brief This class implements the authentication mechanism to Spotify API.
+ *
+ * The tokens are cached by client ID until they're about to expire, and
+ * refreshed in the background ahead of their expiry (see TokenCache): while a
+ * client keeps authenticating, only its first call waits for the accounts
+ * service. The concurrent calls missing the cache share a single request.
+ *
+ * Given a token file, the tokens are also shared with the other processes of
+ * the node (see TokenStore): a process starting up reuses a valid token
+ * instead of requesting its own.
+ *
+ * Given a credential pool, the calls made without a token are spread over its
+ * credentials (see CredentialPool), each keeping its own token.
  */
 class Authenticator {
    public:
@@ -24,8 +52,14 @@ class Authenticator {
      * @brief Constructor.
      *
      * @param curl Lib curl handler.
+     * @param token_file Path of the file sharing the tokens across processes,
+     * empty to keep them in memory only.
+     * @param pool Credentials the calls made without a token are spread over,
+     * null to make them with the token granted last.
      */
-    explicit Authenticator(const std::shared_ptr<CurlWrapper> &curl = nullptr);
+    explicit Authenticator(const std::shared_ptr<CurlWrapper> &curl = nullptr,
+                           const std::string &token_file = "",
+                           const std::shared_ptr<CredentialPool> &pool = nullptr);
 
     /**
      * @brief Authenticate an user into the Spotify API using the client credentials flow
@@ -38,9 +72,145 @@ class Authenticator {
      */
     std::string AuthUser(const std::string &cli_id, const std::string &cli_secret) const;
 
+    /**
+     * @brief Authenticate an user into the Spotify API without blocking the
+     * caller. A request in flight for the same credentials, sync or async,
+     * is joined instead of sending another one.
+     *
+     * @param client_id Client ID.
+     * @param client_secret Client secret.
+     * @param callback Completion callback, invoked from the thread finishing
+     * the request, or right away with a cached token.
+     */
+    void AuthUserAsync(const std::string &cli_id, const std::string &cli_secret,
+                       const AuthCallback &callback) const;
+
+    /**
+     * @brief Get the token granted last, to make the calls with when the
+     * caller doesn't give one. It's read without any lock; once it's due for a
+     * refresh, a single caller starts it in the background, and once it
+     * expired it's requested again with the same credentials.
+     *
+     * @return The access token.
+     */
+    std::string Token() const;
+
+    /**
+     * @brief Get the token to make a call with when the caller doesn't give
+     * one: the one of a credential picked from the pool, or the token granted
+     * last without a pool.
+     *
+     * @param query Query of the call.
+     * @param credential Set to the index of the credential picked, untouched
+     * without a pool.
+     *
+     * @return The access token.
+     */
+    std::string Token(const std::string &query, std::size_t *credential) const;
+
+    /**
+     * @brief Get the credential pool.
+     *
+     * @return The pool, may be null.
+     */
+    const std::shared_ptr<CredentialPool> &Pool() const { return pool_; }
+
+    /**
+     * @brief Open connections to the accounts service in the background, so
+     * that the first authentication doesn't wait for them.
+     *
+     * @param connections Number of connections.
+     */
+    void Warmup(std::size_t connections) const;
+
    private:
+    /**
+     * @brief Get a token once the one read from a slot is missing or due for
+     * a refresh: the refresh is started in the background, and a missing one
+     * is requested again.
+     *
+     * @param slot Slot the token is published in.
+     * @param client_id Client ID.
+     * @param client_secret Client secret.
+     *
+     * @return The access token, as Token().
+     */
+    std::string Renewed(const TokenSlot &slot, const std::string &cli_id,
+                        const std::string &cli_secret) const;
+
+    /**
+     * @brief Request a token from the accounts service and cache it.
+     *
+     * @param client_id Client ID.
+     * @param client_secret Client secret.
+     *
+     * @return The access token.
+     */
+    std::string Fetch(const std::string &cli_id,
+                      const std::string &cli_secret) const;
+
+    /**
+     * @brief Refresh the cached token of a client in the background, unless a
+     * fresher one is found in the token store.
+     *
+     * @param client_id Client ID.
+     * @param client_secret Client secret.
+     */
+    void Refresh(const std::string &cli_id,
+                 const std::string &cli_secret) const;
+
+    /**
+     * @brief Adopt the token of a client found in the token store: cache it
+     * and publish it as the current one, and as its credential's in the pool.
+     *
+     * @param client_id Client ID.
+     * @param client_secret Client secret.
+     * @param renew Whether it renews a token due for a refresh, and so must
+     * not be due itself, or replaces a missing or expired one.
+     * @param token Set to the token adopted.
+     *
+     * @return true if a token was adopted, false otherwise.
+     */
+    bool Load(const std::string &cli_id, const std::string &cli_secret,
+              bool renew, std::string *token) const;
+
+    /**
+     * @brief Build the headers of the token request.
+     *
+     * @param client_id Client ID.
+     * @param client_secret Client secret.
+     *
+     * @return The request headers.
+     */
+    static std::vector<std::string> BuildHeaders(const std::string &cli_id,
+                                                 const std::string &cli_secret);
+
+    /**
+     * @brief Extract the access token from the reply of the accounts service.
+     *
+     * @param reply Token reply.
+     *
+     * @return The access token.
+     */
+    static std::string ParseReply(const Json::Value &reply);
+
+    /**
+     * @brief Extract the lifetime of the access token from the reply of the
+     * accounts service, either a number or a string.
+     *
+     * @param reply Token reply.
+     *
+     * @return The lifetime, zero if it's missing or invalid.
+     */
+    static std::chrono::seconds ParseLifetime(const Json::Value &reply);
+
     const std::string kUri_; //!< Uri for authentication.
     std::shared_ptr<CurlWrapper> curl_; //!< Lib curl handler.
+    std::shared_ptr<TokenCache> tokens_; //!< Cached tokens, shared with the refreshes.
+    std::shared_ptr<TokenSlot> current_; //!< Token granted last, shared with the refreshes.
+    std::shared_ptr<TokenStore> store_; //!< Tokens shared across processes, may be null.
+    std::shared_ptr<CredentialPool> pool_; //!< Credentials of the calls without a token, may be null.
+    mutable Singleflight<std::string> flights_; //!< Token requests in flight.
 };
 
 }  // namespace spotify_lib
@@ -0,0 +1,143 @@
+/**
+ * @file
+ *
+ * @brief Call context class definition.
+ */
+#ifndef CALL_CONTEXT_H_
+#define CALL_CONTEXT_H_
+
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+#include "call_options.h"
+
+namespace spotify_lib {
+
+/**
+ * @class CallAbortedError.
+ *
+ * @brief This class represents the failure of a call which was cancelled or
+ * ran past its deadline.
+ */
+class CallAbortedError : public std::runtime_error {
+   public:
+    using std::runtime_error::runtime_error;
+};
+
+/**
+ * @brief This structure holds the context of the library call being served
+ * by a thread. The requests made meanwhile pick it up, and the asynchronous
+ * ones carry it over to the event thread.
+ */
+struct CallContext {
+  /**
+   * @brief Constructor.
+   *
+   * @param operation Operation of the call.
+   * @param deadline End of the call, none by default.
+   * @param token Cancellation, may be null.
+   */
+  explicit CallContext(const char* operation = "",
+                       std::chrono::steady_clock::time_point deadline =
+                           std::chrono::steady_clock::time_point::max(),
+                       std::shared_ptr<const CancellationToken> token = nullptr)
+      : operation{operation}, deadline{deadline}, token{std::move(token)} {}
+
+  const char* operation; //!< "auth", "search", "playlist", "warmup", or empty.
+  std::chrono::steady_clock::time_point deadline; //!< End of the call.
+  std::shared_ptr<const CancellationToken> token; //!< Cancellation, may be null.
+  bool failover{false}; //!< Whether a 429 is reported right away, for the caller to switch credentials.
+
+  /**
+   * @brief Check whether the call was cancelled.
+   *
+   * @return true if so, false otherwise.
+   */
+  bool Cancelled() const { return token && token->Cancelled(); }
+
+  /**
+   * @brief Check whether the deadline is reached within some time.
+   *
+   * @param delay Time from now.
+   * @return true if so, false otherwise.
+   */
+  bool Expires(std::chrono::steady_clock::duration delay =
+                   std::chrono::steady_clock::duration::zero()) const;
+
+  /**
+   * @brief Throw a CallAbortedError if the call was cancelled or ran past its
+   * deadline.
+   */
+  void Check() const;
+
+  /**
+   * @brief Wait for a result, giving up once the call is cancelled or runs
+   * past its deadline. The cancellation is polled, so it's noticed within
+   * 50 ms.
+   *
+   * @param result Future of the result.
+   */
+  template <typename Future>
+  void Await(const Future& result) const {
+    constexpr std::chrono::milliseconds kSlice{50};
+
+    if (!token && deadline == std::chrono::steady_clock::time_point::max()) {
+      result.wait();
+      return;
+    }
+
+    for (;;) {
+      Check();
+
+      auto until = token ? std::min(deadline,
+                                    std::chrono::steady_clock::now() + kSlice)
+                         : deadline;
+
+      if (result.wait_until(until) == std::future_status::ready) {
+        return;
+      }
+    }
+  }
+
+  /**
+   * @brief Get the context of the calling thread.
+   *
+   * @return The current context, an empty one outside of any call.
+   */
+  static const CallContext& Current();
+};
+
+/**
+ * @class CallScope.
+ *
+ * @brief This class sets the context of the calling thread for its lifetime,
+ * and then restores the previous one.
+ */
+class CallScope {
+   public:
+    /**
+     * @brief Constructor.
+     *
+     * @param context Context of the call.
+     */
+    explicit CallScope(const CallContext& context);
+
+    /**
+     * @brief Destructor.
+     */
+    ~CallScope();
+
+    CallScope(const CallScope&) = delete;
+    CallScope& operator=(const CallScope&) = delete;
+
+   private:
+    CallContext previous_; //!< Context restored on the way out.
+};
+
+}  // namespace spotify_lib
+
+#endif  // CALL_CONTEXT_H_
@@ -0,0 +1,144 @@
+/**
+ * @file
+ *
+ * @brief Concurrency limiter class definition.
+ */
+#ifndef CONCURRENCY_LIMITER_H_
+#define CONCURRENCY_LIMITER_H_
+
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace spotify_lib {
+
+/**
+ * @brief This structure holds the settings of the concurrency limiter.
+ */
+struct LimiterOptions {
+  std::size_t initial_limit{32}; //!< Starting window, zero disables the limiter.
+  std::size_t min_limit{4}; //!< Smallest window.
+  std::size_t max_limit{256}; //!< Largest window.
+  double backoff_ratio{0.7}; //!< Window kept on a decrease.
+  double latency_tolerance{2.0}; //!< Latency over the one without load seen as overload.
+  std::size_t max_queued{1024}; //!< Requests waiting for the window, the next ones are shed.
+};
+
+/**
+ * @brief This structure holds the state of the concurrency limiter.
+ */
+struct LimiterStats {
+  std::size_t limit;      //!< Current window.
+  std::size_t in_flight;  //!< Requests holding a slot.
+  std::size_t queued;     //!< Requests waiting for a slot.
+  std::size_t shed;       //!< Requests rejected with a full queue.
+};
+
+/**
+ * @class ConcurrencyLimiter.
+ *
+ * @brief This class bounds the number of requests in flight with a window
+ * sized from what the server is going through (AIMD). Each request completed
+ * within the latency tolerance, compared with the latency without load of its
+ * host (the fastest requests seen there), widens the window by one slot per
+ * window; a rejected or failed request, or a slow one, shrinks it by the
+ * backoff ratio, at most once per round trip. The latency sampled is the
+ * server's, without the connection setup, so that a new connection isn't
+ * taken for an overload. The
+ * requests exceeding the window wait in order, and once the queue is full
+ * they are shed right away instead of piling up.
+ */
+class ConcurrencyLimiter {
+   public:
+    /**
+     * @brief Outcome of a request, which drives the window.
+     */
+    enum class Outcome {
+      kSuccess, //!< Completed, its latency is sampled.
+      kDropped, //!< Rejected by the server or failed on the way.
+      kIgnored  //!< Aborted on the client side, says nothing about the server.
+    };
+
+    /**
+     * @brief Constructor.
+     *
+     * @param options Limiter settings.
+     */
+    explicit ConcurrencyLimiter(const LimiterOptions &options);
+
+    /**
+     * @brief Take a slot, waiting for one when the window is full. The wait
+     * ends with a CallAbortedError once the call of the calling thread is
+     * cancelled or runs past its deadline; the slot granted later is then
+     * given back right away.
+     *
+     * @return True when the slot is taken, false when the request is shed.
+     */
+    bool Acquire();
+
+    /**
+     * @brief Take a slot only if one is free right away, for the optional
+     * requests.
+     *
+     * @return True when the slot is taken.
+     */
+    bool TryAcquire();
+
+    /**
+     * @brief Take a slot without blocking the caller.
+     *
+     * @param on_granted Callback invoked once the slot is taken, right away
+     * or from the thread releasing a slot.
+     *
+     * @return False when the request is shed, the callback isn't invoked.
+     */
+    bool AcquireAsync(const std::function<void()> &on_granted);
+
+    /**
+     * @brief Give a slot back.
+     *
+     * @param outcome Outcome of the request.
+     * @param latency Latency of the request, from its sending to the first
+     * byte of the reply.
+     * @param host Host of the request, whose latency without load the
+     * latency is compared with.
+     */
+    void Release(Outcome outcome, std::chrono::microseconds latency,
+                 const std::string &host = "");
+
+    /**
+     * @brief Get the state of the limiter.
+     *
+     * @return Snapshot of the state.
+     */
+    LimiterStats Stats() const;
+
+   private:
+    /**
+     * @brief Update the window with an outcome. Must be called with the
+     * mutex held.
+     *
+     * @param outcome Outcome of the request.
+     * @param latency Latency of the request.
+     * @param host Host of the request.
+     */
+    void Adjust(Outcome outcome, std::chrono::microseconds latency,
+                const std::string &host);
+
+    const LimiterOptions kOptions_; //!< Limiter settings.
+    mutable std::mutex mutex_; //!< Protects the state.
+    double limit_; //!< Current window, fractional between increases.
+    std::size_t in_flight_; //!< Requests holding a slot.
+    std::size_t shed_; //!< Shed requests.
+    std::unordered_map<std::string, double> baselines_us_; //!< Latency without load, by host.
+    std::chrono::steady_clock::time_point last_decrease_; //!< Last window decrease.
+    std::deque<std::function<void()>> waiters_; //!< Requests waiting for a slot.
+};
+
+}  // namespace spotify_lib
+
+#endif  // CONCURRENCY_LIMITER_H_
@@ -0,0 +1,145 @@
+/**
+ * @file
+ *
+ * @brief Credential pool class definition.
+ */
+#ifndef CREDENTIAL_POOL_H_
+#define CREDENTIAL_POOL_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "private/token_cache.h"
+#include "private/token_slot.h"
+
+namespace spotify_lib {
+
+/**
+ * @brief This structure holds the credentials of a client.
+ */
+struct Credentials {
+  std::string client_id;      //!< Client ID.
+  std::string client_secret;  //!< Client secret.
+};
+
+/**
+ * @brief Assignment of the calls to the credentials of a pool.
+ */
+enum class PoolPolicy {
+  kRoundRobin,            //!< Each call takes the next credential.
+  kLeastRecentlyLimited,  //!< Each call takes the credential limited the longest ago.
+  kQueryHash              //!< The calls for a query stick to a credential.
+};
+
+/**
+ * @class CredentialPool.
+ *
+ * @brief This class holds several client credentials, each rate limited on
+ * its own by the API, along with the token of each. The calls are spread over
+ * them according to a policy; a credential told to slow down (429) is parked
+ * until its Retry-After expires, the calls going to the others meanwhile. It
+ * can be used from several threads.
+ */
+class CredentialPool {
+   public:
+    /**
+     * @brief Constructor.
+     *
+     * @param credentials Credentials of the pool, at least one.
+     * @param policy Assignment of the calls to the credentials.
+     */
+    CredentialPool(const std::vector<Credentials> &credentials,
+                   PoolPolicy policy = PoolPolicy::kRoundRobin);
+
+    CredentialPool(const CredentialPool &) = delete;
+    CredentialPool &operator=(const CredentialPool &) = delete;
+
+    /**
+     * @brief Pick the credential of a call, skipping the parked ones.
+     *
+     * @param query Query of the call, used by PoolPolicy::kQueryHash.
+     *
+     * @return Index of the credential. An HttpError (429) is thrown if all of
+     * them are parked, with the time left until the first one is back.
+     */
+    std::size_t Pick(const std::string &query) const;
+
+    /**
+     * @brief Get the credentials at an index.
+     *
+     * @param index Index of the credential.
+     *
+     * @return The credentials.
+     */
+    const Credentials &At(std::size_t index) const;
+
+    /**
+     * @brief Get the token slot of the credential at an index.
+     *
+     * @param index Index of the credential.
+     *
+     * @return The slot.
+     */
+    TokenSlot &Slot(std::size_t index) const;
+
+    /**
+     * @brief Publish a new token in the slot of the credential it was granted
+     * to, if it belongs to the pool.
+     *
+     * @param client_id Client ID.
+     * @param client_secret Client secret.
+     * @param token The token.
+     */
+    void Publish(const std::string &client_id, const std::string &client_secret,
+                 const CachedToken &token) const;
+
+    /**
+     * @brief Give back the refresh claimed on the token of a credential after
+     * it failed, if it belongs to the pool.
+     *
+     * @param client_id Client ID.
+     * @param client_secret Client secret.
+     * @param delay Time before the next claim.
+     */
+    void RetryRefresh(const std::string &client_id,
+                      const std::string &client_secret,
+                      std::chrono::steady_clock::duration delay) const;
+
+    /**
+     * @brief Park a rate limited credential.
+     *
+     * @param index Index of the credential.
+     * @param retry_after Delay asked by the server, a second if not given.
+     */
+    void Park(std::size_t index, std::chrono::seconds retry_after) const;
+
+    /**
+     * @brief Get the number of credentials.
+     *
+     * @return The size of the pool.
+     */
+    std::size_t Size() const { return entries_.size(); }
+
+   private:
+    /**
+     * @brief This structure holds a credential of the pool.
+     */
+    struct Entry {
+        Credentials credentials; //!< The credentials.
+        TokenSlot slot; //!< Current token.
+        std::atomic<std::chrono::steady_clock::rep> parked_until; //!< End of the parking.
+        std::atomic<std::chrono::steady_clock::rep> limited_at; //!< Last 429, zero if never.
+    };
+
+    const PoolPolicy kPolicy_; //!< Assignment of the calls.
+    std::vector<std::unique_ptr<Entry>> entries_; //!< The credentials.
+    mutable std::atomic<std::size_t> next_; //!< Next credential in turn.
+};
+
+}  // namespace spotify_lib
+
+#endif  // CREDENTIAL_POOL_H_
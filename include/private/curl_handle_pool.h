@@ -0,0 +1,152 @@
+/**
+ * @file
+ *
+ * @brief Curl handle pool class definition.
+ */
+#ifndef CURL_HANDLE_POOL_H_
+#define CURL_HANDLE_POOL_H_
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <curl/curl.h>
+
+#include "private/response_buffer.h"
+
+namespace spotify_lib {
+
+/**
+ * @class CurlHandlePool.
+ *
+ * @brief This class keeps a set of idle libcurl easy handles which can be
+ * checked out by any thread. Since each easy handle owns its own connection
+ * and DNS caches, reusing them keeps the connections with the remote hosts
+ * alive between requests. Each handle carries the buffer which receives the
+ * response bodies, so the buffer storage is reused as well. The handles keep
+ * their options between leases: the options which don't change from request
+ * to request are only set once, and the holder of a lease sets the others on
+ * each request.
+ */
+class CurlHandlePool {
+   public:
+    /**
+     * @brief This structure holds a pooled handle and its response buffer.
+     */
+    struct Entry {
+      CURL *handle;
+      ResponseBuffer buffer;
+      bool configured;
+    };
+
+    /**
+     * @class Lease.
+     *
+     * @brief Scoped ownership of a pooled handle. The handle is given back to
+     * the pool when the lease is destroyed.
+     */
+    class Lease {
+       public:
+        /**
+         * @brief Constructor.
+         *
+         * @param pool Owner pool.
+         * @param entry Checked out entry.
+         */
+        Lease(CurlHandlePool *pool, std::unique_ptr<Entry> entry);
+
+        /**
+         * @brief Move constructor.
+         */
+        Lease(Lease &&other) noexcept;
+
+        /**
+         * @brief Destructor.
+         */
+        ~Lease();
+
+        Lease(const Lease &) = delete;
+        Lease &operator=(const Lease &) = delete;
+        Lease &operator=(Lease &&) = delete;
+
+        /**
+         * @brief Get the leased handle.
+         *
+         * @return The libcurl easy handle.
+         */
+        CURL *Get() const { return entry_->handle; }
+
+        /**
+         * @brief Get the response buffer of the leased handle.
+         *
+         * @return The response buffer.
+         */
+        ResponseBuffer &Buffer() const { return entry_->buffer; }
+
+        /**
+         * @brief Get the flag telling whether the options which don't change
+         * between requests were set on the handle.
+         *
+         * @return The flag, set by the holder of the lease.
+         */
+        bool &Configured() const { return entry_->configured; }
+
+       private:
+        CurlHandlePool *pool_; //!< Owner pool.
+        std::unique_ptr<Entry> entry_; //!< Leased entry.
+    };
+
+    /**
+     * @brief Constructor.
+     *
+     * @param max_idle Maximum number of idle handles kept by the pool. When
+     * zero, every lease uses a brand new handle (no connection reuse).
+     */
+    explicit CurlHandlePool(std::size_t max_idle);
+
+    /**
+     * @brief Destructor.
+     */
+    ~CurlHandlePool();
+
+    CurlHandlePool(const CurlHandlePool &) = delete;
+    CurlHandlePool &operator=(const CurlHandlePool &) = delete;
+
+    /**
+     * @brief Check out a handle, creating a new one when there isn't any idle.
+     *
+     * @return The lease of the handle.
+     */
+    Lease Acquire();
+
+    /**
+     * @brief Get the number of idle handles.
+     *
+     * @return Number of idle handles.
+     */
+    std::size_t IdleCount() const;
+
+   private:
+    /**
+     * @brief Give a handle back to the pool.
+     *
+     * @param entry Entry to be released.
+     */
+    void Release(std::unique_ptr<Entry> entry);
+
+    /**
+     * @brief Destroy an entry.
+     *
+     * @param entry Entry to be destroyed.
+     */
+    static void Destroy(std::unique_ptr<Entry> entry);
+
+    const std::size_t kMaxIdle_; //!< Maximum number of idle handles.
+    mutable std::mutex mutex_; //!< Protects the idle list.
+    std::vector<std::unique_ptr<Entry>> idle_; //!< Idle entries, most recently used last.
+};
+
+}  // namespace spotify_lib
+
+#endif  // CURL_HANDLE_POOL_H_
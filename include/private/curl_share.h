@@ -0,0 +1,85 @@
+/**
+ * @file
+ *
+ * @brief Curl share class definition.
+ */
+#ifndef CURL_SHARE_H_
+#define CURL_SHARE_H_
+
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include <curl/curl.h>
+
+#include "private/tls_session_store.h"
+
+namespace spotify_lib {
+
+/**
+ * @class CurlShare.
+ *
+ * @brief This class holds the state shared by the libcurl handles of every
+ * curl wrapper using it: the DNS cache and the TLS sessions. A process
+ * keeping a single instance resolves each host once and resumes the TLS
+ * sessions of the hosts already contacted, instead of doing full handshakes.
+ *
+ * The connections themselves aren't shared through it, since libcurl doesn't
+ * support using a shared connection cache from concurrent threads; they are
+ * shared by the components using the same curl wrapper.
+ *
+ * Given a session file, the TLS sessions also outlive the process: a
+ * restarted one resumes them from the file (see TlsSessionStore).
+ */
+class CurlShare {
+   public:
+    /**
+     * @brief Constructor.
+     *
+     * @param tls_session_file Path of the file keeping the TLS sessions across
+     * restarts, empty to keep them in memory only.
+     */
+    explicit CurlShare(const std::string &tls_session_file = "");
+
+    /**
+     * @brief Destructor.
+     */
+    ~CurlShare();
+
+    CurlShare(const CurlShare &) = delete;
+    CurlShare &operator=(const CurlShare &) = delete;
+
+    /**
+     * @brief Get the libcurl share handle.
+     *
+     * @return The share handle.
+     */
+    CURLSH *Get() const { return handle_; }
+
+    /**
+     * @brief Get the store of the TLS sessions.
+     *
+     * @return The store, null without a session file.
+     */
+    const TlsSessionStore *Sessions() const { return sessions_.get(); }
+
+   private:
+    /**
+     * @brief Libcurl callback. It locks the mutex of the shared data.
+     */
+    static void Lock(CURL *handle, curl_lock_data data, curl_lock_access access,
+                     void *userp);
+
+    /**
+     * @brief Libcurl callback. It unlocks the mutex of the shared data.
+     */
+    static void Unlock(CURL *handle, curl_lock_data data, void *userp);
+
+    CURLSH *handle_; //!< Libcurl share handle.
+    std::mutex locks_[CURL_LOCK_DATA_LAST]; //!< One lock per kind of data.
+    std::unique_ptr<TlsSessionStore> sessions_; //!< Persistent TLS sessions, may be null.
+};
+
+}  // namespace spotify_lib
+
+#endif  // CURL_SHARE_H_
@@ -6,29 +6,167 @@
 #ifndef CURL_WRAPPER_H_
 #define CURL_WRAPPER_H_
 
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
 #include <vector>
 
 #include <curl/curl.h>
 #include <json/json.h>
 
+#include "event_loop.h"
+#include "metrics_sink.h"
+#include "private/concurrency_limiter.h"
+#include "private/curl_handle_pool.h"
+#include "private/curl_share.h"
+#include "private/hedge_policy.h"
+#include "private/http_error.h"
+#include "private/prepared_request.h"
+#include "private/response_cache.h"
+#include "private/retry_scheduler.h"
+#include "private/singleflight.h"
+#include "private/request_engine.h"
+
 namespace spotify_lib {
 
+struct CurlTransfer;
+
+/**
+ * @brief This structure holds the settings of the curl wrapper.
+ */
+struct CurlOptions {
+  std::size_t max_idle_handles{8}; //!< Idle handles kept for connection reuse.
+  std::string ca_info; //!< CA bundle path, empty uses the libcurl default.
+  bool http2{false}; //!< Multiplex the requests over HTTP/2 connections.
+  long max_concurrent_streams{100}; //!< Streams per HTTP/2 connection.
+  std::shared_ptr<CurlShare> share; //!< DNS and TLS state shared with other wrappers.
+  bool compression{true}; //!< Ask for compressed replies (gzip, brotli, ...).
+  std::size_t cache_bytes{8 * 1024 * 1024}; //!< Bound of the response cache, zero disables it.
+  bool coalesce{false}; //!< Share a single transfer between identical GETs, opt-in.
+  RetryOptions retry; //!< Pacing and retries of the requests.
+  LimiterOptions limiter; //!< Window of the requests in flight.
+  HedgeOptions hedge; //!< Duplicates of the slow GET requests.
+  std::chrono::milliseconds timeout{15000}; //!< Bound of a whole transfer.
+  std::shared_ptr<MetricsSink> metrics; //!< Receiver of the request timings, may be null.
+  std::shared_ptr<EventLoop> loop; //!< Loop driving the asynchronous requests, null for the event thread.
+};
+
+/**
+ * @brief This structure holds the transfer counters of the curl wrapper.
+ */
+struct CurlStats {
+  std::size_t requests;     //!< Finished transfers.
+  std::size_t connections;  //!< Connections opened by the transfers.
+  std::size_t wire_bytes;   //!< Bytes received, headers and encoded bodies.
+  std::size_t body_bytes;   //!< Bytes of the bodies after decompression.
+  std::size_t cache_hits;   //!< Replies served from the response cache.
+  std::size_t coalesced;    //!< GETs which joined an identical one in flight.
+  std::size_t retries;      //!< Requests sent again after a 429 or 5xx reply.
+  std::size_t limit;        //!< Current window of the concurrency limiter.
+  std::size_t queued;       //!< Requests waiting for the window.
+  std::size_t shed;         //!< Requests rejected with a full queue.
+  std::size_t hedged;       //!< Duplicates sent for slow GETs.
+};
+
+/**
+ * @brief Completion callback of the asynchronous requests. On failure the
+ * error holds the exception that the synchronous call would have thrown.
+ */
+using JsonCallback =
+    std::function<void(std::exception_ptr error, const Json::Value &reply)>;
+
+/**
+ * @brief Chunk callback of the streaming requests, invoked from inside the
+ * transfer as the body arrives. The data is only valid during the call.
+ */
+using ChunkCallback = std::function<void(const char *data, std::size_t size)>;
+
 /**
  * @class CurlWrapper.
  *
- * @brief This class wraps some of functionalities of libcurl.
+ * @brief This class wraps some of functionalities of libcurl. The requests can
+ * be performed from several threads at the same time, each one uses a handle
+ * checked out from an internal pool, so the connections are kept alive and
+ * reused between requests. The asynchronous requests run concurrently on a
+ * single event thread, owned by the wrapper.
+ *
+ * The replies of the GET requests (Get and GetAsync) carrying an ETag or a
+ * Last-Modified header are kept in a bounded response cache. The following
+ * requests for the same uri and headers are sent with the conditional headers
+ * and a 304 reply returns the cached response, without parsing anything.
+ *
+ * With coalescing enabled (CurlOptions::coalesce), the blocking GET requests
+ * (Get and GetRaw) made while an identical one, same uri and headers, is in
+ * flight join it rather than being sent: they share its transfer and parsing,
+ * and get its result or its error.
+ *
+ * The requests are paced per host by a retry scheduler (see RetryScheduler).
+ * A reply with a 429 or 5xx status isn't handed over as a response: the
+ * request is sent again after the delay asked by the server (Retry-After) or
+ * a jittered backoff, and once the retries are exhausted an HttpError is
+ * thrown, or passed to the completion callback. The POST requests, which the
+ * server may have handled before failing, are only sent again after a 429 or
+ * 503 reply with a Retry-After delay.
+ *
+ * The requests in flight are bounded by an adaptive window (see
+ * ConcurrencyLimiter): the requests beyond it wait for a slot, blocking the
+ * caller or, for the asynchronous ones, queued without blocking, and once too
+ * many are waiting the next ones fail right away.
+ *
+ * When hedging is enabled (see HedgePolicy), a blocking GET still waiting
+ * past a percentile of the recent latencies gets a duplicate, on another
+ * connection; the first reply is used and the other transfer is cancelled.
+ * In HTTP/2 mode the duplicate opens a fresh connection rather than being
+ * multiplexed with the slow request, whose connection may be what stalls it
+ * (packet loss, a congested window); the extra handshake is bounded by the
+ * hedge budget.
+ *
+ * The requests follow the deadline and the cancellation token of the call
+ * context they were made from: no transfer starts and no retry is scheduled
+ * once the call gave up, the transfers in flight are aborted, and the call
+ * fails with a CallAbortedError. A GET which joined an identical one is sent
+ * again when the call which sent that one gives up.
+ *
+ * Each finished transfer is reported to the metrics sink, if any, with its
+ * timing breakdown and the operation of the call context it was made from
+ * (see CallContext).
+ *
+ * In HTTP/2 mode every request, including the blocking ones, goes through the
+ * event thread so that the concurrent requests to a host are multiplexed over
+ * a single connection. In this mode, the blocking calls must not be made from
+ * the completion callbacks.
+ *
+ * With an external event loop (see EventLoop) the wrapper starts no thread:
+ * the asynchronous requests run on the loop's thread, which invokes their
+ * completion callbacks, and the blocking ones run on the calling thread, not
+ * hedged nor multiplexed. The wrapper must then be destroyed from the loop's
+ * thread, or once the loop stopped.
  */
 class CurlWrapper {
    public:
+    /**
+     * @brief Spare capacity kept after the raw bodies returned by GetRaw,
+     * matching the padding required by simdjson.
+     */
+    static constexpr std::size_t kRawPadding = 64;
+
     /**
      * @brief Constructor.
+     *
+     * @param options Wrapper settings.
      */
-    CurlWrapper();
+    explicit CurlWrapper(const CurlOptions &options = CurlOptions{});
 
     /**
      * @brief Destructor.
      */
-    ~CurlWrapper();
+    virtual ~CurlWrapper() = default;
 
     /**
      * @brief Performs a POST request.
@@ -54,23 +192,388 @@ class CurlWrapper {
         const std::string &uri,
         const std::vector<std::string> &req_headers) const;
 
+    /**
+     * @brief Performs a prepared GET request.
+     *
+     * @param request The request, bound to its varying parts.
+     * @return Response parsed in json format.
+     */
+    virtual Json::Value Get(const PreparedRequest &request) const;
+
+    /**
+     * @brief Performs a GET request returning the body as received, for the
+     * decoders which don't go through jsoncpp. The returned string keeps some
+     * spare capacity (kRawPadding), which lets SIMD parsers read past the end
+     * of the body without copying it.
+     *
+     * @param uri The requested uri.
+     * @param req_headers Headers associated to request.
+     * @return Raw response body.
+     */
+    virtual std::string GetRaw(
+        const std::string &uri,
+        const std::vector<std::string> &req_headers) const;
+
+    /**
+     * @brief Performs a prepared GET request returning the body as received,
+     * see GetRaw.
+     *
+     * @param request The request, bound to its varying parts.
+     * @return Raw response body.
+     */
+    virtual std::string GetRaw(const PreparedRequest &request) const;
+
+    /**
+     * @brief Performs a GET request handing the body over as it arrives,
+     * instead of buffering and parsing it. An exception thrown by the chunk
+     * callback aborts the transfer and is rethrown to the caller.
+     *
+     * @param uri The requested uri.
+     * @param req_headers Headers associated to request.
+     * @param on_chunk Callback invoked for each received chunk of the body.
+     */
+    virtual void GetStream(
+        const std::string &uri,
+        const std::vector<std::string> &req_headers,
+        const ChunkCallback &on_chunk) const;
+
+    /**
+     * @brief Performs a POST request without blocking the caller.
+     *
+     * @param uri The requested uri.
+     * @param req_headers Headers associated to request.
+     * @param req_data Data associated to request.
+     * @param callback Completion callback, invoked from the event thread.
+     */
+    virtual void PostAsync(
+        const std::string &uri,
+        const std::vector<std::string> &req_headers,
+        const std::vector<std::string> &req_data,
+        const JsonCallback &callback) const;
+
+    /**
+     * @brief Performs a GET request without blocking the caller.
+     *
+     * @param uri The requested uri.
+     * @param req_headers Headers associated to request.
+     * @param callback Completion callback, invoked from the event thread.
+     */
+    virtual void GetAsync(
+        const std::string &uri,
+        const std::vector<std::string> &req_headers,
+        const JsonCallback &callback) const;
+
+    /**
+     * @brief Performs a POST request without blocking the caller.
+     *
+     * @param uri The requested uri.
+     * @param req_headers Headers associated to request.
+     * @param req_data Data associated to request.
+     * @return Future of the response parsed in json format.
+     */
+    std::future<Json::Value> PostAsync(
+        const std::string &uri,
+        const std::vector<std::string> &req_headers,
+        const std::vector<std::string> &req_data) const;
+
+    /**
+     * @brief Performs a GET request without blocking the caller.
+     *
+     * @param uri The requested uri.
+     * @param req_headers Headers associated to request.
+     * @return Future of the response parsed in json format.
+     */
+    std::future<Json::Value> GetAsync(
+        const std::string &uri,
+        const std::vector<std::string> &req_headers) const;
+
+    /**
+     * @brief Open connections to the hosts of some uris in the background,
+     * with HEAD requests, so that the next requests find them established.
+     * The handles of the blocking calls are warmed by a background worker,
+     * each one connected to every host, and go back to the pool; with HTTP/2
+     * or an external event loop the connections of the request engine are
+     * warmed instead. Failures are ignored.
+     *
+     * @param uris Uris whose hosts are connected to.
+     * @param connections Number of connections to each host.
+     */
+    virtual void Warmup(const std::vector<std::string> &uris,
+                        std::size_t connections) const;
+
+    /**
+     * @brief Get the transfer counters.
+     *
+     * @return Snapshot of the counters.
+     */
+    CurlStats Stats() const;
+
    private:
     /**
-     * @brief Fetch a given uri.
+     * @brief Set up a transfer on a pooled handle.
+     *
+     * @param method HTTP method.
+     * @param uri The requested uri.
+     * @param req_headers Headers associated to request.
+     * @param req_data Data associated to request.
+     * @return The transfer ready to be performed.
+     */
+    std::unique_ptr<CurlTransfer> Prepare(
+        const char *method,
+        const std::string &uri,
+        const std::vector<std::string> &req_headers,
+        const std::vector<std::string> &req_data) const;
+
+    /**
+     * @brief Set up a prepared GET transfer on a pooled handle.
+     *
+     * @param request The request, bound to its varying parts.
+     * @return The transfer ready to be performed.
+     */
+    std::unique_ptr<CurlTransfer> Prepare(const PreparedRequest &request) const;
+
+    /**
+     * @brief Build the key identifying a request, the Authorization header
+     * included.
+     *
+     * @param uri The requested uri.
+     * @param req_headers Headers associated to request.
+     * @return The request key.
+     */
+    static std::string RequestKey(
+        const std::string &uri,
+        const std::vector<std::string> &req_headers);
+
+    /**
+     * @brief Set up a GET transfer, revalidating the cached response of the
+     * same request if there's one.
      *
+     * @param uri The requested uri.
+     * @param req_headers Headers associated to request.
+     * @return The transfer ready to be performed.
+     */
+    std::unique_ptr<CurlTransfer> PrepareGet(
+        const std::string &uri,
+        const std::vector<std::string> &req_headers) const;
+
+    /**
+     * @brief Set up a prepared GET transfer, revalidating the cached response
+     * of the same request if there's one.
+     *
+     * @param request The request, bound to its varying parts.
+     * @return The transfer ready to be performed.
+     */
+    std::unique_ptr<CurlTransfer> PrepareGet(const PreparedRequest &request) const;
+
+    /**
+     * @brief Transfer setup of a request, run again for each attempt.
+     */
+    using TransferFactory = std::function<std::unique_ptr<CurlTransfer>()>;
+
+    /**
+     * @brief Run a blocking GET request returning the parsed response, joining
+     * the identical one in flight if any.
+     *
+     * @param key Request key, used when coalescing.
+     * @param host Target host.
+     * @param prepare Transfer setup of the request.
+     * @return Response parsed in json format.
+     */
+    Json::Value FetchJson(const std::string &key, const std::string &host,
+                          const TransferFactory &prepare) const;
+
+    /**
+     * @brief Run a blocking GET request returning the raw body, joining the
+     * identical one in flight if any.
+     *
+     * @param key Request key, used when coalescing.
+     * @param host Target host.
+     * @param prepare Transfer setup of the request.
+     * @return Raw response body, with the spare capacity.
+     */
+    std::string FetchRaw(const std::string &key, const std::string &host,
+                         const TransferFactory &prepare) const;
+
+    /**
+     * @brief Run the attempts of a blocking request, waiting for the host's
+     * turn before each one and retrying the replies rejected with a
+     * retryable status.
+     *
+     * @param host Target host.
+     * @param attempt Performs a single attempt of the request.
+     * @param idempotent Whether the request may be sent again after any
+     * retryable status, otherwise only after a resendable one (see
+     * HttpError::Resendable).
+     */
+    void Schedule(const std::string &host, const std::function<void()> &attempt,
+                  bool idempotent = true) const;
+
+    /**
+     * @brief Perform a GET transfer, hedged when enabled, blocking the caller
+     * until it finishes.
+     *
+     * @param prepare Transfer setup of the request.
+     * @param ret Result of the transfer.
+     * @return The transfer which finished first.
+     */
+    std::unique_ptr<CurlTransfer> PerformGet(const TransferFactory &prepare,
+                                             CURLcode *ret) const;
+
+    /**
+     * @brief Perform a transfer, blocking the caller until it finishes.
+     *
+     * @param transfer The transfer to be performed.
+     * @return Result of the transfer.
+     */
+    CURLcode Perform(CurlTransfer *transfer) const;
+
+    /**
+     * @brief Connect a few handles to some hosts, one after the other, and
+     * release them to the pool.
+     *
+     * @param origins Scheme and authority of the hosts.
+     * @param connections Number of handles.
+     */
+    void WarmHandles(const std::vector<std::string> &origins,
+                     std::size_t connections) const;
+
+    /**
+     * @brief Update the transfer counters with a finished transfer, report it
+     * and check its result and status.
+     *
+     * @param ret Result of the transfer.
+     * @param transfer The finished transfer.
+     */
+    void Finish(CURLcode ret, CurlTransfer *transfer) const;
+
+    /**
+     * @brief Update the transfer counters and the concurrency window with a
+     * finished transfer, and collect its metrics.
+     *
+     * @param ret Result of the transfer.
+     * @param transfer The finished transfer.
+     */
+    void Measure(CURLcode ret, CurlTransfer *transfer) const;
+
+    /**
+     * @brief Hand the metrics of a finished transfer over to the sink.
+     *
+     * @param transfer The finished transfer.
+     */
+    void Report(const CurlTransfer *transfer) const;
+
+    /**
+     * @brief Check the result and the status of a finished transfer.
+     *
+     * @param ret Result of the transfer.
+     * @param transfer The finished transfer.
+     */
+    void Check(CURLcode ret, const CurlTransfer *transfer) const;
+
+    /**
+     * @brief Parse the response of a finished transfer.
+     *
+     * @param ret Result of the transfer.
+     * @param transfer The finished transfer.
+     * @return Response parsed in json format.
+     */
+    Json::Value Parse(CURLcode ret, CurlTransfer *transfer) const;
+
+    /**
+     * @brief Parse the body of a checked transfer, or take the cached
+     * response on a 304 reply.
+     *
+     * @param transfer The finished transfer.
+     * @return Response parsed in json format.
+     */
+    Json::Value Decode(CurlTransfer *transfer) const;
+
+    /**
+     * @brief Hand a request over to the request engine, which submits it
+     * again on a retryable reply.
+     *
+     * @param host Target host.
+     * @param prepare Transfer setup of the request.
+     * @param callback Completion callback.
+     * @param attempt Number of the attempt, starting at zero.
+     * @param delay Time to wait before sending the request.
+     * @param idempotent Whether the request may be sent again after any
+     * retryable status (see Schedule).
+     */
+    void Submit(const std::string &host, const TransferFactory &prepare,
+                const JsonCallback &callback, std::size_t attempt,
+                RetryScheduler::Duration delay, bool idempotent) const;
+
+    /**
+     * @brief Set the options of a transfer which change from request to
+     * request, and the other ones on the first use of the handle.
+     *
+     * @param transfer The transfer receiving the response.
+     * @param method HTTP method.
      * @param uri Requested uri.
-     * @param fetch Libcurl's fetch structure.
-     * @return CURL_OK in success; otherwise the suitable error code.
+     * @param headers Header list, which must outlive the transfer.
      */
-    CURLcode FetchUri(const std::string &uri, struct CurlFetch *fetch) const;
+    void Setup(CurlTransfer *transfer, const char *method, const std::string &uri,
+               curl_slist *headers) const;
 
     /**
-     * @brief Libcurl callback.
+     * @brief Set the timeout of a transfer, bounded by what's left of the
+     * deadline of its call. It's set again once the transfer gets its slot,
+     * so that the time spent waiting for one is counted.
+     *
+     * @param transfer The transfer.
+     * @param delay Time before the transfer starts.
+     */
+    void Bound(CurlTransfer *transfer,
+               RetryScheduler::Duration delay =
+                   RetryScheduler::Duration::zero()) const;
+
+    /**
+     * @brief Set the options which are the same for every request.
+     *
+     * @param handle Libcurl's handle.
+     */
+    void Configure(CURL *handle) const;
+
+    /**
+     * @brief Libcurl callback. It appends the received chunk, already
+     * decompressed, to the response buffer of the transfer's handle, or hands
+     * it over to the chunk callback of a streaming transfer (unless the reply
+     * was rejected with a retryable status).
      */
     static std::size_t CurlCallback(void *contents, size_t size, size_t nmemb, void *userp);
 
-    CURL *curl_handle_; //!< Handle for libcurl.
+    /**
+     * @brief Libcurl callback. It picks the validators of a cacheable
+     * response from its headers.
+     */
+    static std::size_t HeaderCallback(char *buffer, size_t size, size_t nitems, void *userp);
+
+    /**
+     * @brief Libcurl callback. It aborts the transfers of the cancelled
+     * calls.
+     */
+    static int ProgressCallback(void *clientp, curl_off_t dltotal, curl_off_t dlnow,
+                                curl_off_t ultotal, curl_off_t ulnow);
+
+    const CurlOptions kOptions_; //!< Wrapper settings.
+    mutable CurlHandlePool pool_; //!< Pool of libcurl handles.
     Json::CharReaderBuilder builder_; //!< Json parser builder.
+    mutable std::atomic<std::size_t> requests_; //!< Finished transfers.
+    mutable std::atomic<std::size_t> connections_; //!< Opened connections.
+    mutable std::atomic<std::size_t> wire_bytes_; //!< Received bytes.
+    mutable std::atomic<std::size_t> body_bytes_; //!< Decompressed body bytes.
+    mutable std::atomic<std::size_t> cache_hits_; //!< Replies served from the cache.
+    mutable std::atomic<std::size_t> retries_; //!< Requests sent again.
+    mutable RetryScheduler scheduler_; //!< Pacing and retries of the requests.
+    mutable ConcurrencyLimiter limiter_; //!< Window of the requests in flight.
+    mutable HedgePolicy hedger_; //!< Delay and budget of the hedges.
+    std::unique_ptr<ResponseCache> cache_; //!< Response cache, null if disabled.
+    mutable Singleflight<Json::Value> get_flights_; //!< GETs in flight.
+    mutable Singleflight<std::shared_ptr<const std::string>> raw_flights_; //!< Raw GETs in flight.
+    mutable RequestEngine engine_; //!< Engine of the asynchronous requests.
+    mutable std::mutex warmup_mutex_; //!< Protects the warm-up worker.
+    mutable std::future<void> warmup_; //!< Last warm-up of the handles, joined on destruction.
 };
 
 }  // namespace spotify_lib
@@ -0,0 +1,90 @@
+/**
+ * @file
+ *
+ * @brief Hedge policy class definition.
+ */
+#ifndef HEDGE_POLICY_H_
+#define HEDGE_POLICY_H_
+
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+namespace spotify_lib {
+
+/**
+ * @brief This structure holds the settings of the request hedging.
+ */
+struct HedgeOptions {
+  bool enabled{false}; //!< Hedge the blocking GET requests.
+  double percentile{95}; //!< Latency percentile after which a hedge is sent.
+  std::chrono::milliseconds min_delay{5}; //!< Shortest delay before a hedge.
+  double budget{0.05}; //!< Hedges allowed per request.
+  std::size_t samples{20}; //!< Latencies needed before hedging at all.
+};
+
+/**
+ * @class HedgePolicy.
+ *
+ * @brief This class decides when a GET request is hedged. It keeps the
+ * latencies of the recent requests, and a request still waiting past the
+ * configured percentile of them gets a duplicate. The number of duplicates
+ * is capped to a fraction of the requests (the budget), so that a slow
+ * server doesn't get twice the load.
+ */
+class HedgePolicy {
+   public:
+    /**
+     * @brief Constructor.
+     *
+     * @param options Hedging settings.
+     */
+    explicit HedgePolicy(const HedgeOptions &options);
+
+    /**
+     * @brief Get the delay after which a request is hedged.
+     *
+     * @return The delay, zero while there aren't enough samples.
+     */
+    std::chrono::microseconds Delay() const;
+
+    /**
+     * @brief Record a request, and the latency it took.
+     *
+     * @param latency Latency of the request.
+     */
+    void Record(std::chrono::microseconds latency);
+
+    /**
+     * @brief Take a hedge from the budget.
+     *
+     * @return True when the hedge can be sent.
+     */
+    bool Spend();
+
+    /**
+     * @brief Get the number of hedges sent.
+     *
+     * @return Number of hedges.
+     */
+    std::size_t Hedges() const;
+
+   private:
+    /**
+     * @brief Number of latencies kept.
+     */
+    static constexpr std::size_t kWindow = 512;
+
+    const HedgeOptions kOptions_; //!< Hedging settings.
+    mutable std::mutex mutex_; //!< Protects the state.
+    std::vector<std::chrono::microseconds> latencies_; //!< Recent latencies, a ring.
+    std::size_t next_; //!< Next slot of the ring.
+    std::size_t requests_; //!< Recorded requests.
+    std::size_t hedges_; //!< Hedges sent.
+    std::chrono::microseconds delay_; //!< Percentile of the recent latencies.
+};
+
+}  // namespace spotify_lib
+
+#endif  // HEDGE_POLICY_H_
@@ -0,0 +1,79 @@
+/**
+ * @file
+ *
+ * @brief Http error class definition.
+ */
+#ifndef HTTP_ERROR_H_
+#define HTTP_ERROR_H_
+
+#include <chrono>
+#include <stdexcept>
+#include <string>
+
+namespace spotify_lib {
+
+/**
+ * @class HttpError.
+ *
+ * @brief This exception reports a reply whose status tells that the request
+ * may succeed later: rate limited (429) or failed on the server side (5xx).
+ */
+class HttpError : public std::runtime_error {
+   public:
+    /**
+     * @brief Constructor.
+     *
+     * @param status Status of the reply.
+     * @param retry_after Delay asked by the server before retrying, zero
+     * when the reply has no Retry-After header.
+     */
+    HttpError(long status, std::chrono::seconds retry_after)
+        : std::runtime_error{status == 429
+                                 ? "too many requests to the remote server!"
+                                 : "the remote server failed to handle the "
+                                   "request (" + std::to_string(status) + ")!"},
+          kStatus_{status},
+          kRetryAfter_{retry_after} {}
+
+    /**
+     * @brief Get the status of the reply.
+     *
+     * @return The HTTP status.
+     */
+    long Status() const { return kStatus_; }
+
+    /**
+     * @brief Get the delay asked by the server before retrying.
+     *
+     * @return The Retry-After delay, zero if not given.
+     */
+    std::chrono::seconds RetryAfter() const { return kRetryAfter_; }
+
+    /**
+     * @brief Check whether a status reports a failure worth a retry.
+     *
+     * @param status HTTP status.
+     *
+     * @return True for 429 and 5xx.
+     */
+    static bool Retryable(long status) { return status == 429 || status >= 500; }
+
+    /**
+     * @brief Check whether a request which isn't idempotent (a POST) may be
+     * sent again: the server must have turned it down with a delay, rather
+     * than failed while handling it.
+     *
+     * @return True for 429 and 503 with a Retry-After delay.
+     */
+    bool Resendable() const {
+      return (kStatus_ == 429 || kStatus_ == 503) && kRetryAfter_.count() > 0;
+    }
+
+   private:
+    long kStatus_; //!< Status of the reply.
+    std::chrono::seconds kRetryAfter_; //!< Delay asked by the server.
+};
+
+}  // namespace spotify_lib
+
+#endif  // HTTP_ERROR_H_
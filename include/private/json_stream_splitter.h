@@ -0,0 +1,128 @@
+/**
+ * @file
+ *
+ * @brief Json stream splitter class definition.
+ */
+#ifndef JSON_STREAM_SPLITTER_H_
+#define JSON_STREAM_SPLITTER_H_
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace spotify_lib {
+
+/**
+ * @class JsonStreamSplitter.
+ *
+ * @brief This class scans a json document as its bytes arrive and hands out
+ * each element of a given array as soon as the element is complete, e.g. the
+ * tracks of a search reply, found at the path {"tracks", "items"}. Only the
+ * structure is tracked (strings, nesting and member names, whose escapes are
+ * decoded before they're matched); the elements themselves are parsed by the
+ * caller. Elements received within a single chunk
+ * are handed out in place, without copies.
+ */
+class JsonStreamSplitter {
+   public:
+    /**
+     * @brief Element callback. The data is only valid during the call.
+     */
+    using ElementCallback = std::function<void(const char *data, std::size_t size)>;
+
+    /**
+     * @brief Constructor.
+     *
+     * @param path Member names leading from the root object to the array.
+     * @param on_element Callback invoked for each complete element.
+     */
+    JsonStreamSplitter(const std::vector<std::string> &path,
+                       const ElementCallback &on_element);
+
+    /**
+     * @brief Feed the next chunk of the document.
+     *
+     * @param data Chunk data.
+     * @param size Chunk size.
+     */
+    void Feed(const char *data, std::size_t size);
+
+   private:
+    /**
+     * @brief This structure holds an open object or array.
+     */
+    struct Frame {
+      bool object;
+      std::string key;
+    };
+
+    /**
+     * @brief Process a single byte of the current chunk.
+     *
+     * @param pos Position of the byte in the chunk.
+     */
+    void Consume(std::size_t pos);
+
+    /**
+     * @brief Append an escaped character to the member name being read.
+     *
+     * @param c The byte following the backslash, or a digit of a \\u escape.
+     */
+    void Unescape(char c);
+
+    /**
+     * @brief Append a code point to the member name being read, in UTF-8.
+     *
+     * @param code The code point.
+     */
+    void AppendUtf8(char32_t code);
+
+    /**
+     * @brief Skip over the content of an object or array element.
+     *
+     * @param pos Position in the current chunk to start from.
+     * @param size Size of the current chunk.
+     *
+     * @return Position of the end of the element, or the chunk size when it
+     * continues in the next chunk.
+     */
+    std::size_t SkipNested(std::size_t pos, std::size_t size);
+
+    /**
+     * @brief Check whether the array just opened is the target one.
+     *
+     * @return True when the open members match the path.
+     */
+    bool PathMatches() const;
+
+    /**
+     * @brief Hand out the current element.
+     *
+     * @param end Position of the end of the element in the current chunk.
+     * @param trim Drop the trailing blanks, for scalar elements.
+     */
+    void Emit(std::size_t end, bool trim);
+
+    const std::vector<std::string> kPath_; //!< Path of the target array.
+    ElementCallback on_element_; //!< Element callback.
+    std::vector<Frame> stack_; //!< Open objects and arrays.
+    std::string key_; //!< Member name being read.
+    std::string element_; //!< Bytes of the current element from previous chunks.
+    const char *chunk_; //!< Chunk being processed.
+    std::size_t mark_; //!< Start of the current element in the chunk.
+    std::size_t target_depth_; //!< Depth of the target array, zero if closed.
+    std::size_t nesting_; //!< Nesting level inside an object or array element.
+    bool in_string_; //!< Inside a string.
+    bool escape_; //!< Previous byte was an escape.
+    unsigned hex_digits_; //!< Digits left of a \\u escape in a member name.
+    char32_t code_; //!< Code unit of the \\u escape being read.
+    char32_t high_surrogate_; //!< First half of a surrogate pair, zero if none.
+    bool reading_key_; //!< The current string is a member name.
+    bool expect_key_; //!< The next string is a member name.
+    bool in_element_; //!< Inside an element of the target array.
+};
+
+}  // namespace spotify_lib
+
+#endif  // JSON_STREAM_SPLITTER_H_
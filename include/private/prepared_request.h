@@ -0,0 +1,118 @@
+/**
+ * @file
+ *
+ * @brief Prepared request class definition.
+ */
+#ifndef PREPARED_REQUEST_H_
+#define PREPARED_REQUEST_H_
+
+#include <string>
+#include <vector>
+
+#include <curl/curl.h>
+
+namespace spotify_lib {
+
+/**
+ * @class PreparedRequest.
+ *
+ * @brief This class holds a request sent over and over with only a couple of
+ * varying parts, e.g. the searches: the uri template carries a placeholder
+ * ("{}") for the query and a header template one for the token. The header
+ * list handed to libcurl, the request key and the host are built once, and
+ * each call only patches the varying parts in place, so that once the
+ * strings have grown to the usual size nothing is allocated anymore.
+ *
+ * A prepared request isn't thread safe, each thread keeps its own.
+ */
+class PreparedRequest {
+   public:
+    /**
+     * @brief Constructor.
+     *
+     * @param uri_template Request uri, with a placeholder for the query.
+     * @param header_templates Request headers, one of them may have a
+     * placeholder for the token.
+     */
+    PreparedRequest(const std::string &uri_template,
+                    const std::vector<std::string> &header_templates);
+
+    PreparedRequest(const PreparedRequest &) = delete;
+    PreparedRequest &operator=(const PreparedRequest &) = delete;
+
+    /**
+     * @brief Patch the varying parts of the request. The blanks of the query
+     * are sent as '+'.
+     *
+     * @param query Query put into the uri.
+     * @param token Token put into the header.
+     */
+    void Bind(const std::string &query, const std::string &token);
+
+    /**
+     * @brief Get the request uri.
+     *
+     * @return The uri.
+     */
+    const std::string &Uri() const { return uri_; }
+
+    /**
+     * @brief Get the request headers.
+     *
+     * @return The header lines.
+     */
+    const std::vector<std::string> &HeaderLines() const { return headers_; }
+
+    /**
+     * @brief Get the header list handed to libcurl. It's valid as long as the
+     * request isn't bound again.
+     *
+     * @return The header list, null if there's no header.
+     */
+    curl_slist *Headers() const { return nodes_.empty() ? nullptr : &nodes_[0]; }
+
+    /**
+     * @brief Get the key identifying the request, uri and headers included.
+     *
+     * @return The request key.
+     */
+    const std::string &Key() const { return key_; }
+
+    /**
+     * @brief Get the host of the request.
+     *
+     * @return The host.
+     */
+    const std::string &Host() const { return kHost_; }
+
+   private:
+    /**
+     * @brief This structure holds a template split at its placeholder.
+     */
+    struct Template {
+      std::string prefix;
+      std::string suffix;
+      bool bound;
+    };
+
+    /**
+     * @brief Split a template at its placeholder.
+     *
+     * @param text Template text.
+     *
+     * @return The split template.
+     */
+    static Template Split(const std::string &text);
+
+    const Template kUri_; //!< Uri template.
+    const std::vector<Template> kHeaders_; //!< Header templates.
+    const std::string kHost_; //!< Host of the uri.
+    std::string uri_; //!< Bound uri.
+    std::vector<std::string> headers_; //!< Bound headers.
+    mutable std::vector<curl_slist> nodes_; //!< Header list over the bound headers.
+    std::string key_; //!< Bound request key.
+};
+
+}  // namespace spotify_lib
+
+#endif  // PREPARED_REQUEST_H_
@@ -0,0 +1,225 @@
+/**
+ * @file
+ *
+ * @brief Asynchronous request engine class definition.
+ */
+#ifndef REQUEST_ENGINE_H_
+#define REQUEST_ENGINE_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <curl/curl.h>
+
+#include "event_loop.h"
+
+namespace spotify_lib {
+
+/**
+ * @class RequestEngine.
+ *
+ * @brief This class runs libcurl transfers concurrently on a single event
+ * thread using the multi interface. The thread is started along with the first
+ * submitted transfer. A transfer may be submitted with a delay, it then waits
+ * on the event thread before being started.
+ *
+ * With an external event loop no thread is started: the engine hands its
+ * sockets and its timer over to the loop (multi_socket_action), and the loop's
+ * thread takes the place of the event thread. The engine must then be
+ * destroyed from the loop's thread, or once the loop stopped.
+ */
+class RequestEngine : public EventHandler {
+   public:
+    /**
+     * @brief Transfer completion callback. It's invoked from the event thread
+     * with the result of the transfer.
+     */
+    using Completion = std::function<void(CURLcode)>;
+
+    /**
+     * @brief Clock of the delayed transfers.
+     */
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Identifier of a submitted transfer. Unlike the easy handle, which
+     * goes back to a pool once the transfer completed, it's never reused.
+     */
+    using Ticket = std::uint64_t;
+
+    /**
+     * @brief Constructor.
+     *
+     * @param max_concurrent_streams Maximum number of HTTP/2 streams
+     * multiplexed over a single connection. When zero, the transfers don't
+     * share connections (HTTP/1.1 behavior).
+     * @param loop External event loop, null to run on the engine's own thread.
+     */
+    explicit RequestEngine(long max_concurrent_streams = 0,
+                           const std::shared_ptr<EventLoop> &loop = nullptr);
+
+    /**
+     * @brief Destructor. The transfers still running are aborted and their
+     * completions invoked with CURLE_ABORTED_BY_CALLBACK.
+     */
+    ~RequestEngine();
+
+    RequestEngine(const RequestEngine &) = delete;
+    RequestEngine &operator=(const RequestEngine &) = delete;
+
+    /**
+     * @brief Submit a transfer. The handle must be fully configured and stay
+     * valid until the completion is invoked.
+     *
+     * @param handle Easy handle of the transfer.
+     * @param on_done Completion callback.
+     * @param delay Time to wait before starting the transfer.
+     *
+     * @return Ticket of the transfer.
+     */
+    Ticket Submit(CURL *handle, const Completion &on_done,
+                  Clock::duration delay = Clock::duration::zero());
+
+    /**
+     * @brief Cancel a submitted transfer. Its completion is invoked with
+     * CURLE_ABORTED_BY_CALLBACK, unless it already completed; a transfer
+     * submitted later with the same handle isn't affected.
+     *
+     * @param ticket Ticket of the transfer.
+     */
+    void Cancel(Ticket ticket);
+
+    /**
+     * @brief Get the number of transfers submitted and not yet completed.
+     *
+     * @return Number of transfers in flight.
+     */
+    std::size_t InFlight() const { return in_flight_; }
+
+    /**
+     * @brief Handle the readiness of a socket, with an external event loop.
+     *
+     * @param fd The socket.
+     * @param events Events which occurred.
+     */
+    void OnSocket(int fd, int events) override;
+
+    /**
+     * @brief Handle the expiry of the timer or a wake up, with an external
+     * event loop.
+     */
+    void OnTimeout() override;
+
+   private:
+    /**
+     * @brief This structure holds a submitted transfer.
+     */
+    struct Pending {
+      Ticket ticket;
+      CURL *handle;
+      Completion on_done;
+      Clock::time_point start;
+    };
+
+    /**
+     * @brief This structure holds a transfer in the multi handle.
+     */
+    struct Running {
+      Ticket ticket;
+      Completion on_done;
+    };
+
+    /**
+     * @brief Event loop.
+     */
+    void Run();
+
+    /**
+     * @brief Have the submitted transfers and the cancellations taken into
+     * account by the event thread, or the external loop.
+     */
+    void Wake();
+
+    /**
+     * @brief Abort the transfers still queued, delayed or running.
+     */
+    void Shutdown();
+
+    /**
+     * @brief Arm the timer of the external loop for the earliest of the
+     * libcurl timeout and the next delayed transfer.
+     */
+    void Arm();
+
+    /**
+     * @brief Move the submitted transfers into the multi handle, or into the
+     * delayed ones when their time hasn't come yet, and abort the cancelled
+     * ones.
+     *
+     * @return Milliseconds until the next delayed transfer is due, capped to
+     * one second.
+     */
+    int AddPending();
+
+    /**
+     * @brief Add a transfer to the multi handle.
+     *
+     * @param ticket Ticket of the transfer.
+     * @param handle Easy handle of the transfer.
+     * @param on_done Completion callback.
+     */
+    void Start(Ticket ticket, CURL *handle, Completion on_done);
+
+    /**
+     * @brief Invoke the completion of the finished transfers.
+     */
+    void Complete();
+
+    /**
+     * @brief Abort the transfers whose cancellation was requested.
+     *
+     * @param cancelled Tickets of the transfers.
+     */
+    void CancelRequested(const std::vector<Ticket> &cancelled);
+
+    /**
+     * @brief Libcurl callback. It hands the sockets to be watched over to the
+     * external loop.
+     */
+    static int SocketCallback(CURL *handle, curl_socket_t fd, int what,
+                              void *userp, void *socketp);
+
+    /**
+     * @brief Libcurl callback. It records the timeout asked by libcurl.
+     */
+    static int TimerCallback(CURLM *multi, long timeout_ms, void *userp);
+
+    CURLM *multi_; //!< Libcurl multi handle.
+    std::shared_ptr<EventLoop> loop_; //!< External event loop, may be null.
+    Clock::time_point timeout_; //!< Timeout asked by libcurl, external loop only.
+    Clock::time_point armed_; //!< Expiry of the loop's timer, external loop only.
+    std::mutex mutex_; //!< Protects the pending and cancelled lists.
+    std::vector<Pending> pending_; //!< Submitted transfers.
+    std::vector<Ticket> cancelled_; //!< Transfers to be cancelled.
+    std::multimap<Clock::time_point, Pending> delayed_; //!< Transfers waiting to start, event thread only.
+    std::unordered_map<CURL *, Running> running_; //!< Transfers in the multi handle.
+    std::atomic<Ticket> next_ticket_; //!< Ticket of the next submitted transfer.
+    std::atomic<bool> stop_; //!< Stop flag of the event loop.
+    std::atomic<std::size_t> in_flight_; //!< Transfers not completed yet.
+    std::once_flag started_; //!< Starts the event thread once.
+    std::thread thread_; //!< Event thread.
+};
+
+}  // namespace spotify_lib
+
+#endif  // REQUEST_ENGINE_H_
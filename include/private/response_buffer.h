@@ -0,0 +1,76 @@
+/**
+ * @file
+ *
+ * @brief Response buffer class definition.
+ */
+#ifndef RESPONSE_BUFFER_H_
+#define RESPONSE_BUFFER_H_
+
+#include <cstddef>
+#include <vector>
+
+namespace spotify_lib {
+
+/**
+ * @class ResponseBuffer.
+ *
+ * @brief This class implements a growable buffer for response bodies. It's
+ * owned by a pooled handle and kept across requests, so once it has grown to
+ * the usual response size the transfers don't allocate memory anymore.
+ */
+class ResponseBuffer {
+   public:
+    /**
+     * @brief Largest capacity kept between requests. Buffers grown beyond it
+     * by an unusually large response release their storage on reset.
+     */
+    static constexpr std::size_t kMaxRetainedCapacity = 1024 * 1024;
+
+    /**
+     * @brief Reserve room for a response of a known size.
+     *
+     * @param size Expected size of the response.
+     */
+    void Reserve(std::size_t size);
+
+    /**
+     * @brief Append a chunk to the buffer.
+     *
+     * @param data Chunk data.
+     * @param size Chunk size.
+     */
+    void Append(const char *data, std::size_t size);
+
+    /**
+     * @brief Discard the contents, keeping the storage for the next request.
+     */
+    void Reset();
+
+    /**
+     * @brief Get the buffer contents.
+     *
+     * @return Pointer to the first byte.
+     */
+    const char *Data() const { return data_.data(); }
+
+    /**
+     * @brief Get the size of the contents.
+     *
+     * @return Number of bytes.
+     */
+    std::size_t Size() const { return data_.size(); }
+
+    /**
+     * @brief Get the allocated storage.
+     *
+     * @return Number of bytes.
+     */
+    std::size_t Capacity() const { return data_.capacity(); }
+
+   private:
+    std::vector<char> data_; //!< Buffer storage.
+};
+
+}  // namespace spotify_lib
+
+#endif  // RESPONSE_BUFFER_H_
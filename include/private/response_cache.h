@@ -0,0 +1,117 @@
+/**
+ * @file
+ *
+ * @brief Response cache class definition.
+ */
+#ifndef RESPONSE_CACHE_H_
+#define RESPONSE_CACHE_H_
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include <json/json.h>
+
+namespace spotify_lib {
+
+/**
+ * @brief This structure holds a cached response and its validators.
+ */
+struct CachedResponse {
+  std::string etag;           //!< ETag of the response, may be empty.
+  std::string last_modified;  //!< Last-Modified of the response, may be empty.
+  Json::Value value;          //!< Parsed response.
+  std::size_t cost;           //!< Accounted size of the entry.
+};
+
+/**
+ * @class ResponseCache.
+ *
+ * @brief This class keeps the parsed responses of the GET requests along with
+ * their validators, so the requests can be revalidated with conditional
+ * headers and a 304 reply served without parsing anything. The entries are
+ * evicted in least recently used order once the accounted size (an estimate
+ * of the memory held by the parsed responses, see Cost) goes beyond the
+ * bound. It can be used from several threads.
+ */
+class ResponseCache {
+   public:
+    /**
+     * @brief Constructor.
+     *
+     * @param max_bytes Bound of the accounted size of the entries.
+     */
+    explicit ResponseCache(std::size_t max_bytes);
+
+    /**
+     * @brief Find the response cached under a key, marking it as recently
+     * used.
+     *
+     * @param key Cache key.
+     *
+     * @return The cached response, null if there isn't any.
+     */
+    std::shared_ptr<const CachedResponse> Find(const std::string &key);
+
+    /**
+     * @brief Cache a response, replacing the previous one under the same key.
+     * Responses larger than the bound aren't cached.
+     *
+     * @param key Cache key.
+     * @param response Response to be cached.
+     */
+    void Store(const std::string &key,
+               const std::shared_ptr<const CachedResponse> &response);
+
+    /**
+     * @brief Estimate the memory held by an entry: the parsed value, whose
+     * nodes take several times the size of the raw body, its key and its
+     * validators.
+     *
+     * @param key Cache key.
+     * @param response The response.
+     *
+     * @return Size in bytes.
+     */
+    static std::size_t Cost(const std::string &key,
+                            const CachedResponse &response);
+
+    /**
+     * @brief Get the accounted size of the entries.
+     *
+     * @return Size in bytes.
+     */
+    std::size_t Bytes() const;
+
+    /**
+     * @brief Get the number of entries.
+     *
+     * @return Number of entries.
+     */
+    std::size_t Count() const;
+
+   private:
+    using Entry = std::pair<std::string, std::shared_ptr<const CachedResponse>>;
+    using Lru = std::list<Entry>;
+
+    /**
+     * @brief Remove an entry. The lock must be held.
+     *
+     * @param it The entry.
+     */
+    void Remove(Lru::iterator it);
+
+    const std::size_t kMaxBytes_; //!< Bound of the accounted size.
+    mutable std::mutex mutex_; //!< Protects the entries.
+    Lru lru_; //!< Entries, most recently used first.
+    std::unordered_map<std::string, Lru::iterator> index_; //!< Entries by key.
+    std::size_t bytes_; //!< Accounted size of the entries.
+};
+
+}  // namespace spotify_lib
+
+#endif  // RESPONSE_CACHE_H_
@@ -0,0 +1,124 @@
+/**
+ * @file
+ *
+ * @brief Retry scheduler class definition.
+ */
+#ifndef RETRY_SCHEDULER_H_
+#define RETRY_SCHEDULER_H_
+
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <random>
+#include <string>
+#include <unordered_map>
+
+namespace spotify_lib {
+
+/**
+ * @brief This structure holds the settings of the retry scheduler.
+ */
+struct RetryOptions {
+  std::size_t max_retries{3}; //!< Retries after the first attempt, zero disables them.
+  std::chrono::milliseconds base_delay{200}; //!< Backoff bound of the first retry.
+  std::chrono::milliseconds max_delay{10000}; //!< Upper bound of the backoff and of the Retry-After delays.
+  double host_rate{0}; //!< Requests per second sent to a host, zero for unlimited.
+  double host_burst{10}; //!< Requests sent to a host at once before pacing.
+};
+
+/**
+ * @class RetryScheduler.
+ *
+ * @brief This class decides when the requests are sent. Each host has a token
+ * bucket, refilled at the configured rate, and the requests wait for their
+ * token before being sent instead of being rejected by the server. A host
+ * replying with a Retry-After header is parked for that long, up to the
+ * backoff bound: every request to it waits, not only the rejected one. The retries of the other failures
+ * wait for an exponential backoff with full jitter, so that the clients don't
+ * retry in lockstep.
+ */
+class RetryScheduler {
+   public:
+    /**
+     * @brief Time span used by the scheduler.
+     */
+    using Duration = std::chrono::steady_clock::duration;
+
+    /**
+     * @brief Constructor.
+     *
+     * @param options Scheduler settings.
+     */
+    explicit RetryScheduler(const RetryOptions &options);
+
+    /**
+     * @brief Reserve the sending of a request to a host. The token is taken
+     * right away, the caller must wait for the returned delay before sending.
+     *
+     * @param host Target host.
+     *
+     * @return Delay before the request can be sent.
+     */
+    Duration Admit(const std::string &host);
+
+    /**
+     * @brief Schedule the retry of a failed request, parking the host when
+     * the server asked for a delay.
+     *
+     * @param host Target host.
+     * @param attempt Number of the failed attempt, starting at zero.
+     * @param retry_after Delay asked by the server, zero if none. It's
+     * bounded by the maximum delay.
+     *
+     * @return Delay before the retry, the token of the host included.
+     */
+    Duration Retry(const std::string &host, std::size_t attempt,
+                   std::chrono::seconds retry_after);
+
+    /**
+     * @brief Check whether a failed attempt may be retried.
+     *
+     * @param attempt Number of the failed attempt, starting at zero.
+     *
+     * @return True when there are retries left.
+     */
+    bool CanRetry(std::size_t attempt) const { return attempt < kOptions_.max_retries; }
+
+    /**
+     * @brief Get the host of an uri.
+     *
+     * @param uri Target uri.
+     *
+     * @return The host, with its port if given.
+     */
+    static std::string Host(const std::string &uri);
+
+   private:
+    /**
+     * @brief This structure holds the state of a host.
+     */
+    struct HostState {
+      double tokens; //!< Available tokens, negative when reserved ahead.
+      std::chrono::steady_clock::time_point refilled; //!< Last refill.
+      std::chrono::steady_clock::time_point parked_until; //!< End of the Retry-After delay.
+    };
+
+    /**
+     * @brief Take a token of a host. Must be called with the mutex held.
+     *
+     * @param host Target host.
+     * @param now Current time.
+     *
+     * @return Delay before the request can be sent.
+     */
+    Duration Reserve(const std::string &host, std::chrono::steady_clock::time_point now);
+
+    const RetryOptions kOptions_; //!< Scheduler settings.
+    std::mutex mutex_; //!< Protects the hosts and the generator.
+    std::unordered_map<std::string, HostState> hosts_; //!< State of each host.
+    std::mt19937 random_; //!< Jitter generator.
+};
+
+}  // namespace spotify_lib
+
+#endif  // RETRY_SCHEDULER_H_
@@ -0,0 +1,98 @@
+/**
+ * @file
+ *
+ * @brief Search reply decoders definition.
+ */
+#ifndef SEARCH_DECODER_H_
+#define SEARCH_DECODER_H_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <json/json.h>
+
+#include "types.h"
+
+namespace spotify_lib {
+
+/**
+ * @interface SearchDecoder.
+ *
+ * @brief This class defines an interface for the backends which decode the
+ * raw search replies into musics.
+ */
+class SearchDecoder {
+   public:
+    /**
+     * @brief Destructor.
+     */
+    virtual ~SearchDecoder() = default;
+
+    /**
+     * @brief Decode a whole search reply.
+     *
+     * @param body Raw reply.
+     *
+     * @return The list of musics.
+     */
+    virtual std::vector<MusicInfo> Decode(const std::string &body) const = 0;
+
+    /**
+     * @brief Decode a single entry of the tracks list of a search reply.
+     *
+     * @param data Raw entry.
+     * @param size Entry size.
+     *
+     * @return The music.
+     */
+    virtual MusicInfo DecodeItem(const char *data, std::size_t size) const = 0;
+};
+
+/**
+ * @class JsoncppSearchDecoder.
+ *
+ * @brief This class decodes the search replies by building their jsoncpp
+ * document and reading the musics from it.
+ */
+class JsoncppSearchDecoder : public SearchDecoder {
+   public:
+    std::vector<MusicInfo> Decode(const std::string &body) const override;
+
+    MusicInfo DecodeItem(const char *data, std::size_t size) const override;
+
+    /**
+     * @brief Extract the musics from a search reply.
+     *
+     * @param reply Search reply.
+     *
+     * @return The list of musics.
+     */
+    static std::vector<MusicInfo> ToMusics(const Json::Value &reply);
+
+    /**
+     * @brief Extract a music from an entry of a search reply.
+     *
+     * @param item Entry of the reply.
+     *
+     * @return The music.
+     */
+    static MusicInfo ToMusic(const Json::Value &item);
+
+   private:
+    /**
+     * @brief Parse a json document.
+     *
+     * @param data Raw document.
+     * @param size Document size.
+     *
+     * @return The parsed document.
+     */
+    Json::Value Parse(const char *data, std::size_t size) const;
+
+    Json::CharReaderBuilder builder_; //!< Json parser builder.
+};
+
+}  // namespace spotify_lib
+
+#endif  // SEARCH_DECODER_H_
@@ -6,20 +6,55 @@
 #ifndef MUSIC_SEARCHER_H_
 #define MUSIC_SEARCHER_H_
 
+#include <cstddef>
+#include <exception>
+#include <functional>
 #include <memory>
 #include <string>
 #include <vector>
 
+#include "paging_options.h"
 #include "types.h"
 #include "private/curl_wrapper.h"
+#include "private/search_decoder.h"
 
 namespace spotify_lib {
 
+/**
+ * @brief Completion callback of the asynchronous searches.
+ */
+using SearchCallback = std::function<void(
+    std::exception_ptr error, const std::vector<MusicInfo> &result)>;
+
+/**
+ * @brief Callback of the streaming searches, invoked for each music found.
+ */
+using MusicCallback = std::function<void(const MusicInfo &music)>;
+
+/**
+ * @brief Callback of the paged searches, invoked for each page received.
+ */
+using PageCallback = std::function<void(std::size_t offset,
+                                        const std::vector<MusicInfo> &page)>;
+
+/**
+ * @brief Source of the access token of each query of a batch search.
+ */
+using TokenSource = std::function<std::string(std::size_t index)>;
+
+/**
+ * @brief Callback of the batch searches, invoked for each query completed.
+ */
+using QueryCallback =
+    std::function<void(std::size_t index, std::exception_ptr error,
+                       const std::vector<MusicInfo> &result)>;
+
 /**
  * @class Searcher.
  *
  * @brief This class implements the mechanism for music searching in the
- * Spotify platform.
+ * Spotify platform. By default the replies are parsed by jsoncpp; a decoder
+ * backend can be plugged in instead, which then receives the raw replies.
  */
 class Searcher {
    public:
@@ -27,8 +62,10 @@ class Searcher {
      * @brief Constructor.
      *
      * @param curl Lib curl handler.
+     * @param decoder Decoder of the replies, jsoncpp is used when null.
      */
-    explicit Searcher(const std::shared_ptr<CurlWrapper> &curl = nullptr);
+    explicit Searcher(const std::shared_ptr<CurlWrapper> &curl = nullptr,
+                      const std::shared_ptr<SearchDecoder> &decoder = nullptr);
 
     /**
      * @brief Search a music in the Spotify platform.
@@ -42,9 +79,120 @@ class Searcher {
         const std::string &token,
         const std::string &name) const;
 
+    /**
+     * @brief Search a music in the Spotify platform without blocking the
+     * caller.
+     *
+     * @param token Access token.
+     * @param name Name of the music.
+     * @param callback Completion callback, invoked from the event thread.
+     *
+     * @note The asynchronous searches always parse the replies with jsoncpp.
+     */
+    void SearchAsync(
+        const std::string &token,
+        const std::string &name,
+        const SearchCallback &callback) const;
+
+    /**
+     * @brief Search a music in the Spotify platform, parsing the reply as it
+     * arrives. Each music is reported as soon as its entry is received, before
+     * the rest of the reply.
+     *
+     * @param token Access token.
+     * @param name Name of the music.
+     * @param on_music Callback invoked for each music found.
+     *
+     * @return The search result.
+     */
+    std::vector<MusicInfo> SearchStreaming(
+        const std::string &token,
+        const std::string &name,
+        const MusicCallback &on_music) const;
+
+    /**
+     * @brief Search a music in the Spotify platform, fetching every page of
+     * the result. The first page tells the number of results, and the
+     * remaining ones are then requested concurrently, pipelined up to a bound
+     * of pages in flight: the whole result takes a few round trips rather
+     * than one per page.
+     *
+     * @param token Access token.
+     * @param name Name of the music.
+     * @param paging Size of the pages, bounds of the results and the pages
+     * in flight, and order of the pages.
+     * @param on_page Callback invoked on the calling thread for each page,
+     * with its offset.
+     *
+     * @return The search result, by offset.
+     *
+     * @note The pages are always parsed with jsoncpp. With an external event
+     * loop, it must not be called from the loop's thread.
+     */
+    std::vector<MusicInfo> SearchPaged(
+        const std::string &token,
+        const std::string &name,
+        const PagingOptions &paging,
+        const PageCallback &on_page) const;
+
+    /**
+     * @brief Search several musics in the Spotify platform, keeping a bound
+     * of searches in flight over the shared transport: each completion sends
+     * the next one.
+     *
+     * @param names Names of the musics.
+     * @param token Source of the token of each query, invoked in order on the
+     * calling thread right before the query is sent. A failure is reported as
+     * the query's.
+     * @param max_in_flight Bound of the searches in flight.
+     * @param on_query Callback invoked on the calling thread for each query,
+     * as they complete, with its index.
+     *
+     * @note The replies are always parsed with jsoncpp. With an external
+     * event loop, it must not be called from the loop's thread.
+     */
+    void SearchBatch(
+        const std::vector<std::string> &names,
+        const TokenSource &token,
+        std::size_t max_in_flight,
+        const QueryCallback &on_query) const;
+
+    /**
+     * @brief Open connections to the search service in the background, so
+     * that the first search doesn't wait for them.
+     *
+     * @param connections Number of connections.
+     */
+    void Warmup(std::size_t connections) const;
+
    private:
+    /**
+     * @brief Request a search reply without blocking the caller, and extract
+     * its musics.
+     *
+     * @param uri The search uri.
+     * @param req_headers Headers of the request.
+     * @param callback Completion callback, invoked from the event thread.
+     */
+    void FetchAsync(const std::string &uri,
+                    const std::vector<std::string> &req_headers,
+                    const SearchCallback &callback) const;
+
+    /**
+     * @brief Build the search uri.
+     *
+     * @param name Name of the music.
+     * @param limit Number of results.
+     * @param offset Index of the first result.
+     *
+     * @return The search uri.
+     */
+    std::string BuildUri(const std::string &name, std::size_t limit = 10,
+                         std::size_t offset = 0) const;
+
     std::string kBaseUri_; //!< Base uri for music searching.
     std::shared_ptr<CurlWrapper> curl_; //!< Lib curl handler.
+    std::shared_ptr<SearchDecoder> decoder_; //!< Replies decoder, may be null.
 };
 
 }  // namespace spotify_lib
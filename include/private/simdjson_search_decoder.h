@@ -0,0 +1,36 @@
+/**
+ * @file
+ *
+ * @brief Simdjson search reply decoder definition.
+ */
+#ifndef SIMDJSON_SEARCH_DECODER_H_
+#define SIMDJSON_SEARCH_DECODER_H_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "private/search_decoder.h"
+
+namespace spotify_lib {
+
+/**
+ * @class SimdjsonSearchDecoder.
+ *
+ * @brief This class decodes the search replies with the simdjson on-demand
+ * parser, reading the fields of each music straight into it without building
+ * a document. Only available when the library is built with SIMDJSON.
+ *
+ * The parser reads up to SIMDJSON_PADDING bytes past the end of the data, so
+ * the replies without that spare capacity are copied before being decoded.
+ */
+class SimdjsonSearchDecoder : public SearchDecoder {
+   public:
+    std::vector<MusicInfo> Decode(const std::string &body) const override;
+
+    MusicInfo DecodeItem(const char *data, std::size_t size) const override;
+};
+
+}  // namespace spotify_lib
+
+#endif  // SIMDJSON_SEARCH_DECODER_H_
@@ -0,0 +1,259 @@
+/**
+ * @file
+ *
+ * @brief Singleflight class definition.
+ */
+#ifndef SINGLEFLIGHT_H_
+#define SINGLEFLIGHT_H_
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "private/call_context.h"
+
+namespace spotify_lib {
+
+/**
+ * @class Singleflight.
+ *
+ * @brief This class coalesces the concurrent calls made with the same key:
+ * the first caller runs the call and the ones arriving while it's in flight
+ * wait for it and get its result, or its exception, instead of running their
+ * own.
+ */
+template <typename T>
+class Singleflight {
+   public:
+    /**
+     * @brief Callback getting the result of an asynchronous call, or its
+     * error.
+     */
+    using Callback =
+        std::function<void(std::exception_ptr error, const T &value)>;
+
+    /**
+     * @brief Asynchronous call, reporting its result to the given callback.
+     */
+    using AsyncCall = std::function<void(const Callback &done)>;
+
+    /**
+     * @brief Constructor.
+     */
+    Singleflight() : calls_{std::make_shared<Calls>()} {}
+
+    /**
+     * @brief Run a call, or join the one in flight with the same key. A
+     * caller joining a call waits for it within its own deadline and
+     * cancellation, a CallAbortedError being thrown once it gives up.
+     *
+     * @param key Call key.
+     * @param call The call.
+     *
+     * @return The result of the call.
+     */
+    T Do(const std::string &key, const std::function<T()> &call) {
+      std::unique_lock<std::mutex> lock{calls_->mutex};
+      auto it = calls_->flights.find(key);
+
+      if (it != calls_->flights.end()) {
+        auto result = it->second->result;
+
+        lock.unlock();
+        calls_->coalesced++;
+        CallContext::Current().Await(result);
+
+        return result.get();
+      }
+
+      auto flight = std::make_shared<Flight>();
+
+      calls_->flights.emplace(key, flight);
+      lock.unlock();
+
+      std::unique_ptr<T> value;
+      std::exception_ptr error;
+
+      try {
+        value.reset(new T(call()));
+      } catch (...) {
+        error = std::current_exception();
+      }
+
+      Finish(calls_, key, flight, error, std::move(value));
+
+      return flight->result.get();
+    }
+
+    /**
+     * @brief Start an asynchronous call, or join the one in flight with the
+     * same key, either started by Do() or by DoAsync(). A caller whose joined
+     * call was aborted by its own caller starts the call again, unless it was
+     * aborted too.
+     *
+     * @param key Call key.
+     * @param call The call, run within the current call context.
+     * @param callback Callback getting the result of the call.
+     */
+    void DoAsync(const std::string &key, const AsyncCall &call,
+                 const Callback &callback) {
+      Join(calls_, key, Waiter{CallContext::Current(), call, callback});
+    }
+
+    /**
+     * @brief Get the number of calls which joined another one.
+     *
+     * @return Number of coalesced calls.
+     */
+    std::size_t Coalesced() const { return calls_->coalesced; }
+
+   private:
+    /**
+     * @brief Asynchronous caller waiting for a call.
+     */
+    struct Waiter {
+      CallContext context; //!< Context of the caller.
+      AsyncCall call;      //!< Call to run again if the joined one aborts.
+      Callback callback;   //!< Callback getting the result.
+    };
+
+    /**
+     * @brief Call in flight.
+     */
+    struct Flight {
+      Flight() : result{done.get_future().share()} {}
+
+      std::promise<T> done;            //!< Fulfilled once the call finishes.
+      std::shared_future<T> result;    //!< Result for the synchronous callers.
+      std::vector<Waiter> waiters;     //!< Asynchronous callers.
+    };
+
+    /**
+     * @brief Calls in flight, shared with the asynchronous calls so that
+     * they may finish after the instance is gone.
+     */
+    struct Calls {
+      std::mutex mutex; //!< Protects the calls in flight.
+      std::unordered_map<std::string, std::shared_ptr<Flight>> flights; //!< Calls in flight.
+      std::atomic<std::size_t> coalesced{0}; //!< Coalesced calls.
+    };
+
+    /**
+     * @brief Start an asynchronous call, or join the one in flight.
+     *
+     * @param calls Calls in flight.
+     * @param key Call key.
+     * @param waiter The caller.
+     */
+    static void Join(const std::shared_ptr<Calls> &calls,
+                     const std::string &key, Waiter waiter) {
+      std::unique_lock<std::mutex> lock{calls->mutex};
+      auto it = calls->flights.find(key);
+
+      if (it != calls->flights.end()) {
+        it->second->waiters.push_back(std::move(waiter));
+        calls->coalesced++;
+
+        return;
+      }
+
+      auto flight = std::make_shared<Flight>();
+      CallScope scope{waiter.context};
+      AsyncCall call = waiter.call;
+
+      flight->waiters.push_back(std::move(waiter));
+      calls->flights.emplace(key, flight);
+      lock.unlock();
+
+      /* the call may report back right away, so the flight must be already
+       * registered. */
+      try {
+        call([calls, key, flight](std::exception_ptr error, const T &value) {
+          Finish(calls, key, flight, error,
+                 error ? nullptr : std::unique_ptr<T>{new T(value)});
+        });
+      } catch (...) {
+        Finish(calls, key, flight, std::current_exception(), nullptr);
+      }
+    }
+
+    /**
+     * @brief Finish a call, handing its result to every caller.
+     *
+     * @param calls Calls in flight.
+     * @param key Call key.
+     * @param flight The call.
+     * @param error Error of the call, if it failed.
+     * @param value Result of the call, if it succeeded.
+     */
+    static void Finish(const std::shared_ptr<Calls> &calls,
+                       const std::string &key,
+                       const std::shared_ptr<Flight> &flight,
+                       std::exception_ptr error, std::unique_ptr<T> value) {
+      /* the call leaves before it's fulfilled, so that a caller arriving
+       * meanwhile runs its own instead of joining a finished one. */
+      std::unique_lock<std::mutex> lock{calls->mutex};
+      std::vector<Waiter> waiters = std::move(flight->waiters);
+
+      calls->flights.erase(key);
+      lock.unlock();
+
+      if (error) {
+        flight->done.set_exception(error);
+      } else {
+        flight->done.set_value(std::move(*value));
+      }
+
+      for (auto &waiter : waiters) {
+        if (!error) {
+          waiter.callback(nullptr, flight->result.get());
+        } else if (Aborted(error) && !Aborted(waiter.context)) {
+          Join(calls, key, std::move(waiter));
+        } else {
+          waiter.callback(error, T{});
+        }
+      }
+    }
+
+    /**
+     * @brief Check whether an error aborted a call.
+     *
+     * @param error The error.
+     *
+     * @return Whether it's a CallAbortedError.
+     */
+    static bool Aborted(const std::exception_ptr &error) {
+      try {
+        std::rethrow_exception(error);
+      } catch (const CallAbortedError &) {
+        return true;
+      } catch (...) {
+        return false;
+      }
+    }
+
+    /**
+     * @brief Check whether a caller gave up.
+     *
+     * @param context Context of the caller.
+     *
+     * @return Whether the caller was cancelled or reached its deadline.
+     */
+    static bool Aborted(const CallContext &context) {
+      return context.Cancelled() || context.Expires();
+    }
+
+    std::shared_ptr<Calls> calls_; //!< Calls in flight.
+};
+
+}  // namespace spotify_lib
+
+#endif  // SINGLEFLIGHT_H_
@@ -6,11 +6,19 @@
 #ifndef API_PRIVATE_H_
 #define API_PRIVATE_H_
 
+#include <cstddef>
+#include <functional>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "access_listener.h"
 #include "add_music_playlist_listener.h"
+#include "batch_search_listener.h"
+#include "call_options.h"
+#include "event_loop.h"
+#include "metrics_sink.h"
+#include "paging_options.h"
 #include "playlist_listener.h"
 #include "search_listener.h"
 #include "types.h"
@@ -18,6 +26,8 @@
 namespace spotify_lib {
 
 class Authenticator;
+class CurlShare;
+struct CallContext;
 class PlaylistMgr;
 class Searcher;
 
@@ -34,10 +44,17 @@ class SpotifyPrivate {
    * @param auth Spotify authenticator instance.
    * @param searcher Spotify music searcher.
    * @param mgr Playlist manager.
+   * @param share DNS and TLS state shared by the default components.
+   * @param metrics Receiver of the operation timings, and of the request
+   * timings of the default components.
+   * @param loop External event loop of the default components.
    */
   SpotifyPrivate(const std::shared_ptr<Authenticator>& auth = nullptr,
              const std::shared_ptr<Searcher>& searcher = nullptr,
-             const std::shared_ptr<PlaylistMgr>& mgr = nullptr);
+             const std::shared_ptr<PlaylistMgr>& mgr = nullptr,
+             const std::shared_ptr<CurlShare>& share = nullptr,
+             const std::shared_ptr<MetricsSink>& metrics = nullptr,
+             const std::shared_ptr<EventLoop>& loop = nullptr);
 
   /**
    * @brief Authenticate a user within the spotify API.
@@ -45,9 +62,11 @@ class SpotifyPrivate {
    * @param listener Event listener.
    * @param client_id Client's ID.
    * @param client_secret Client's secret.
+   * @param options Deadline and cancellation of the call.
    */
   void Auth(AccessListener& listener, const std::string& client_id,
-            const std::string& client_secret) const;
+            const std::string& client_secret,
+            const CallOptions& options = CallOptions{}) const;
 
   /**
    * @brief Search for a string in the spotify platform.
@@ -55,17 +74,149 @@ class SpotifyPrivate {
    * @param listener Event listener.
    * @param token Access token.
    * @param name String to be queried.
+   * @param options Deadline and cancellation of the call.
    */
   void Search(SearchListener& listener, const std::string& token,
-              const std::string& name) const;
+              const std::string& name,
+              const CallOptions& options = CallOptions{}) const;
+
+  /**
+   * @brief Search for a string in the spotify platform with the token granted
+   * last, kept by the library and refreshed in the background. Given a
+   * credential pool to the authenticator, the token of one of its credentials
+   * is taken instead, and a rate limited credential is parked while the
+   * search is tried again with another one.
+   *
+   * @param listener Event listener.
+   * @param name String to be queried.
+   * @param options Deadline and cancellation of the call.
+   */
+  void Search(SearchListener& listener, const std::string& name,
+              const CallOptions& options = CallOptions{}) const;
+
+  /**
+   * @brief Search for a string in the spotify platform, parsing the reply as
+   * it arrives. Each music is reported by OnMusicFound as soon as it's
+   * received, then the whole result by OnPatternFound. On failure, the musics
+   * already reported are followed by OnSearchError.
+   *
+   * @param listener Event listener.
+   * @param token Access token.
+   * @param name String to be queried.
+   * @param options Deadline and cancellation of the call.
+   */
+  void SearchStreaming(SearchListener& listener, const std::string& token,
+                       const std::string& name,
+                       const CallOptions& options = CallOptions{}) const;
+
+  /**
+   * @brief Search for a string in the spotify platform, fetching every page of
+   * the result: the pages after the first one are requested concurrently, up
+   * to a bound, and each is reported by OnPageFound once received, by offset
+   * or as they complete. The whole result is then reported by OnPatternFound.
+   *
+   * @param listener Event listener.
+   * @param token Access token.
+   * @param name String to be queried.
+   * @param paging Size of the pages, bounds of the results and the pages in
+   * flight, and order of the pages.
+   * @param options Deadline and cancellation of the call.
+   */
+  void SearchPaged(SearchListener& listener, const std::string& token,
+                   const std::string& name, const PagingOptions& paging,
+                   const CallOptions& options = CallOptions{}) const;
+
+  /**
+   * @brief Search for several strings in the spotify platform at once,
+   * keeping a bound of searches in flight over the shared transport. Each
+   * query is reported as soon as it completes, with its index, by
+   * OnQueryFound or OnQueryError; the call returns once all of them are.
+   *
+   * @param listener Event listener.
+   * @param token Access token.
+   * @param names Strings to be queried.
+   * @param max_in_flight Bound of the searches in flight.
+   * @param options Deadline and cancellation of the call.
+   */
+  void SearchBatch(BatchSearchListener& listener, const std::string& token,
+                   const std::vector<std::string>& names,
+                   std::size_t max_in_flight = 16,
+                   const CallOptions& options = CallOptions{}) const;
+
+  /**
+   * @brief Search for several strings in the spotify platform at once, with
+   * the token granted last, or the one of a credential of the pool picked
+   * for each query (a rate limited credential is parked, its query failing).
+   *
+   * @param listener Event listener.
+   * @param names Strings to be queried.
+   * @param max_in_flight Bound of the searches in flight.
+   * @param options Deadline and cancellation of the call.
+   */
+  void SearchBatch(BatchSearchListener& listener,
+                   const std::vector<std::string>& names,
+                   std::size_t max_in_flight = 16,
+                   const CallOptions& options = CallOptions{}) const;
+
+  /**
+   * @brief Authenticate a user within the spotify API without blocking the
+   * caller. The listener is notified from the library's event thread, so it
+   * must outlive the call.
+   *
+   * @param listener Event listener.
+   * @param client_id Client's ID.
+   * @param client_secret Client's secret.
+   * @param options Deadline and cancellation of the call.
+   */
+  void AuthAsync(AccessListener& listener, const std::string& client_id,
+                 const std::string& client_secret,
+                 const CallOptions& options = CallOptions{}) const;
+
+  /**
+   * @brief Search for a string in the spotify platform without blocking the
+   * caller. The listener is notified from the library's event thread, so it
+   * must outlive the call.
+   *
+   * @param listener Event listener.
+   * @param token Access token.
+   * @param name String to be queried.
+   * @param options Deadline and cancellation of the call.
+   */
+  void SearchAsync(SearchListener& listener, const std::string& token,
+                   const std::string& name,
+                   const CallOptions& options = CallOptions{}) const;
+
+  /**
+   * @brief Search for a string in the spotify platform without blocking the
+   * caller, with the token granted last, or the one of a credential of the
+   * pool (a rate limited credential is parked, the search failing). The
+   * listener is notified from the library's event thread, so it must outlive
+   * the call.
+   *
+   * @param listener Event listener.
+   * @param name String to be queried.
+   * @param options Deadline and cancellation of the call.
+   */
+  void SearchAsync(SearchListener& listener, const std::string& name,
+                   const CallOptions& options = CallOptions{}) const;
+
+  /**
+   * @brief Open connections to the accounts and the search services in the
+   * background.
+   *
+   * @param connections Number of connections to each service.
+   */
+  void Warmup(std::size_t connections) const;
 
   /**
    * @brief Create a spotify playlist.
    *
    * @param listener Event listener.
    * @param name Name of the playlist.
+   * @param options Deadline and cancellation of the call.
    */
-  void CreatePlaylist(PlaylistListener& listener, const std::string& name) const;
+  void CreatePlaylist(PlaylistListener& listener, const std::string& name,
+                      const CallOptions& options = CallOptions{}) const;
 
   /**
    * @brief Add a music into an existent playlist.
@@ -73,31 +224,87 @@ class SpotifyPrivate {
    * @param listener Event listener.
    * @param music Informations of the music.
    * @param playlist Name of the playlist.
+   * @param options Deadline and cancellation of the call.
    */
   void AddMusicToPlaylist(AddMusicPlaylistListener& listener,
                           const MusicInfo& music,
-                          const std::string& playlist) const;
+                          const std::string& playlist,
+                          const CallOptions& options = CallOptions{}) const;
 
   /**
    * @brief List the musics for a given playlist.
    *
    * @param listener Event listener.
    * @param playlist_name Name of the playlist.
+   * @param options Deadline and cancellation of the call.
    */
   void ListPlaylistMusics(PlaylistListener& listener,
-                          const std::string& playlist_name) const;
+                          const std::string& playlist_name,
+                          const CallOptions& options = CallOptions{}) const;
 
   /**
    * @brief Get all playlists of the authenticated user.
    *
    * @param listener Event listener.
+   * @param options Deadline and cancellation of the call.
    */
-  void GetPlaylists(PlaylistListener& listener) const;
+  void GetPlaylists(PlaylistListener& listener,
+                    const CallOptions& options = CallOptions{}) const;
 
  private:
+  /**
+   * @brief Get the token of a search made without one, reporting the
+   * failure to get one.
+   *
+   * @param listener Event listener.
+   * @param name String to be queried.
+   * @param credential Set to the index of the credential picked from the
+   * pool, if any.
+   * @param options Deadline and cancellation of the call.
+   * @param token Set to the token.
+   *
+   * @return true if the token was got, false otherwise.
+   */
+  bool CurrentToken(SearchListener& listener, const std::string& name,
+                    std::size_t* credential, const CallOptions& options,
+                    std::string* token) const;
+
+  /**
+   * @brief Start a search in the given context. When the context fails over,
+   * the credential of the token is parked if it's rate limited.
+   *
+   * @param listener Event listener.
+   * @param token Access token.
+   * @param name String to be queried.
+   * @param context Context of the call.
+   * @param credential Index of the credential of the token in the pool.
+   */
+  void StartSearch(SearchListener& listener, const std::string& token,
+                   const std::string& name, const CallContext& context,
+                   std::size_t credential) const;
+
+  /**
+   * @brief Run a batch search. When the credentials of the queries are
+   * given, the credential of a rate limited query is parked.
+   *
+   * @param listener Event listener.
+   * @param names Strings to be queried.
+   * @param max_in_flight Bound of the searches in flight.
+   * @param options Deadline and cancellation of the call.
+   * @param token Source of the token of each query.
+   * @param credentials Index in the pool of the credential of each query,
+   * set by the token source, may be null.
+   */
+  void RunBatch(BatchSearchListener& listener,
+                const std::vector<std::string>& names,
+                std::size_t max_in_flight, const CallOptions& options,
+                const std::function<std::string(std::size_t)>& token,
+                const std::vector<std::size_t>* credentials) const;
+
   std::shared_ptr<Authenticator> auth_;        //!< Spotify authenticator.
   std::shared_ptr<Searcher> searcher_;  //!< Spotify music searcher.
   std::shared_ptr<PlaylistMgr> playlist_mgr_;     //!< Playlist manager.
+  std::shared_ptr<MetricsSink> metrics_;  //!< Metrics sink, may be null.
 };
 
 }  // namespace spotify_lib
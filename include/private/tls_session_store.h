@@ -0,0 +1,131 @@
+/**
+ * @file
+ *
+ * @brief TLS session store class definition.
+ */
+#ifndef TLS_SESSION_STORE_H_
+#define TLS_SESSION_STORE_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <curl/curl.h>
+
+namespace spotify_lib {
+
+/**
+ * @class TlsSessionStore.
+ *
+ * @brief This class keeps the TLS sessions of a share handle in a local file,
+ * so that a restarted process resumes them instead of doing full handshakes.
+ * The stored sessions are imported into libcurl's own session cache before
+ * any connection is made, so libcurl offers them itself at the start of each
+ * handshake. They're kept under libcurl's key of each peer, which covers the
+ * host and the port; the key is hashed, so the file doesn't list the hosts. It
+ * requires a libcurl built with the session export (SSLS-EXPORT, from 8.12).
+ *
+ * The file holds secrets, it's only readable by its owner. The sessions are
+ * exported by a writer thread once a second at most, and on destruction,
+ * never from the transfers. The file is written aside and renamed over the
+ * old one, so a crash doesn't leave it half written. The processes of a node
+ * can share it: each one loads it on construction, and merges it on each
+ * update under the lock of a companion file (flock).
+ */
+class TlsSessionStore {
+   public:
+    /**
+     * @brief Constructor. It imports the sessions not expired yet into the
+     * share. A runtime_error is thrown if libcurl can't export its sessions.
+     *
+     * @param path Path of the store file, created if needed.
+     * @param share Share handle keeping the sessions, with
+     * CURL_LOCK_DATA_SSL_SESSION; it must outlive the store.
+     */
+    TlsSessionStore(const std::string &path, CURLSH *share);
+
+    /**
+     * @brief Destructor. It saves the sessions a last time.
+     */
+    ~TlsSessionStore();
+
+    TlsSessionStore(const TlsSessionStore &) = delete;
+    TlsSessionStore &operator=(const TlsSessionStore &) = delete;
+
+    /**
+     * @brief Get the number of sessions imported from the file.
+     *
+     * @return Number of sessions.
+     */
+    std::size_t Imported() const { return imported_; }
+
+   private:
+    /**
+     * @brief This structure holds a session, as exported by libcurl.
+     */
+    struct Session {
+      long expiry;      //!< Expiry, in seconds since the epoch.
+      std::string data; //!< The session.
+    };
+
+    /**
+     * @brief Sessions by hashed peer key.
+     */
+    using Sessions = std::map<std::string, Session>;
+
+    /**
+     * @brief Read the sessions of the store file not expired yet.
+     *
+     * @param path Path of the file.
+     * @return The sessions.
+     */
+    static Sessions Read(const std::string &path);
+
+    /**
+     * @brief Export the sessions of the share.
+     *
+     * @param sessions Set to the sessions.
+     * @return Result of the export.
+     */
+    CURLcode Export(Sessions *sessions) const;
+
+    /**
+     * @brief Merge the sessions of the share into the store file, unless
+     * they didn't change since the last time.
+     */
+    void Save();
+
+    /**
+     * @brief Save the sessions periodically, until the store is destroyed.
+     */
+    void Run();
+
+    /**
+     * @brief Libcurl callback. It collects an exported session.
+     */
+    static CURLcode Collect(CURL *handle, void *userptr,
+                            const char *session_key,
+                            const unsigned char *shmac, std::size_t shmac_len,
+                            const unsigned char *sdata, std::size_t sdata_len,
+                            curl_off_t valid_until, int ietf_tls_id,
+                            const char *alpn, std::size_t earlydata_max);
+
+    static constexpr std::chrono::seconds kSaveInterval_{1}; //!< Time between two saves.
+
+    const std::string kPath_; //!< Path of the store file.
+    CURL *handle_; //!< Handle on the share, used for the import and export.
+    std::size_t imported_; //!< Sessions imported.
+    Sessions saved_; //!< Sessions of the share saved last.
+    std::mutex mutex_; //!< Protects the stop flag.
+    std::condition_variable stop_; //!< Signaled on destruction.
+    bool stopped_; //!< Whether the store is being destroyed.
+    std::thread writer_; //!< Thread saving the sessions.
+};
+
+}  // namespace spotify_lib
+
+#endif  // TLS_SESSION_STORE_H_
@@ -0,0 +1,98 @@
+/**
+ * @file
+ *
+ * @brief Token cache class definition.
+ */
+#ifndef TOKEN_CACHE_H_
+#define TOKEN_CACHE_H_
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace spotify_lib {
+
+/**
+ * @brief This structure holds a cached access token.
+ */
+struct CachedToken {
+  std::string credentials;  //!< Credentials the token was granted to.
+  std::string value;        //!< The access token.
+  std::chrono::steady_clock::time_point refresh_at;  //!< Start of the refresh.
+  std::chrono::steady_clock::time_point expiry;      //!< End of its use.
+  bool refreshing;  //!< Whether a refresh is in flight.
+};
+
+/**
+ * @class TokenCache.
+ *
+ * @brief This class keeps the access tokens by client ID until they expire.
+ * Past three quarters of its lifetime a token is due for a refresh: it's
+ * still handed out, and the first caller to see it due is told to refresh it,
+ * so that the callers don't wait for the accounts service while a token is in
+ * use. A token is given up a bit before its expiry, for the requests to
+ * reach the API in time. It can be used from several threads.
+ */
+class TokenCache {
+   public:
+    /**
+     * @brief Find the token of a client.
+     *
+     * @param client_id Client ID.
+     * @param credentials Credentials of the caller, the token being only
+     * handed out with the ones it was granted to.
+     * @param refresh Set to true if the caller has to refresh the token, false
+     * otherwise.
+     *
+     * @return The token, empty if there isn't any usable.
+     */
+    std::string Find(const std::string &client_id,
+                     const std::string &credentials, bool *refresh);
+
+    /**
+     * @brief Build the cache entry of a token, without caching it.
+     *
+     * @param credentials Credentials the token was granted to.
+     * @param token The access token.
+     * @param lifetime Lifetime of the token.
+     * @param issued Time of the token request.
+     *
+     * @return The entry, expired if the lifetime isn't positive.
+     */
+    static CachedToken Make(const std::string &credentials,
+                            const std::string &token,
+                            std::chrono::seconds lifetime,
+                            std::chrono::steady_clock::time_point issued);
+
+    /**
+     * @brief Cache the token of a client, replacing the previous one.
+     *
+     * @param client_id Client ID.
+     * @param credentials Credentials the token was granted to.
+     * @param token The access token.
+     * @param lifetime Lifetime of the token, it isn't cached if not positive.
+     * @param issued Time of the token request.
+     *
+     * @return The cached token, expired if it isn't cached.
+     */
+    CachedToken Store(const std::string &client_id, const std::string &credentials,
+               const std::string &token, std::chrono::seconds lifetime,
+               std::chrono::steady_clock::time_point issued);
+
+    /**
+     * @brief Give up the refresh of a client's token, a later caller will
+     * retry it.
+     *
+     * @param client_id Client ID.
+     */
+    void Abandon(const std::string &client_id);
+
+   private:
+    std::mutex mutex_; //!< Protects the tokens.
+    std::unordered_map<std::string, CachedToken> tokens_; //!< Tokens by client ID.
+};
+
+}  // namespace spotify_lib
+
+#endif  // TOKEN_CACHE_H_
@@ -0,0 +1,157 @@
+/**
+ * @file
+ *
+ * @brief Token slot class definition.
+ */
+#ifndef TOKEN_SLOT_H_
+#define TOKEN_SLOT_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "private/token_cache.h"
+
+namespace spotify_lib {
+
+/**
+ * @brief This structure holds the token published in a slot, along with the
+ * credentials it's renewed with.
+ */
+struct SlotEntry {
+  std::string client_id;      //!< Client ID.
+  std::string client_secret;  //!< Client secret.
+  CachedToken token;          //!< The token.
+};
+
+/**
+ * @class TokenSlot.
+ *
+ * @brief This class holds the access token the calls are made with when the
+ * caller doesn't give one. It's read by every call and rarely written, so the
+ * readers don't take any lock nor touch any shared reference count: each
+ * thread keeps its own reference to the entry it read last from each slot,
+ * and only takes the lock to replace it once the version of the slot has
+ * changed. These references are owned by the slot, so the token and the
+ * credentials don't outlive it, and are dropped when their thread exits.
+ */
+class TokenSlot {
+   public:
+    /**
+     * @brief Constructor.
+     */
+    TokenSlot();
+
+    /**
+     * @brief Destructor. The references of the reading threads are released.
+     */
+    ~TokenSlot();
+
+    TokenSlot(const TokenSlot &) = delete;
+    TokenSlot &operator=(const TokenSlot &) = delete;
+
+    /**
+     * @brief Publish the token of a client, replacing the current one.
+     *
+     * @param client_id Client ID.
+     * @param client_secret Client secret.
+     * @param token The token.
+     */
+    void Publish(const std::string &client_id, const std::string &client_secret,
+                 const CachedToken &token);
+
+    /**
+     * @brief Publish the renewed token of the current client, unless another
+     * client's token was published meanwhile.
+     *
+     * @param token The token.
+     */
+    void Renew(const CachedToken &token);
+
+    /**
+     * @brief Read the current token.
+     *
+     * @return The token, empty if there isn't any or it expired. The reference
+     * is valid on the calling thread until its next read of this slot.
+     */
+    const std::string &Read() const;
+
+    /**
+     * @brief Claim the refresh of the current token once it's due. A single
+     * caller gets it until another token is published.
+     *
+     * @return true if the caller has to refresh the token, false otherwise.
+     */
+    bool ClaimRefresh() const;
+
+    /**
+     * @brief Give back the refresh claimed on a token which failed, so that
+     * it's claimed again after a delay rather than renewed at its expiry.
+     *
+     * @param client_id Client ID of the token, nothing is done if another
+     * client's token was published meanwhile.
+     * @param client_secret Client secret of the token.
+     * @param delay Time before the next claim.
+     */
+    void RetryRefresh(const std::string &client_id,
+                      const std::string &client_secret,
+                      std::chrono::steady_clock::duration delay) const;
+
+    /**
+     * @brief Get the credentials of the current token.
+     *
+     * @param client_id Set to the client ID.
+     * @param client_secret Set to the client secret.
+     *
+     * @return false if no token was ever published, true otherwise.
+     */
+    bool Credentials(std::string *client_id, std::string *client_secret) const;
+
+    /**
+     * @brief Get the number of threads holding a reference to the slot.
+     *
+     * @return Number of reading threads.
+     */
+    std::size_t ReaderCount() const;
+
+   private:
+    struct Reader;
+    struct ReaderCaches;
+
+    /**
+     * @brief Add the reference of the calling thread.
+     *
+     * @return The reference, owned by the slot.
+     */
+    Reader *AddReader() const;
+
+    /**
+     * @brief Release the reference of a thread which exits.
+     *
+     * @param reader The reference.
+     */
+    void RemoveReader(const Reader *reader) const;
+
+    /**
+     * @brief Replace the entry, the caller holding the lock.
+     *
+     * @param entry The new entry.
+     */
+    void Replace(const std::shared_ptr<const SlotEntry> &entry);
+
+    const std::uint64_t kId_; //!< Unique id, keying the per-thread references.
+    mutable std::mutex mutex_; //!< Protects the entry and the references.
+    std::shared_ptr<const SlotEntry> entry_; //!< Current entry, may be null.
+    std::atomic<std::uint64_t> version_; //!< Bumped on each publication.
+    mutable std::atomic<std::chrono::steady_clock::rep> refresh_at_; //!< When the refresh is due.
+    mutable std::vector<std::unique_ptr<Reader>> readers_; //!< References of the reading threads.
+};
+
+}  // namespace spotify_lib
+
+#endif  // TOKEN_SLOT_H_
@@ -0,0 +1,77 @@
+/**
+ * @file
+ *
+ * @brief Token store class definition.
+ */
+#ifndef TOKEN_STORE_H_
+#define TOKEN_STORE_H_
+
+#include <chrono>
+#include <string>
+
+namespace spotify_lib {
+
+/**
+ * @brief This structure holds a token kept in a token store.
+ */
+struct StoredToken {
+  std::string value;                              //!< The access token.
+  std::chrono::system_clock::time_point issued;  //!< Time of its request.
+  std::chrono::seconds lifetime;                 //!< Its lifetime.
+};
+
+/**
+ * @class TokenStore.
+ *
+ * @brief This class keeps the access tokens by client ID in a local file, so
+ * that the processes of a node reuse a valid token instead of requesting
+ * their own, e.g. the short-lived ones on their startup. A token is only
+ * handed out with the credentials it was granted to, of which the file keeps
+ * a digest.
+ *
+ * The file holds secrets, it's only readable by its owner. It's locked
+ * (flock) around each read and update, and read again on each lookup, since
+ * other processes update it.
+ */
+class TokenStore {
+   public:
+    /**
+     * @brief Constructor.
+     *
+     * @param path Path of the store file, created if needed.
+     */
+    explicit TokenStore(const std::string &path);
+
+    TokenStore(const TokenStore &) = delete;
+    TokenStore &operator=(const TokenStore &) = delete;
+
+    /**
+     * @brief Find the token of a client.
+     *
+     * @param client_id Client ID.
+     * @param credentials Credentials of the caller.
+     * @param token Set to the token found.
+     *
+     * @return true if a token not expired yet was found, false otherwise.
+     */
+    bool Find(const std::string &client_id, const std::string &credentials,
+              StoredToken *token) const;
+
+    /**
+     * @brief Store the token of a client, replacing the previous one. Failures
+     * are ignored, the store being a mere shortcut.
+     *
+     * @param client_id Client ID.
+     * @param credentials Credentials the token was granted to.
+     * @param token The token.
+     */
+    void Save(const std::string &client_id, const std::string &credentials,
+              const StoredToken &token) const;
+
+   private:
+    const std::string kPath_; //!< Path of the store file.
+};
+
+}  // namespace spotify_lib
+
+#endif  // TOKEN_STORE_H_
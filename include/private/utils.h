@@ -20,6 +20,83 @@ namespace utils {
  */
 std::string GetBase64Code(const std::string &str);
 
+/**
+ * @brief Initialize libcurl once per process. Since curl_global_init isn't
+ * thread safe, it must run before any libcurl handle is created.
+ */
+void InitCurl();
+
+/**
+ * @brief Open a file only readable by its owner, creating it if needed. It
+ * must be a regular file owned by the effective user, links aren't followed.
+ *
+ * @param path Path of the file.
+ *
+ * @return Descriptor of the file, -1 on failure.
+ */
+int OpenPrivateFile(const std::string &path);
+
+/**
+ * @brief Read a whole file.
+ *
+ * @param fd Descriptor of the file.
+ *
+ * @return The contents of the file.
+ */
+std::string ReadFile(int fd);
+
+/**
+ * @brief Replace the contents of a file in place, keeping its inode (and the
+ * locks taken on it).
+ *
+ * @param fd Descriptor of the file.
+ * @param contents The new contents.
+ *
+ * @return true on success, false otherwise.
+ */
+bool RewriteFile(int fd, const std::string &contents);
+
+/**
+ * @brief Replace a file by a new one holding the contents, only readable by
+ * its owner. The new file is written aside and renamed over the old one, so
+ * it's never seen half written.
+ *
+ * @param path Path of the file.
+ * @param contents The new contents.
+ *
+ * @return true on success, false otherwise.
+ */
+bool ReplaceFile(const std::string &path, const std::string &contents);
+
+/**
+ * @class FileLock.
+ *
+ * @brief This class holds an advisory lock (flock) on a file for its
+ * lifetime, shared by the processes of a node.
+ */
+class FileLock {
+   public:
+    /**
+     * @brief Constructor. It blocks until the lock is taken, unless LOCK_NB
+     * is given, a runtime_error is thrown if it can't be.
+     *
+     * @param fd Descriptor of the file.
+     * @param operation LOCK_SH or LOCK_EX, optionally along with LOCK_NB.
+     */
+    FileLock(int fd, int operation);
+
+    /**
+     * @brief Destructor.
+     */
+    ~FileLock();
+
+    FileLock(const FileLock &) = delete;
+    FileLock &operator=(const FileLock &) = delete;
+
+   private:
+    int fd_; //!< The locked file.
+};
+
 }  // namespace utils
 }  // namespace spotify_lib
 
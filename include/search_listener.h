@@ -6,6 +6,7 @@
 #ifndef SEARCH_LISTENER_H_
 #define SEARCH_LISTENER_H_
 
+#include <cstddef>
 #include <string>
 #include <vector>
 
@@ -27,6 +28,24 @@ class SearchListener {
    */
   virtual void OnPatternFound(const std::vector<MusicInfo>& result) const = 0;
 
+  /**
+   * @brief Report a music as soon as it's found, during a streaming search.
+   * The whole result is reported afterwards by OnPatternFound.
+   *
+   * @param music The music found.
+   */
+  virtual void OnMusicFound(const MusicInfo& /* music */) const {}
+
+  /**
+   * @brief Report a page of results as soon as it's received, during a paged
+   * search. The whole result is reported afterwards by OnPatternFound.
+   *
+   * @param offset Index of the first result of the page.
+   * @param page The musics of the page.
+   */
+  virtual void OnPageFound(std::size_t /* offset */,
+                           const std::vector<MusicInfo>& /* page */) const {}
+
   /**
    * @brief Indicates a error during the operation.
    *
@@ -6,11 +6,18 @@
 #ifndef SPOTIFY_H_
 #define SPOTIFY_H_
 
+#include <cstddef>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "access_listener.h"
 #include "add_music_playlist_listener.h"
+#include "batch_search_listener.h"
+#include "call_options.h"
+#include "event_loop.h"
+#include "metrics_sink.h"
+#include "paging_options.h"
 #include "playlist_listener.h"
 #include "search_listener.h"
 #include "types.h"
@@ -19,6 +26,7 @@ namespace spotify_lib {
 
 class SpotifyPrivate;
 class Authenticator;
+class CurlShare;
 class Searcher;
 class PlaylistMgr;
 
@@ -35,20 +43,35 @@ class Spotify {
    * @param auth Spotify authenticator instance.
    * @param searcher Spotify music searcher.
    * @param mgr Playlist manager.
+   * @param share DNS and TLS state shared by the default authenticator and
+   * searcher with every other instance using it. The default components also
+   * share their connections.
+   * @param metrics Receiver of the timings of the operations and, for the
+   * default authenticator and searcher, of each request they make.
+   * @param loop External event loop running the I/O of the asynchronous
+   * calls of the default authenticator and searcher, whose listeners are
+   * then notified from the loop's thread. No thread is started, the calls
+   * must be made from the loop's thread and the instance destroyed there.
    */
   Spotify(const std::shared_ptr<Authenticator>& auth = nullptr,
       const std::shared_ptr<Searcher>& searcher = nullptr,
-      const std::shared_ptr<PlaylistMgr>& mgr = nullptr);
+      const std::shared_ptr<PlaylistMgr>& mgr = nullptr,
+      const std::shared_ptr<CurlShare>& share = nullptr,
+      const std::shared_ptr<MetricsSink>& metrics = nullptr,
+      const std::shared_ptr<EventLoop>& loop = nullptr);
 
   /**
-   * @brief Authenticate a user within the spotify API.
+   * @brief Authenticate a user within the spotify API. The token is cached
+   * until it's about to expire, and refreshed in the background meanwhile.
    *
    * @param listener Event listener.
    * @param client_id Client's ID.
    * @param client_secret Client's secret.
+   * @param options Deadline and cancellation of the call.
    */
   void Auth(AccessListener& listener, const std::string& client_id,
-            const std::string& client_secret) const;
+            const std::string& client_secret,
+            const CallOptions& options = CallOptions{}) const;
 
   /**
    * @brief Search for a string in the spotify platform.
@@ -56,18 +79,152 @@ class Spotify {
    * @param listener Event listener.
    * @param token Access token.
    * @param name String to be queried.
+   * @param options Deadline and cancellation of the call.
    */
   void Search(SearchListener& listener, const std::string& token,
-              const std::string& name) const;
+              const std::string& name,
+              const CallOptions& options = CallOptions{}) const;
+
+  /**
+   * @brief Search for a string in the spotify platform with the token granted
+   * last, kept by the library and refreshed in the background. Given a
+   * credential pool to the authenticator, the token of one of its credentials
+   * is taken instead, and a rate limited credential is parked while the
+   * search is tried again with another one.
+   *
+   * @param listener Event listener.
+   * @param name String to be queried.
+   * @param options Deadline and cancellation of the call.
+   */
+  void Search(SearchListener& listener, const std::string& name,
+              const CallOptions& options = CallOptions{}) const;
+
+  /**
+   * @brief Search for a string in the spotify platform, parsing the reply as
+   * it arrives. Each music is reported by OnMusicFound as soon as it's
+   * received, then the whole result by OnPatternFound. On failure, the musics
+   * already reported are followed by OnSearchError.
+   *
+   * @param listener Event listener.
+   * @param token Access token.
+   * @param name String to be queried.
+   * @param options Deadline and cancellation of the call.
+   */
+  void SearchStreaming(SearchListener& listener, const std::string& token,
+                       const std::string& name,
+                       const CallOptions& options = CallOptions{}) const;
+
+  /**
+   * @brief Search for a string in the spotify platform, fetching every page of
+   * the result: the pages after the first one are requested concurrently, up
+   * to a bound, and each is reported by OnPageFound once received, by offset
+   * or as they complete. The whole result is then reported by OnPatternFound.
+   *
+   * @param listener Event listener.
+   * @param token Access token.
+   * @param name String to be queried.
+   * @param paging Size of the pages, bounds of the results and the pages in
+   * flight, and order of the pages.
+   * @param options Deadline and cancellation of the call.
+   */
+  void SearchPaged(SearchListener& listener, const std::string& token,
+                   const std::string& name, const PagingOptions& paging,
+                   const CallOptions& options = CallOptions{}) const;
+
+  /**
+   * @brief Search for several strings in the spotify platform at once,
+   * keeping a bound of searches in flight over the shared transport. Each
+   * query is reported as soon as it completes, with its index, by
+   * OnQueryFound or OnQueryError; the call returns once all of them are.
+   *
+   * @param listener Event listener.
+   * @param token Access token.
+   * @param names Strings to be queried.
+   * @param max_in_flight Bound of the searches in flight.
+   * @param options Deadline and cancellation of the call.
+   */
+  void SearchBatch(BatchSearchListener& listener, const std::string& token,
+                   const std::vector<std::string>& names,
+                   std::size_t max_in_flight = 16,
+                   const CallOptions& options = CallOptions{}) const;
+
+  /**
+   * @brief Search for several strings in the spotify platform at once, with
+   * the token granted last, or the one of a credential of the pool picked
+   * for each query (a rate limited credential is parked, its query failing).
+   *
+   * @param listener Event listener.
+   * @param names Strings to be queried.
+   * @param max_in_flight Bound of the searches in flight.
+   * @param options Deadline and cancellation of the call.
+   */
+  void SearchBatch(BatchSearchListener& listener,
+                   const std::vector<std::string>& names,
+                   std::size_t max_in_flight = 16,
+                   const CallOptions& options = CallOptions{}) const;
+
+  /**
+   * @brief Authenticate a user within the spotify API without blocking the
+   * caller. The listener is notified from the library's event thread, so it
+   * must outlive the call, or right away with a cached token.
+   *
+   * @param listener Event listener.
+   * @param client_id Client's ID.
+   * @param client_secret Client's secret.
+   * @param options Deadline and cancellation of the call.
+   */
+  void AuthAsync(AccessListener& listener, const std::string& client_id,
+                 const std::string& client_secret,
+                 const CallOptions& options = CallOptions{}) const;
+
+  /**
+   * @brief Search for a string in the spotify platform without blocking the
+   * caller. The listener is notified from the library's event thread, so it
+   * must outlive the call.
+   *
+   * @param listener Event listener.
+   * @param token Access token.
+   * @param name String to be queried.
+   * @param options Deadline and cancellation of the call.
+   */
+  void SearchAsync(SearchListener& listener, const std::string& token,
+                   const std::string& name,
+                   const CallOptions& options = CallOptions{}) const;
+
+  /**
+   * @brief Search for a string in the spotify platform without blocking the
+   * caller, with the token granted last, or the one of a credential of the
+   * pool (a rate limited credential is parked, the search failing). The
+   * listener is notified from the library's event thread, so it must outlive
+   * the call.
+   *
+   * @param listener Event listener.
+   * @param name String to be queried.
+   * @param options Deadline and cancellation of the call.
+   */
+  void SearchAsync(SearchListener& listener, const std::string& name,
+                   const CallOptions& options = CallOptions{}) const;
+
+  /**
+   * @brief Open connections to the accounts and the search services in the
+   * background, so that the first authentication and search don't pay for
+   * the name lookups, the connects and the TLS handshakes. Meant to be
+   * called right after the construction, it doesn't block.
+   *
+   * @param connections Number of connections to each service.
+   */
+  void Warmup(std::size_t connections = 1) const;
 
   /**
    * @brief Create a spotify playlist.
    *
    * @param listener Event listener.
    * @param name Name of the playlist.
+   * @param options Deadline and cancellation of the call.
    */
   void CreatePlaylist(PlaylistListener& listener,
-                      const std::string& name) const;
+                      const std::string& name,
+                      const CallOptions& options = CallOptions{}) const;
 
   /**
    * @brief Add a music into an existent playlist.
@@ -75,26 +232,32 @@ class Spotify {
    * @param listener Event listener.
    * @param music Informations of the music.
    * @param playlist Name of the playlist.
+   * @param options Deadline and cancellation of the call.
    */
   void AddMusicToPlaylist(AddMusicPlaylistListener& listener,
                           const MusicInfo& music,
-                          const std::string& playlist) const;
+                          const std::string& playlist,
+                          const CallOptions& options = CallOptions{}) const;
 
   /**
    * @brief List the musics of a given playlist.
    *
    * @param listener Event listener.
    * @param playlist_name Name of the playlist.
+   * @param options Deadline and cancellation of the call.
    */
   void ListPlaylistMusics(PlaylistListener& listener,
-                          const std::string& playlist_name) const;
+                          const std::string& playlist_name,
+                          const CallOptions& options = CallOptions{}) const;
 
   /**
    * @brief Get all playlists of the authenticated user.
    *
    * @param listener Event listener.
+   * @param options Deadline and cancellation of the call.
    */
-  void GetPlaylists(PlaylistListener& listener) const;
+  void GetPlaylists(PlaylistListener& listener,
+                    const CallOptions& options = CallOptions{}) const;
 
  private:
   // TODO: make it a unique_ptr
@@ -5,31 +5,399 @@
  */
 #include "private/authenticator.h"
 
+#include <exception>
 #include <stdexcept>
 #include <vector>
 
+#include "private/call_context.h"
 #include "private/utils.h"
 
 namespace spotify_lib {
 
+using Json::Value;
+using std::current_exception;
+using std::exception;
+using std::exception_ptr;
 using std::make_shared;
+using std::rethrow_exception;
 using std::runtime_error;
 using std::shared_ptr;
+using std::size_t;
+using std::stoll;
 using std::string;
 using std::vector;
+using std::weak_ptr;
+using std::chrono::duration_cast;
+using std::chrono::seconds;
+using std::chrono::steady_clock;
+using std::chrono::system_clock;
 
-Authenticator::Authenticator(const shared_ptr<CurlWrapper>& curl)
+namespace {
+
+/**
+ * @brief Delay before a failed refresh is tried again, the token being still
+ * valid meanwhile.
+ */
+const seconds kRefreshRetry{5};
+
+/**
+ * @brief Convert a time of the system clock, the one the token store keeps,
+ * to the steady clock.
+ *
+ * @param time The time.
+ *
+ * @return The same time on the steady clock.
+ */
+steady_clock::time_point SteadyTime(system_clock::time_point time) {
+  return steady_clock::now() - duration_cast<steady_clock::duration>(
+                                   system_clock::now() - time);
+}
+
+/**
+ * @brief Save a new token in the token store, if any.
+ *
+ * @param store The token store, may be null.
+ * @param client_id Client ID.
+ * @param credentials Credentials the token was granted to.
+ * @param token The token.
+ * @param lifetime Lifetime of the token, it isn't saved if not positive.
+ * @param issued Time of the token request.
+ */
+void Persist(const shared_ptr<TokenStore>& store, const string& cli_id,
+             const string& credentials, const string& token, seconds lifetime,
+             system_clock::time_point issued) {
+  if (store && lifetime > seconds{0}) {
+    store->Save(cli_id, credentials, StoredToken{token, issued, lifetime});
+  }
+}
+
+/**
+ * @brief Publish a new token of a client as the current one, and as the one
+ * of its credential in the pool, if any.
+ *
+ * @param current Slot of the token granted last, may be null.
+ * @param pool The credential pool, may be null.
+ * @param client_id Client ID.
+ * @param client_secret Client secret.
+ * @param token The token.
+ * @param renew Whether it renews the token of the current client only.
+ */
+void Announce(const shared_ptr<TokenSlot>& current,
+              const shared_ptr<CredentialPool>& pool, const string& cli_id,
+              const string& cli_secret, const CachedToken& token, bool renew) {
+  if (current) {
+    if (renew) {
+      current->Renew(token);
+    } else {
+      current->Publish(cli_id, cli_secret, token);
+    }
+  }
+
+  if (pool) {
+    pool->Publish(cli_id, cli_secret, token);
+  }
+}
+
+/**
+ * @brief Give back the refresh claimed on the token of a client after it
+ * failed, both in the current slot and in its credential of the pool, so that
+ * it's tried again later rather than at the expiry of the token.
+ *
+ * @param current Slot of the token granted last, may be null.
+ * @param pool The credential pool, may be null.
+ * @param client_id Client ID.
+ * @param client_secret Client secret.
+ */
+void Retry(const shared_ptr<TokenSlot>& current,
+           const shared_ptr<CredentialPool>& pool, const string& cli_id,
+           const string& cli_secret) {
+  if (current) {
+    current->RetryRefresh(cli_id, cli_secret, kRefreshRetry);
+  }
+
+  if (pool) {
+    pool->RetryRefresh(cli_id, cli_secret, kRefreshRetry);
+  }
+}
+
+}  // namespace
+
+Authenticator::Authenticator(const shared_ptr<CurlWrapper>& curl,
+                             const string& token_file,
+                             const shared_ptr<CredentialPool>& pool)
     : kUri_{"https://accounts.spotify.com/lib/token"},
-      curl_{curl ? curl : make_shared<CurlWrapper>()} {}
+      curl_{curl ? curl : make_shared<CurlWrapper>()},
+      tokens_{make_shared<TokenCache>()},
+      current_{make_shared<TokenSlot>()},
+      store_{token_file.empty() ? nullptr
+                                : make_shared<TokenStore>(token_file)},
+      pool_{pool} {}
 
 string Authenticator::AuthUser(const string& cli_id,
                                const string& cli_secret) const {
+  auto headers = BuildHeaders(cli_id, cli_secret);
+  bool refresh = false;
+  string token = tokens_->Find(cli_id, headers[0], &refresh);
+
+  if (refresh) {
+    Refresh(cli_id, cli_secret);
+  }
+
+  if (!token.empty()) {
+    return token;
+  }
+
+  for (;;) {
+    try {
+      return flights_.Do(headers[0],
+                         [this, &cli_id, &cli_secret] {
+                           return Fetch(cli_id, cli_secret);
+                         });
+    } catch (const CallAbortedError&) {
+      /* the request joined was aborted by its own caller, this one runs
+       * another unless it was aborted too. */
+      CallContext::Current().Check();
+    }
+  }
+}
+
+string Authenticator::Token() const {
+  /* the slot is read without copying, the token only once it's usable. */
+  const string& token = current_->Read();
+
+  if (!token.empty() && !current_->ClaimRefresh()) {
+    return token;
+  }
+
+  string cli_id;
+  string cli_secret;
+
+  if (!current_->Credentials(&cli_id, &cli_secret)) {
+    throw runtime_error("no access token, authenticate the client first!");
+  }
+
+  return Renewed(*current_, cli_id, cli_secret);
+}
+
+string Authenticator::Token(const string& query, size_t* credential) const {
+  if (!pool_) {
+    return Token();
+  }
+
+  *credential = pool_->Pick(query);
+
+  auto& slot = pool_->Slot(*credential);
+  const string& token = slot.Read();
+
+  if (!token.empty() && !slot.ClaimRefresh()) {
+    return token;
+  }
+
+  auto& credentials = pool_->At(*credential);
+
+  return Renewed(slot, credentials.client_id, credentials.client_secret);
+}
+
+void Authenticator::Warmup(size_t connections) const {
+  curl_->Warmup({kUri_}, connections);
+}
+
+string Authenticator::Renewed(const TokenSlot& slot, const string& cli_id,
+                              const string& cli_secret) const {
+  /* either starts the refresh of the token, or gets a new one. */
+  string fresh = AuthUser(cli_id, cli_secret);
+  const string& published = slot.Read();
+
+  if (!published.empty()) {
+    return published;
+  }
+
+  /* a token without lifetime is never published as usable. */
+  return fresh;
+}
+
+void Authenticator::AuthUserAsync(const string& cli_id,
+                                  const string& cli_secret,
+                                  const AuthCallback& callback) const {
+  vector<string> req_data{"grant_type=client_credentials"};
+  auto headers = BuildHeaders(cli_id, cli_secret);
+  bool refresh = false;
+  string cached = tokens_->Find(cli_id, headers[0], &refresh);
+
+  if (refresh) {
+    Refresh(cli_id, cli_secret);
+  }
+
+  if (!cached.empty() || Load(cli_id, cli_secret, false, &cached)) {
+    callback(nullptr, cached);
+
+    return;
+  }
+
+  weak_ptr<TokenCache> tokens = tokens_;
+  weak_ptr<TokenSlot> current = current_;
+  auto curl = curl_;
+  auto uri = kUri_;
+  auto store = store_;
+  auto pool = pool_;
+
+  /* joins the request in flight for the same credentials, either sync or
+   * async. */
+  flights_.DoAsync(
+      headers[0],
+      [curl, uri, tokens, current, store, pool, cli_id, cli_secret, headers,
+       req_data](const AuthCallback& done) {
+        auto issued = steady_clock::now();
+        auto wall_issued = system_clock::now();
+
+        curl->PostAsync(
+            uri, headers, req_data,
+            [done, tokens, current, store, pool, cli_id, cli_secret, headers,
+             issued, wall_issued](exception_ptr error, const Value& reply) {
+              string token;
+
+              if (!error) {
+                try {
+                  token = ParseReply(reply);
+
+                  auto cache = tokens.lock();
+
+                  if (cache) {
+                    Announce(current.lock(), pool, cli_id, cli_secret,
+                             cache->Store(cli_id, headers[0], token,
+                                          ParseLifetime(reply), issued),
+                             false);
+                  }
+
+                  Persist(store, cli_id, headers[0], token,
+                          ParseLifetime(reply), wall_issued);
+                } catch (...) {
+                  error = current_exception();
+                }
+              }
+
+              done(error, token);
+            });
+      },
+      callback);
+}
+
+string Authenticator::Fetch(const string& cli_id,
+                            const string& cli_secret) const {
   vector<string> req_data{"grant_type=client_credentials"};
-  vector<string> req_headers{"Authorization: Basic " +
-                             utils::GetBase64Code(cli_id + ":" + cli_secret)};
+  auto headers = BuildHeaders(cli_id, cli_secret);
+  string token;
 
-  auto reply = curl_->Post(kUri_, req_headers, req_data);
+  if (Load(cli_id, cli_secret, false, &token)) {
+    return token;
+  }
+
+  auto issued = steady_clock::now();
+  auto wall_issued = system_clock::now();
+  auto reply = curl_->Post(kUri_, headers, req_data);
+
+  token = ParseReply(reply);
+  Announce(current_, pool_, cli_id, cli_secret,
+           tokens_->Store(cli_id, headers[0], token, ParseLifetime(reply),
+                          issued),
+           false);
+  Persist(store_, cli_id, headers[0], token, ParseLifetime(reply),
+          wall_issued);
+
+  return token;
+}
+
+bool Authenticator::Load(const string& cli_id, const string& cli_secret,
+                         bool renew, string* token) const {
+  string credentials = BuildHeaders(cli_id, cli_secret)[0];
+  StoredToken stored;
+
+  if (!store_ || !store_->Find(cli_id, credentials, &stored)) {
+    return false;
+  }
 
+  auto issued = SteadyTime(stored.issued);
+  auto cached =
+      TokenCache::Make(credentials, stored.value, stored.lifetime, issued);
+
+  /* a renewal must be fresher than the token due for a refresh. */
+  if (steady_clock::now() >= (renew ? cached.refresh_at : cached.expiry)) {
+    return false;
+  }
+
+  tokens_->Store(cli_id, credentials, stored.value, stored.lifetime, issued);
+
+  Announce(current_, pool_, cli_id, cli_secret, cached, renew);
+
+  *token = stored.value;
+
+  return true;
+}
+
+void Authenticator::Refresh(const string& cli_id,
+                            const string& cli_secret) const {
+  vector<string> req_data{"grant_type=client_credentials"};
+  auto headers = BuildHeaders(cli_id, cli_secret);
+  string renewed;
+
+  /* another process may have refreshed it already. */
+  if (Load(cli_id, cli_secret, true, &renewed)) {
+    return;
+  }
+
+  weak_ptr<TokenCache> tokens = tokens_;
+  weak_ptr<TokenSlot> current = current_;
+  auto store = store_;
+  auto pool = pool_;
+  auto issued = steady_clock::now();
+  auto wall_issued = system_clock::now();
+  /* the refresh outlives the call which triggered it, so it isn't bound to
+   * its deadline nor its cancellation. */
+  CallScope scope{CallContext{"auth"}};
+
+  try {
+    curl_->PostAsync(kUri_, headers, req_data,
+                     [tokens, current, store, pool, cli_id, cli_secret,
+                      headers, issued, wall_issued](exception_ptr error,
+                                                    const Value& reply) {
+                       auto cache = tokens.lock();
+
+                       if (!cache) {
+                         return;
+                       }
+
+                       try {
+                         if (error) {
+                           rethrow_exception(error);
+                         }
+
+                         string token = ParseReply(reply);
+
+                         Announce(current.lock(), pool, cli_id, cli_secret,
+                                  cache->Store(cli_id, headers[0], token,
+                                               ParseLifetime(reply), issued),
+                                  true);
+                         Persist(store, cli_id, headers[0], token,
+                                 ParseLifetime(reply), wall_issued);
+                       } catch (...) {
+                         /* the token is still valid, a later call retries. */
+                         cache->Abandon(cli_id);
+                         Retry(current.lock(), pool, cli_id, cli_secret);
+                       }
+                     });
+  } catch (...) {
+    tokens_->Abandon(cli_id);
+    Retry(current_, pool_, cli_id, cli_secret);
+  }
+}
+
+vector<string> Authenticator::BuildHeaders(const string& cli_id,
+                                           const string& cli_secret) {
+  return {"Authorization: Basic " +
+          utils::GetBase64Code(cli_id + ":" + cli_secret)};
+}
+
+string Authenticator::ParseReply(const Value& reply) {
   /* check if the access token isn't present into the message. */
   if (!reply["access_token"]) {
     throw runtime_error(
@@ -39,4 +407,22 @@ string Authenticator::AuthUser(const string& cli_id,
   return reply["access_token"].asString();
 }
 
+seconds Authenticator::ParseLifetime(const Value& reply) {
+  const Value& expires_in = reply["expires_in"];
+
+  if (expires_in.isIntegral()) {
+    return seconds{expires_in.asInt64()};
+  }
+
+  if (expires_in.isString()) {
+    try {
+      return seconds{stoll(expires_in.asString())};
+    } catch (const exception&) {
+      /* not a number, the token isn't cached. */
+    }
+  }
+
+  return seconds{0};
+}
+
 }  // namespace spotify_lib
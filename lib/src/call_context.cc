@@ -0,0 +1,44 @@
+/**
+ * @file
+ *
+ * @brief Call context class implementation.
+ */
+#include "private/call_context.h"
+
+namespace spotify_lib {
+
+using std::chrono::steady_clock;
+
+namespace {
+
+thread_local CallContext current; //!< Context of the calling thread.
+
+}  // namespace
+
+const CallContext& CallContext::Current() { return current; }
+
+bool CallContext::Expires(steady_clock::duration delay) const {
+  if (deadline == steady_clock::time_point::max()) {
+    return false;
+  }
+
+  return deadline - steady_clock::now() <= delay;
+}
+
+void CallContext::Check() const {
+  if (Cancelled()) {
+    throw CallAbortedError("the call was cancelled!");
+  }
+
+  if (Expires()) {
+    throw CallAbortedError("the call deadline was exceeded!");
+  }
+}
+
+CallScope::CallScope(const CallContext& context) : previous_{current} {
+  current = context;
+}
+
+CallScope::~CallScope() { current = previous_; }
+
+}  // namespace spotify_lib
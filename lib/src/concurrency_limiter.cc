@@ -0,0 +1,198 @@
+/**
+ * @file
+ *
+ * @brief Concurrency limiter class implementation.
+ */
+#include "private/concurrency_limiter.h"
+
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <memory>
+#include <vector>
+
+#include "private/call_context.h"
+
+namespace spotify_lib {
+
+using std::atomic;
+using std::function;
+using std::lock_guard;
+using std::make_shared;
+using std::max;
+using std::min;
+using std::mutex;
+using std::promise;
+using std::size_t;
+using std::string;
+using std::unique_lock;
+using std::vector;
+using std::chrono::microseconds;
+using std::chrono::steady_clock;
+
+ConcurrencyLimiter::ConcurrencyLimiter(const LimiterOptions& options)
+    : kOptions_{options},
+      limit_{static_cast<double>(options.initial_limit)},
+      in_flight_{0},
+      shed_{0},
+      last_decrease_{} {}
+
+bool ConcurrencyLimiter::Acquire() {
+  /* a free slot is taken without setting up the wait. */
+  if (TryAcquire()) {
+    return true;
+  }
+
+  /* the waiter may give up before the slot is granted, whoever comes second
+   * gives it back. */
+  auto granted = make_shared<promise<void>>();
+  auto claimed = make_shared<atomic<bool>>(false);
+  auto ready = granted->get_future();
+
+  if (!AcquireAsync([this, granted, claimed] {
+        if (claimed->exchange(true)) {
+          Release(Outcome::kIgnored, microseconds{0});
+        } else {
+          granted->set_value();
+        }
+      })) {
+    return false;
+  }
+
+  try {
+    CallContext::Current().Await(ready);
+  } catch (const CallAbortedError&) {
+    if (claimed->exchange(true)) {
+      Release(Outcome::kIgnored, microseconds{0});
+    }
+
+    throw;
+  }
+
+  return true;
+}
+
+bool ConcurrencyLimiter::TryAcquire() {
+  if (!kOptions_.initial_limit) {
+    return true;
+  }
+
+  lock_guard<mutex> lock{mutex_};
+
+  if (!waiters_.empty() || in_flight_ >= static_cast<size_t>(limit_)) {
+    return false;
+  }
+
+  in_flight_++;
+
+  return true;
+}
+
+bool ConcurrencyLimiter::AcquireAsync(const function<void()>& on_granted) {
+  if (!kOptions_.initial_limit) {
+    on_granted();
+    return true;
+  }
+
+  {
+    lock_guard<mutex> lock{mutex_};
+
+    /* the waiters go first, a request arriving now mustn't overtake them. */
+    if (!waiters_.empty() || in_flight_ >= static_cast<size_t>(limit_)) {
+      if (waiters_.size() >= kOptions_.max_queued) {
+        shed_++;
+        return false;
+      }
+
+      waiters_.push_back(on_granted);
+      return true;
+    }
+
+    in_flight_++;
+  }
+
+  on_granted();
+
+  return true;
+}
+
+void ConcurrencyLimiter::Release(Outcome outcome, microseconds latency,
+                                 const string& host) {
+  if (!kOptions_.initial_limit) {
+    return;
+  }
+
+  vector<function<void()>> granted;
+
+  {
+    lock_guard<mutex> lock{mutex_};
+
+    Adjust(outcome, latency, host);
+    in_flight_--;
+
+    while (!waiters_.empty() && in_flight_ < static_cast<size_t>(limit_)) {
+      in_flight_++;
+      granted.push_back(std::move(waiters_.front()));
+      waiters_.pop_front();
+    }
+  }
+
+  /* the waiters resume outside the lock, they may take another slot. */
+  for (auto& g : granted) {
+    g();
+  }
+}
+
+LimiterStats ConcurrencyLimiter::Stats() const {
+  lock_guard<mutex> lock{mutex_};
+
+  return LimiterStats{static_cast<size_t>(limit_), in_flight_, waiters_.size(),
+                      shed_};
+}
+
+void ConcurrencyLimiter::Adjust(Outcome outcome, microseconds latency,
+                                const string& host) {
+  if (outcome == Outcome::kIgnored) {
+    return;
+  }
+
+  bool overloaded = outcome == Outcome::kDropped;
+
+  /* each host has its own baseline, a slower endpoint isn't an overload of
+   * the faster ones. */
+  auto& baseline_us = baselines_us_[host];
+
+  if (outcome == Outcome::kSuccess) {
+    double sample = static_cast<double>(latency.count());
+
+    overloaded = baseline_us > 0 &&
+                 sample > kOptions_.latency_tolerance * baseline_us;
+
+    /* the baseline follows the fastest requests, an average would drift up
+     * along with the overload. It creeps up slowly so that it still adapts
+     * to slower endpoints. */
+    if (baseline_us <= 0 || sample < baseline_us) {
+      baseline_us = sample;
+    } else {
+      baseline_us += 0.01 * (sample - baseline_us);
+    }
+  }
+
+  if (overloaded) {
+    /* the requests already in flight went through the same overload, a
+     * single decrease per round trip is enough. */
+    auto now = steady_clock::now();
+    auto round_trip = max(baseline_us, static_cast<double>(latency.count()));
+
+    if (now - last_decrease_ >= microseconds{static_cast<long>(round_trip)}) {
+      limit_ = max(static_cast<double>(kOptions_.min_limit),
+                   limit_ * kOptions_.backoff_ratio);
+      last_decrease_ = now;
+    }
+  } else if (2 * in_flight_ >= static_cast<size_t>(limit_)) {
+    /* only widen a window which is actually in use, one slot per window. */
+    limit_ = min(static_cast<double>(kOptions_.max_limit), limit_ + 1 / limit_);
+  }
+}
+
+}  // namespace spotify_lib
@@ -0,0 +1,129 @@
+/**
+ * @file
+ *
+ * @brief Credential pool class implementation.
+ */
+#include "private/credential_pool.h"
+
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+
+#include "private/http_error.h"
+
+namespace spotify_lib {
+
+using std::hash;
+using std::max;
+using std::min;
+using std::move;
+using std::runtime_error;
+using std::size_t;
+using std::string;
+using std::unique_ptr;
+using std::vector;
+using std::chrono::duration_cast;
+using std::chrono::seconds;
+using std::chrono::steady_clock;
+
+CredentialPool::CredentialPool(const vector<Credentials>& credentials,
+                               PoolPolicy policy)
+    : kPolicy_{policy}, next_{0} {
+  if (credentials.empty()) {
+    throw runtime_error("the credential pool is empty!");
+  }
+
+  for (auto& credential : credentials) {
+    unique_ptr<Entry> entry{new Entry};
+
+    entry->credentials = credential;
+    entry->parked_until = 0;
+    entry->limited_at = 0;
+    entries_.push_back(move(entry));
+  }
+}
+
+size_t CredentialPool::Pick(const string& query) const {
+  auto now = steady_clock::now().time_since_epoch().count();
+  size_t size = entries_.size();
+  size_t start = kPolicy_ == PoolPolicy::kQueryHash ? hash<string>{}(query)
+                                                    : next_++;
+  size_t picked = size;
+  auto back_at = steady_clock::time_point::max().time_since_epoch().count();
+
+  for (size_t n = 0; n < size; n++) {
+    size_t index = (start + n) % size;
+    auto& entry = *entries_[index];
+    auto parked_until = entry.parked_until.load();
+
+    if (parked_until > now) {
+      back_at = min(back_at, parked_until);
+      continue;
+    }
+
+    if (kPolicy_ != PoolPolicy::kLeastRecentlyLimited) {
+      return index;
+    }
+
+    /* the ties go to the next one in turn. */
+    if (picked == size ||
+        entry.limited_at.load() < entries_[picked]->limited_at.load()) {
+      picked = index;
+    }
+  }
+
+  if (picked == size) {
+    /* rounded up, the first one isn't back before. */
+    throw HttpError{429, duration_cast<seconds>(steady_clock::duration{
+                             back_at - now}) + seconds{1}};
+  }
+
+  return picked;
+}
+
+const Credentials& CredentialPool::At(size_t index) const {
+  return entries_.at(index)->credentials;
+}
+
+TokenSlot& CredentialPool::Slot(size_t index) const {
+  return entries_.at(index)->slot;
+}
+
+void CredentialPool::Publish(const string& client_id,
+                             const string& client_secret,
+                             const CachedToken& token) const {
+  for (auto& entry : entries_) {
+    if (entry->credentials.client_id == client_id &&
+        entry->credentials.client_secret == client_secret) {
+      entry->slot.Publish(client_id, client_secret, token);
+    }
+  }
+}
+
+void CredentialPool::RetryRefresh(const string& client_id,
+                                  const string& client_secret,
+                                  steady_clock::duration delay) const {
+  for (auto& entry : entries_) {
+    if (entry->credentials.client_id == client_id &&
+        entry->credentials.client_secret == client_secret) {
+      entry->slot.RetryRefresh(client_id, client_secret, delay);
+    }
+  }
+}
+
+void CredentialPool::Park(size_t index, seconds retry_after) const {
+  auto& entry = *entries_.at(index);
+  auto now = steady_clock::now();
+  auto until = (now + max(retry_after, seconds{1})).time_since_epoch().count();
+  auto parked_until = entry.parked_until.load();
+
+  /* concurrent 429s keep the latest end. */
+  while (parked_until < until &&
+         !entry.parked_until.compare_exchange_weak(parked_until, until)) {
+  }
+
+  entry.limited_at = now.time_since_epoch().count();
+}
+
+}  // namespace spotify_lib
@@ -0,0 +1,94 @@
+/**
+ * @file
+ *
+ * @brief Curl handle pool class implementation.
+ */
+#include "private/curl_handle_pool.h"
+
+#include <stdexcept>
+
+#include "private/utils.h"
+
+namespace spotify_lib {
+
+using std::lock_guard;
+using std::mutex;
+using std::runtime_error;
+using std::size_t;
+using std::unique_ptr;
+
+CurlHandlePool::Lease::Lease(CurlHandlePool* pool, unique_ptr<Entry> entry)
+    : pool_{pool}, entry_{std::move(entry)} {}
+
+CurlHandlePool::Lease::Lease(Lease&& other) noexcept
+    : pool_{other.pool_}, entry_{std::move(other.entry_)} {}
+
+CurlHandlePool::Lease::~Lease() {
+  if (entry_) {
+    pool_->Release(std::move(entry_));
+  }
+}
+
+CurlHandlePool::CurlHandlePool(size_t max_idle) : kMaxIdle_{max_idle} {
+  /* it must run before any handle is created from the worker threads. */
+  utils::InitCurl();
+
+  idle_.reserve(kMaxIdle_);
+}
+
+CurlHandlePool::~CurlHandlePool() {
+  for (auto& entry : idle_) {
+    Destroy(std::move(entry));
+  }
+}
+
+CurlHandlePool::Lease CurlHandlePool::Acquire() {
+  unique_ptr<Entry> entry;
+
+  {
+    lock_guard<mutex> lock{mutex_};
+
+    if (!idle_.empty()) {
+      entry = std::move(idle_.back());
+      idle_.pop_back();
+    }
+  }
+
+  if (!entry) {
+    entry.reset(new Entry{curl_easy_init(), {}, false});
+
+    if (!entry->handle) {
+      throw runtime_error("failed to allocate a libcurl handle!");
+    }
+  }
+
+  return Lease{this, std::move(entry)};
+}
+
+size_t CurlHandlePool::IdleCount() const {
+  lock_guard<mutex> lock{mutex_};
+
+  return idle_.size();
+}
+
+void CurlHandlePool::Release(unique_ptr<Entry> entry) {
+  /* the options are kept, the next holder only sets the varying ones. */
+  entry->buffer.Reset();
+
+  {
+    lock_guard<mutex> lock{mutex_};
+
+    if (idle_.size() < kMaxIdle_) {
+      idle_.push_back(std::move(entry));
+      return;
+    }
+  }
+
+  Destroy(std::move(entry));
+}
+
+void CurlHandlePool::Destroy(unique_ptr<Entry> entry) {
+  curl_easy_cleanup(entry->handle);
+}
+
+}  // namespace spotify_lib
@@ -0,0 +1,57 @@
+/**
+ * @file
+ *
+ * @brief Curl share class implementation.
+ */
+#include "private/curl_share.h"
+
+#include <stdexcept>
+
+#include "private/utils.h"
+
+namespace spotify_lib {
+
+using std::runtime_error;
+using std::string;
+
+CurlShare::CurlShare(const string& tls_session_file) : handle_{nullptr} {
+  utils::InitCurl();
+
+  handle_ = curl_share_init();
+
+  if (!handle_) {
+    throw runtime_error("failed to allocate a libcurl share handle!");
+  }
+
+  curl_share_setopt(handle_, CURLSHOPT_LOCKFUNC, Lock);
+  curl_share_setopt(handle_, CURLSHOPT_UNLOCKFUNC, Unlock);
+  curl_share_setopt(handle_, CURLSHOPT_USERDATA, this);
+  curl_share_setopt(handle_, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+  curl_share_setopt(handle_, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+
+  if (!tls_session_file.empty()) {
+    try {
+      sessions_.reset(new TlsSessionStore(tls_session_file, handle_));
+    } catch (...) {
+      curl_share_cleanup(handle_);
+      throw;
+    }
+  }
+}
+
+CurlShare::~CurlShare() {
+  /* the store saves the sessions of the share a last time. */
+  sessions_.reset();
+  curl_share_cleanup(handle_);
+}
+
+void CurlShare::Lock(CURL* /* handle */, curl_lock_data data,
+                     curl_lock_access /* access */, void* userp) {
+  static_cast<CurlShare*>(userp)->locks_[data].lock();
+}
+
+void CurlShare::Unlock(CURL* /* handle */, curl_lock_data data, void* userp) {
+  static_cast<CurlShare*>(userp)->locks_[data].unlock();
+}
+
+}  // namespace spotify_lib
@@ -5,152 +5,1144 @@
  */
 #include "private/curl_wrapper.h"
 
+#include <strings.h>
+
 #include <cstring>
+
+#include <algorithm>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
 #include <stdexcept>
+#include <thread>
+
+#include "private/call_context.h"
 
 namespace spotify_lib {
 
+using Json::CharReader;
 using Json::Value;
-using std::memcpy;
+using std::async;
+using std::condition_variable;
+using std::current_exception;
+using std::exception_ptr;
+using std::function;
+using std::future;
+using std::launch;
+using std::lock_guard;
+using std::make_exception_ptr;
+using std::make_shared;
+using std::max;
+using std::mutex;
+using std::promise;
+using std::rethrow_exception;
 using std::runtime_error;
+using std::shared_ptr;
 using std::size_t;
+using std::strcmp;
 using std::string;
+using std::unique_lock;
+using std::unique_ptr;
 using std::vector;
+using std::chrono::duration_cast;
+using std::chrono::microseconds;
+using std::chrono::milliseconds;
+using std::chrono::seconds;
+using std::chrono::steady_clock;
+
+/**
+ * @brief This structure holds the state of a single transfer.
+ */
+struct CurlTransfer {
+  explicit CurlTransfer(CurlHandlePool::Lease&& handle_lease)
+      : lease{std::move(handle_lease)},
+        headers{nullptr},
+        on_chunk{nullptr},
+        body_bytes{0},
+        rejected{false},
+        limiter{nullptr},
+        context{CallContext::Current()},
+        bounded{false},
+        metrics{} {
+    metrics.operation = context.operation;
+  }
+
+  ~CurlTransfer() {
+    /* the transfer didn't finish, its slot says nothing about the server. */
+    if (limiter) {
+      limiter->Release(ConcurrencyLimiter::Outcome::kIgnored, microseconds{0});
+    }
+
+    curl_slist_free_all(headers);
+  }
+
+  CurlHandlePool::Lease lease;
+  struct curl_slist* headers;
+  string data;
+  const ChunkCallback* on_chunk;
+  exception_ptr error;
+  size_t body_bytes;
+  bool rejected;
+  ConcurrencyLimiter* limiter;
+  string cache_key;
+  shared_ptr<const CachedResponse> cached;
+  string etag;
+  string last_modified;
+  CallContext context;
+  bool bounded;
+  RequestMetrics metrics;
+};
 
-struct CurlFetch {
-  char* payload;
-  size_t size;
+namespace {
+
+/**
+ * @brief This structure holds the state of a hedged GET, shared with the
+ * completions of its transfers.
+ */
+struct HedgeRace {
+  mutex guard;
+  condition_variable finished;
+  int winner{-1};
+  int done{0};
+  CURLcode ret[2]{CURLE_OK, CURLE_OK};
 };
 
-CurlWrapper::CurlWrapper()
-    : curl_handle_{static_cast<CURL*>(curl_easy_init())} {
-  if (!curl_handle_) {
-    throw runtime_error("failed to start the authentication process!");
+/**
+ * @brief Strip the blanks and the line break around a header value.
+ *
+ * @param data Header value.
+ * @param size Value size.
+ *
+ * @return The stripped value.
+ */
+string HeaderValue(const char* data, size_t size) {
+  while (size && (data[size - 1] == '\r' || data[size - 1] == '\n' ||
+                  data[size - 1] == ' ' || data[size - 1] == '\t')) {
+    size--;
   }
+
+  while (size && (data[0] == ' ' || data[0] == '\t')) {
+    data++;
+    size--;
+  }
+
+  return string{data, size};
 }
 
-CurlWrapper::~CurlWrapper() { curl_easy_cleanup(curl_handle_); }
+/**
+ * @brief Add the conditional headers revalidating a cached response.
+ *
+ * @param headers Request headers.
+ * @param cached The cached response.
+ *
+ * @return The headers of the revalidation.
+ */
+vector<string> Conditional(const vector<string>& headers,
+                           const CachedResponse& cached) {
+  vector<string> conditional{headers};
+
+  if (!cached.etag.empty()) {
+    conditional.push_back("If-None-Match: " + cached.etag);
+  }
+
+  if (!cached.last_modified.empty()) {
+    conditional.push_back("If-Modified-Since: " + cached.last_modified);
+  }
+
+  return conditional;
+}
+
+/**
+ * @brief Get the origin of an uri, its scheme and authority.
+ *
+ * @param uri The uri.
+ *
+ * @return The origin, with a trailing slash.
+ */
+string Origin(const string& uri) {
+  auto authority = uri.find("://");
+
+  authority = authority == string::npos ? 0 : authority + 3;
+
+  return uri.substr(0, uri.find_first_of("/?#", authority)) + '/';
+}
+
+/**
+ * @brief Wait before a retry, giving up early if the call is cancelled.
+ *
+ * @param context Context of the call.
+ * @param delay Time to wait.
+ */
+void Wait(const CallContext& context, RetryScheduler::Duration delay) {
+  constexpr milliseconds kSlice{50};
+  auto until = steady_clock::now() + delay;
+
+  for (auto now = steady_clock::now(); now < until && !context.Cancelled();
+       now = steady_clock::now()) {
+    std::this_thread::sleep_for(std::min<RetryScheduler::Duration>(until - now,
+                                                                  kSlice));
+  }
+
+  context.Check();
+}
+
+/**
+ * @brief Join an identical request in flight, or make it. When the request
+ * joined is aborted by the cancellation or the deadline of its own call, the
+ * request is made again for this call.
+ *
+ * @param flights Requests in flight.
+ * @param key Key of the request.
+ * @param fetch The request.
+ *
+ * @return The result of the request.
+ */
+template <typename T>
+T Join(Singleflight<T>* flights, const string& key,
+       const function<T()>& fetch) {
+  for (;;) {
+    try {
+      return flights->Do(key, fetch);
+    } catch (const CallAbortedError&) {
+      CallContext::Current().Check();
+    }
+  }
+}
+
+}  // namespace
+
+CurlWrapper::CurlWrapper(const CurlOptions& options)
+    : kOptions_{options},
+      pool_{options.max_idle_handles},
+      requests_{0},
+      connections_{0},
+      wire_bytes_{0},
+      body_bytes_{0},
+      cache_hits_{0},
+      retries_{0},
+      scheduler_{options.retry},
+      limiter_{options.limiter},
+      hedger_{options.hedge},
+      cache_{options.cache_bytes ? new ResponseCache{options.cache_bytes}
+                                 : nullptr},
+      engine_{options.http2 ? options.max_concurrent_streams : 0,
+              options.loop} {
+  if (kOptions_.http2 &&
+      !(curl_version_info(CURLVERSION_NOW)->features & CURL_VERSION_HTTP2)) {
+    throw runtime_error("libcurl was built without HTTP/2 support!");
+  }
+}
 
 Value CurlWrapper::Post(const string& uri, const vector<string>& req_headers,
                         const vector<string>& req_data) const {
-  Value response;
-  struct curl_slist* headers = nullptr;
-  struct CurlFetch curl_fetch;
-  struct CurlFetch* cf = &curl_fetch;
+  Value reply;
+
+  Schedule(RetryScheduler::Host(uri),
+           [this, &uri, &req_headers, &req_data, &reply] {
+             auto transfer = Prepare("POST", uri, req_headers, req_data);
+
+             reply = Parse(Perform(transfer.get()), transfer.get());
+           },
+           false);
+
+  return reply;
+}
+
+Value CurlWrapper::Get(const string& uri,
+                       const vector<string>& req_headers) const {
+  return FetchJson(
+      kOptions_.coalesce ? RequestKey(uri, req_headers) : string{},
+      RetryScheduler::Host(uri),
+      [this, &uri, &req_headers] { return PrepareGet(uri, req_headers); });
+}
+
+Value CurlWrapper::Get(const PreparedRequest& request) const {
+  return FetchJson(request.Key(), request.Host(),
+                   [this, &request] { return PrepareGet(request); });
+}
+
+string CurlWrapper::GetRaw(const string& uri,
+                           const vector<string>& req_headers) const {
+  return FetchRaw(
+      kOptions_.coalesce ? RequestKey(uri, req_headers) : string{},
+      RetryScheduler::Host(uri), [this, &uri, &req_headers] {
+        return Prepare("GET", uri, req_headers, {});
+      });
+}
+
+string CurlWrapper::GetRaw(const PreparedRequest& request) const {
+  return FetchRaw(request.Key(), request.Host(),
+                  [this, &request] { return Prepare(request); });
+}
+
+void CurlWrapper::GetStream(const string& uri,
+                            const vector<string>& req_headers,
+                            const ChunkCallback& on_chunk) const {
+  /* the body of a rejected reply is dropped, so nothing reached the chunk
+   * callback when the request is sent again. */
+  Schedule(RetryScheduler::Host(uri), [this, &uri, &req_headers, &on_chunk] {
+    auto transfer = Prepare("GET", uri, req_headers, {});
+
+    transfer->on_chunk = &on_chunk;
+
+    Finish(Perform(transfer.get()), transfer.get());
+  });
+}
+
+void CurlWrapper::PostAsync(const string& uri,
+                            const vector<string>& req_headers,
+                            const vector<string>& req_data,
+                            const JsonCallback& callback) const {
+  auto host = RetryScheduler::Host(uri);
+
+  Submit(host,
+         [this, uri, req_headers, req_data] {
+           return Prepare("POST", uri, req_headers, req_data);
+         },
+         callback, 0, scheduler_.Admit(host), false);
+}
+
+void CurlWrapper::GetAsync(const string& uri, const vector<string>& req_headers,
+                           const JsonCallback& callback) const {
+  auto host = RetryScheduler::Host(uri);
+
+  Submit(host, [this, uri, req_headers] { return PrepareGet(uri, req_headers); },
+         callback, 0, scheduler_.Admit(host), true);
+}
+
+future<Value> CurlWrapper::PostAsync(const string& uri,
+                                     const vector<string>& req_headers,
+                                     const vector<string>& req_data) const {
+  auto result = make_shared<promise<Value>>();
+
+  PostAsync(uri, req_headers, req_data,
+            [result](exception_ptr error, const Value& reply) {
+              if (error) {
+                result->set_exception(error);
+              } else {
+                result->set_value(reply);
+              }
+            });
+
+  return result->get_future();
+}
+
+future<Value> CurlWrapper::GetAsync(const string& uri,
+                                    const vector<string>& req_headers) const {
+  auto result = make_shared<promise<Value>>();
+
+  GetAsync(uri, req_headers, [result](exception_ptr error, const Value& reply) {
+    if (error) {
+      result->set_exception(error);
+    } else {
+      result->set_value(reply);
+    }
+  });
+
+  return result->get_future();
+}
+
+void CurlWrapper::Warmup(const vector<string>& uris,
+                         size_t connections) const {
+  CallScope scope{CallContext{"warmup"}};
+  vector<string> origins;
+
+  for (auto& uri : uris) {
+    origins.push_back(Origin(uri));
+  }
+
+  /* the engine keeps its own connections, whatever the handle. */
+  if (kOptions_.http2 || kOptions_.loop) {
+    for (size_t i = 0; i < connections; i++) {
+      for (auto& origin : origins) {
+        shared_ptr<CurlTransfer> transfer{Prepare("GET", origin, {}, {})};
+
+        curl_easy_setopt(transfer->lease.Get(), CURLOPT_NOBODY, 1L);
+        engine_.Submit(transfer->lease.Get(), [this, transfer](CURLcode ret) {
+          curl_easy_setopt(transfer->lease.Get(), CURLOPT_NOBODY, 0L);
+          Measure(ret, transfer.get());
+          Report(transfer.get());
+        });
+      }
+    }
+
+    return;
+  }
+
+  /* the warm-ups run one after the other, so that the handles warmed by the
+   * previous ones (the last released) get connected to the new hosts. */
+  lock_guard<mutex> lock{warmup_mutex_};
+  auto previous = make_shared<future<void>>(std::move(warmup_));
+
+  warmup_ = async(launch::async, [this, origins, connections, previous] {
+    if (previous->valid()) {
+      previous->wait();
+    }
+
+    CallScope scope{CallContext{"warmup"}};
+
+    WarmHandles(origins, connections);
+  });
+}
+
+CurlStats CurlWrapper::Stats() const {
+  auto limiter = limiter_.Stats();
+
+  return CurlStats{requests_, connections_, wire_bytes_, body_bytes_,
+                   cache_hits_,
+                   get_flights_.Coalesced() + raw_flights_.Coalesced(),
+                   retries_, limiter.limit, limiter.queued, limiter.shed,
+                   hedger_.Hedges()};
+}
+
+unique_ptr<CurlTransfer> CurlWrapper::Prepare(
+    const char* method, const string& uri, const vector<string>& req_headers,
+    const vector<string>& req_data) const {
+  unique_ptr<CurlTransfer> transfer{new CurlTransfer{pool_.Acquire()}};
 
   for (auto& h : req_headers) {
-    headers = curl_slist_append(headers, h.c_str());
+    transfer->headers = curl_slist_append(transfer->headers, h.c_str());
+  }
+
+  if (!req_data.empty()) {
+    transfer->data = req_data.back();
   }
 
-  curl_easy_setopt(curl_handle_, CURLOPT_CUSTOMREQUEST, "POST");
-  curl_easy_setopt(curl_handle_, CURLOPT_HTTPHEADER, headers);
+  Setup(transfer.get(), method, uri, transfer->headers);
 
-  for (auto& d : req_data) {
-    headers = curl_slist_append(headers, d.c_str());
-    curl_easy_setopt(curl_handle_, CURLOPT_POSTFIELDS, d.c_str());
+  return transfer;
+}
+
+unique_ptr<CurlTransfer> CurlWrapper::Prepare(
+    const PreparedRequest& request) const {
+  unique_ptr<CurlTransfer> transfer{new CurlTransfer{pool_.Acquire()}};
+
+  /* the header list belongs to the request, nothing is copied. */
+  Setup(transfer.get(), "GET", request.Uri(), request.Headers());
+
+  return transfer;
+}
+
+string CurlWrapper::RequestKey(const string& uri,
+                               const vector<string>& req_headers) {
+  string key{uri};
+
+  for (auto& h : req_headers) {
+    key += '\n' + h;
+  }
+
+  return key;
+}
+
+unique_ptr<CurlTransfer> CurlWrapper::PrepareGet(
+    const string& uri, const vector<string>& req_headers) const {
+  if (!cache_) {
+    return Prepare("GET", uri, req_headers, {});
+  }
+
+  string key = RequestKey(uri, req_headers);
+  auto cached = cache_->Find(key);
+  auto transfer = Prepare("GET", uri,
+                          cached ? Conditional(req_headers, *cached) : req_headers,
+                          {});
+
+  transfer->cache_key = std::move(key);
+  transfer->cached = std::move(cached);
+
+  return transfer;
+}
+
+unique_ptr<CurlTransfer> CurlWrapper::PrepareGet(
+    const PreparedRequest& request) const {
+  if (!cache_) {
+    return Prepare(request);
+  }
+
+  /* a revalidation adds headers, so it doesn't use the prepared list. */
+  auto cached = cache_->Find(request.Key());
+  auto transfer = cached ? Prepare("GET", request.Uri(),
+                                   Conditional(request.HeaderLines(), *cached),
+                                   {})
+                         : Prepare(request);
+
+  transfer->cache_key = request.Key();
+  transfer->cached = std::move(cached);
+
+  return transfer;
+}
+
+Value CurlWrapper::FetchJson(const string& key, const string& host,
+                             const TransferFactory& prepare) const {
+  auto fetch = [this, &host, &prepare] {
+    Value reply;
+
+    Schedule(host, [this, &prepare, &reply] {
+      CURLcode ret;
+      auto transfer = PerformGet(prepare, &ret);
+
+      reply = Parse(ret, transfer.get());
+    });
+
+    return reply;
+  };
+
+  if (!kOptions_.coalesce) {
+    return fetch();
   }
 
-  auto ret = FetchUri(uri.c_str(), cf);
+  return Join<Value>(&get_flights_, key, fetch);
+}
+
+string CurlWrapper::FetchRaw(const string& key, const string& host,
+                             const TransferFactory& prepare) const {
+  auto fetch = [this, &host,
+                &prepare](const function<void(const ResponseBuffer&)>& read) {
+    Schedule(host, [this, &prepare, &read] {
+      CURLcode ret;
+      auto transfer = PerformGet(prepare, &ret);
 
-  curl_slist_free_all(headers);
+      Finish(ret, transfer.get());
+      read(transfer->lease.Buffer());
+    });
+  };
+  string raw;
+  auto pad = [&raw](const char* data, size_t size) {
+    raw.reserve(size + kRawPadding);
+    raw.assign(data, size);
+  };
+
+  if (!kOptions_.coalesce) {
+    /* a single copy, straight from the response buffer. */
+    fetch([&pad](const ResponseBuffer& buffer) {
+      pad(buffer.Data(), buffer.Size());
+    });
+
+    return raw;
+  }
+
+  /* the body is shared by the joined callers, each one gets its own copy
+   * with the spare capacity. */
+  auto body = Join<shared_ptr<const string>>(&raw_flights_, key, [&fetch] {
+    shared_ptr<const string> body;
+
+    fetch([&body](const ResponseBuffer& buffer) {
+      body = make_shared<const string>(buffer.Data(), buffer.Size());
+    });
+
+    return body;
+  });
+
+  pad(body->data(), body->size());
+
+  return raw;
+}
+
+void CurlWrapper::Schedule(const string& host,
+                           const function<void()>& attempt,
+                           bool idempotent) const {
+  auto& context = CallContext::Current();
+  auto delay = scheduler_.Admit(host);
+
+  for (size_t n = 0;; n++) {
+    if (delay > RetryScheduler::Duration::zero()) {
+      Wait(context, delay);
+    }
+
+    try {
+      attempt();
+      return;
+    } catch (const HttpError& e) {
+      /* a credential limited on its own isn't waited for, the caller has
+       * others to go on with. */
+      if (!scheduler_.CanRetry(n) || (!idempotent && !e.Resendable()) ||
+          (context.failover && e.Status() == 429)) {
+        throw;
+      }
+
+      delay = scheduler_.Retry(host, n, e.RetryAfter());
+
+      /* a retry sent past the deadline would be aborted anyway. */
+      if (context.Expires(delay)) {
+        throw;
+      }
+
+      retries_++;
+    }
+  }
+}
+
+unique_ptr<CurlTransfer> CurlWrapper::PerformGet(const TransferFactory& prepare,
+                                                 CURLcode* ret) const {
+  auto start = steady_clock::now();
+  unique_ptr<CurlTransfer> transfers[2]{prepare(), nullptr};
+  auto delay = hedger_.Delay();
+
+  /* the race would be run by the loop, which may be the calling thread. */
+  if (!kOptions_.hedge.enabled || kOptions_.loop ||
+      delay == microseconds::zero()) {
+    *ret = Perform(transfers[0].get());
+
+    if (kOptions_.hedge.enabled) {
+      hedger_.Record(duration_cast<microseconds>(steady_clock::now() - start));
+    }
+
+    return std::move(transfers[0]);
+  }
+
+  /* both transfers run on the event thread, so that the loser can be
+   * cancelled; the first successful one wins. */
+  auto race = make_shared<HedgeRace>();
+  RequestEngine::Ticket tickets[2]{0, 0};
+  auto submit = [this, race, &tickets](CurlTransfer* transfer, int index) {
+    auto on_done = [race, index](CURLcode result) {
+      lock_guard<mutex> lock{race->guard};
+
+      race->ret[index] = result;
+      race->done++;
+
+      if (race->winner < 0 && result == CURLE_OK) {
+        race->winner = index;
+      }
+
+      race->finished.notify_all();
+    };
+
+    /* the loser is cancelled by ticket, its handle may be leased again by
+     * then. */
+    tickets[index] = engine_.Submit(transfer->lease.Get(), on_done);
+  };
+
+  if (!limiter_.Acquire()) {
+    throw runtime_error("too many requests waiting for the remote server!");
+  }
+
+  transfers[0]->limiter = &limiter_;
+  transfers[0]->context.Check();
+  Bound(transfers[0].get());
+  submit(transfers[0].get(), 0);
+
+  unique_lock<mutex> lock{race->guard};
+  int sent = 1;
+
+  /* the hedge is optional load: it needs a budget and a free slot. */
+  if (!race->finished.wait_for(lock, delay, [&race] { return race->done > 0; }) &&
+      limiter_.TryAcquire()) {
+    if (hedger_.Spend()) {
+      try {
+        transfers[1] = prepare();
+        transfers[1]->limiter = &limiter_;
+
+        /* as another stream of the slow transfer's connection, the hedge
+         * would be stalled along with it. */
+        if (kOptions_.http2) {
+          curl_easy_setopt(transfers[1]->lease.Get(), CURLOPT_FRESH_CONNECT,
+                           1L);
+        }
+
+        submit(transfers[1].get(), 1);
+        sent = 2;
+      } catch (...) {
+        /* not hedged, the first transfer is still running. */
+      }
+    }
+
+    if (sent == 1) {
+      limiter_.Release(ConcurrencyLimiter::Outcome::kIgnored, microseconds{0});
+    }
+  }
+
+  race->finished.wait(lock, [&race, sent] {
+    return race->winner >= 0 || race->done == sent;
+  });
+
+  int winner = race->winner >= 0 ? race->winner : 0;
+
+  if (race->done < sent) {
+    engine_.Cancel(tickets[1 - winner]);
+    race->finished.wait(lock, [&race, sent] { return race->done == sent; });
+  }
+
+  *ret = race->ret[winner];
+  hedger_.Record(duration_cast<microseconds>(steady_clock::now() - start));
+
+  return std::move(transfers[winner]);
+}
+
+CURLcode CurlWrapper::Perform(CurlTransfer* transfer) const {
+  if (!limiter_.Acquire()) {
+    throw runtime_error("too many requests waiting for the remote server!");
+  }
+
+  transfer->limiter = &limiter_;
+
+  /* the time spent in the queue counts against the deadline. */
+  transfer->context.Check();
+  Bound(transfer);
+
+  if (!kOptions_.http2 || kOptions_.loop) {
+    return curl_easy_perform(transfer->lease.Get());
+  }
+
+  /* in HTTP/2 mode the transfer runs on the event thread as well, so that it
+   * shares the multiplexed connections. */
+  promise<CURLcode> done;
+  auto ret = done.get_future();
+
+  engine_.Submit(transfer->lease.Get(),
+                 [&done](CURLcode result) { done.set_value(result); });
+
+  return ret.get();
+}
+
+void CurlWrapper::WarmHandles(const vector<string>& origins,
+                              size_t connections) const {
+  /* all held at once, so that they're distinct handles. */
+  vector<unique_ptr<CurlTransfer>> transfers;
+
+  for (size_t i = 0; i < connections; i++) {
+    transfers.emplace_back(new CurlTransfer{pool_.Acquire()});
+
+    auto transfer = transfers.back().get();
+    auto handle = transfer->lease.Get();
+
+    for (auto& origin : origins) {
+      Setup(transfer, "GET", origin, nullptr);
+      curl_easy_setopt(handle, CURLOPT_NOBODY, 1L);
+      Measure(curl_easy_perform(handle), transfer);
+      Report(transfer);
+    }
+
+    /* back to a GET, the next holder doesn't expect a HEAD. */
+    curl_easy_setopt(handle, CURLOPT_NOBODY, 0L);
+  }
+}
+
+void CurlWrapper::Finish(CURLcode ret, CurlTransfer* transfer) const {
+  Measure(ret, transfer);
+  Report(transfer);
+  Check(ret, transfer);
+}
+
+void CurlWrapper::Measure(CURLcode ret, CurlTransfer* transfer) const {
+  auto handle = transfer->lease.Get();
+  auto& metrics = transfer->metrics;
+  long new_connections = 0;
+  long header_size = 0;
+  long request_size = 0;
+  curl_off_t download_size = 0;
+  curl_off_t upload_size = 0;
+
+  /* the download size counts the body as received, before decompression. */
+  curl_easy_getinfo(handle, CURLINFO_NUM_CONNECTS, &new_connections);
+  curl_easy_getinfo(handle, CURLINFO_HEADER_SIZE, &header_size);
+  curl_easy_getinfo(handle, CURLINFO_REQUEST_SIZE, &request_size);
+  curl_easy_getinfo(handle, CURLINFO_SIZE_DOWNLOAD_T, &download_size);
+  curl_easy_getinfo(handle, CURLINFO_SIZE_UPLOAD_T, &upload_size);
+  connections_ += new_connections;
+  wire_bytes_ += header_size + download_size;
+  body_bytes_ += transfer->body_bytes;
+  requests_++;
+
+  /* the times are counted from the start of the transfer, each phase ends
+   * where the next one begins. */
+  curl_off_t dns = 0;
+  curl_off_t connect = 0;
+  curl_off_t tls = 0;
+  curl_off_t sent = 0;
+  curl_off_t first_byte = 0;
+  curl_off_t total = 0;
+
+  curl_easy_getinfo(handle, CURLINFO_NAMELOOKUP_TIME_T, &dns);
+  curl_easy_getinfo(handle, CURLINFO_CONNECT_TIME_T, &connect);
+  curl_easy_getinfo(handle, CURLINFO_APPCONNECT_TIME_T, &tls);
+  curl_easy_getinfo(handle, CURLINFO_PRETRANSFER_TIME_T, &sent);
+  curl_easy_getinfo(handle, CURLINFO_STARTTRANSFER_TIME_T, &first_byte);
+  curl_easy_getinfo(handle, CURLINFO_TOTAL_TIME_T, &total);
+  curl_easy_getinfo(handle, CURLINFO_RESPONSE_CODE, &metrics.status);
+  curl_easy_getinfo(handle, CURLINFO_EFFECTIVE_METHOD, &metrics.method);
+  curl_easy_getinfo(handle, CURLINFO_EFFECTIVE_URL, &metrics.uri);
+
+  metrics.failed = ret != CURLE_OK;
+  metrics.reused = !new_connections;
+  metrics.dns = microseconds{dns};
+  metrics.connect = microseconds{max<curl_off_t>(connect - dns, 0)};
+  metrics.tls = microseconds{tls ? max<curl_off_t>(tls - connect, 0) : 0};
+  metrics.first_byte = microseconds{
+      first_byte ? max<curl_off_t>(first_byte - sent, 0) : 0};
+  metrics.total = microseconds{total};
+  metrics.bytes_in = header_size + download_size;
+  metrics.bytes_out = request_size + upload_size;
+
+  if (transfer->limiter) {
+    /* the aborted transfers (callback errors, cancellations, shutdown) and
+     * the ones cut by the call deadline don't tell anything about the server
+     * load. */
+    auto outcome = ConcurrencyLimiter::Outcome::kSuccess;
+
+    if (transfer->error || ret == CURLE_ABORTED_BY_CALLBACK ||
+        (ret == CURLE_OPERATION_TIMEDOUT && transfer->bounded)) {
+      outcome = ConcurrencyLimiter::Outcome::kIgnored;
+    } else if (ret != CURLE_OK || HttpError::Retryable(metrics.status)) {
+      outcome = ConcurrencyLimiter::Outcome::kDropped;
+    }
+
+    /* the server's latency: the connection setup of a new connection, or
+     * the TLS handshake, isn't a sign of overload. */
+    auto latency = metrics.first_byte.count() ? metrics.first_byte
+                                              : metrics.total;
+
+    transfer->limiter->Release(
+        outcome, latency,
+        metrics.uri ? RetryScheduler::Host(metrics.uri) : string{});
+    transfer->limiter = nullptr;
+  }
+}
+
+void CurlWrapper::Report(const CurlTransfer* transfer) const {
+  if (!kOptions_.metrics) {
+    return;
+  }
+
+  auto metrics = transfer->metrics;
+  auto limiter = limiter_.Stats();
+
+  metrics.limit = limiter.limit;
+  metrics.queued = limiter.queued;
+  metrics.shed = limiter.shed;
+
+  /* a failing sink must not fail the request. */
+  try {
+    kOptions_.metrics->OnRequest(metrics);
+  } catch (...) {
+  }
+}
+
+void CurlWrapper::Check(CURLcode ret, const CurlTransfer* transfer) const {
+  /* a failed chunk callback is reported instead of the aborted transfer. */
+  if (transfer->error) {
+    rethrow_exception(transfer->error);
+  }
+
+  if (ret == CURLE_ABORTED_BY_CALLBACK || ret == CURLE_OPERATION_TIMEDOUT) {
+    transfer->context.Check();
+  }
 
   if (ret != CURLE_OK) {
     throw runtime_error(
         "failed to establish the connection with remote server!");
   }
 
-  if (cf->payload) {
-    string errors; /* unused */
-    auto json_reader = builder_.newCharReader();
+  auto status = transfer->metrics.status;
 
-    bool parse_ok = json_reader->parse(cf->payload, cf->payload + cf->size,
-                                       &response, &errors);
+  if (HttpError::Retryable(status)) {
+    /* libcurl parses both forms of the header, seconds and http date. */
+    curl_off_t retry_after = 0;
 
-    free(cf->payload);
+    curl_easy_getinfo(transfer->lease.Get(), CURLINFO_RETRY_AFTER,
+                      &retry_after);
 
-    if (!parse_ok) {
-      throw runtime_error("failed to parse the response from server!");
-    }
+    throw HttpError{status, seconds{retry_after}};
   }
+}
+
+Value CurlWrapper::Parse(CURLcode ret, CurlTransfer* transfer) const {
+  Value response;
+
+  /* the report waits for the parsing, so that it's accounted as well. */
+  Measure(ret, transfer);
+
+  try {
+    Check(ret, transfer);
+
+    auto start = steady_clock::now();
+
+    response = Decode(transfer);
+    transfer->metrics.parse =
+        duration_cast<microseconds>(steady_clock::now() - start);
+  } catch (...) {
+    Report(transfer);
+    throw;
+  }
+
+  Report(transfer);
 
   return response;
 }
 
-Value CurlWrapper::Get(const string& uri,
-                       const vector<string>& req_headers) const {
+Value CurlWrapper::Decode(CurlTransfer* transfer) const {
   Value response;
-  struct curl_slist* headers = nullptr;
-  struct CurlFetch curl_fetch;
-  struct CurlFetch* cf = &curl_fetch;
+  auto& body = transfer->lease.Buffer();
+  long status = transfer->metrics.status;
 
-  for (auto& h : req_headers) {
-    headers = curl_slist_append(headers, h.c_str());
+  /* not modified, the cached response is still valid. */
+  if (!transfer->cache_key.empty() && status == 304 && transfer->cached) {
+    cache_hits_++;
+    return transfer->cached->value;
   }
 
-  curl_easy_setopt(curl_handle_, CURLOPT_CUSTOMREQUEST, "GET");
-  curl_easy_setopt(curl_handle_, CURLOPT_HTTPHEADER, headers);
+  string errors; /* unused */
+  unique_ptr<CharReader> json_reader{builder_.newCharReader()};
+
+  /* the parser reads straight from the handle's buffer, no copies. */
+  bool parse_ok = json_reader->parse(body.Data(), body.Data() + body.Size(),
+                                     &response, &errors);
 
-  auto ret = FetchUri(uri.c_str(), cf);
+  if (!parse_ok) {
+    throw runtime_error("failed to parse the response from server!");
+  }
 
-  curl_slist_free_all(headers);
+  if (!transfer->cache_key.empty() && status == 200 &&
+      (!transfer->etag.empty() || !transfer->last_modified.empty())) {
+    auto cached = make_shared<CachedResponse>(CachedResponse{
+        transfer->etag, transfer->last_modified, response, 0});
 
-  if (ret != CURLE_OK) {
-    throw runtime_error(
-        "failed to establish the connection with remote server!");
+    /* the parsed value takes several times the size of the body. */
+    cached->cost = ResponseCache::Cost(transfer->cache_key, *cached);
+    cache_->Store(transfer->cache_key, cached);
   }
 
-  if (cf->payload) {
-    string errors; /* unused */
-    auto json_reader = builder_.newCharReader();
+  return response;
+}
+
+void CurlWrapper::Submit(const string& host, const TransferFactory& prepare,
+                         const JsonCallback& callback, size_t attempt,
+                         RetryScheduler::Duration delay,
+                         bool idempotent) const {
+  shared_ptr<CurlTransfer> shared{prepare()};
+  auto context = CallContext::Current();
+
+  auto on_done = [this, shared, host, prepare, callback, attempt, idempotent,
+                  context](CURLcode ret) {
+    /* the retries and the callback run in the context of the call. */
+    CallScope scope{context};
+    Value reply;
+    exception_ptr error;
 
-    bool parse_ok = json_reader->parse(cf->payload, cf->payload + cf->size,
-                                       &response, &errors);
+    try {
+      reply = Parse(ret, shared.get());
+    } catch (const HttpError& e) {
+      error = current_exception();
 
-    free(cf->payload);
+      if (scheduler_.CanRetry(attempt) && (idempotent || e.Resendable()) &&
+          !(context.failover && e.Status() == 429)) {
+        auto delay = scheduler_.Retry(host, attempt, e.RetryAfter());
 
-    if (!parse_ok) {
-      throw runtime_error("failed to parse the response from server!");
+        /* the retry waits on the event thread, nothing blocks meanwhile. */
+        if (!context.Expires(delay)) {
+          try {
+            retries_++;
+            Submit(host, prepare, callback, attempt + 1, delay, idempotent);
+            return;
+          } catch (...) {
+            error = current_exception();
+          }
+        }
+      }
+    } catch (...) {
+      error = current_exception();
     }
+
+    callback(error, reply);
+  };
+
+  /* a request beyond the window waits in the limiter's queue, the slot is
+   * then granted from the thread finishing another request. */
+  bool admitted = limiter_.AcquireAsync([this, shared, on_done, delay] {
+    shared->limiter = &limiter_;
+    Bound(shared.get(), delay);
+    engine_.Submit(shared->lease.Get(), on_done, delay);
+  });
+
+  if (!admitted) {
+    callback(make_exception_ptr(runtime_error(
+                 "too many requests waiting for the remote server!")),
+             Value{});
   }
+}
 
-  return response;
+void CurlWrapper::Bound(CurlTransfer* transfer,
+                        RetryScheduler::Duration delay) const {
+  auto timeout = kOptions_.timeout;
+
+  /* the transfer is bounded by the deadline of its call as well. A deadline
+   * already reached by then still gets a timeout, zero would disable it. */
+  if (transfer->context.Expires(timeout + delay)) {
+    timeout = max(duration_cast<milliseconds>(transfer->context.deadline -
+                                              steady_clock::now() - delay) +
+                      milliseconds{1},
+                  milliseconds{1});
+    transfer->bounded = true;
+  }
+
+  curl_easy_setopt(transfer->lease.Get(), CURLOPT_TIMEOUT_MS,
+                   static_cast<long>(timeout.count()));
+}
+
+void CurlWrapper::Setup(CurlTransfer* transfer, const char* method,
+                        const string& uri, curl_slist* headers) const {
+  auto handle = transfer->lease.Get();
+  auto& configured = transfer->lease.Configured();
+
+  if (!configured) {
+    Configure(handle);
+    configured = true;
+  }
+
+  /* the call may have given up already, e.g. while waiting for a retry. */
+  transfer->context.Check();
+  Bound(transfer);
+
+  /* the progress callback is only needed to abort a cancelled call. */
+  curl_easy_setopt(handle, CURLOPT_NOPROGRESS,
+                   transfer->context.token ? 0L : 1L);
+  curl_easy_setopt(handle, CURLOPT_XFERINFODATA, (void*)transfer);
+  curl_easy_setopt(handle, CURLOPT_URL, uri.c_str());
+  curl_easy_setopt(handle, CURLOPT_HTTPHEADER, headers);
+  curl_easy_setopt(handle, CURLOPT_WRITEDATA, (void*)transfer);
+  curl_easy_setopt(handle, CURLOPT_HEADERDATA, (void*)transfer);
+
+  /* the handle may have sent a hedge, which asked for its own connection. */
+  curl_easy_setopt(handle, CURLOPT_FRESH_CONNECT, 0L);
+
+  /* the handle may come from a POST, the method is set either way. The
+   * custom method is only needed when it isn't implied by the data. */
+  if (transfer->data.empty()) {
+    curl_easy_setopt(handle, CURLOPT_HTTPGET, 1L);
+  } else {
+    curl_easy_setopt(handle, CURLOPT_POSTFIELDS, transfer->data.c_str());
+  }
+
+  bool implied = !strcmp(method, transfer->data.empty() ? "GET" : "POST");
+
+  curl_easy_setopt(handle, CURLOPT_CUSTOMREQUEST, implied ? nullptr : method);
 }
 
-CURLcode CurlWrapper::FetchUri(const string& uri,
-                               struct CurlFetch* fetch) const {
-  fetch->size = 0;
-  fetch->payload = (char*)calloc(1, sizeof(fetch->payload));
+void CurlWrapper::Configure(CURL* handle) const {
+  curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, CurlCallback);
+  curl_easy_setopt(handle, CURLOPT_HEADERFUNCTION, HeaderCallback);
+  curl_easy_setopt(handle, CURLOPT_USERAGENT, "libcurl-agent/1.0");
+  curl_easy_setopt(handle, CURLOPT_XFERINFOFUNCTION, ProgressCallback);
+  curl_easy_setopt(handle, CURLOPT_FOLLOWLOCATION, 1);
+  curl_easy_setopt(handle, CURLOPT_MAXREDIRS, 1);
+  curl_easy_setopt(handle, CURLOPT_TCP_KEEPALIVE, 1);
+  curl_easy_setopt(handle, CURLOPT_NOSIGNAL, 1);
 
-  if (!fetch->payload) {
-    return CURLE_FAILED_INIT;
+  if (kOptions_.compression) {
+    /* an empty list advertises every encoding libcurl was built with, the
+     * replies are then decompressed as they arrive. */
+    curl_easy_setopt(handle, CURLOPT_ACCEPT_ENCODING, "");
   }
 
-  curl_easy_setopt(curl_handle_, CURLOPT_URL, uri.c_str());
-  curl_easy_setopt(curl_handle_, CURLOPT_WRITEFUNCTION, CurlCallback);
-  curl_easy_setopt(curl_handle_, CURLOPT_WRITEDATA, (void*)fetch);
-  curl_easy_setopt(curl_handle_, CURLOPT_USERAGENT, "libcurl-agent/1.0");
-  curl_easy_setopt(curl_handle_, CURLOPT_TIMEOUT, 15);
-  curl_easy_setopt(curl_handle_, CURLOPT_FOLLOWLOCATION, 1);
-  curl_easy_setopt(curl_handle_, CURLOPT_MAXREDIRS, 1);
+  if (kOptions_.share) {
+    curl_easy_setopt(handle, CURLOPT_SHARE, kOptions_.share->Get());
+  }
 
-  return curl_easy_perform(curl_handle_);
+  if (!kOptions_.ca_info.empty()) {
+    curl_easy_setopt(handle, CURLOPT_CAINFO, kOptions_.ca_info.c_str());
+  }
+
+  if (kOptions_.http2) {
+    /* wait for a connection that is being set up to confirm multiplexing
+     * instead of opening a new one for each concurrent request. */
+    curl_easy_setopt(handle, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+    curl_easy_setopt(handle, CURLOPT_PIPEWAIT, 1L);
+  } else {
+    curl_easy_setopt(handle, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_1_1);
+  }
 }
 
 size_t CurlWrapper::CurlCallback(void* contents, size_t size, size_t nmemb,
                                  void* userp) {
   size_t realsize = size * nmemb;
-  struct CurlFetch* p = (struct CurlFetch*)userp;
+  auto transfer = static_cast<CurlTransfer*>(userp);
+
+  if (transfer->on_chunk) {
+    /* the body of a rejected reply isn't part of the stream. */
+    if (!transfer->body_bytes) {
+      long status = 0;
+
+      curl_easy_getinfo(transfer->lease.Get(), CURLINFO_RESPONSE_CODE, &status);
+      transfer->rejected = HttpError::Retryable(status);
+    }
+
+    transfer->body_bytes += realsize;
+
+    if (transfer->rejected) {
+      return realsize;
+    }
+
+    /* exceptions must not cross libcurl, returning a short count aborts the
+     * transfer and the error is rethrown once it finishes. */
+    try {
+      (*transfer->on_chunk)(static_cast<const char*>(contents), realsize);
+    } catch (...) {
+      transfer->error = current_exception();
+      return 0;
+    }
 
-  p->payload = (char*)realloc(p->payload, p->size + realsize + 1);
-  if (!p->payload) {
-    free(p->payload);
-    return 1;
+    return realsize;
   }
 
-  memcpy(&(p->payload[p->size]), contents, realsize);
+  transfer->body_bytes += realsize;
+
+  auto& body = transfer->lease.Buffer();
+
+  try {
+    /* on the first chunk, make room for the whole body at once (only a hint
+     * for compressed replies, whose length is the encoded one). The length
+     * comes from the server, so the hint is bounded by the capacity a buffer
+     * keeps; a larger body just grows the buffer as it arrives. */
+    if (!body.Size()) {
+      curl_off_t length = -1;
+
+      curl_easy_getinfo(transfer->lease.Get(),
+                        CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &length);
+
+      curl_off_t bound = ResponseBuffer::kMaxRetainedCapacity;
 
-  p->size += realsize;
-  p->payload[p->size] = 0;
+      if (length > 0) {
+        body.Reserve(static_cast<size_t>(std::min(length, bound)));
+      }
+    }
+
+    body.Append(static_cast<const char*>(contents), realsize);
+  } catch (...) {
+    transfer->error = current_exception();
+    return 0;
+  }
+
+  return realsize;
+}
+
+int CurlWrapper::ProgressCallback(void* clientp, curl_off_t /* dltotal */,
+                                  curl_off_t /* dlnow */,
+                                  curl_off_t /* ultotal */,
+                                  curl_off_t /* ulnow */) {
+  auto transfer = static_cast<CurlTransfer*>(clientp);
+
+  /* a non-zero value aborts the transfer. */
+  return transfer->context.Cancelled();
+}
+
+size_t CurlWrapper::HeaderCallback(char* buffer, size_t size, size_t nitems,
+                                   void* userp) {
+  size_t realsize = size * nitems;
+  auto transfer = static_cast<CurlTransfer*>(userp);
+
+  /* only the cached requests need the validators. */
+  if (transfer->cache_key.empty()) {
+    return realsize;
+  }
+
+  /* a new status line starts the headers of another response (redirects). */
+  if (realsize > 5 && !strncasecmp(buffer, "HTTP/", 5)) {
+    transfer->etag.clear();
+    transfer->last_modified.clear();
+  } else if (realsize > 5 && !strncasecmp(buffer, "ETag:", 5)) {
+    transfer->etag = HeaderValue(buffer + 5, realsize - 5);
+  } else if (realsize > 14 && !strncasecmp(buffer, "Last-Modified:", 14)) {
+    transfer->last_modified = HeaderValue(buffer + 14, realsize - 14);
+  }
 
   return realsize;
 }
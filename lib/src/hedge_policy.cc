@@ -0,0 +1,82 @@
+/**
+ * @file
+ *
+ * @brief Hedge policy class implementation.
+ */
+#include "private/hedge_policy.h"
+
+#include <algorithm>
+
+namespace spotify_lib {
+
+using std::lock_guard;
+using std::max;
+using std::mutex;
+using std::nth_element;
+using std::size_t;
+using std::vector;
+using std::chrono::duration_cast;
+using std::chrono::microseconds;
+
+constexpr size_t HedgePolicy::kWindow;
+
+HedgePolicy::HedgePolicy(const HedgeOptions& options)
+    : kOptions_{options},
+      next_{0},
+      requests_{0},
+      hedges_{0},
+      delay_{0} {
+  latencies_.reserve(kWindow);
+}
+
+microseconds HedgePolicy::Delay() const {
+  lock_guard<mutex> lock{mutex_};
+
+  return delay_;
+}
+
+void HedgePolicy::Record(microseconds latency) {
+  lock_guard<mutex> lock{mutex_};
+
+  requests_++;
+
+  if (latencies_.size() < kWindow) {
+    latencies_.push_back(latency);
+  } else {
+    latencies_[next_] = latency;
+    next_ = (next_ + 1) % kWindow;
+  }
+
+  if (latencies_.size() < kOptions_.samples) {
+    return;
+  }
+
+  /* recomputed on each sample, it's a few microseconds for the window. */
+  vector<microseconds> sorted{latencies_};
+  auto nth = sorted.begin() +
+             static_cast<size_t>(kOptions_.percentile / 100 * (sorted.size() - 1));
+
+  nth_element(sorted.begin(), nth, sorted.end());
+  delay_ = max(*nth, duration_cast<microseconds>(kOptions_.min_delay));
+}
+
+bool HedgePolicy::Spend() {
+  lock_guard<mutex> lock{mutex_};
+
+  /* one hedge is always allowed, so that a quiet client still hedges. */
+  if (hedges_ + 1 > kOptions_.budget * requests_ + 1) {
+    return false;
+  }
+
+  hedges_++;
+
+  return true;
+}
+
+size_t HedgePolicy::Hedges() const {
+  lock_guard<mutex> lock{mutex_};
+
+  return hedges_;
+}
+
+}  // namespace spotify_lib
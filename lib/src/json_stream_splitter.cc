@@ -0,0 +1,297 @@
+/**
+ * @file
+ *
+ * @brief Json stream splitter class implementation.
+ */
+#include "private/json_stream_splitter.h"
+
+namespace spotify_lib {
+
+using std::size_t;
+using std::string;
+using std::vector;
+
+JsonStreamSplitter::JsonStreamSplitter(const vector<string>& path,
+                                       const ElementCallback& on_element)
+    : kPath_{path},
+      on_element_{on_element},
+      chunk_{nullptr},
+      mark_{0},
+      target_depth_{0},
+      nesting_{0},
+      in_string_{false},
+      escape_{false},
+      hex_digits_{0},
+      code_{0},
+      high_surrogate_{0},
+      reading_key_{false},
+      expect_key_{false},
+      in_element_{false} {}
+
+void JsonStreamSplitter::Feed(const char* data, size_t size) {
+  chunk_ = data;
+  mark_ = 0;
+
+  for (size_t i = 0; i < size; i++) {
+    if (nesting_) {
+      i = SkipNested(i, size);
+
+      if (i == size) {
+        break;
+      }
+
+      Emit(i + 1, false);
+      continue;
+    }
+
+    if (in_string_ && !escape_ && !reading_key_) {
+      /* skip the plain bytes of a string value at once. */
+      while (i < size && data[i] != '"' && data[i] != '\\') {
+        i++;
+      }
+
+      if (i == size) {
+        break;
+      }
+    }
+
+    Consume(i);
+  }
+
+  /* keep the start of an element which continues in the next chunk. */
+  if (in_element_) {
+    element_.append(data + mark_, size - mark_);
+  }
+}
+
+size_t JsonStreamSplitter::SkipNested(size_t pos, size_t size) {
+  /* work on local copies, the stores into the members would otherwise force
+   * the chunk bytes to be reloaded (char pointers alias everything). */
+  const char* data = chunk_;
+  size_t nesting = nesting_;
+  bool in_string = in_string_;
+  bool escape = escape_;
+
+  for (; pos < size; pos++) {
+    char c = data[pos];
+
+    if (in_string) {
+      if (escape) {
+        escape = false;
+      } else if (c == '\\') {
+        escape = true;
+      } else if (c == '"') {
+        in_string = false;
+      }
+    } else if (c == '"') {
+      in_string = true;
+    } else if (c == '{' || c == '[') {
+      nesting++;
+    } else if ((c == '}' || c == ']') && !--nesting) {
+      break;
+    }
+  }
+
+  nesting_ = nesting;
+  in_string_ = in_string;
+  escape_ = escape;
+
+  return pos;
+}
+
+void JsonStreamSplitter::Consume(size_t pos) {
+  char c = chunk_[pos];
+
+  if (in_string_) {
+    /* the member names are compared with the path once decoded, the escapes
+     * of the values are only stepped over. */
+    if (hex_digits_ || escape_) {
+      escape_ = false;
+
+      if (reading_key_) {
+        Unescape(c);
+      }
+    } else if (c == '\\') {
+      escape_ = true;
+    } else if (c == '"') {
+      in_string_ = false;
+
+      if (reading_key_) {
+        stack_.back().key = key_;
+        reading_key_ = false;
+      }
+    } else if (reading_key_) {
+      key_.push_back(c);
+    }
+
+    return;
+  }
+
+  if (c == ' ' || c == '\n' || c == '\r' || c == '\t') {
+    return;
+  }
+
+  if (target_depth_ && stack_.size() == target_depth_) {
+    if (!in_element_ && c != ',' && c != ']') {
+      in_element_ = true;
+      mark_ = pos;
+
+      /* the content of an object or array element is only skipped over. */
+      if (c == '{' || c == '[') {
+        nesting_ = 1;
+        return;
+      }
+    } else if (in_element_ && (c == ',' || c == ']')) {
+      /* end of a scalar element, the separator isn't part of it. */
+      Emit(pos, true);
+    }
+  }
+
+  switch (c) {
+    case '"':
+      in_string_ = true;
+
+      if (!stack_.empty() && stack_.back().object && expect_key_) {
+        reading_key_ = true;
+        expect_key_ = false;
+        key_.clear();
+      }
+      break;
+    case '{':
+      stack_.push_back(Frame{true, ""});
+      expect_key_ = true;
+      break;
+    case '[':
+      stack_.push_back(Frame{false, ""});
+
+      if (!target_depth_ && PathMatches()) {
+        target_depth_ = stack_.size();
+      }
+      break;
+    case '}':
+    case ']':
+      if (target_depth_ == stack_.size()) {
+        target_depth_ = 0;
+      }
+
+      if (!stack_.empty()) {
+        stack_.pop_back();
+      }
+      break;
+    case ',':
+      if (!stack_.empty() && stack_.back().object) {
+        expect_key_ = true;
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+void JsonStreamSplitter::Unescape(char c) {
+  if (hex_digits_) {
+    char32_t digit = c >= '0' && c <= '9'   ? c - '0'
+                     : c >= 'a' && c <= 'f' ? c - 'a' + 10
+                     : c >= 'A' && c <= 'F' ? c - 'A' + 10
+                                            : 0;
+
+    code_ = code_ << 4 | digit;
+
+    if (--hex_digits_) {
+      return;
+    }
+
+    /* the characters beyond the basic plane come as a surrogate pair. */
+    if (code_ >= 0xD800 && code_ < 0xDC00) {
+      high_surrogate_ = code_;
+    } else if (code_ >= 0xDC00 && code_ < 0xE000 && high_surrogate_) {
+      AppendUtf8(0x10000 + ((high_surrogate_ - 0xD800) << 10) +
+                 (code_ - 0xDC00));
+      high_surrogate_ = 0;
+    } else {
+      AppendUtf8(code_);
+      high_surrogate_ = 0;
+    }
+
+    return;
+  }
+
+  switch (c) {
+    case 'b':
+      key_.push_back('\b');
+      break;
+    case 'f':
+      key_.push_back('\f');
+      break;
+    case 'n':
+      key_.push_back('\n');
+      break;
+    case 'r':
+      key_.push_back('\r');
+      break;
+    case 't':
+      key_.push_back('\t');
+      break;
+    case 'u':
+      hex_digits_ = 4;
+      code_ = 0;
+      break;
+    default:
+      /* '"', '\\' and '/' stand for themselves. */
+      key_.push_back(c);
+      break;
+  }
+}
+
+void JsonStreamSplitter::AppendUtf8(char32_t code) {
+  if (code < 0x80) {
+    key_.push_back(static_cast<char>(code));
+  } else if (code < 0x800) {
+    key_.push_back(static_cast<char>(0xC0 | code >> 6));
+    key_.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+  } else if (code < 0x10000) {
+    key_.push_back(static_cast<char>(0xE0 | code >> 12));
+    key_.push_back(static_cast<char>(0x80 | (code >> 6 & 0x3F)));
+    key_.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+  } else {
+    key_.push_back(static_cast<char>(0xF0 | code >> 18));
+    key_.push_back(static_cast<char>(0x80 | (code >> 12 & 0x3F)));
+    key_.push_back(static_cast<char>(0x80 | (code >> 6 & 0x3F)));
+    key_.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+  }
+}
+
+bool JsonStreamSplitter::PathMatches() const {
+  if (stack_.size() != kPath_.size() + 1) {
+    return false;
+  }
+
+  for (size_t i = 0; i < kPath_.size(); i++) {
+    if (!stack_[i].object || stack_[i].key != kPath_[i]) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+void JsonStreamSplitter::Emit(size_t end, bool trim) {
+  in_element_ = false;
+
+  /* an element received within a single chunk is handed out in place. */
+  if (element_.empty() && !trim) {
+    on_element_(chunk_ + mark_, end - mark_);
+    return;
+  }
+
+  element_.append(chunk_ + mark_, end - mark_);
+
+  if (trim) {
+    element_.erase(element_.find_last_not_of(" \n\r\t") + 1);
+  }
+
+  on_element_(element_.data(), element_.size());
+  element_.clear();
+}
+
+}  // namespace spotify_lib
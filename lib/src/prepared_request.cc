@@ -0,0 +1,95 @@
+/**
+ * @file
+ *
+ * @brief Prepared request class implementation.
+ */
+#include "private/prepared_request.h"
+
+#include <algorithm>
+
+#include "private/retry_scheduler.h"
+
+namespace spotify_lib {
+
+using std::replace;
+using std::size_t;
+using std::string;
+using std::vector;
+
+namespace {
+
+/**
+ * @brief Placeholder of the templates.
+ */
+const char kPlaceholder[] = "{}";
+
+}  // namespace
+
+PreparedRequest::PreparedRequest(const string& uri_template,
+                                 const vector<string>& header_templates)
+    : kUri_{Split(uri_template)},
+      kHeaders_{[&header_templates] {
+        vector<Template> headers;
+
+        for (auto& h : header_templates) {
+          headers.push_back(Split(h));
+        }
+
+        return headers;
+      }()},
+      kHost_{RetryScheduler::Host(uri_template)},
+      headers_(header_templates.size()),
+      nodes_(header_templates.size()) {
+  /* the list is linked once, only the data pointers change afterwards. */
+  for (size_t i = 0; i + 1 < nodes_.size(); i++) {
+    nodes_[i].next = &nodes_[i + 1];
+  }
+
+  if (!nodes_.empty()) {
+    nodes_.back().next = nullptr;
+  }
+
+  Bind("", "");
+}
+
+void PreparedRequest::Bind(const string& query, const string& token) {
+  /* assign and append reuse the storage of the previous call. */
+  uri_.assign(kUri_.prefix);
+
+  if (kUri_.bound) {
+    auto begin = uri_.size();
+
+    uri_.append(query);
+    replace(uri_.begin() + begin, uri_.end(), ' ', '+');
+    uri_.append(kUri_.suffix);
+  }
+
+  key_.assign(uri_);
+
+  for (size_t i = 0; i < kHeaders_.size(); i++) {
+    auto& header = headers_[i];
+
+    header.assign(kHeaders_[i].prefix);
+
+    if (kHeaders_[i].bound) {
+      header.append(token);
+      header.append(kHeaders_[i].suffix);
+    }
+
+    nodes_[i].data = &header[0];
+    key_.push_back('\n');
+    key_.append(header);
+  }
+}
+
+PreparedRequest::Template PreparedRequest::Split(const string& text) {
+  auto pos = text.find(kPlaceholder);
+
+  if (pos == string::npos) {
+    return Template{text, "", false};
+  }
+
+  return Template{text.substr(0, pos), text.substr(pos + 2), true};
+}
+
+}  // namespace spotify_lib
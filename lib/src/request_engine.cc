@@ -0,0 +1,360 @@
+/**
+ * @file
+ *
+ * @brief Asynchronous request engine class implementation.
+ */
+#include "private/request_engine.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace spotify_lib {
+
+using std::call_once;
+using std::lock_guard;
+using std::max;
+using std::min;
+using std::mutex;
+using std::runtime_error;
+using std::shared_ptr;
+using std::thread;
+using std::vector;
+using std::chrono::duration_cast;
+using std::chrono::milliseconds;
+
+RequestEngine::RequestEngine(long max_concurrent_streams,
+                             const shared_ptr<EventLoop>& loop)
+    : multi_{curl_multi_init()},
+      loop_{loop},
+      timeout_{Clock::time_point::max()},
+      armed_{Clock::time_point::max()},
+      next_ticket_{1},
+      stop_{false},
+      in_flight_{0} {
+  if (!multi_) {
+    throw runtime_error("failed to start the request engine!");
+  }
+
+  if (max_concurrent_streams > 0) {
+    curl_multi_setopt(multi_, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+    curl_multi_setopt(multi_, CURLMOPT_MAX_CONCURRENT_STREAMS,
+                      max_concurrent_streams);
+  } else {
+    curl_multi_setopt(multi_, CURLMOPT_PIPELINING, CURLPIPE_NOTHING);
+  }
+
+  if (loop_) {
+    curl_multi_setopt(multi_, CURLMOPT_SOCKETFUNCTION, SocketCallback);
+    curl_multi_setopt(multi_, CURLMOPT_SOCKETDATA, this);
+    curl_multi_setopt(multi_, CURLMOPT_TIMERFUNCTION, TimerCallback);
+    curl_multi_setopt(multi_, CURLMOPT_TIMERDATA, this);
+  }
+}
+
+RequestEngine::~RequestEngine() {
+  stop_ = true;
+
+  if (thread_.joinable()) {
+    curl_multi_wakeup(multi_);
+    thread_.join();
+  }
+
+  /* the event thread shuts down on its own, the loop doesn't. */
+  if (loop_) {
+    Shutdown();
+  }
+
+  curl_multi_cleanup(multi_);
+
+  if (loop_) {
+    loop_->Detach(*this);
+  }
+}
+
+RequestEngine::Ticket RequestEngine::Submit(CURL* handle,
+                                            const Completion& on_done,
+                                            Clock::duration delay) {
+  auto ticket = next_ticket_++;
+
+  /* a transfer submitted while shutting down, e.g. from a completion, would
+   * never run. */
+  if (stop_) {
+    on_done(CURLE_ABORTED_BY_CALLBACK);
+    return ticket;
+  }
+
+  if (!loop_) {
+    call_once(started_,
+              [this] { thread_ = thread{&RequestEngine::Run, this}; });
+  }
+
+  in_flight_++;
+
+  {
+    lock_guard<mutex> lock{mutex_};
+
+    pending_.push_back(Pending{ticket, handle, on_done, Clock::now() + delay});
+  }
+
+  Wake();
+
+  return ticket;
+}
+
+void RequestEngine::Cancel(Ticket ticket) {
+  {
+    lock_guard<mutex> lock{mutex_};
+
+    cancelled_.push_back(ticket);
+  }
+
+  Wake();
+}
+
+void RequestEngine::OnSocket(int fd, int events) {
+  int mask = 0;
+  int running = 0;
+
+  if (events & EventLoop::kRead) {
+    mask |= CURL_CSELECT_IN;
+  }
+
+  if (events & EventLoop::kWrite) {
+    mask |= CURL_CSELECT_OUT;
+  }
+
+  if (events & EventLoop::kError) {
+    mask |= CURL_CSELECT_ERR;
+  }
+
+  curl_multi_socket_action(multi_, fd, mask, &running);
+  Complete();
+  Arm();
+}
+
+void RequestEngine::OnTimeout() {
+  int running = 0;
+
+  /* a wake up leaves the libcurl timeout armed until it's due. */
+  if (timeout_ <= Clock::now()) {
+    timeout_ = Clock::time_point::max();
+  }
+
+  AddPending();
+  curl_multi_socket_action(multi_, CURL_SOCKET_TIMEOUT, 0, &running);
+  Complete();
+  Arm();
+}
+
+void RequestEngine::Wake() {
+  if (loop_) {
+    loop_->Wake(*this);
+  } else {
+    curl_multi_wakeup(multi_);
+  }
+}
+
+void RequestEngine::Arm() {
+  auto due = timeout_;
+
+  if (!delayed_.empty()) {
+    due = min(due, delayed_.begin()->first);
+  }
+
+  if (due == armed_) {
+    return;
+  }
+
+  armed_ = due;
+
+  if (due == Clock::time_point::max()) {
+    loop_->SetTimer(*this, milliseconds{-1});
+    return;
+  }
+
+  /* round up, waking up early would only spin until the timeout is due. */
+  auto wait = duration_cast<milliseconds>(due - Clock::now());
+
+  loop_->SetTimer(*this, max(wait + milliseconds{1}, milliseconds{0}));
+}
+
+void RequestEngine::Run() {
+  int running = 0;
+
+  while (!stop_) {
+    int timeout = AddPending();
+
+    curl_multi_perform(multi_, &running);
+    Complete();
+
+    curl_multi_poll(multi_, nullptr, 0, timeout, nullptr);
+  }
+
+  Shutdown();
+}
+
+void RequestEngine::Shutdown() {
+  /* abort whatever is still queued, delayed or running. */
+  AddPending();
+
+  for (auto& d : delayed_) {
+    in_flight_--;
+    d.second.on_done(CURLE_ABORTED_BY_CALLBACK);
+  }
+
+  delayed_.clear();
+
+  for (auto& t : running_) {
+    curl_multi_remove_handle(multi_, t.first);
+    in_flight_--;
+    t.second.on_done(CURLE_ABORTED_BY_CALLBACK);
+  }
+
+  running_.clear();
+}
+
+int RequestEngine::AddPending() {
+  vector<Pending> pending;
+  vector<Ticket> cancelled;
+  auto now = Clock::now();
+
+  /* taken together, a transfer cancelled right after being submitted is
+   * found in the multi handle. The cancellations go by ticket: a handle
+   * whose transfer completed meanwhile may already carry another one. */
+  {
+    lock_guard<mutex> lock{mutex_};
+
+    pending.swap(pending_);
+    cancelled.swap(cancelled_);
+  }
+
+  for (auto& p : pending) {
+    if (p.start > now) {
+      delayed_.emplace(p.start, std::move(p));
+    } else {
+      Start(p.ticket, p.handle, std::move(p.on_done));
+    }
+  }
+
+  CancelRequested(cancelled);
+
+  while (!delayed_.empty() && delayed_.begin()->first <= now) {
+    auto due = delayed_.begin();
+
+    Start(due->second.ticket, due->second.handle,
+          std::move(due->second.on_done));
+    delayed_.erase(due);
+  }
+
+  if (delayed_.empty()) {
+    return 1000;
+  }
+
+  /* round up, waking up early would only spin until the transfer is due. */
+  auto wait = duration_cast<milliseconds>(delayed_.begin()->first - now);
+
+  return static_cast<int>(min<milliseconds::rep>(wait.count() + 1, 1000));
+}
+
+void RequestEngine::CancelRequested(const vector<Ticket>& cancelled) {
+  /* the cancellations are rare (hedges which lost), a scan will do. */
+  for (auto ticket : cancelled) {
+    Completion on_done;
+    auto it = std::find_if(running_.begin(), running_.end(),
+                           [ticket](const std::pair<CURL* const, Running>& t) {
+                             return t.second.ticket == ticket;
+                           });
+
+    if (it != running_.end()) {
+      curl_multi_remove_handle(multi_, it->first);
+      on_done = std::move(it->second.on_done);
+      running_.erase(it);
+    } else {
+      /* still waiting for its delay, or already completed. */
+      for (auto d = delayed_.begin(); d != delayed_.end(); ++d) {
+        if (d->second.ticket == ticket) {
+          on_done = std::move(d->second.on_done);
+          delayed_.erase(d);
+          break;
+        }
+      }
+    }
+
+    if (on_done) {
+      in_flight_--;
+      on_done(CURLE_ABORTED_BY_CALLBACK);
+    }
+  }
+}
+
+void RequestEngine::Start(Ticket ticket, CURL* handle, Completion on_done) {
+  auto ret = curl_multi_add_handle(multi_, handle);
+
+  if (ret != CURLM_OK) {
+    in_flight_--;
+    on_done(CURLE_FAILED_INIT);
+    return;
+  }
+
+  running_.emplace(handle, Running{ticket, std::move(on_done)});
+}
+
+void RequestEngine::Complete() {
+  CURLMsg* msg = nullptr;
+  int queued = 0;
+
+  while ((msg = curl_multi_info_read(multi_, &queued))) {
+    if (msg->msg != CURLMSG_DONE) {
+      continue;
+    }
+
+    auto handle = msg->easy_handle;
+    auto result = msg->data.result;
+    auto it = running_.find(handle);
+
+    curl_multi_remove_handle(multi_, handle);
+
+    if (it == running_.end()) {
+      continue;
+    }
+
+    auto on_done = std::move(it->second.on_done);
+
+    running_.erase(it);
+    in_flight_--;
+    on_done(result);
+  }
+}
+
+int RequestEngine::SocketCallback(CURL* /* handle */, curl_socket_t fd,
+                                  int what, void* userp,
+                                  void* /* socketp */) {
+  auto engine = static_cast<RequestEngine*>(userp);
+  int events = EventLoop::kNone;
+
+  if (what == CURL_POLL_IN || what == CURL_POLL_INOUT) {
+    events |= EventLoop::kRead;
+  }
+
+  if (what == CURL_POLL_OUT || what == CURL_POLL_INOUT) {
+    events |= EventLoop::kWrite;
+  }
+
+  engine->loop_->Watch(*engine, fd, events);
+
+  return 0;
+}
+
+int RequestEngine::TimerCallback(CURLM* /* multi */, long timeout_ms,
+                                 void* userp) {
+  auto engine = static_cast<RequestEngine*>(userp);
+
+  /* the loop's timer is armed once the engine is done with libcurl. */
+  engine->timeout_ = timeout_ms < 0
+                         ? Clock::time_point::max()
+                         : Clock::now() + milliseconds{timeout_ms};
+
+  return 0;
+}
+
+}  // namespace spotify_lib
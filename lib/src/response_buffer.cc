@@ -0,0 +1,33 @@
+/**
+ * @file
+ *
+ * @brief Response buffer class implementation.
+ */
+#include "private/response_buffer.h"
+
+namespace spotify_lib {
+
+using std::size_t;
+using std::vector;
+
+constexpr size_t ResponseBuffer::kMaxRetainedCapacity;
+
+void ResponseBuffer::Reserve(size_t size) {
+  if (size > data_.capacity()) {
+    data_.reserve(size);
+  }
+}
+
+void ResponseBuffer::Append(const char* data, size_t size) {
+  data_.insert(data_.end(), data, data + size);
+}
+
+void ResponseBuffer::Reset() {
+  if (data_.capacity() > kMaxRetainedCapacity) {
+    vector<char>{}.swap(data_);
+  } else {
+    data_.clear();
+  }
+}
+
+}  // namespace spotify_lib
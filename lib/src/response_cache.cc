@@ -0,0 +1,127 @@
+/**
+ * @file
+ *
+ * @brief Response cache class implementation.
+ */
+#include "private/response_cache.h"
+
+#include <iterator>
+
+namespace spotify_lib {
+
+using std::lock_guard;
+using std::mutex;
+using std::shared_ptr;
+using std::size_t;
+using std::string;
+
+namespace {
+
+/**
+ * @brief Overhead of a node of the maps holding the arrays and the objects:
+ * the tree links and color, and the key (index or name pointer and length).
+ */
+constexpr size_t kNodeBytes = 6 * sizeof(void*);
+
+/**
+ * @brief Estimate the memory held by a parsed value.
+ *
+ * @param value The value.
+ *
+ * @return Size in bytes.
+ */
+size_t Footprint(const Json::Value& value) {
+  size_t bytes = sizeof(Json::Value);
+  const char* begin = nullptr;
+  const char* end = nullptr;
+
+  switch (value.type()) {
+    case Json::stringValue:
+      /* the strings are allocated with their length ahead. */
+      if (value.getString(&begin, &end)) {
+        bytes += sizeof(unsigned) + static_cast<size_t>(end - begin) + 1;
+      }
+      break;
+    case Json::arrayValue:
+    case Json::objectValue:
+      for (auto it = value.begin(); it != value.end(); ++it) {
+        bytes += kNodeBytes + Footprint(*it);
+
+        /* the member names are copied into each node. */
+        if (value.isObject() && (begin = it.memberName(&end))) {
+          bytes += sizeof(unsigned) + static_cast<size_t>(end - begin) + 1;
+        }
+      }
+      break;
+    default:
+      break;
+  }
+
+  return bytes;
+}
+
+}  // namespace
+
+ResponseCache::ResponseCache(size_t max_bytes)
+    : kMaxBytes_{max_bytes}, bytes_{0} {}
+
+shared_ptr<const CachedResponse> ResponseCache::Find(const string& key) {
+  lock_guard<mutex> lock{mutex_};
+  auto it = index_.find(key);
+
+  if (it == index_.end()) {
+    return nullptr;
+  }
+
+  lru_.splice(lru_.begin(), lru_, it->second);
+
+  return it->second->second;
+}
+
+void ResponseCache::Store(const string& key,
+                          const shared_ptr<const CachedResponse>& response) {
+  lock_guard<mutex> lock{mutex_};
+  auto it = index_.find(key);
+
+  if (it != index_.end()) {
+    Remove(it->second);
+  }
+
+  if (response->cost > kMaxBytes_) {
+    return;
+  }
+
+  lru_.emplace_front(key, response);
+  index_[key] = lru_.begin();
+  bytes_ += response->cost;
+
+  while (bytes_ > kMaxBytes_) {
+    Remove(std::prev(lru_.end()));
+  }
+}
+
+size_t ResponseCache::Cost(const string& key, const CachedResponse& response) {
+  /* the key is held by the index and by the list. */
+  return sizeof(CachedResponse) + 2 * key.size() + response.etag.size() +
+         response.last_modified.size() + Footprint(response.value);
+}
+
+size_t ResponseCache::Bytes() const {
+  lock_guard<mutex> lock{mutex_};
+
+  return bytes_;
+}
+
+size_t ResponseCache::Count() const {
+  lock_guard<mutex> lock{mutex_};
+
+  return lru_.size();
+}
+
+void ResponseCache::Remove(Lru::iterator it) {
+  bytes_ -= it->second->cost;
+  index_.erase(it->first);
+  lru_.erase(it);
+}
+
+}  // namespace spotify_lib
@@ -0,0 +1,106 @@
+/**
+ * @file
+ *
+ * @brief Retry scheduler class implementation.
+ */
+#include "private/retry_scheduler.h"
+
+#include <algorithm>
+
+namespace spotify_lib {
+
+using std::lock_guard;
+using std::max;
+using std::min;
+using std::mutex;
+using std::random_device;
+using std::size_t;
+using std::string;
+using std::uniform_int_distribution;
+using std::chrono::duration;
+using std::chrono::duration_cast;
+using std::chrono::milliseconds;
+using std::chrono::seconds;
+using std::chrono::steady_clock;
+
+RetryScheduler::RetryScheduler(const RetryOptions& options)
+    : kOptions_{options}, random_{random_device{}()} {}
+
+RetryScheduler::Duration RetryScheduler::Admit(const string& host) {
+  lock_guard<mutex> lock{mutex_};
+
+  return Reserve(host, steady_clock::now());
+}
+
+RetryScheduler::Duration RetryScheduler::Retry(const string& host,
+                                               size_t attempt,
+                                               seconds retry_after) {
+  lock_guard<mutex> lock{mutex_};
+  auto now = steady_clock::now();
+  Duration delay = retry_after;
+
+  if (retry_after.count() > 0) {
+    /* the whole host is parked, the other requests to it wait as well. The
+     * delay comes from the server, it's bounded like the backoff so that a
+     * call without deadline doesn't block for hours. */
+    auto& state = hosts_[host];
+
+    delay = min<Duration>(retry_after, kOptions_.max_delay);
+    state.parked_until = max(state.parked_until, now + delay);
+  } else {
+    /* full jitter: anywhere between zero and the exponential bound. */
+    auto bound = min(kOptions_.max_delay,
+                     kOptions_.base_delay * (1L << min<size_t>(attempt, 20)));
+
+    delay = milliseconds{
+        uniform_int_distribution<milliseconds::rep>{0, bound.count()}(random_)};
+  }
+
+  return max(delay, Reserve(host, now));
+}
+
+string RetryScheduler::Host(const string& uri) {
+  auto begin = uri.find("://");
+
+  begin = begin == string::npos ? 0 : begin + 3;
+
+  auto end = uri.find_first_of("/?#", begin);
+
+  return uri.substr(begin, end == string::npos ? string::npos : end - begin);
+}
+
+RetryScheduler::Duration RetryScheduler::Reserve(const string& host,
+                                                 steady_clock::time_point now) {
+  auto it = hosts_.find(host);
+
+  if (it == hosts_.end()) {
+    it = hosts_.emplace(host, HostState{kOptions_.host_burst, now, {}}).first;
+  }
+
+  auto& state = it->second;
+  Duration wait = Duration::zero();
+
+  if (kOptions_.host_rate > 0) {
+    /* the tokens go negative when the requests are reserved ahead, each one
+     * waits for its share of the refill. */
+    double elapsed = duration<double>(now - state.refilled).count();
+
+    state.tokens = min(kOptions_.host_burst,
+                       state.tokens + elapsed * kOptions_.host_rate);
+    state.refilled = now;
+    state.tokens -= 1;
+
+    if (state.tokens < 0) {
+      wait = duration_cast<Duration>(
+          duration<double>{-state.tokens / kOptions_.host_rate});
+    }
+  }
+
+  if (state.parked_until > now) {
+    wait = max(wait, state.parked_until - now);
+  }
+
+  return wait;
+}
+
+}  // namespace spotify_lib
@@ -0,0 +1,61 @@
+/**
+ * @file
+ *
+ * @brief Search reply decoders implementation.
+ */
+#include "private/search_decoder.h"
+
+#include <memory>
+#include <stdexcept>
+
+namespace spotify_lib {
+
+using Json::CharReader;
+using Json::Value;
+using std::runtime_error;
+using std::size_t;
+using std::string;
+using std::unique_ptr;
+using std::vector;
+
+vector<MusicInfo> JsoncppSearchDecoder::Decode(const string& body) const {
+  return ToMusics(Parse(body.data(), body.size()));
+}
+
+MusicInfo JsoncppSearchDecoder::DecodeItem(const char* data,
+                                           size_t size) const {
+  return ToMusic(Parse(data, size));
+}
+
+vector<MusicInfo> JsoncppSearchDecoder::ToMusics(const Value& reply) {
+  vector<MusicInfo> ret;
+
+  for (auto& item : reply["tracks"]["items"]) {
+    ret.emplace_back(ToMusic(item));
+  }
+
+  return ret;
+}
+
+MusicInfo JsoncppSearchDecoder::ToMusic(const Value& item) {
+  MusicInfo info = {.name = item["name"].asString(),
+                    .artist = item["album"]["artists"][0]["name"].asString(),
+                    .uri = item["uri"].asString(),
+                    .duration = item["duration_ms"].asInt()};
+
+  return info;
+}
+
+Value JsoncppSearchDecoder::Parse(const char* data, size_t size) const {
+  Value doc;
+  string errors; /* unused */
+  unique_ptr<CharReader> json_reader{builder_.newCharReader()};
+
+  if (!json_reader->parse(data, data + size, &doc, &errors)) {
+    throw runtime_error("failed to parse the response from server!");
+  }
+
+  return doc;
+}
+
+}  // namespace spotify_lib
@@ -6,41 +6,337 @@
 #include "private/searcher.h"
 
 #include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <stdexcept>
+#include <utility>
 #include <vector>
 
+#include "private/json_stream_splitter.h"
+
 namespace spotify_lib {
 
+using Json::CharReader;
+using Json::CharReaderBuilder;
+using Json::Value;
+using std::current_exception;
+using std::condition_variable;
+using std::exception_ptr;
+using std::function;
+using std::lock_guard;
 using std::make_shared;
+using std::map;
+using std::max;
+using std::min;
+using std::mutex;
+using std::pair;
 using std::replace;
+using std::rethrow_exception;
+using std::runtime_error;
 using std::shared_ptr;
+using std::size_t;
 using std::string;
+using std::to_string;
+using std::unique_lock;
+using std::unique_ptr;
 using std::vector;
 
-Searcher::Searcher(const shared_ptr<CurlWrapper>& curl)
-    : kBaseUri_{"https://lib.spotify.com/v1/search?q="},
-      curl_{curl ? curl : make_shared<CurlWrapper>()} {}
+namespace {
+
+/**
+ * @brief Base uri for music searching, the same for every searcher.
+ */
+const char kSearchUri[] = "https://lib.spotify.com/v1/search?q=";
+
+/**
+ * @brief Largest page the search API serves.
+ */
+const size_t kMaxPageSize = 50;
+
+/**
+ * @brief Results the search API serves at most, the offsets past it are
+ * refused.
+ */
+const size_t kMaxResults = 1000;
+
+/**
+ * @brief This structure holds the outcome of a request of a pipeline.
+ */
+struct Outcome {
+  exception_ptr error;       //!< Failure, if any.
+  vector<MusicInfo> result;  //!< Musics found.
+};
+
+/**
+ * @brief This structure holds the requests of a pipeline completed on the
+ * event thread, until the caller reports them.
+ */
+struct PipelineState {
+  mutex lock;                        //!< Protects the state.
+  condition_variable received;       //!< Signaled on each completion.
+  map<size_t, Outcome> outcomes;     //!< Outcomes not reported, by index.
+  vector<size_t> arrivals;           //!< Their indexes, as received.
+};
+
+/**
+ * @brief Callback starting a request of a pipeline.
+ */
+using StartCallback =
+    function<void(size_t index, const SearchCallback& callback)>;
+
+/**
+ * @brief Callback reporting a request of a pipeline.
+ */
+using OutcomeCallback = function<void(size_t index, const Outcome& outcome)>;
+
+/**
+ * @brief Run requests without blocking, keeping a bound of them in flight:
+ * each completion starts the next one. They're started and reported on the
+ * calling thread.
+ *
+ * @param count Number of requests.
+ * @param max_in_flight Bound of the requests in flight.
+ * @param in_order Whether the requests are reported by index, or as they
+ * complete.
+ * @param stop_on_error Whether the first failure ends the run, being thrown,
+ * or is reported as the other outcomes.
+ * @param start Callback starting a request, in order.
+ * @param report Callback reporting a request.
+ */
+void RunPipelined(size_t count, size_t max_in_flight, bool in_order,
+                  bool stop_on_error, const StartCallback& start,
+                  const OutcomeCallback& report) {
+  auto state = make_shared<PipelineState>();
+  size_t next = 0;
+  size_t in_flight = 0;
+  size_t reported = 0;
+
+  while (reported < count) {
+    while (next < count && in_flight < max<size_t>(max_in_flight, 1)) {
+      size_t index = next++;
+      auto done = [state, index](exception_ptr error,
+                                 const vector<MusicInfo>& result) {
+        lock_guard<mutex> lock{state->lock};
+
+        state->outcomes.emplace(index, Outcome{error, result});
+        state->arrivals.push_back(index);
+        state->received.notify_one();
+      };
+
+      in_flight++;
+
+      /* the callback may run right away, so no lock is held meanwhile. */
+      try {
+        start(index, done);
+      } catch (...) {
+        done(current_exception(), {});
+      }
+    }
+
+    vector<pair<size_t, Outcome>> ready;
+
+    {
+      unique_lock<mutex> lock{state->lock};
+
+      state->received.wait(lock, [&state] { return !state->arrivals.empty(); });
+      in_flight -= state->arrivals.size();
+
+      /* the requests still in flight complete in the background. */
+      for (auto index : state->arrivals) {
+        auto& error = state->outcomes[index].error;
+
+        if (error && stop_on_error) {
+          rethrow_exception(error);
+        }
+      }
+
+      if (in_order) {
+        for (auto outcome = state->outcomes.find(reported + ready.size());
+             outcome != state->outcomes.end() &&
+             outcome->first == reported + ready.size();
+             outcome = state->outcomes.erase(outcome)) {
+          ready.emplace_back(outcome->first, std::move(outcome->second));
+        }
+      } else {
+        for (auto index : state->arrivals) {
+          auto outcome = state->outcomes.find(index);
+
+          ready.emplace_back(index, std::move(outcome->second));
+          state->outcomes.erase(outcome);
+        }
+      }
+
+      state->arrivals.clear();
+    }
+
+    for (auto& outcome : ready) {
+      report(outcome.first, outcome.second);
+      reported++;
+    }
+  }
+}
+
+}  // namespace
+
+Searcher::Searcher(const shared_ptr<CurlWrapper>& curl,
+                   const shared_ptr<SearchDecoder>& decoder)
+    : kBaseUri_{kSearchUri},
+      curl_{curl ? curl : make_shared<CurlWrapper>()},
+      decoder_{decoder} {}
 
 vector<MusicInfo> Searcher::Search(const string& token,
                                    const string& name) const {
-  vector<MusicInfo> ret;
-  string uri{kBaseUri_ + name + "&type=track&limit=10"};
+  /* one per thread, shared by the searchers since it's only built from
+   * constants; the query and the token are patched on each call. */
+  thread_local PreparedRequest request{
+      string{kSearchUri} + "{}&type=track&limit=10",
+      {"Authorization: Bearer {}"}};
+
+  request.Bind(name, token);
+
+  if (decoder_) {
+    return decoder_->Decode(curl_->GetRaw(request));
+  }
+
+  auto reply = curl_->Get(request);
+
+  return JsoncppSearchDecoder::ToMusics(reply);
+}
+
+void Searcher::SearchAsync(const string& token, const string& name,
+                           const SearchCallback& callback) const {
+  FetchAsync(BuildUri(name), {"Authorization: Bearer " + token}, callback);
+}
+
+void Searcher::SearchBatch(const vector<string>& names,
+                           const TokenSource& token, size_t max_in_flight,
+                           const QueryCallback& on_query) const {
+  RunPipelined(
+      names.size(), max_in_flight, false, false,
+      [&](size_t index, const SearchCallback& callback) {
+        SearchAsync(token(index), names[index], callback);
+      },
+      [&](size_t index, const Outcome& outcome) {
+        on_query(index, outcome.error, outcome.result);
+      });
+}
+
+void Searcher::FetchAsync(const string& uri, const vector<string>& req_headers,
+                          const SearchCallback& callback) const {
+  curl_->GetAsync(uri, req_headers,
+                  [callback](exception_ptr error, const Value& reply) {
+                    vector<MusicInfo> result;
+
+                    if (!error) {
+                      try {
+                        result = JsoncppSearchDecoder::ToMusics(reply);
+                      } catch (...) {
+                        error = current_exception();
+                      }
+                    }
+
+                    callback(error, result);
+                  });
+}
+
+vector<MusicInfo> Searcher::SearchPaged(const string& token,
+                                        const string& name,
+                                        const PagingOptions& paging,
+                                        const PageCallback& on_page) const {
   vector<string> req_headers{"Authorization: Bearer " + token};
+  size_t page_size = min(max<size_t>(paging.page_size, 1), kMaxPageSize);
 
-  replace(uri.begin(), uri.end(), ' ', '+');
+  /* the first page tells how many results there are. */
+  auto first = curl_->Get(BuildUri(name, page_size, 0), req_headers);
+  auto ret = JsoncppSearchDecoder::ToMusics(first);
+  size_t total = min<size_t>(first["tracks"]["total"].asUInt64(),
+                             min(paging.max_results, kMaxResults));
+
+  if (ret.size() > total) {
+    ret.resize(total);
+  }
+
+  on_page(0, ret);
+
+  size_t pages = total > page_size ? (total - 1) / page_size : 0;
+  map<size_t, vector<MusicInfo>> reported;
 
-  auto reply = curl_->Get(uri, req_headers);
+  /* the pages after the first one are requested at once. */
+  RunPipelined(
+      pages, paging.max_in_flight, paging.in_order, true,
+      [&](size_t index, const SearchCallback& callback) {
+        size_t offset = (index + 1) * page_size;
 
-  for (auto& item : reply["tracks"]["items"]) {
-    MusicInfo info = {.name = item["name"].asString(),
-                      .artist = item["album"]["artists"][0]["name"].asString(),
-                      .uri = item["uri"].asString(),
-                      .duration = item["duration_ms"].asInt()};
+        FetchAsync(BuildUri(name, min(page_size, total - offset), offset),
+                   req_headers, callback);
+      },
+      [&](size_t index, const Outcome& outcome) {
+        size_t offset = (index + 1) * page_size;
 
-    ret.emplace_back(info);
+        on_page(offset, outcome.result);
+        reported.emplace(offset, outcome.result);
+      });
+
+  for (auto& page : reported) {
+    ret.insert(ret.end(), page.second.begin(), page.second.end());
   }
 
   return ret;
 }
 
+void Searcher::Warmup(size_t connections) const {
+  curl_->Warmup({kBaseUri_}, connections);
+}
+
+vector<MusicInfo> Searcher::SearchStreaming(
+    const string& token, const string& name,
+    const MusicCallback& on_music) const {
+  vector<MusicInfo> ret;
+  vector<string> req_headers{"Authorization: Bearer " + token};
+  CharReaderBuilder builder;
+  unique_ptr<CharReader> json_reader{builder.newCharReader()};
+
+  /* only the entries are parsed, one at a time, while the transfer goes on. */
+  JsonStreamSplitter splitter{
+      {"tracks", "items"}, [&](const char* data, size_t size) {
+        if (decoder_) {
+          ret.emplace_back(decoder_->DecodeItem(data, size));
+        } else {
+          Value item;
+          string errors; /* unused */
+
+          if (!json_reader->parse(data, data + size, &item, &errors)) {
+            throw runtime_error("failed to parse the response from server!");
+          }
+
+          ret.emplace_back(JsoncppSearchDecoder::ToMusic(item));
+        }
+
+        on_music(ret.back());
+      }};
+
+  curl_->GetStream(BuildUri(name), req_headers,
+                   [&splitter](const char* data, size_t size) {
+                     splitter.Feed(data, size);
+                   });
+
+  return ret;
+}
+
+string Searcher::BuildUri(const string& name, size_t limit,
+                          size_t offset) const {
+  string uri{kBaseUri_ + name + "&type=track&limit=" + to_string(limit)};
+
+  if (offset > 0) {
+    uri += "&offset=" + to_string(offset);
+  }
+
+  replace(uri.begin(), uri.end(), ' ', '+');
+
+  return uri;
+}
+
 }  // namespace spotify_lib
@@ -0,0 +1,214 @@
+/**
+ * @file
+ *
+ * @brief Simdjson search reply decoder implementation.
+ */
+#include "private/simdjson_search_decoder.h"
+
+#include <cstdint>
+#include <stdexcept>
+
+#include <simdjson.h>
+
+namespace spotify_lib {
+
+using simdjson::error_code;
+using simdjson::padded_string_view;
+using simdjson::ondemand::array;
+using simdjson::ondemand::document;
+using simdjson::ondemand::object;
+using simdjson::ondemand::parser;
+using simdjson::ondemand::value;
+using std::int64_t;
+using std::runtime_error;
+using std::size_t;
+using std::string;
+using std::vector;
+
+namespace {
+
+/**
+ * @brief Throw the parsing error on a failure.
+ *
+ * @param error Simdjson's error code.
+ */
+void Check(error_code error) {
+  if (error) {
+    throw runtime_error("failed to parse the response from server!");
+  }
+}
+
+/**
+ * @brief Parse a json document, copying it when it lacks the padding.
+ *
+ * @param data Raw document.
+ * @param size Document size.
+ * @param capacity Readable bytes from the start of the document.
+ *
+ * @return The document, valid until the next parse on the same thread.
+ */
+document Iterate(const char* data, size_t size, size_t capacity) {
+  /* the parser and the copies are kept per thread, so their storage is
+   * reused between the replies. */
+  thread_local parser json_parser;
+  thread_local string padded;
+  document doc;
+
+  if (capacity < size + simdjson::SIMDJSON_PADDING) {
+    padded.reserve(size + simdjson::SIMDJSON_PADDING);
+    padded.assign(data, size);
+    data = padded.data();
+    capacity = padded.capacity();
+  }
+
+  Check(json_parser.iterate(padded_string_view{data, size, capacity}).get(doc));
+
+  return doc;
+}
+
+/**
+ * @brief Read a string value, leaving the output untouched on other types.
+ *
+ * @param val The value.
+ * @param out The output string.
+ */
+void ReadString(value val, string& out) {
+  std::string_view str;
+
+  if (!val.get_string().get(str)) {
+    out.assign(str.data(), str.size());
+  }
+}
+
+/**
+ * @brief Read the name of the first artist of an album.
+ *
+ * @param album The album object.
+ *
+ * @return The name of the artist.
+ */
+string ReadArtist(value album) {
+  string artist;
+  object album_obj;
+
+  if (album.get_object().get(album_obj)) {
+    return artist;
+  }
+
+  for (auto field : album_obj) {
+    std::string_view key;
+    array artists;
+
+    Check(field.unescaped_key().get(key));
+
+    if (key != "artists" || field.value().get_array().get(artists)) {
+      continue;
+    }
+
+    for (auto entry : artists) {
+      object artist_obj;
+
+      Check(entry.get_object().get(artist_obj));
+
+      for (auto artist_field : artist_obj) {
+        Check(artist_field.unescaped_key().get(key));
+
+        if (key == "name") {
+          ReadString(artist_field.value(), artist);
+        }
+      }
+
+      /* only the first artist is reported. */
+      break;
+    }
+  }
+
+  return artist;
+}
+
+/**
+ * @brief Read a music from an entry of a search reply.
+ *
+ * @param item The entry object.
+ *
+ * @return The music.
+ */
+MusicInfo ReadMusic(object item) {
+  MusicInfo info{"", "", "", 0};
+
+  for (auto field : item) {
+    std::string_view key;
+    value val;
+
+    Check(field.unescaped_key().get(key));
+    Check(field.value().get(val));
+
+    if (key == "name") {
+      ReadString(val, info.name);
+    } else if (key == "uri") {
+      ReadString(val, info.uri);
+    } else if (key == "album") {
+      info.artist = ReadArtist(val);
+    } else if (key == "duration_ms") {
+      int64_t duration;
+
+      if (!val.get_int64().get(duration)) {
+        info.duration = static_cast<int>(duration);
+      }
+    }
+  }
+
+  return info;
+}
+
+}  // namespace
+
+vector<MusicInfo> SimdjsonSearchDecoder::Decode(const string& body) const {
+  vector<MusicInfo> ret;
+  document doc = Iterate(body.data(), body.size(), body.capacity());
+  object root;
+
+  Check(doc.get_object().get(root));
+
+  for (auto field : root) {
+    std::string_view key;
+    object tracks;
+
+    Check(field.unescaped_key().get(key));
+
+    if (key != "tracks" || field.value().get_object().get(tracks)) {
+      continue;
+    }
+
+    for (auto tracks_field : tracks) {
+      array items;
+
+      Check(tracks_field.unescaped_key().get(key));
+
+      if (key != "items" || tracks_field.value().get_array().get(items)) {
+        continue;
+      }
+
+      for (auto item : items) {
+        object item_obj;
+
+        Check(item.get_object().get(item_obj));
+        ret.emplace_back(ReadMusic(item_obj));
+      }
+    }
+  }
+
+  return ret;
+}
+
+MusicInfo SimdjsonSearchDecoder::DecodeItem(const char* data,
+                                            size_t size) const {
+  document doc = Iterate(data, size, size);
+  object item;
+
+  Check(doc.get_object().get(item));
+
+  return ReadMusic(item);
+}
+
+}  // namespace spotify_lib
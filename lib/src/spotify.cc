@@ -12,40 +12,102 @@ namespace spotify_lib {
 using std::exception;
 using std::make_shared;
 using std::shared_ptr;
+using std::size_t;
 using std::string;
+using std::vector;
 
 Spotify::Spotify(const shared_ptr<Authenticator>& auth,
                  const shared_ptr<Searcher>& searcher,
-                 const shared_ptr<PlaylistMgr>& mgr)
-    : private_{make_shared<SpotifyPrivate>(auth, searcher, mgr)} {}
+                 const shared_ptr<PlaylistMgr>& mgr,
+                 const shared_ptr<CurlShare>& share,
+                 const shared_ptr<MetricsSink>& metrics,
+                 const shared_ptr<EventLoop>& loop)
+    : private_{make_shared<SpotifyPrivate>(auth, searcher, mgr, share,
+                                           metrics, loop)} {}
 
 void Spotify::Auth(AccessListener& listener, const string& client_id,
-               const string& client_secret) const {
-  private_->Auth(listener, client_id, client_secret);
+               const string& client_secret,
+               const CallOptions& options) const {
+  private_->Auth(listener, client_id, client_secret, options);
 }
 
 void Spotify::Search(SearchListener& listener, const string& token,
-                 const string& name) const {
-  private_->Search(listener, token, name);
+                 const string& name,
+                 const CallOptions& options) const {
+  private_->Search(listener, token, name, options);
 }
 
-void Spotify::CreatePlaylist(PlaylistListener& listener, const string& name) const {
-  private_->CreatePlaylist(listener, name);
+void Spotify::Search(SearchListener& listener, const string& name,
+                     const CallOptions& options) const {
+  private_->Search(listener, name, options);
+}
+
+void Spotify::SearchStreaming(SearchListener& listener, const string& token,
+                              const string& name,
+                              const CallOptions& options) const {
+  private_->SearchStreaming(listener, token, name, options);
+}
+
+void Spotify::SearchPaged(SearchListener& listener, const string& token,
+                          const string& name, const PagingOptions& paging,
+                          const CallOptions& options) const {
+  private_->SearchPaged(listener, token, name, paging, options);
+}
+
+void Spotify::SearchBatch(BatchSearchListener& listener, const string& token,
+                          const vector<string>& names, size_t max_in_flight,
+                          const CallOptions& options) const {
+  private_->SearchBatch(listener, token, names, max_in_flight, options);
+}
+
+void Spotify::SearchBatch(BatchSearchListener& listener,
+                          const vector<string>& names, size_t max_in_flight,
+                          const CallOptions& options) const {
+  private_->SearchBatch(listener, names, max_in_flight, options);
+}
+
+void Spotify::AuthAsync(AccessListener& listener, const string& client_id,
+                        const string& client_secret,
+                        const CallOptions& options) const {
+  private_->AuthAsync(listener, client_id, client_secret, options);
+}
+
+void Spotify::SearchAsync(SearchListener& listener, const string& token,
+                          const string& name,
+                          const CallOptions& options) const {
+  private_->SearchAsync(listener, token, name, options);
+}
+
+void Spotify::SearchAsync(SearchListener& listener, const string& name,
+                          const CallOptions& options) const {
+  private_->SearchAsync(listener, name, options);
+}
+
+void Spotify::Warmup(size_t connections) const {
+  private_->Warmup(connections);
+}
+
+void Spotify::CreatePlaylist(PlaylistListener& listener, const string& name,
+                             const CallOptions& options) const {
+  private_->CreatePlaylist(listener, name, options);
 }
 
 void Spotify::AddMusicToPlaylist(AddMusicPlaylistListener& listener,
                              const MusicInfo& music,
-                             const string& playlist) const {
-  private_->AddMusicToPlaylist(listener, music, playlist);
+                             const string& playlist,
+                             const CallOptions& options) const {
+  private_->AddMusicToPlaylist(listener, music, playlist, options);
 }
 
 void Spotify::ListPlaylistMusics(PlaylistListener& listener,
-                             const string& playlist_name) const {
-  private_->ListPlaylistMusics(listener, playlist_name);
+                             const string& playlist_name,
+                             const CallOptions& options) const {
+  private_->ListPlaylistMusics(listener, playlist_name, options);
 }
 
-void Spotify::GetPlaylists(PlaylistListener& listener) const {
-  private_->GetPlaylists(listener);
+void Spotify::GetPlaylists(PlaylistListener& listener,
+                           const CallOptions& options) const {
+  private_->GetPlaylists(listener, options);
 }
 
 }  // namespace spotify_lib
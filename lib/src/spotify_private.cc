@@ -5,88 +5,494 @@
  */
 #include "private/spotify_private.h"
 
+#include <chrono>
+#include <functional>
+
 #include "private/authenticator.h"
+#include "private/call_context.h"
+#include "private/curl_wrapper.h"
+#include "private/http_error.h"
 #include "private/playlist_mgr.h"
 #include "private/searcher.h"
 
 namespace spotify_lib {
 
 using std::exception;
+using std::exception_ptr;
+using std::function;
 using std::make_shared;
+using std::rethrow_exception;
 using std::shared_ptr;
+using std::size_t;
 using std::string;
+using std::vector;
+using std::chrono::duration_cast;
+using std::chrono::microseconds;
+using std::chrono::steady_clock;
+
+namespace {
+
+/**
+ * @brief This class times an operation for the metrics sink, from its
+ * creation to the first call to Stop.
+ */
+class OperationTimer {
+ public:
+  OperationTimer(const shared_ptr<MetricsSink>& sink, const char* operation)
+      : sink_{sink},
+        operation_{operation},
+        start_{steady_clock::now()},
+        stopped_{false} {}
+
+  /**
+   * @brief Report the operation, unless it was already.
+   *
+   * @param failed Whether the operation failed.
+   */
+  void Stop(bool failed) const {
+    if (!sink_ || stopped_) {
+      return;
+    }
+
+    stopped_ = true;
+
+    try {
+      sink_->OnOperation(
+          operation_,
+          duration_cast<microseconds>(steady_clock::now() - start_), failed);
+    } catch (...) {
+    }
+  }
+
+ private:
+  shared_ptr<MetricsSink> sink_;  //!< Metrics sink, may be null.
+  const char* operation_;         //!< Name of the operation.
+  steady_clock::time_point start_;  //!< Start of the operation.
+  mutable bool stopped_;          //!< Whether it was reported.
+};
+
+}  // namespace
 
 SpotifyPrivate::SpotifyPrivate(const shared_ptr<Authenticator>& auth,
                        const shared_ptr<Searcher>& searcher,
-                       const shared_ptr<PlaylistMgr>& mgr)
-    : auth_{auth ? auth : make_shared<Authenticator>()},
-      searcher_{searcher ? searcher : make_shared<Searcher>()},
-      playlist_mgr_{mgr ? mgr : make_shared<PlaylistMgr>()} {}
+                       const shared_ptr<PlaylistMgr>& mgr,
+                       const shared_ptr<CurlShare>& share,
+                       const shared_ptr<MetricsSink>& metrics,
+                       const shared_ptr<EventLoop>& loop)
+    : auth_{auth},
+      searcher_{searcher},
+      playlist_mgr_{mgr ? mgr : make_shared<PlaylistMgr>()},
+      metrics_{metrics} {
+  /* the default components use a single curl wrapper, so they share its
+   * pooled connections as well. */
+  if (!auth_ || !searcher_) {
+    CurlOptions options;
+
+    options.share = share;
+    options.metrics = metrics;
+    options.loop = loop;
+
+    auto curl = make_shared<CurlWrapper>(options);
+
+    if (!auth_) {
+      auth_ = make_shared<Authenticator>(curl);
+    }
+
+    if (!searcher_) {
+      searcher_ = make_shared<Searcher>(curl);
+    }
+  }
+}
 
 void SpotifyPrivate::Auth(AccessListener& listener, const string& client_id,
-                      const string& client_secret) const {
+                      const string& client_secret,
+                      const CallOptions& options) const {
+  CallScope scope{CallContext{"auth", options.deadline, options.token}};
+  OperationTimer timer{metrics_, "auth"};
+
   try {
     auto token = auth_->AuthUser(client_id, client_secret);
 
+    timer.Stop(false);
     listener.OnAccessGuaranteed(token);
   } catch (const exception& e) {
+    timer.Stop(true);
     listener.OnAccessDenied(e.what());
   }
 }
 
 void SpotifyPrivate::Search(SearchListener& listener, const string& token,
-                        const string& name) const {
+                        const string& name,
+                        const CallOptions& options) const {
+  CallScope scope{CallContext{"search", options.deadline, options.token}};
+  OperationTimer timer{metrics_, "search"};
+
   try {
     auto musics = searcher_->Search(token, name);
 
+    timer.Stop(false);
     listener.OnPatternFound(musics);
   } catch (const exception& e) {
+    timer.Stop(true);
     listener.OnSearchError(e.what());
   }
 }
 
+void SpotifyPrivate::Search(SearchListener& listener, const string& name,
+                            const CallOptions& options) const {
+  auto& pool = auth_->Pool();
+  size_t credential = 0;
+
+  if (!pool) {
+    string token;
+
+    if (CurrentToken(listener, name, &credential, options, &token)) {
+      Search(listener, token, name, options);
+    }
+
+    return;
+  }
+
+  CallContext context{"search", options.deadline, options.token};
+
+  /* a rate limited credential is parked, and the search tried again with
+   * another one rather than waiting for it. */
+  context.failover = true;
+
+  CallScope scope{context};
+  OperationTimer timer{metrics_, "search"};
+
+  for (size_t attempt = 1;; attempt++) {
+    string token;
+
+    if (!CurrentToken(listener, name, &credential, options, &token)) {
+      timer.Stop(true);
+      return;
+    }
+
+    try {
+      auto musics = searcher_->Search(token, name);
+
+      timer.Stop(false);
+      listener.OnPatternFound(musics);
+      return;
+    } catch (const HttpError& e) {
+      if (e.Status() == 429) {
+        pool->Park(credential, e.RetryAfter());
+
+        if (attempt < pool->Size()) {
+          continue;
+        }
+      }
+
+      timer.Stop(true);
+      listener.OnSearchError(e.what());
+      return;
+    } catch (const exception& e) {
+      timer.Stop(true);
+      listener.OnSearchError(e.what());
+      return;
+    }
+  }
+}
+
+void SpotifyPrivate::SearchStreaming(SearchListener& listener,
+                                     const string& token,
+                                     const string& name,
+                                     const CallOptions& options) const {
+  CallScope scope{CallContext{"search", options.deadline, options.token}};
+  OperationTimer timer{metrics_, "search"};
+
+  try {
+    auto musics = searcher_->SearchStreaming(
+        token, name,
+        [&listener](const MusicInfo& music) { listener.OnMusicFound(music); });
+
+    timer.Stop(false);
+    listener.OnPatternFound(musics);
+  } catch (const exception& e) {
+    timer.Stop(true);
+    listener.OnSearchError(e.what());
+  }
+}
+
+void SpotifyPrivate::SearchPaged(SearchListener& listener,
+                                 const string& token, const string& name,
+                                 const PagingOptions& paging,
+                                 const CallOptions& options) const {
+  CallScope scope{CallContext{"search", options.deadline, options.token}};
+  OperationTimer timer{metrics_, "search"};
+
+  try {
+    auto musics = searcher_->SearchPaged(
+        token, name, paging,
+        [&listener](size_t offset, const vector<MusicInfo>& page) {
+          listener.OnPageFound(offset, page);
+        });
+
+    timer.Stop(false);
+    listener.OnPatternFound(musics);
+  } catch (const exception& e) {
+    timer.Stop(true);
+    listener.OnSearchError(e.what());
+  }
+}
+
+void SpotifyPrivate::SearchBatch(BatchSearchListener& listener,
+                                 const string& token,
+                                 const vector<string>& names,
+                                 size_t max_in_flight,
+                                 const CallOptions& options) const {
+  RunBatch(listener, names, max_in_flight, options,
+           [&token](size_t) { return token; }, nullptr);
+}
+
+void SpotifyPrivate::SearchBatch(BatchSearchListener& listener,
+                                 const vector<string>& names,
+                                 size_t max_in_flight,
+                                 const CallOptions& options) const {
+  vector<size_t> credentials(names.size());
+
+  RunBatch(listener, names, max_in_flight, options,
+           [&](size_t index) {
+             /* only an expired token is requested on the caller's thread. */
+             CallScope scope{
+                 CallContext{"auth", options.deadline, options.token}};
+
+             return auth_->Token(names[index], &credentials[index]);
+           },
+           &credentials);
+}
+
+void SpotifyPrivate::AuthAsync(AccessListener& listener,
+                               const string& client_id,
+                               const string& client_secret,
+                               const CallOptions& options) const {
+  /* the requests carry the context over to the event thread. */
+  CallScope scope{CallContext{"auth", options.deadline, options.token}};
+  OperationTimer timer{metrics_, "auth"};
+
+  try {
+    auth_->AuthUserAsync(client_id, client_secret,
+                         [&listener, timer](exception_ptr error,
+                                            const string& token) {
+                           timer.Stop(error != nullptr);
+
+                           if (!error) {
+                             listener.OnAccessGuaranteed(token);
+                             return;
+                           }
+
+                           try {
+                             rethrow_exception(error);
+                           } catch (const exception& e) {
+                             listener.OnAccessDenied(e.what());
+                           }
+                         });
+  } catch (const exception& e) {
+    timer.Stop(true);
+    listener.OnAccessDenied(e.what());
+  }
+}
+
+void SpotifyPrivate::SearchAsync(SearchListener& listener, const string& token,
+                                 const string& name,
+                                 const CallOptions& options) const {
+  StartSearch(listener, token, name,
+              CallContext{"search", options.deadline, options.token}, 0);
+}
+
+void SpotifyPrivate::SearchAsync(SearchListener& listener, const string& name,
+                                 const CallOptions& options) const {
+  size_t credential = 0;
+  string token;
+
+  if (!CurrentToken(listener, name, &credential, options, &token)) {
+    return;
+  }
+
+  CallContext context{"search", options.deadline, options.token};
+
+  context.failover = auth_->Pool() != nullptr;
+  StartSearch(listener, token, name, context, credential);
+}
+
+void SpotifyPrivate::Warmup(size_t connections) const {
+  /* the default components share their handles, which get connected to
+   * both services. */
+  auth_->Warmup(connections);
+  searcher_->Warmup(connections);
+}
+
 void SpotifyPrivate::CreatePlaylist(PlaylistListener& listener,
-                                const string& name) const {
+                                const string& name,
+                                const CallOptions& options) const {
+  CallScope scope{CallContext{"playlist", options.deadline, options.token}};
+  OperationTimer timer{metrics_, "playlist"};
+
   try {
     playlist_mgr_->Create(name);
 
+    timer.Stop(false);
     listener.OnPlaylistCreated();
   } catch (const exception& e) {
+    timer.Stop(true);
     listener.OnPlaylistCreationError(e.what());
   }
 }
 
 void SpotifyPrivate::AddMusicToPlaylist(AddMusicPlaylistListener& listener,
                                     const MusicInfo& music,
-                                    const string& playlist) const {
+                                    const string& playlist,
+                                    const CallOptions& options) const {
+  CallScope scope{CallContext{"playlist", options.deadline, options.token}};
+  OperationTimer timer{metrics_, "playlist"};
+
   try {
     playlist_mgr_->AddMusic(music, playlist);
 
+    timer.Stop(false);
     listener.OnMusicAdded();
   } catch (const exception& e) {
+    timer.Stop(true);
     listener.OnMusicAdditionError(e.what());
   }
 }
 
 void SpotifyPrivate::ListPlaylistMusics(PlaylistListener& listener,
-                                    const string& playlist_name) const {
+                                    const string& playlist_name,
+                                    const CallOptions& options) const {
+  CallScope scope{CallContext{"playlist", options.deadline, options.token}};
+  OperationTimer timer{metrics_, "playlist"};
+
   try {
     auto musics = playlist_mgr_->ListMusics(playlist_name);
 
+    timer.Stop(false);
     listener.OnMusicList(musics);
   } catch (const exception& e) {
+    timer.Stop(true);
     listener.OnMusicListError(e.what());
   }
 }
 
-void SpotifyPrivate::GetPlaylists(PlaylistListener& listener) const {
+void SpotifyPrivate::GetPlaylists(PlaylistListener& listener,
+                                  const CallOptions& options) const {
+  CallScope scope{CallContext{"playlist", options.deadline, options.token}};
+  OperationTimer timer{metrics_, "playlist"};
+
   try {
     auto playlists = playlist_mgr_->GetPlaylists();
 
+    timer.Stop(false);
     listener.OnPlaylistsFound(playlists);
   } catch (const exception& e) {
+    timer.Stop(true);
     listener.OnPlaylistsFoundError(e.what());
   }
 }
 
+bool SpotifyPrivate::CurrentToken(SearchListener& listener, const string& name,
+                                  size_t* credential,
+                                  const CallOptions& options,
+                                  string* token) const {
+  /* only an expired token is requested on the caller's thread. */
+  CallScope scope{CallContext{"auth", options.deadline, options.token}};
+
+  try {
+    *token = auth_->Token(name, credential);
+
+    return true;
+  } catch (const exception& e) {
+    listener.OnSearchError(e.what());
+  }
+
+  return false;
+}
+
+void SpotifyPrivate::RunBatch(BatchSearchListener& listener,
+                              const vector<string>& names,
+                              size_t max_in_flight, const CallOptions& options,
+                              const function<string(size_t)>& token,
+                              const vector<size_t>* credentials) const {
+  CallContext context{"search", options.deadline, options.token};
+  auto pool = credentials ? auth_->Pool() : nullptr;
+  vector<OperationTimer> timers;
+
+  /* a rate limited credential is parked, the next queries going to the
+   * other ones rather than waiting for it. */
+  context.failover = pool != nullptr;
+  timers.reserve(names.size());
+
+  CallScope scope{context};
+
+  searcher_->SearchBatch(
+      names,
+      [&](size_t index) {
+        /* each query is timed from its request, the tokens taken in order. */
+        timers.emplace_back(metrics_, "search");
+
+        return token(index);
+      },
+      max_in_flight,
+      [&](size_t index, exception_ptr error, const vector<MusicInfo>& result) {
+        timers[index].Stop(error != nullptr);
+
+        if (!error) {
+          listener.OnQueryFound(index, result);
+          return;
+        }
+
+        try {
+          rethrow_exception(error);
+        } catch (const HttpError& e) {
+          if (pool && e.Status() == 429) {
+            pool->Park((*credentials)[index], e.RetryAfter());
+          }
+
+          listener.OnQueryError(index, e.what());
+        } catch (const exception& e) {
+          listener.OnQueryError(index, e.what());
+        }
+      });
+}
+
+void SpotifyPrivate::StartSearch(SearchListener& listener, const string& token,
+                                 const string& name, const CallContext& context,
+                                 size_t credential) const {
+  CallScope scope{context};
+  OperationTimer timer{metrics_, "search"};
+  auto pool = context.failover ? auth_->Pool() : nullptr;
+
+  try {
+    searcher_->SearchAsync(
+        token, name,
+        [&listener, timer, pool, credential](exception_ptr error,
+                                             const vector<MusicInfo>& musics) {
+          timer.Stop(error != nullptr);
+
+          if (!error) {
+            listener.OnPatternFound(musics);
+            return;
+          }
+
+          try {
+            rethrow_exception(error);
+          } catch (const HttpError& e) {
+            /* the next searches go to the other credentials. */
+            if (pool && e.Status() == 429) {
+              pool->Park(credential, e.RetryAfter());
+            }
+
+            listener.OnSearchError(e.what());
+          } catch (const exception& e) {
+            listener.OnSearchError(e.what());
+          }
+        });
+  } catch (const exception& e) {
+    timer.Stop(true);
+    listener.OnSearchError(e.what());
+  }
+}
+
 }  // namespace spotify_lib
@@ -0,0 +1,287 @@
+/**
+ * @file
+ *
+ * @brief TLS session store class implementation.
+ */
+#include "private/tls_session_store.h"
+
+#include <sys/file.h>
+#include <unistd.h>
+
+#include <ctime>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "private/utils.h"
+
+namespace spotify_lib {
+
+using std::condition_variable;
+using std::istringstream;
+using std::lock_guard;
+using std::mutex;
+using std::runtime_error;
+using std::size_t;
+using std::string;
+using std::thread;
+using std::time;
+using std::to_string;
+using std::unique_lock;
+using std::chrono::seconds;
+
+namespace {
+
+/**
+ * @brief Encode bytes in hexadecimal.
+ *
+ * @param bytes The bytes.
+ * @return The encoded bytes.
+ */
+string ToHex(const string& bytes) {
+  static const char kDigits[] = "0123456789abcdef";
+  string hex;
+
+  hex.reserve(bytes.size() * 2);
+
+  for (unsigned char byte : bytes) {
+    hex += kDigits[byte >> 4];
+    hex += kDigits[byte & 0x0f];
+  }
+
+  return hex;
+}
+
+/**
+ * @brief Decode hexadecimal bytes.
+ *
+ * @param hex The encoded bytes.
+ * @return The bytes, empty if the encoding is invalid.
+ */
+string FromHex(const string& hex) {
+  auto value = [](char digit) {
+    if (digit >= '0' && digit <= '9') return digit - '0';
+    if (digit >= 'a' && digit <= 'f') return digit - 'a' + 10;
+    return -1;
+  };
+  string bytes;
+
+  if (hex.size() % 2) {
+    return bytes;
+  }
+
+  for (size_t i = 0; i < hex.size(); i += 2) {
+    int high = value(hex[i]);
+    int low = value(hex[i + 1]);
+
+    if (high < 0 || low < 0) {
+      return "";
+    }
+
+    bytes += static_cast<char>((high << 4) | low);
+  }
+
+  return bytes;
+}
+
+/**
+ * @brief Get the bytes of a buffer given by libcurl.
+ *
+ * @param data The buffer.
+ * @param size Size of the buffer.
+ * @return The bytes.
+ */
+string Bytes(const unsigned char* data, size_t size) {
+  return string{reinterpret_cast<const char*>(data), size};
+}
+
+}  // namespace
+
+constexpr seconds TlsSessionStore::kSaveInterval_;
+
+TlsSessionStore::TlsSessionStore(const string& path, CURLSH* share)
+    : kPath_{path},
+      handle_{curl_easy_init()},
+      imported_{0},
+      stopped_{false} {
+  if (!handle_) {
+    throw runtime_error("failed to allocate a libcurl handle!");
+  }
+
+  Sessions probe;
+
+  curl_easy_setopt(handle_, CURLOPT_SHARE, share);
+
+  if (Export(&probe) == CURLE_NOT_BUILT_IN) {
+    curl_easy_cleanup(handle_);
+    throw runtime_error(
+        "the tls session store requires libcurl with the session export!");
+  }
+
+  int fd = utils::OpenPrivateFile(kPath_);
+
+  if (fd < 0) {
+    curl_easy_cleanup(handle_);
+    throw runtime_error("failed to open the tls session store!");
+  }
+
+  close(fd);
+
+  /* imported before any connection, libcurl offers them itself. A session
+   * libcurl doesn't take just costs its peer a full handshake. */
+  for (const auto& session : Read(kPath_)) {
+    auto shmac = session.first;
+    auto data = session.second.data;
+
+    if (curl_easy_ssls_import(
+            handle_, nullptr,
+            reinterpret_cast<const unsigned char*>(shmac.data()),
+            shmac.size(),
+            reinterpret_cast<const unsigned char*>(data.data()),
+            data.size()) == CURLE_OK) {
+      imported_++;
+    }
+  }
+
+  writer_ = thread{[this] { Run(); }};
+}
+
+TlsSessionStore::~TlsSessionStore() {
+  {
+    lock_guard<mutex> lock{mutex_};
+
+    stopped_ = true;
+  }
+
+  stop_.notify_one();
+  writer_.join();
+  curl_easy_cleanup(handle_);
+}
+
+TlsSessionStore::Sessions TlsSessionStore::Read(const string& path) {
+  Sessions sessions;
+  int fd = utils::OpenPrivateFile(path);
+
+  if (fd < 0) {
+    return sessions;
+  }
+
+  /* the file is replaced as a whole, it's read without the lock. */
+  istringstream lines{utils::ReadFile(fd)};
+  string shmac;
+  long expiry;
+  string data;
+
+  close(fd);
+
+  while (lines >> shmac >> expiry >> data) {
+    Session session{expiry, FromHex(data)};
+
+    shmac = FromHex(shmac);
+
+    if (!shmac.empty() && !session.data.empty() && expiry > time(nullptr)) {
+      sessions[shmac] = session;
+    }
+  }
+
+  return sessions;
+}
+
+CURLcode TlsSessionStore::Export(Sessions* sessions) const {
+  sessions->clear();
+
+  return curl_easy_ssls_export(handle_, Collect, sessions);
+}
+
+void TlsSessionStore::Save() {
+  Sessions sessions;
+
+  if (Export(&sessions) != CURLE_OK || sessions.empty()) {
+    return;
+  }
+
+  bool changed = sessions.size() != saved_.size();
+
+  for (auto own = sessions.begin(), saved = saved_.begin();
+       !changed && own != sessions.end(); ++own, ++saved) {
+    changed = own->first != saved->first ||
+              own->second.data != saved->second.data;
+  }
+
+  if (!changed) {
+    return;
+  }
+
+  /* the writers of the node take turns, each one merging the others'
+   * sessions; the readers only see whole files. */
+  int fd = utils::OpenPrivateFile(kPath_ + ".lock");
+
+  if (fd < 0) {
+    return;
+  }
+
+  try {
+    utils::FileLock lock{fd, LOCK_EX};
+    auto merged = Read(kPath_);
+    string contents;
+
+    for (const auto& session : sessions) {
+      merged[session.first] = session.second;
+    }
+
+    for (const auto& session : merged) {
+      contents += ToHex(session.first) + ' ' +
+                  to_string(session.second.expiry) + ' ' +
+                  ToHex(session.second.data) + '\n';
+    }
+
+    /* a failure only costs the next restart some handshakes, the sessions
+     * are saved again on the next round. */
+    if (utils::ReplaceFile(kPath_, contents)) {
+      saved_ = sessions;
+    }
+  } catch (const runtime_error&) {
+  }
+
+  close(fd);
+}
+
+void TlsSessionStore::Run() {
+  unique_lock<mutex> lock{mutex_};
+
+  for (;;) {
+    bool last = stop_.wait_for(lock, kSaveInterval_, [this] {
+      return stopped_;
+    });
+
+    lock.unlock();
+    Save();
+    lock.lock();
+
+    if (last) {
+      return;
+    }
+  }
+}
+
+CURLcode TlsSessionStore::Collect(CURL* /* handle */, void* userptr,
+                                  const char* /* session_key */,
+                                  const unsigned char* shmac, size_t shmac_len,
+                                  const unsigned char* sdata, size_t sdata_len,
+                                  curl_off_t valid_until,
+                                  int /* ietf_tls_id */,
+                                  const char* /* alpn */,
+                                  size_t /* earlydata_max */) {
+  auto sessions = static_cast<Sessions*>(userptr);
+
+  /* only the sessions keyed by a hash are imported back. */
+  if (sessions && shmac && shmac_len && sdata_len &&
+      valid_until > time(nullptr)) {
+    (*sessions)[Bytes(shmac, shmac_len)] =
+        Session{static_cast<long>(valid_until), Bytes(sdata, sdata_len)};
+  }
+
+  return CURLE_OK;
+}
+
+}  // namespace spotify_lib
@@ -0,0 +1,89 @@
+/**
+ * @file
+ *
+ * @brief Token cache class implementation.
+ */
+#include "private/token_cache.h"
+
+#include <algorithm>
+
+namespace spotify_lib {
+
+using std::lock_guard;
+using std::min;
+using std::mutex;
+using std::string;
+using std::chrono::seconds;
+using std::chrono::steady_clock;
+
+namespace {
+
+/**
+ * @brief Bound of the margin between the end of a token's use and its expiry.
+ */
+constexpr seconds kExpiryMargin{30};
+
+}  // namespace
+
+string TokenCache::Find(const string& client_id, const string& credentials,
+                        bool* refresh) {
+  lock_guard<mutex> lock{mutex_};
+  auto token = tokens_.find(client_id);
+  auto now = steady_clock::now();
+
+  *refresh = false;
+
+  if (token == tokens_.end() || token->second.credentials != credentials ||
+      now >= token->second.expiry) {
+    return "";
+  }
+
+  if (now >= token->second.refresh_at && !token->second.refreshing) {
+    token->second.refreshing = true;
+    *refresh = true;
+  }
+
+  return token->second.value;
+}
+
+CachedToken TokenCache::Make(const string& credentials, const string& token,
+                             seconds lifetime,
+                             steady_clock::time_point issued) {
+  if (lifetime <= seconds{0}) {
+    return CachedToken{credentials, token, issued, issued, false};
+  }
+
+  /* a tenth of the lifetime for the short-lived tokens. */
+  auto margin = min<steady_clock::duration>(kExpiryMargin, lifetime / 10);
+
+  return CachedToken{credentials, token, issued + lifetime * 3 / 4,
+                     issued + lifetime - margin, false};
+}
+
+CachedToken TokenCache::Store(const string& client_id,
+                              const string& credentials, const string& token,
+                              seconds lifetime,
+                              steady_clock::time_point issued) {
+  CachedToken cached = Make(credentials, token, lifetime, issued);
+
+  if (lifetime <= seconds{0}) {
+    return cached;
+  }
+
+  lock_guard<mutex> lock{mutex_};
+
+  tokens_[client_id] = cached;
+
+  return cached;
+}
+
+void TokenCache::Abandon(const string& client_id) {
+  lock_guard<mutex> lock{mutex_};
+  auto token = tokens_.find(client_id);
+
+  if (token != tokens_.end()) {
+    token->second.refreshing = false;
+  }
+}
+
+}  // namespace spotify_lib
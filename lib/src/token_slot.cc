@@ -0,0 +1,291 @@
+/**
+ * @file
+ *
+ * @brief Token slot class implementation.
+ */
+#include "private/token_slot.h"
+
+#include <time.h>
+
+#include <algorithm>
+#include <unordered_map>
+
+namespace spotify_lib {
+
+using std::atomic;
+using std::lock_guard;
+using std::make_shared;
+using std::memory_order_acquire;
+using std::memory_order_relaxed;
+using std::memory_order_release;
+using std::mutex;
+using std::shared_ptr;
+using std::size_t;
+using std::string;
+using std::uint64_t;
+using std::unique_ptr;
+using std::unordered_map;
+using std::chrono::duration_cast;
+using std::chrono::nanoseconds;
+using std::chrono::seconds;
+using std::chrono::steady_clock;
+
+namespace {
+
+/**
+ * @brief Source of the slot ids, 0 is never given.
+ */
+atomic<uint64_t> next_slot_id{1};
+
+/**
+ * @brief This structure holds the slots alive.
+ */
+struct SlotRegistry {
+  mutex guard;                                    //!< Protects the slots.
+  unordered_map<uint64_t, const TokenSlot*> live;  //!< Slots alive, by id.
+  atomic<uint64_t> retired{0};  //!< Bumped on each slot destruction.
+};
+
+/**
+ * @brief Get the registry of the slots.
+ *
+ * @return The registry. It's never destroyed, since the slots and the reading
+ * threads may outlive the other statics.
+ */
+SlotRegistry& Registry() {
+  static auto registry = new SlotRegistry;
+
+  return *registry;
+}
+
+/**
+ * @brief Value returned when there isn't any token.
+ */
+const string kNoToken;
+
+/**
+ * @brief Get the time on the steady clock, at the resolution of the
+ * scheduler tick. The tokens are given up well ahead of their expiry, while
+ * reading the precise clock can cost more than the rest of a read.
+ *
+ * @return The current time.
+ */
+steady_clock::time_point CoarseNow() {
+#ifdef CLOCK_MONOTONIC_COARSE
+  /* the steady clock is CLOCK_MONOTONIC, of the same origin. */
+  timespec now;
+
+  if (clock_gettime(CLOCK_MONOTONIC_COARSE, &now) == 0) {
+    return steady_clock::time_point{
+        duration_cast<steady_clock::duration>(
+            seconds{now.tv_sec} + nanoseconds{now.tv_nsec})};
+  }
+#endif
+
+  return steady_clock::now();
+}
+
+}  // namespace
+
+/**
+ * @brief This structure holds the entry a thread read last from a slot.
+ */
+struct TokenSlot::Reader {
+  uint64_t version{0};                //!< Version of the slot read.
+  shared_ptr<const SlotEntry> entry;  //!< The entry read, may be null.
+};
+
+/**
+ * @brief This structure holds the references of a thread, by slot. The slot
+ * read last is found without any lookup.
+ */
+struct TokenSlot::ReaderCaches {
+  /**
+   * @brief Destructor. The slots still alive release the references.
+   */
+  ~ReaderCaches() {
+    auto& registry = Registry();
+    lock_guard<mutex> lock{registry.guard};
+
+    for (auto& r : slots) {
+      auto slot = registry.live.find(r.first);
+
+      if (slot != registry.live.end()) {
+        slot->second->RemoveReader(r.second);
+      }
+    }
+  }
+
+  /**
+   * @brief Forget the slots destroyed since the last time.
+   */
+  void Sweep() {
+    auto& registry = Registry();
+    lock_guard<mutex> lock{registry.guard};
+
+    for (auto r = slots.begin(); r != slots.end();) {
+      if (registry.live.count(r->first)) {
+        ++r;
+      } else {
+        r = slots.erase(r);
+      }
+    }
+
+    retired = registry.retired.load(memory_order_relaxed);
+    last_slot = 0;
+    last = nullptr;
+  }
+
+  uint64_t retired{0};                     //!< Slots destroyed when swept.
+  uint64_t last_slot{0};                   //!< Id of the slot read last.
+  Reader* last{nullptr};                   //!< Its reference.
+  unordered_map<uint64_t, Reader*> slots;  //!< References by slot id.
+};
+
+TokenSlot::TokenSlot()
+    : kId_{next_slot_id++},
+      version_{0},
+      refresh_at_{
+          steady_clock::time_point::max().time_since_epoch().count()} {
+  auto& registry = Registry();
+  lock_guard<mutex> lock{registry.guard};
+
+  registry.live.emplace(kId_, this);
+}
+
+TokenSlot::~TokenSlot() {
+  auto& registry = Registry();
+  lock_guard<mutex> lock{registry.guard};
+
+  /* the references are released along with the slot, the threads only drop
+   * their pointers to them on their next sweep. */
+  registry.live.erase(kId_);
+  registry.retired.fetch_add(1, memory_order_relaxed);
+}
+
+void TokenSlot::Publish(const string& client_id, const string& client_secret,
+                        const CachedToken& token) {
+  lock_guard<mutex> lock{mutex_};
+
+  Replace(make_shared<const SlotEntry>(
+      SlotEntry{client_id, client_secret, token}));
+}
+
+void TokenSlot::Renew(const CachedToken& token) {
+  lock_guard<mutex> lock{mutex_};
+
+  if (!entry_ || entry_->token.credentials != token.credentials) {
+    return;
+  }
+
+  Replace(make_shared<const SlotEntry>(
+      SlotEntry{entry_->client_id, entry_->client_secret, token}));
+}
+
+const string& TokenSlot::Read() const {
+  thread_local ReaderCaches caches;
+
+  /* a slot read for the first time by the thread is at version 0, which is
+   * never current once something is published. */
+  if (caches.last_slot != kId_) {
+    auto reader = caches.slots.find(kId_);
+
+    if (reader == caches.slots.end()) {
+      /* the map only grows here, it's rid of the slots gone beforehand. */
+      if (caches.retired != Registry().retired.load(memory_order_relaxed)) {
+        caches.Sweep();
+      }
+
+      reader = caches.slots.emplace(kId_, AddReader()).first;
+    }
+
+    caches.last_slot = kId_;
+    caches.last = reader->second;
+  }
+
+  auto& cache = *caches.last;
+  uint64_t version = version_.load(memory_order_acquire);
+
+  if (cache.version != version) {
+    lock_guard<mutex> lock{mutex_};
+
+    cache.version = version_.load(memory_order_relaxed);
+    cache.entry = entry_;
+  }
+
+  if (!cache.entry || CoarseNow() >= cache.entry->token.expiry) {
+    return kNoToken;
+  }
+
+  return cache.entry->token.value;
+}
+
+bool TokenSlot::ClaimRefresh() const {
+  auto refresh_at = refresh_at_.load(memory_order_relaxed);
+
+  if (CoarseNow().time_since_epoch().count() < refresh_at) {
+    return false;
+  }
+
+  return refresh_at_.compare_exchange_strong(
+      refresh_at, steady_clock::time_point::max().time_since_epoch().count());
+}
+
+void TokenSlot::RetryRefresh(const string& client_id,
+                             const string& client_secret,
+                             steady_clock::duration delay) const {
+  lock_guard<mutex> lock{mutex_};
+
+  if (!entry_ || entry_->client_id != client_id ||
+      entry_->client_secret != client_secret) {
+    return;
+  }
+
+  refresh_at_.store((CoarseNow() + delay).time_since_epoch().count(),
+                    memory_order_relaxed);
+}
+
+bool TokenSlot::Credentials(string* client_id, string* client_secret) const {
+  lock_guard<mutex> lock{mutex_};
+
+  if (!entry_) {
+    return false;
+  }
+
+  *client_id = entry_->client_id;
+  *client_secret = entry_->client_secret;
+
+  return true;
+}
+
+size_t TokenSlot::ReaderCount() const {
+  lock_guard<mutex> lock{mutex_};
+
+  return readers_.size();
+}
+
+TokenSlot::Reader* TokenSlot::AddReader() const {
+  lock_guard<mutex> lock{mutex_};
+
+  readers_.emplace_back(new Reader{});
+
+  return readers_.back().get();
+}
+
+void TokenSlot::RemoveReader(const Reader* reader) const {
+  lock_guard<mutex> lock{mutex_};
+
+  readers_.erase(std::find_if(readers_.begin(), readers_.end(),
+                              [reader](const unique_ptr<Reader>& r) {
+                                return r.get() == reader;
+                              }));
+}
+
+void TokenSlot::Replace(const shared_ptr<const SlotEntry>& entry) {
+  entry_ = entry;
+  refresh_at_.store(entry->token.refresh_at.time_since_epoch().count(),
+                    memory_order_relaxed);
+  version_.fetch_add(1, memory_order_release);
+}
+
+}  // namespace spotify_lib
@@ -0,0 +1,183 @@
+/**
+ * @file
+ *
+ * @brief Token store class implementation.
+ */
+#include "private/token_store.h"
+
+#include <sys/file.h>
+#include <unistd.h>
+
+#include <openssl/evp.h>
+
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "private/utils.h"
+
+namespace spotify_lib {
+
+using std::istringstream;
+using std::runtime_error;
+using std::string;
+using std::to_string;
+using std::unordered_map;
+using std::chrono::duration_cast;
+using std::chrono::seconds;
+using std::chrono::system_clock;
+
+namespace {
+
+/**
+ * @brief This structure holds a line of the store file.
+ */
+struct Line {
+  string digest;      //!< Digest of the credentials.
+  StoredToken token;  //!< The token.
+};
+
+/**
+ * @brief Get the digest of some credentials, so that the file doesn't hold
+ * them.
+ *
+ * @param credentials The credentials.
+ *
+ * @return The SHA-256 digest, in hexadecimal.
+ */
+string Digest(const string& credentials) {
+  static const char kDigits[] = "0123456789abcdef";
+  unsigned char digest[EVP_MAX_MD_SIZE];
+  unsigned int size = 0;
+  string hex;
+
+  EVP_Digest(credentials.data(), credentials.size(), digest, &size,
+             EVP_sha256(), nullptr);
+
+  for (unsigned int i = 0; i < size; i++) {
+    hex += kDigits[digest[i] >> 4];
+    hex += kDigits[digest[i] & 0x0f];
+  }
+
+  return hex;
+}
+
+/**
+ * @brief Check whether a token has expired.
+ *
+ * @param token The token.
+ *
+ * @return true if so, false otherwise.
+ */
+bool Expired(const StoredToken& token) {
+  return token.issued + token.lifetime <= system_clock::now();
+}
+
+/**
+ * @brief Read the tokens not expired yet, the caller holding the lock.
+ *
+ * @param fd Descriptor of the store file.
+ *
+ * @return The lines by client ID.
+ */
+unordered_map<string, Line> Read(int fd) {
+  unordered_map<string, Line> lines;
+  istringstream contents{utils::ReadFile(fd)};
+  string client_id;
+  Line line;
+  long long issued;
+  long long lifetime;
+
+  while (contents >> client_id >> line.digest >> issued >> lifetime >>
+         line.token.value) {
+    line.token.issued = system_clock::time_point{seconds{issued}};
+    line.token.lifetime = seconds{lifetime};
+
+    if (!Expired(line.token)) {
+      lines[client_id] = line;
+    }
+  }
+
+  return lines;
+}
+
+}  // namespace
+
+TokenStore::TokenStore(const string& path) : kPath_{path} {
+  int fd = utils::OpenPrivateFile(kPath_);
+
+  if (fd < 0) {
+    throw runtime_error("failed to open the token store!");
+  }
+
+  close(fd);
+}
+
+bool TokenStore::Find(const string& client_id, const string& credentials,
+                      StoredToken* token) const {
+  int fd = utils::OpenPrivateFile(kPath_);
+
+  if (fd < 0) {
+    return false;
+  }
+
+  unordered_map<string, Line> lines;
+
+  try {
+    utils::FileLock lock{fd, LOCK_SH};
+
+    lines = Read(fd);
+  } catch (const runtime_error&) {
+    /* an unlocked read could see a half written file. */
+    close(fd);
+
+    return false;
+  }
+
+  close(fd);
+
+  auto line = lines.find(client_id);
+
+  if (line == lines.end() || line->second.digest != Digest(credentials)) {
+    return false;
+  }
+
+  *token = line->second.token;
+
+  return true;
+}
+
+void TokenStore::Save(const string& client_id, const string& credentials,
+                      const StoredToken& token) const {
+  int fd = utils::OpenPrivateFile(kPath_);
+
+  if (fd < 0) {
+    return;
+  }
+
+  try {
+    utils::FileLock lock{fd, LOCK_EX};
+    auto lines = Read(fd);
+    string contents;
+
+    lines[client_id] = Line{Digest(credentials), token};
+
+    for (const auto& line : lines) {
+      auto issued = duration_cast<seconds>(
+          line.second.token.issued.time_since_epoch());
+
+      contents += line.first + ' ' + line.second.digest + ' ' +
+                  to_string(issued.count()) + ' ' +
+                  to_string(line.second.token.lifetime.count()) + ' ' +
+                  line.second.token.value + '\n';
+    }
+
+    utils::RewriteFile(fd, contents);
+  } catch (const runtime_error&) {
+    /* the token is only kept in memory then. */
+  }
+
+  close(fd);
+}
+
+}  // namespace spotify_lib
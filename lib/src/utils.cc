@@ -5,18 +5,34 @@
  */
 #include "private/utils.h"
 
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include <boost/beast/core/detail/base64.hpp>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <stdexcept>
 #include <vector>
 
+#include <curl/curl.h>
+
 namespace spotify_lib {
 namespace utils {
 
 using boost::beast::detail::base64::encode;
 using boost::beast::detail::base64::encoded_size;
+using std::call_once;
 using std::memset;
+using std::once_flag;
+using std::runtime_error;
 using std::size_t;
 using std::string;
 using std::strlen;
+using std::vector;
 
 std::string GetBase64Code(const string& str) {
   const char* auth = str.c_str();
@@ -30,5 +46,102 @@ std::string GetBase64Code(const string& str) {
   return string{result};
 }
 
+void InitCurl() {
+  static once_flag global_init;
+
+  call_once(global_init, [] { curl_global_init(CURL_GLOBAL_DEFAULT); });
+}
+
+int OpenPrivateFile(const string& path) {
+  /* a link planted at the path would send the tokens elsewhere. */
+  int fd = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC | O_NOFOLLOW, 0600);
+  struct stat info;
+
+  if (fd < 0) {
+    return -1;
+  }
+
+  /* only a regular file of our own is trusted with the tokens; then a file
+   * created by an earlier version, or under a laxer umask, is restricted. */
+  if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode) ||
+      info.st_uid != geteuid() || fchmod(fd, 0600) != 0) {
+    close(fd);
+
+    return -1;
+  }
+
+  return fd;
+}
+
+string ReadFile(int fd) {
+  vector<char> buffer(4096);
+  string contents;
+  off_t offset = 0;
+  ssize_t ret;
+
+  while ((ret = pread(fd, buffer.data(), buffer.size(), offset)) > 0) {
+    contents.append(buffer.data(), static_cast<size_t>(ret));
+    offset += ret;
+  }
+
+  return contents;
+}
+
+bool RewriteFile(int fd, const string& contents) {
+  size_t written = 0;
+
+  if (ftruncate(fd, 0) != 0) {
+    return false;
+  }
+
+  while (written < contents.size()) {
+    ssize_t ret = pwrite(fd, contents.data() + written,
+                         contents.size() - written, written);
+
+    if (ret <= 0) {
+      return false;
+    }
+
+    written += static_cast<size_t>(ret);
+  }
+
+  return true;
+}
+
+bool ReplaceFile(const string& path, const string& contents) {
+  string temp = path + ".XXXXXX";
+  int fd = mkstemp(&temp[0]);
+
+  if (fd < 0) {
+    return false;
+  }
+
+  /* mkstemp makes it only readable by its owner. */
+  bool written = RewriteFile(fd, contents) && fsync(fd) == 0;
+
+  close(fd);
+
+  if (!written || rename(temp.c_str(), path.c_str()) != 0) {
+    unlink(temp.c_str());
+
+    return false;
+  }
+
+  return true;
+}
+
+FileLock::FileLock(int fd, int operation) : fd_{fd} {
+  int ret;
+
+  while ((ret = flock(fd_, operation)) != 0 && errno == EINTR) {
+  }
+
+  if (ret != 0) {
+    throw runtime_error("failed to lock the file!");
+  }
+}
+
+FileLock::~FileLock() { flock(fd_, LOCK_UN); }
+
 }  // namespace utils
 }  // namespace spotify_lib
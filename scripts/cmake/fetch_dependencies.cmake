@@ -22,9 +22,23 @@ message(STATUS "Fetching libcurl")
 FetchContent_Declare(
     libcurl
     GIT_REPOSITORY  git@github.com:curl/curl.git
-    GIT_TAG         curl-7_79_1
+    GIT_TAG         curl-8_14_1
 )
 
+# the tls session store imports and exports libcurl's own session cache
+set(USE_SSLS_EXPORT ON CACHE BOOL "Enable the SSL session export" FORCE)
+
+if(HTTP2)
+    set(USE_NGHTTP2 ON CACHE BOOL "Use nghttp2 for HTTP/2 support" FORCE)
+endif(HTTP2)
+
+# gzip decoding comes with zlib, which libcurl picks up when it's found
+set(CURL_ZLIB ON CACHE BOOL "Use zlib for gzip decoding" FORCE)
+
+if(BROTLI)
+    set(CURL_BROTLI ON CACHE BOOL "Use brotli for br decoding" FORCE)
+endif(BROTLI)
+
 FetchContent_MakeAvailable(libcurl)
 
 set_target_properties(
@@ -34,6 +48,26 @@ set_target_properties(
 )
 #################################################################
 
+### simdjson ###################################################
+if(SIMDJSON)
+    message(STATUS "Fetching simdjson")
+
+    FetchContent_Declare(
+        simdjson
+        GIT_REPOSITORY  git@github.com:simdjson/simdjson.git
+        GIT_TAG         v3.10.1
+    )
+
+    FetchContent_MakeAvailable(simdjson)
+
+    set_target_properties(
+        simdjson
+        PROPERTIES
+        COMPILE_FLAGS "-fPIC"
+    )
+endif(SIMDJSON)
+#################################################################
+
 ### gtest #######################################################
 if(UNIT_TESTS)
     message(STATUS "Fetching gtest")
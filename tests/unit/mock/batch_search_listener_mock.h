@@ -0,0 +1,21 @@
+#ifndef BATCH_SEARCH_LISTENER_MOCK_H_
+#define BATCH_SEARCH_LISTENER_MOCK_H_
+
+#include <gmock/gmock.h>
+
+#include "batch_search_listener.h"
+
+namespace spotify_lib {
+namespace test {
+
+class BatchSearchListenerMock : public BatchSearchListener {
+ public:
+  MOCK_CONST_METHOD2(OnQueryFound,
+                     void(std::size_t, const std::vector<MusicInfo> &));
+  MOCK_CONST_METHOD2(OnQueryError, void(std::size_t, const std::string &));
+};
+
+}  // namespace test
+}  // namespace spotify_lib
+
+#endif  // BATCH_SEARCH_LISTENER_MOCK_H_
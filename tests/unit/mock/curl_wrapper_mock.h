@@ -16,6 +16,34 @@ class CurlWrapperMock : public CurlWrapper {
 
   MOCK_CONST_METHOD2(Get, Json::Value(const std::string &,
                                       const std::vector<std::string> &));
+
+  MOCK_CONST_METHOD2(GetRaw, std::string(const std::string &,
+                                         const std::vector<std::string> &));
+
+  /* the prepared requests are checked as the plain ones. */
+  Json::Value Get(const PreparedRequest &request) const override {
+    return Get(request.Uri(), request.HeaderLines());
+  }
+
+  std::string GetRaw(const PreparedRequest &request) const override {
+    return GetRaw(request.Uri(), request.HeaderLines());
+  }
+
+  MOCK_CONST_METHOD3(GetStream, void(const std::string &,
+                                     const std::vector<std::string> &,
+                                     const ChunkCallback &));
+
+  MOCK_CONST_METHOD4(PostAsync, void(const std::string &,
+                                     const std::vector<std::string> &,
+                                     const std::vector<std::string> &,
+                                     const JsonCallback &));
+
+  MOCK_CONST_METHOD3(GetAsync, void(const std::string &,
+                                    const std::vector<std::string> &,
+                                    const JsonCallback &));
+
+  MOCK_CONST_METHOD2(Warmup, void(const std::vector<std::string> &,
+                                  std::size_t));
 };
 
 }  // namespace test
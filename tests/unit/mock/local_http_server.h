@@ -0,0 +1,179 @@
+#ifndef LOCAL_HTTP_SERVER_H_
+#define LOCAL_HTTP_SERVER_H_
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace spotify_lib {
+namespace test {
+
+/**
+ * @brief HTTP/1.1 server on the loopback, answering each request with the
+ * reply built by a handler. The connections are kept alive, and the head of
+ * every request is recorded.
+ */
+class LocalHttpServer {
+ public:
+  /**
+   * @brief Builder of the reply to the head of a request.
+   */
+  using Handler = std::function<std::string(const std::string &head)>;
+
+  explicit LocalHttpServer(const Handler &handler)
+      : handler_{handler}, listener_{socket(AF_INET, SOCK_STREAM, 0)} {
+    sockaddr_in address{};
+    socklen_t length = sizeof(address);
+
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0;
+
+    bind(listener_, reinterpret_cast<sockaddr *>(&address), sizeof(address));
+    listen(listener_, 64);
+    getsockname(listener_, reinterpret_cast<sockaddr *>(&address), &length);
+    port_ = ntohs(address.sin_port);
+
+    acceptor_ = std::thread{[this] { Accept(); }};
+  }
+
+  ~LocalHttpServer() {
+    stopped_ = true;
+    shutdown(listener_, SHUT_RDWR);
+    acceptor_.join();
+    close(listener_);
+
+    {
+      std::lock_guard<std::mutex> lock{mutex_};
+
+      for (int fd : clients_) {
+        shutdown(fd, SHUT_RDWR);
+      }
+    }
+
+    for (auto &t : connections_) {
+      t.join();
+    }
+
+    /* closed once served, a closed descriptor could be reused meanwhile. */
+    for (int fd : clients_) {
+      close(fd);
+    }
+  }
+
+  LocalHttpServer(const LocalHttpServer &) = delete;
+  LocalHttpServer &operator=(const LocalHttpServer &) = delete;
+
+  /**
+   * @brief Build a 200 reply.
+   *
+   * @param body Body of the reply.
+   * @param headers Additional header lines, each ending with CRLF.
+   *
+   * @return The reply.
+   */
+  static std::string Ok(const std::string &body,
+                        const std::string &headers = "") {
+    return "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\n"
+           "Content-Length: " +
+           std::to_string(body.size()) + "\r\n" + headers + "\r\n" + body;
+  }
+
+  int Port() const { return port_; }
+
+  std::string Uri(const std::string &path) const {
+    return "http://127.0.0.1:" + std::to_string(port_) + path;
+  }
+
+  std::vector<std::string> Heads() const {
+    std::lock_guard<std::mutex> lock{mutex_};
+
+    return heads_;
+  }
+
+  std::size_t Connections() const { return accepted_; }
+
+ private:
+  void Accept() {
+    for (;;) {
+      int fd = accept(listener_, nullptr, nullptr);
+
+      if (fd < 0 || stopped_) {
+        if (fd >= 0) {
+          close(fd);
+        }
+
+        return;
+      }
+
+      std::lock_guard<std::mutex> lock{mutex_};
+
+      accepted_++;
+      clients_.push_back(fd);
+      connections_.emplace_back([this, fd] { Serve(fd); });
+    }
+  }
+
+  void Serve(int fd) {
+    std::string received;
+    char buffer[4096];
+
+    for (;;) {
+      auto end = received.find("\r\n\r\n");
+
+      if (end == std::string::npos) {
+        ssize_t ret = read(fd, buffer, sizeof(buffer));
+
+        if (ret <= 0) {
+          break;
+        }
+
+        received.append(buffer, static_cast<std::size_t>(ret));
+        continue;
+      }
+
+      std::string head = received.substr(0, end + 4);
+
+      received.erase(0, end + 4);
+
+      {
+        std::lock_guard<std::mutex> lock{mutex_};
+
+        heads_.push_back(head);
+      }
+
+      std::string reply = handler_(head);
+
+      /* the client may have given up on the reply meanwhile. */
+      if (send(fd, reply.data(), reply.size(), MSG_NOSIGNAL) !=
+          static_cast<ssize_t>(reply.size())) {
+        break;
+      }
+    }
+  }
+
+  Handler handler_;                  //!< Builder of the replies.
+  int listener_;                     //!< Listening socket.
+  int port_;                         //!< Port listened to.
+  std::atomic<bool> stopped_{false};  //!< Whether the server is stopping.
+  std::atomic<std::size_t> accepted_{0};  //!< Connections accepted.
+  mutable std::mutex mutex_;         //!< Protects the state below.
+  std::vector<int> clients_;         //!< Sockets of the connections.
+  std::vector<std::string> heads_;   //!< Heads of the requests received.
+  std::thread acceptor_;             //!< Thread accepting the connections.
+  std::vector<std::thread> connections_;  //!< Threads serving them.
+};
+
+}  // namespace test
+}  // namespace spotify_lib
+
+#endif  // LOCAL_HTTP_SERVER_H_
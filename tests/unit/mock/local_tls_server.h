@@ -0,0 +1,201 @@
+#ifndef LOCAL_TLS_SERVER_H_
+#define LOCAL_TLS_SERVER_H_
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <openssl/pem.h>
+#include <openssl/ssl.h>
+#include <openssl/x509v3.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+
+namespace spotify_lib {
+namespace test {
+
+/**
+ * @brief HTTPS server on the loopback, with a self-signed certificate for
+ * localhost made at startup. It serves one connection at a time, answering a
+ * single request with an empty JSON object before closing it, and counts the
+ * handshakes which resumed a session.
+ */
+class LocalTlsServer {
+ public:
+  LocalTlsServer()
+      : ctx_{SSL_CTX_new(TLS_server_method())},
+        listener_{socket(AF_INET, SOCK_STREAM, 0)} {
+    sockaddr_in address{};
+    socklen_t length = sizeof(address);
+
+    Certify();
+
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0;
+
+    bind(listener_, reinterpret_cast<sockaddr *>(&address), sizeof(address));
+    listen(listener_, 8);
+    getsockname(listener_, reinterpret_cast<sockaddr *>(&address), &length);
+    port_ = ntohs(address.sin_port);
+
+    acceptor_ = std::thread{[this] { Accept(); }};
+  }
+
+  ~LocalTlsServer() {
+    stopped_ = true;
+    shutdown(listener_, SHUT_RDWR);
+    acceptor_.join();
+    close(listener_);
+    SSL_CTX_free(ctx_);
+    unlink(ca_file_.c_str());
+  }
+
+  LocalTlsServer(const LocalTlsServer &) = delete;
+  LocalTlsServer &operator=(const LocalTlsServer &) = delete;
+
+  std::string Uri(const std::string &path) const {
+    return "https://localhost:" + std::to_string(port_) + path;
+  }
+
+  /**
+   * @brief Get the path of the certificate, to be trusted by the clients.
+   *
+   * @return Path of the PEM file.
+   */
+  const std::string &CaFile() const { return ca_file_; }
+
+  std::size_t Handshakes() const { return handshakes_; }
+
+  std::size_t Resumed() const { return resumed_; }
+
+ private:
+  /**
+   * @brief Make the self-signed certificate and install it.
+   */
+  void Certify() {
+    EVP_PKEY *key = nullptr;
+    EVP_PKEY_CTX *key_ctx = EVP_PKEY_CTX_new_id(EVP_PKEY_EC, nullptr);
+
+    if (!key_ctx || EVP_PKEY_keygen_init(key_ctx) <= 0 ||
+        EVP_PKEY_CTX_set_ec_paramgen_curve_nid(key_ctx,
+                                               NID_X9_62_prime256v1) <= 0 ||
+        EVP_PKEY_keygen(key_ctx, &key) <= 0) {
+      EVP_PKEY_CTX_free(key_ctx);
+      throw std::runtime_error("failed to generate the server key!");
+    }
+
+    EVP_PKEY_CTX_free(key_ctx);
+
+    X509 *cert = X509_new();
+    X509_NAME *name = X509_get_subject_name(cert);
+    X509V3_CTX v3_ctx;
+
+    X509_set_version(cert, 2);
+    ASN1_INTEGER_set(X509_get_serialNumber(cert), 1);
+    X509_gmtime_adj(X509_getm_notBefore(cert), -3600);
+    X509_gmtime_adj(X509_getm_notAfter(cert), 3600);
+    X509_set_pubkey(cert, key);
+    X509_NAME_add_entry_by_txt(
+        name, "CN", MBSTRING_ASC,
+        reinterpret_cast<const unsigned char *>("localhost"), -1, -1, 0);
+    X509_set_issuer_name(cert, name);
+    X509V3_set_ctx_nodb(&v3_ctx);
+    X509V3_set_ctx(&v3_ctx, cert, cert, nullptr, nullptr, 0);
+
+    for (auto extension : {std::make_pair(NID_basic_constraints, "CA:TRUE"),
+                           std::make_pair(NID_subject_alt_name,
+                                          "DNS:localhost,IP:127.0.0.1")}) {
+      X509_EXTENSION *ext =
+          X509V3_EXT_conf_nid(nullptr, &v3_ctx, extension.first,
+                              const_cast<char *>(extension.second));
+
+      X509_add_ext(cert, ext, -1);
+      X509_EXTENSION_free(ext);
+    }
+
+    X509_sign(cert, key, EVP_sha256());
+
+    char path[] = "/tmp/local_tls_server_XXXXXX";
+    int fd = mkstemp(path);
+    FILE *out = fd >= 0 ? fdopen(fd, "w") : nullptr;
+
+    if (!out || !PEM_write_X509(out, cert)) {
+      throw std::runtime_error("failed to write the server certificate!");
+    }
+
+    fclose(out);
+    ca_file_ = path;
+
+    SSL_CTX_use_certificate(ctx_, cert);
+    SSL_CTX_use_PrivateKey(ctx_, key);
+
+    X509_free(cert);
+    EVP_PKEY_free(key);
+  }
+
+  void Accept() {
+    for (;;) {
+      int fd = accept(listener_, nullptr, nullptr);
+
+      if (fd < 0 || stopped_) {
+        if (fd >= 0) {
+          close(fd);
+        }
+
+        return;
+      }
+
+      Serve(fd);
+      close(fd);
+    }
+  }
+
+  void Serve(int fd) {
+    static const std::string kReply{
+        "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\n"
+        "Content-Length: 2\r\nConnection: close\r\n\r\n{}"};
+    SSL *ssl = SSL_new(ctx_);
+    std::string received;
+    char buffer[4096];
+    int ret;
+
+    SSL_set_fd(ssl, fd);
+
+    if (SSL_accept(ssl) > 0) {
+      handshakes_++;
+      resumed_ += SSL_session_reused(ssl) ? 1 : 0;
+
+      while (received.find("\r\n\r\n") == std::string::npos &&
+             (ret = SSL_read(ssl, buffer, sizeof(buffer))) > 0) {
+        received.append(buffer, static_cast<std::size_t>(ret));
+      }
+
+      SSL_write(ssl, kReply.data(), static_cast<int>(kReply.size()));
+      SSL_shutdown(ssl);
+    }
+
+    SSL_free(ssl);
+  }
+
+  SSL_CTX *ctx_;                     //!< TLS context, keeping the ticket keys.
+  int listener_;                     //!< Listening socket.
+  int port_;                         //!< Port listened to.
+  std::string ca_file_;              //!< Path of the certificate.
+  std::atomic<bool> stopped_{false};  //!< Whether the server is stopping.
+  std::atomic<std::size_t> handshakes_{0};  //!< Handshakes completed.
+  std::atomic<std::size_t> resumed_{0};     //!< Handshakes resumed.
+  std::thread acceptor_;             //!< Thread serving the connections.
+};
+
+}  // namespace test
+}  // namespace spotify_lib
+
+#endif  // LOCAL_TLS_SERVER_H_
@@ -0,0 +1,20 @@
+#ifndef METRICS_SINK_MOCK_H_
+#define METRICS_SINK_MOCK_H_
+
+#include <gmock/gmock.h>
+
+#include "metrics_sink.h"
+
+namespace spotify_lib {
+namespace test {
+
+class MetricsSinkMock : public MetricsSink {
+ public:
+  MOCK_METHOD1(OnRequest, void(const RequestMetrics &));
+  MOCK_METHOD3(OnOperation, void(const char *, std::chrono::microseconds, bool));
+};
+
+}  // namespace test
+}  // namespace spotify_lib
+
+#endif  // METRICS_SINK_MOCK_H_
@@ -11,6 +11,9 @@ namespace test {
 class SearchListenerMock : public SearchListener {
  public:
   MOCK_CONST_METHOD1(OnPatternFound, void(const std::vector<MusicInfo> &));
+  MOCK_CONST_METHOD1(OnMusicFound, void(const MusicInfo &));
+  MOCK_CONST_METHOD2(OnPageFound,
+                     void(std::size_t, const std::vector<MusicInfo> &));
   MOCK_CONST_METHOD1(OnSearchError, void(const std::string &));
 };
 
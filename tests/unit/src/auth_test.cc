@@ -7,26 +7,44 @@
 
 #include <gtest/gtest.h>
 
+#include <unistd.h>
+
+#include <cstdlib>
 #include <memory>
 
 #include "spotify.h"
 #include "mock/access_listener_mock.h"
 #include "mock/curl_wrapper_mock.h"
+#include "mock/search_listener_mock.h"
+#include "private/credential_pool.h"
 #include "private/curl_wrapper.h"
+#include "private/http_error.h"
+#include "private/searcher.h"
 #include "private/utils.h"
 
+using std::exception_ptr;
 using std::make_shared;
 using std::shared_ptr;
+using std::size_t;
 using std::string;
 using std::vector;
+using std::chrono::seconds;
 
 using spotify_lib::Spotify;
 using spotify_lib::Authenticator;
+using spotify_lib::CredentialPool;
+using spotify_lib::HttpError;
+using spotify_lib::JsonCallback;
+using spotify_lib::PoolPolicy;
+using spotify_lib::Searcher;
 using spotify_lib::test::AccessListenerMock;
 using spotify_lib::test::CurlWrapperMock;
+using spotify_lib::test::SearchListenerMock;
 
 using testing::_;
+using testing::InvokeArgument;
 using testing::Return;
+using testing::SaveArg;
 using testing::Test;
 using testing::Throw;
 
@@ -150,3 +168,331 @@ TEST_F(AuthTest, W_UserRequestAuthOffline_S_ReturnFailure) {
 
   lib_.Auth(*listener, kClientId, kClientSecret);
 }
+
+/**
+ * @brief This tests validates the scenario when the user try to log into the
+ * spotify API without blocking, using valid credentials. When this occurs,
+ * the spotify_lib must return the access token through the listener once the
+ * request completes.
+ */
+TEST_F(AuthTest, W_UserRequestAsyncAuthWithValidCredentials_S_LogWithSuccess) {
+  /* test constants */
+  const string kClientId{"good_id"};
+  const string kClientSecret{"good_secret"};
+  const vector<string> kReqHeaders{
+      "Authorization: Basic " +
+      spotify_lib::utils::GetBase64Code(kClientId + ":" + kClientSecret)};
+  const vector<string> kReqData{"grant_type=client_credentials"};
+  Value expected_return;
+
+  /* build the expected return */
+  expected_return["access_token"] =
+      "BQDGLtwpiJbNGiJejVpzV6xvFFwlaDCysDW41sPWJgVBL0XBWXj7wMm7";
+  expected_return["token_type"] = "Bearer";
+  expected_return["expires_in"] = "3600";
+  expected_return["scope"] = "";
+
+  auto listener = make_shared<AccessListenerMock>();
+
+  EXPECT_CALL(*curl_, PostAsync(KLoginUri_, kReqHeaders, kReqData, _))
+      .Times(1)
+      .WillOnce(InvokeArgument<3>(exception_ptr{}, expected_return));
+  EXPECT_CALL(*listener, OnAccessDenied(_)).Times(0);
+  EXPECT_CALL(*listener,
+              OnAccessGuaranteed(expected_return["access_token"].asString()))
+      .Times(1);
+
+  lib_.AuthAsync(*listener, kClientId, kClientSecret);
+}
+
+/**
+ * @brief This tests validates the scenario when the user try to log into the
+ * spotify API without blocking, using invalid credentials. When this occurs,
+ * the spotify_lib must return the suitable error message through the
+ * listener.
+ */
+TEST_F(AuthTest, W_UserRequestAsyncAuthWithBadCredentials_S_ReturnFailure) {
+  /* test constants */
+  const string kClientId{"bad_id"};
+  const string kClientSecret{"bad_secret"};
+  const string kExpectedMsg{
+      "fail to authenticate the user with the provided credentials!"};
+  const vector<string> kReqHeaders{
+      "Authorization: Basic " +
+      spotify_lib::utils::GetBase64Code(kClientId + ":" + kClientSecret)};
+  const vector<string> kReqData{"grant_type=client_credentials"};
+  Value expected_return;
+
+  /* build the expected return */
+  expected_return["error"] = "invalid_client";
+  expected_return["error_description"] = "Invalid client secret";
+
+  auto listener = make_shared<AccessListenerMock>();
+
+  EXPECT_CALL(*curl_, PostAsync(KLoginUri_, kReqHeaders, kReqData, _))
+      .Times(1)
+      .WillOnce(InvokeArgument<3>(exception_ptr{}, expected_return));
+  EXPECT_CALL(*listener, OnAccessDenied(kExpectedMsg)).Times(1);
+  EXPECT_CALL(*listener, OnAccessGuaranteed(_)).Times(0);
+
+  lib_.AuthAsync(*listener, kClientId, kClientSecret);
+}
+
+/**
+ * @brief This tests validates the scenario when the authenticator is warmed
+ * up. When this occurs, the connections to the accounts service must be
+ * opened through the curl wrapper.
+ */
+TEST_F(AuthTest, W_AuthenticatorIsWarmedUp_S_ConnectToTheAccountsService) {
+  EXPECT_CALL(*curl_, Warmup(vector<string>{KLoginUri_}, 2)).Times(1);
+
+  auth_->Warmup(2);
+}
+
+/**
+ * @brief This tests validates the scenario when the user log into the spotify
+ * API twice with the same credentials. When this occurs, the token granted
+ * first must be returned the second time, without another request.
+ */
+TEST_F(AuthTest, W_UserRequestAuthTwice_S_ReuseTheCachedToken) {
+  Value expected_return;
+
+  expected_return["access_token"] = "BQDGLtwpiJbNGiJejVpzV6xvFFwlaDCysDW41";
+  expected_return["expires_in"] = "3600";
+
+  auto listener = make_shared<AccessListenerMock>();
+
+  EXPECT_CALL(*curl_, Post(KLoginUri_, _, _))
+      .Times(1)
+      .WillOnce(Return(expected_return));
+  EXPECT_CALL(*listener,
+              OnAccessGuaranteed(expected_return["access_token"].asString()))
+      .Times(2);
+
+  lib_.Auth(*listener, "good_id", "good_secret");
+  lib_.Auth(*listener, "good_id", "good_secret");
+}
+
+/**
+ * @brief This tests validates the scenario when the user log into the spotify
+ * API without blocking and then again with other credentials. When this
+ * occurs, the cached token must not be returned for the other credentials.
+ */
+TEST_F(AuthTest, W_UserRequestAuthWithOtherCredentials_S_RequestAnotherToken) {
+  Value first_return;
+  Value second_return;
+
+  first_return["access_token"] = "BQDGLtwpiJbNGiJejVpzV6xvFFwlaDCysDW41";
+  first_return["expires_in"] = 3600;
+  second_return["access_token"] = "BQCs2MZbMqQOnBcX3JWz0F8y8Ko1hUthjbhu";
+  second_return["expires_in"] = 3600;
+
+  auto listener = make_shared<AccessListenerMock>();
+
+  EXPECT_CALL(*curl_, PostAsync(KLoginUri_, _, _, _))
+      .Times(1)
+      .WillOnce(InvokeArgument<3>(exception_ptr{}, first_return));
+  EXPECT_CALL(*curl_, Post(KLoginUri_, _, _))
+      .Times(1)
+      .WillOnce(Return(second_return));
+  EXPECT_CALL(*listener,
+              OnAccessGuaranteed(first_return["access_token"].asString()))
+      .Times(2);
+  EXPECT_CALL(*listener,
+              OnAccessGuaranteed(second_return["access_token"].asString()))
+      .Times(1);
+
+  lib_.AuthAsync(*listener, "good_id", "good_secret");
+  lib_.Auth(*listener, "good_id", "good_secret");
+  lib_.Auth(*listener, "good_id", "other_secret");
+}
+
+/**
+ * @brief This tests validates the scenario when the user log into the spotify
+ * API without blocking twice while the first request is in flight. When this
+ * occurs, the second login must join the first request instead of sending
+ * another one.
+ */
+TEST_F(AuthTest, W_UserRequestAsyncAuthTwiceAtOnce_S_RequestOneToken) {
+  Value expected_return;
+  JsonCallback reply;
+
+  expected_return["access_token"] = "BQDGLtwpiJbNGiJejVpzV6xvFFwlaDCysDW41";
+  expected_return["expires_in"] = 3600;
+
+  auto listener = make_shared<AccessListenerMock>();
+
+  EXPECT_CALL(*curl_, PostAsync(KLoginUri_, _, _, _))
+      .Times(1)
+      .WillOnce(SaveArg<3>(&reply));
+  EXPECT_CALL(*listener,
+              OnAccessGuaranteed(expected_return["access_token"].asString()))
+      .Times(2);
+
+  lib_.AuthAsync(*listener, "good_id", "good_secret");
+  lib_.AuthAsync(*listener, "good_id", "good_secret");
+
+  reply(nullptr, expected_return);
+}
+
+/**
+ * @brief This tests validates the scenario when the user searches a music
+ * without a token after logging into the spotify API. When this occurs, the
+ * search must be made with the token granted.
+ */
+TEST_F(AuthTest, W_UserSearchesWithoutAToken_S_UseTheTokenGranted) {
+  const string kAccessToken{"BQDGLtwpiJbNGiJejVpzV6xvFFwlaDCysDW41"};
+  const vector<string> kReqHeaders{"Authorization: Bearer " + kAccessToken};
+  Spotify lib{auth_, make_shared<Searcher>(curl_), nullptr};
+  Value expected_return;
+
+  expected_return["access_token"] = kAccessToken;
+  expected_return["expires_in"] = 3600;
+
+  AccessListenerMock access_listener;
+  SearchListenerMock search_listener;
+
+  EXPECT_CALL(*curl_, Post(KLoginUri_, _, _))
+      .Times(1)
+      .WillOnce(Return(expected_return));
+  EXPECT_CALL(*curl_, Get(_, kReqHeaders)).Times(2).WillRepeatedly(
+      Return(Value{}));
+  EXPECT_CALL(access_listener, OnAccessGuaranteed(kAccessToken)).Times(1);
+  EXPECT_CALL(search_listener, OnPatternFound(_)).Times(2);
+
+  lib.Auth(access_listener, "good_id", "good_secret");
+  lib.Search(search_listener, "umbrella");
+  lib.Search(search_listener, "cheap thrills");
+}
+
+/**
+ * @brief This tests validates the scenario when the user searches a music
+ * without a token before logging into the spotify API. When this occurs, the
+ * spotify_lib must return the suitable error message through the listener.
+ */
+TEST_F(AuthTest, W_UserSearchesWithoutATokenBeforeAuth_S_ReturnFailure) {
+  Spotify lib{auth_, make_shared<Searcher>(curl_), nullptr};
+  SearchListenerMock listener;
+
+  EXPECT_CALL(*curl_, Get(_, _)).Times(0);
+  EXPECT_CALL(listener,
+              OnSearchError("no access token, authenticate the client first!"))
+      .Times(1);
+
+  lib.Search(listener, "umbrella");
+}
+
+/**
+ * @brief This tests validates the scenario when the user log into the spotify
+ * API from two authenticators sharing a token file, e.g. two processes. When
+ * this occurs, the second one must reuse the token granted to the first one,
+ * without another request.
+ */
+TEST_F(AuthTest, W_UserRequestAuthWithATokenFile_S_ShareTheToken) {
+  char path[] = "/tmp/auth_test_tokens_XXXXXX";
+  Value expected_return;
+
+  close(mkstemp(path));
+
+  expected_return["access_token"] = "BQDGLtwpiJbNGiJejVpzV6xvFFwlaDCysDW41";
+  expected_return["expires_in"] = 3600;
+
+  EXPECT_CALL(*curl_, Post(KLoginUri_, _, _))
+      .Times(1)
+      .WillOnce(Return(expected_return));
+
+  Authenticator first{curl_, path};
+  Authenticator second{curl_, path};
+
+  EXPECT_EQ(expected_return["access_token"].asString(),
+            first.AuthUser("good_id", "good_secret"));
+  EXPECT_EQ(expected_return["access_token"].asString(),
+            second.AuthUser("good_id", "good_secret"));
+  EXPECT_EQ(expected_return["access_token"].asString(), second.Token());
+
+  unlink(path);
+}
+
+/**
+ * @brief This tests validates the scenario when the user searches without a
+ * token through a credential pool, and a credential is rate limited. When this
+ * occurs, the credential must be parked and the search made again with the
+ * next one, the later searches skipping it.
+ */
+TEST_F(AuthTest, W_PooledCredentialIsLimited_S_SearchWithTheNextOne) {
+  const vector<string> kFirstHeaders{
+      "Authorization: Basic " +
+      spotify_lib::utils::GetBase64Code("first_id:first_secret")};
+  const vector<string> kSecondHeaders{
+      "Authorization: Basic " +
+      spotify_lib::utils::GetBase64Code("second_id:second_secret")};
+  auto pool = make_shared<CredentialPool>(
+      vector<spotify_lib::Credentials>{{"first_id", "first_secret"},
+                                       {"second_id", "second_secret"}},
+      PoolPolicy::kRoundRobin);
+  auto auth = make_shared<Authenticator>(curl_, "", pool);
+  Spotify lib{auth, make_shared<Searcher>(curl_), nullptr};
+  Value first_token;
+  Value second_token;
+
+  first_token["access_token"] = "first_token";
+  first_token["expires_in"] = 3600;
+  second_token["access_token"] = "second_token";
+  second_token["expires_in"] = 3600;
+
+  SearchListenerMock listener;
+
+  EXPECT_CALL(*curl_, Post(KLoginUri_, kFirstHeaders, _))
+      .Times(1)
+      .WillOnce(Return(first_token));
+  EXPECT_CALL(*curl_, Post(KLoginUri_, kSecondHeaders, _))
+      .Times(1)
+      .WillOnce(Return(second_token));
+  EXPECT_CALL(*curl_,
+              Get(_, vector<string>{"Authorization: Bearer first_token"}))
+      .Times(1)
+      .WillOnce(Throw(HttpError{429, seconds{30}}));
+  EXPECT_CALL(*curl_,
+              Get(_, vector<string>{"Authorization: Bearer second_token"}))
+      .Times(2)
+      .WillRepeatedly(Return(Value{}));
+  EXPECT_CALL(listener, OnPatternFound(_)).Times(2);
+  EXPECT_CALL(listener, OnSearchError(_)).Times(0);
+
+  lib.Search(listener, "umbrella");
+  lib.Search(listener, "cheap thrills");
+}
+
+/**
+ * @brief This tests validates the scenario when the tokens of a credential
+ * pool are read one after the other from the same thread. When this occurs,
+ * each token got must be kept intact by the later reads.
+ */
+TEST_F(AuthTest, W_PooledTokensAreReadInTurn_S_KeepEachTokenGot) {
+  auto pool = make_shared<CredentialPool>(
+      vector<spotify_lib::Credentials>{{"first_id", "first_secret"},
+                                       {"second_id", "second_secret"}},
+      PoolPolicy::kRoundRobin);
+  Authenticator auth{curl_, "", pool};
+  Value first_token;
+  Value second_token;
+  size_t credential = 0;
+
+  first_token["access_token"] = "first_token";
+  first_token["expires_in"] = 3600;
+  second_token["access_token"] = "second_token";
+  second_token["expires_in"] = 3600;
+
+  EXPECT_CALL(*curl_, Post(KLoginUri_, _, _))
+      .Times(2)
+      .WillOnce(Return(first_token))
+      .WillOnce(Return(second_token));
+
+  auto first = auth.Token("umbrella", &credential);
+  auto second = auth.Token("cheap thrills", &credential);
+  auto third = auth.Token("umbrella", &credential);
+
+  EXPECT_EQ("first_token", first);
+  EXPECT_EQ("second_token", second);
+  EXPECT_EQ("first_token", third);
+}
@@ -0,0 +1,195 @@
+/**
+ * @file
+ *
+ * @brief Call context test class implementation.
+ */
+#include "private/call_context.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "spotify.h"
+#include "mock/access_listener_mock.h"
+#include "mock/curl_wrapper_mock.h"
+#include "mock/metrics_sink_mock.h"
+#include "mock/search_listener_mock.h"
+#include "private/authenticator.h"
+#include "private/searcher.h"
+
+using spotify_lib::Authenticator;
+using spotify_lib::CallAbortedError;
+using spotify_lib::CallContext;
+using spotify_lib::CallOptions;
+using spotify_lib::CallScope;
+using spotify_lib::CancellationToken;
+using spotify_lib::Searcher;
+using spotify_lib::Spotify;
+using spotify_lib::test::AccessListenerMock;
+using spotify_lib::test::CurlWrapperMock;
+using spotify_lib::test::MetricsSinkMock;
+using spotify_lib::test::SearchListenerMock;
+
+using std::make_shared;
+using std::runtime_error;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+using std::chrono::milliseconds;
+using std::chrono::steady_clock;
+
+using Json::Value;
+
+using testing::_;
+using testing::InvokeWithoutArgs;
+using testing::Return;
+using testing::StrEq;
+using testing::Test;
+using testing::Throw;
+
+class CallContextTest : public Test {
+ public:
+  CallContextTest()
+      : curl_{make_shared<CurlWrapperMock>()},
+        sink_{make_shared<MetricsSinkMock>()},
+        lib_{make_shared<Authenticator>(curl_), make_shared<Searcher>(curl_),
+             nullptr, nullptr, sink_} {}
+
+ protected:
+  shared_ptr<CurlWrapperMock> curl_;  //!< Curl wrapper mock instance.
+  shared_ptr<MetricsSinkMock> sink_;  //!< Metrics sink mock instance.
+  Spotify lib_;                       //!< Spotify instance.
+};
+
+/**
+ * @brief This tests validates the scenario when no call of the library is
+ * running. When this occurs, the context must have no operation.
+ */
+TEST_F(CallContextTest, W_NoCallIsRunning_S_TheOperationIsEmpty) {
+  EXPECT_STREQ("", CallContext::Current().operation);
+}
+
+/**
+ * @brief This tests validates the scenario when a scope is opened inside
+ * another one. When this occurs, the inner context must be replaced by the
+ * outer one once the inner scope ends.
+ */
+TEST_F(CallContextTest, W_ScopesAreNested_S_RestoreTheOuterContext) {
+  {
+    CallScope outer{CallContext("search")};
+
+    {
+      CallScope inner{CallContext("auth")};
+
+      EXPECT_STREQ("auth", CallContext::Current().operation);
+      EXPECT_EQ(steady_clock::time_point::max(),
+                CallContext::Current().deadline);
+      EXPECT_EQ(nullptr, CallContext::Current().token);
+    }
+
+    EXPECT_STREQ("search", CallContext::Current().operation);
+  }
+
+  EXPECT_STREQ("", CallContext::Current().operation);
+}
+
+/**
+ * @brief This tests validates the scenario when the user searches a music
+ * with a metrics sink. When this occurs, the request must be made in the
+ * context of the search and the search must be reported to the sink.
+ */
+TEST_F(CallContextTest, W_UserSearchesWithAMetricsSink_S_ReportTheSearch) {
+  SearchListenerMock listener;
+  string operation;
+
+  EXPECT_CALL(*curl_, Get(_, _)).WillOnce(InvokeWithoutArgs([&operation] {
+    operation = CallContext::Current().operation;
+
+    return Value{};
+  }));
+  EXPECT_CALL(*sink_, OnOperation(StrEq("search"), _, false)).Times(1);
+  EXPECT_CALL(listener, OnPatternFound(_)).Times(1);
+
+  lib_.Search(listener, "token", "umbrella");
+
+  EXPECT_EQ("search", operation);
+  EXPECT_STREQ("", CallContext::Current().operation);
+}
+
+/**
+ * @brief This tests validates the scenario when the user authentication fails
+ * with a metrics sink. When this occurs, the authentication must be reported
+ * to the sink as failed.
+ */
+TEST_F(CallContextTest, W_UserAuthFailsWithAMetricsSink_S_ReportTheFailure) {
+  AccessListenerMock listener;
+
+  EXPECT_CALL(*curl_, Post(_, _, _))
+      .WillOnce(Throw(runtime_error("some cool error message")));
+  EXPECT_CALL(*sink_, OnOperation(StrEq("auth"), _, true)).Times(1);
+  EXPECT_CALL(listener, OnAccessDenied(_)).Times(1);
+
+  lib_.Auth(listener, "id", "secret");
+}
+
+/**
+ * @brief This tests validates the scenario when the token of a call is
+ * cancelled. When this occurs, the check of its context must fail.
+ */
+TEST_F(CallContextTest, W_TokenIsCancelled_S_CheckThrows) {
+  auto token = make_shared<CancellationToken>();
+  CallContext context{"search", steady_clock::time_point::max(), token};
+
+  EXPECT_NO_THROW(context.Check());
+
+  token->Cancel();
+
+  EXPECT_TRUE(context.Cancelled());
+  EXPECT_THROW(context.Check(), CallAbortedError);
+}
+
+/**
+ * @brief This tests validates the scenario when the deadline of a call is
+ * close or past. When this occurs, the context must tell that it expires and
+ * its check must fail once the deadline is past.
+ */
+TEST_F(CallContextTest, W_DeadlineIsReached_S_CheckThrows) {
+  CallContext close{"search", steady_clock::now() + milliseconds{500}};
+  CallContext past{"search", steady_clock::now() - milliseconds{1}};
+
+  EXPECT_FALSE(CallContext{}.Expires(milliseconds{1000000}));
+  EXPECT_FALSE(close.Expires());
+  EXPECT_TRUE(close.Expires(milliseconds{1000}));
+  EXPECT_NO_THROW(close.Check());
+  EXPECT_THROW(past.Check(), CallAbortedError);
+}
+
+/**
+ * @brief This tests validates the scenario when the user searches a music
+ * with a deadline and a cancellation token. When this occurs, the request
+ * must be made in a context carrying both.
+ */
+TEST_F(CallContextTest, W_UserSearchesWithCallOptions_S_PropagateThem) {
+  SearchListenerMock listener;
+  CallOptions options{steady_clock::now() + milliseconds{500},
+                      make_shared<CancellationToken>()};
+  CallContext context;
+
+  EXPECT_CALL(*curl_, Get(_, _)).WillOnce(InvokeWithoutArgs([&context] {
+    context = CallContext::Current();
+
+    return Value{};
+  }));
+  EXPECT_CALL(*sink_, OnOperation(StrEq("search"), _, false)).Times(1);
+  EXPECT_CALL(listener, OnPatternFound(_)).Times(1);
+
+  lib_.Search(listener, "token", "umbrella", options);
+
+  EXPECT_TRUE(context.deadline == options.deadline);
+  EXPECT_EQ(options.token, context.token);
+  EXPECT_EQ(nullptr, CallContext::Current().token);
+}
@@ -0,0 +1,191 @@
+/**
+ * @file
+ *
+ * @brief Concurrency limiter test class implementation.
+ */
+#include "private/concurrency_limiter.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <thread>
+
+#include "private/call_context.h"
+
+using spotify_lib::CallAbortedError;
+using spotify_lib::CallContext;
+using spotify_lib::CallScope;
+using spotify_lib::CancellationToken;
+using spotify_lib::ConcurrencyLimiter;
+using spotify_lib::LimiterOptions;
+
+using std::make_shared;
+using std::size_t;
+using std::thread;
+using std::chrono::microseconds;
+using std::chrono::milliseconds;
+
+using testing::Test;
+
+class ConcurrencyLimiterTest : public Test {
+ protected:
+  /**
+   * @brief Build the limiter settings.
+   *
+   * @param limit Starting window.
+   * @param max_queued Requests waiting for the window.
+   *
+   * @return The settings.
+   */
+  static LimiterOptions Options(size_t limit, size_t max_queued) {
+    LimiterOptions options;
+
+    options.initial_limit = limit;
+    options.min_limit = 2;
+    options.max_limit = 16;
+    options.backoff_ratio = 0.5;
+    options.max_queued = max_queued;
+
+    return options;
+  }
+
+  const microseconds kLatency_{1000}; //!< Latency of the requests.
+};
+
+/**
+ * @brief This tests validates the scenario when the window is full. When this
+ * occurs, the limiter must queue the next requests and grant their slots in
+ * order as the others finish, then shed the requests beyond the queue.
+ */
+TEST_F(ConcurrencyLimiterTest, W_WindowIsFull_S_QueueThenShed) {
+  ConcurrencyLimiter limiter{Options(2, 1)};
+  int granted = 0;
+
+  EXPECT_TRUE(limiter.Acquire());
+  EXPECT_TRUE(limiter.Acquire());
+  EXPECT_TRUE(limiter.AcquireAsync([&granted] { granted++; }));
+  EXPECT_FALSE(limiter.AcquireAsync([&granted] { granted++; }));
+
+  auto stats = limiter.Stats();
+
+  EXPECT_EQ(granted, 0);
+  EXPECT_EQ(stats.in_flight, 2u);
+  EXPECT_EQ(stats.queued, 1u);
+  EXPECT_EQ(stats.shed, 1u);
+
+  limiter.Release(ConcurrencyLimiter::Outcome::kIgnored, kLatency_);
+
+  EXPECT_EQ(granted, 1);
+  EXPECT_EQ(limiter.Stats().in_flight, 2u);
+  EXPECT_EQ(limiter.Stats().queued, 0u);
+}
+
+/**
+ * @brief This tests validates the scenario when the requests are rejected by
+ * the server. When this occurs, the limiter must shrink the window, once per
+ * round trip and not below the minimum.
+ */
+TEST_F(ConcurrencyLimiterTest, W_RequestsAreDropped_S_ShrinkTheWindow) {
+  ConcurrencyLimiter limiter{Options(8, 0)};
+
+  for (int i = 0; i < 8; i++) {
+    limiter.Acquire();
+  }
+
+  /* the drops of the same round trip count as a single one. */
+  limiter.Release(ConcurrencyLimiter::Outcome::kDropped, kLatency_);
+  limiter.Release(ConcurrencyLimiter::Outcome::kDropped, kLatency_);
+
+  EXPECT_EQ(limiter.Stats().limit, 4u);
+  EXPECT_FALSE(limiter.Acquire());
+}
+
+/**
+ * @brief This tests validates the scenario when the requests complete within
+ * the usual latency with a busy window. When this occurs, the limiter must
+ * widen the window, up to the maximum, and shrink it on a latency spike.
+ */
+TEST_F(ConcurrencyLimiterTest, W_RequestsSucceed_S_WidenTheWindow) {
+  ConcurrencyLimiter limiter{Options(4, 0)};
+
+  for (int i = 0; i < 200; i++) {
+    while (limiter.Stats().in_flight < limiter.Stats().limit) {
+      limiter.Acquire();
+    }
+
+    limiter.Release(ConcurrencyLimiter::Outcome::kSuccess, kLatency_);
+  }
+
+  EXPECT_EQ(limiter.Stats().limit, 16u);
+
+  limiter.Release(ConcurrencyLimiter::Outcome::kSuccess, kLatency_ * 10);
+
+  EXPECT_EQ(limiter.Stats().limit, 8u);
+}
+
+/**
+ * @brief This tests validates the scenario when a request waiting for a slot
+ * is cancelled. When this occurs, the wait must end with an error, and the
+ * slot granted afterwards must go back to the window.
+ */
+TEST_F(ConcurrencyLimiterTest, W_WaitingRequestIsCancelled_S_GiveTheSlotBack) {
+  ConcurrencyLimiter limiter{Options(2, 4)};
+  auto token = make_shared<CancellationToken>();
+  CallContext context;
+
+  context.token = token;
+
+  EXPECT_TRUE(limiter.Acquire());
+  EXPECT_TRUE(limiter.Acquire());
+
+  thread canceller{[&token] {
+    std::this_thread::sleep_for(milliseconds{20});
+    token->Cancel();
+  }};
+
+  {
+    CallScope scope{context};
+
+    EXPECT_THROW(limiter.Acquire(), CallAbortedError);
+  }
+
+  canceller.join();
+  limiter.Release(ConcurrencyLimiter::Outcome::kIgnored, kLatency_);
+
+  EXPECT_EQ(limiter.Stats().in_flight, 1u);
+  EXPECT_EQ(limiter.Stats().queued, 0u);
+  EXPECT_TRUE(limiter.TryAcquire());
+}
+
+/**
+ * @brief This tests validates the scenario when a first, cold request to a
+ * slower host completes among warm requests to a faster one. When this
+ * occurs, its latency must be compared with its own host's, and the window
+ * keep widening rather than collapse.
+ */
+TEST_F(ConcurrencyLimiterTest, W_ColdRequestToASlowerHost_S_KeepTheWindow) {
+  ConcurrencyLimiter limiter{Options(4, 0)};
+  size_t limit = 0;
+
+  for (int i = 0; i < 200; i++) {
+    while (limiter.Stats().in_flight < limiter.Stats().limit) {
+      limiter.Acquire();
+    }
+
+    /* the slower host answers in tens of milliseconds, the first request
+     * slower than the next ones. */
+    if (i % 10 == 5) {
+      limiter.Release(ConcurrencyLimiter::Outcome::kSuccess,
+                      kLatency_ * (i == 5 ? 60 : 40), "accounts.spotify.com");
+    } else {
+      limiter.Release(ConcurrencyLimiter::Outcome::kSuccess, kLatency_,
+                      "api.spotify.com");
+    }
+
+    EXPECT_GE(limiter.Stats().limit, limit);
+    limit = limiter.Stats().limit;
+  }
+
+  EXPECT_EQ(limiter.Stats().limit, 16u);
+}
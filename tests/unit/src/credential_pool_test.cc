@@ -0,0 +1,125 @@
+/**
+ * @file
+ *
+ * @brief Credential pool test class implementation.
+ */
+#include "private/credential_pool.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "private/http_error.h"
+
+using spotify_lib::CredentialPool;
+using spotify_lib::HttpError;
+using spotify_lib::PoolPolicy;
+
+using std::size_t;
+using std::string;
+using std::unique_ptr;
+using std::chrono::milliseconds;
+using std::chrono::seconds;
+using std::this_thread::sleep_for;
+
+using testing::Test;
+
+class CredentialPoolTest : public Test {
+ protected:
+  /**
+   * @brief Make a pool of three credentials.
+   *
+   * @param policy Assignment of the calls.
+   *
+   * @return The pool.
+   */
+  static unique_ptr<CredentialPool> MakePool(PoolPolicy policy) {
+    return unique_ptr<CredentialPool>{
+        new CredentialPool{{{"first_id", "first_secret"},
+                            {"second_id", "second_secret"},
+                            {"third_id", "third_secret"}},
+                           policy}};
+  }
+};
+
+/**
+ * @brief This tests validates the scenario when the calls are assigned round
+ * robin and a credential is rate limited. When this occurs, the credentials
+ * must be picked in turn, skipping the parked one.
+ */
+TEST_F(CredentialPoolTest, W_CredentialIsLimited_S_SkipItInTurn) {
+  auto pool = MakePool(PoolPolicy::kRoundRobin);
+
+  EXPECT_EQ(0u, pool->Pick("umbrella"));
+  EXPECT_EQ(1u, pool->Pick("umbrella"));
+  EXPECT_EQ(2u, pool->Pick("umbrella"));
+
+  pool->Park(1, seconds{30});
+
+  EXPECT_EQ(0u, pool->Pick("umbrella"));
+  EXPECT_EQ(2u, pool->Pick("umbrella"));
+  EXPECT_EQ(2u, pool->Pick("umbrella"));
+  EXPECT_EQ("third_id", pool->At(2).client_id);
+}
+
+/**
+ * @brief This tests validates the scenario when every credential is rate
+ * limited. When this occurs, the pick must fail with a 429 telling when the
+ * first one is back.
+ */
+TEST_F(CredentialPoolTest, W_EveryCredentialIsLimited_S_ReturnFailure) {
+  auto pool = MakePool(PoolPolicy::kRoundRobin);
+
+  pool->Park(0, seconds{30});
+  pool->Park(1, seconds{10});
+  pool->Park(2, seconds{20});
+
+  try {
+    pool->Pick("umbrella");
+    FAIL();
+  } catch (const HttpError& e) {
+    EXPECT_EQ(429, e.Status());
+    EXPECT_EQ(seconds{10}, e.RetryAfter());
+  }
+}
+
+/**
+ * @brief This tests validates the scenario when the calls go to the least
+ * recently limited credential. When this occurs, the credentials never
+ * limited must be picked first, then the one limited the longest ago.
+ */
+TEST_F(CredentialPoolTest, W_CallsGoToTheLeastLimited_S_PickTheOldestLimit) {
+  auto pool = MakePool(PoolPolicy::kLeastRecentlyLimited);
+
+  /* a zero Retry-After parks for a second. */
+  pool->Park(0, seconds{0});
+  pool->Park(2, seconds{0});
+  sleep_for(milliseconds{1100});
+
+  EXPECT_EQ(1u, pool->Pick("umbrella"));
+  EXPECT_EQ(1u, pool->Pick("cheap thrills"));
+
+  pool->Park(1, seconds{30});
+
+  EXPECT_EQ(0u, pool->Pick("umbrella"));
+}
+
+/**
+ * @brief This tests validates the scenario when the calls are assigned by
+ * query. When this occurs, the calls of a query must stick to a credential
+ * until it's rate limited.
+ */
+TEST_F(CredentialPoolTest, W_CallsAreAssignedByQuery_S_StickToACredential) {
+  auto pool = MakePool(PoolPolicy::kQueryHash);
+  size_t picked = pool->Pick("umbrella");
+
+  EXPECT_EQ(picked, pool->Pick("umbrella"));
+
+  pool->Park(picked, seconds{30});
+
+  EXPECT_NE(picked, pool->Pick("umbrella"));
+}
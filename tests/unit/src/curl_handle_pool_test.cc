@@ -0,0 +1,76 @@
+/**
+ * @file
+ *
+ * @brief Curl handle pool test class implementation.
+ */
+#include "private/curl_handle_pool.h"
+
+#include <gtest/gtest.h>
+
+using spotify_lib::CurlHandlePool;
+
+using testing::Test;
+
+class CurlHandlePoolTest : public Test {};
+
+/**
+ * @brief This tests validates the scenario when a handle is released back to
+ * the pool and checked out again. When this occurs, the pool must hand out the
+ * same handle, so its connections are reused.
+ */
+TEST_F(CurlHandlePoolTest, W_HandleIsReleased_S_ReuseTheSameHandle) {
+  CurlHandlePool pool{2};
+  CURL *first = nullptr;
+
+  {
+    auto lease = pool.Acquire();
+
+    first = lease.Get();
+    ASSERT_NE(first, nullptr);
+    EXPECT_EQ(pool.IdleCount(), 0u);
+  }
+
+  EXPECT_EQ(pool.IdleCount(), 1u);
+
+  auto lease = pool.Acquire();
+
+  EXPECT_EQ(lease.Get(), first);
+  EXPECT_EQ(pool.IdleCount(), 0u);
+}
+
+/**
+ * @brief This tests validates the scenario when several handles are checked
+ * out at the same time. When this occurs, each lease must own a distinct
+ * handle and the pool must keep at most its limit of idle handles.
+ */
+TEST_F(CurlHandlePoolTest, W_ConcurrentLeases_S_UseDistinctHandles) {
+  CurlHandlePool pool{2};
+
+  {
+    auto a = pool.Acquire();
+    auto b = pool.Acquire();
+    auto c = pool.Acquire();
+
+    EXPECT_NE(a.Get(), b.Get());
+    EXPECT_NE(b.Get(), c.Get());
+    EXPECT_NE(a.Get(), c.Get());
+  }
+
+  EXPECT_EQ(pool.IdleCount(), 2u);
+}
+
+/**
+ * @brief This tests validates the scenario when the pool has no room for idle
+ * handles. When this occurs, released handles must be destroyed.
+ */
+TEST_F(CurlHandlePoolTest, W_PoolWithoutIdleRoom_S_DiscardReleasedHandles) {
+  CurlHandlePool pool{0};
+
+  {
+    auto lease = pool.Acquire();
+
+    EXPECT_NE(lease.Get(), nullptr);
+  }
+
+  EXPECT_EQ(pool.IdleCount(), 0u);
+}
@@ -0,0 +1,150 @@
+/**
+ * @file
+ *
+ * @brief Curl share test class implementation.
+ */
+#include "private/curl_share.h"
+
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <cstddef>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+
+#include "mock/local_http_server.h"
+#include "mock/local_tls_server.h"
+
+using spotify_lib::CurlShare;
+using spotify_lib::test::LocalHttpServer;
+using spotify_lib::test::LocalTlsServer;
+
+using std::runtime_error;
+using std::size_t;
+using std::string;
+using std::to_string;
+
+using testing::Test;
+
+class CurlShareTest : public Test {
+ public:
+  CurlShareTest()
+      : server_{[](const string & /* head */) {
+          return LocalHttpServer::Ok("{}");
+        }} {
+    char path[] = "/tmp/curl_share_XXXXXX";
+
+    close(mkstemp(path));
+    unlink(path);
+    path_ = path;
+  }
+
+  ~CurlShareTest() { unlink(path_.c_str()); }
+
+ protected:
+  /**
+   * @brief Request the server through a host name only known to some handles.
+   *
+   * @param share Share handle of the request, may be null.
+   * @param resolve Whether the handle knows the address of the host.
+   *
+   * @return Result of the transfer.
+   */
+  CURLcode Request(CURLSH *share, bool resolve) const {
+    string port = to_string(server_.Port());
+    string uri = "http://" + kHost_ + ':' + port + '/';
+    string entry = kHost_ + ':' + port + ":127.0.0.1";
+    curl_slist *entries = curl_slist_append(nullptr, entry.c_str());
+    CURL *handle = curl_easy_init();
+
+    curl_easy_setopt(handle, CURLOPT_URL, uri.c_str());
+    curl_easy_setopt(handle, CURLOPT_PROXY, "");
+    curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION,
+                     +[](char *, size_t size, size_t nmemb, void *) {
+                       return size * nmemb;
+                     });
+
+    if (share) {
+      curl_easy_setopt(handle, CURLOPT_SHARE, share);
+    }
+
+    if (resolve) {
+      curl_easy_setopt(handle, CURLOPT_RESOLVE, entries);
+    }
+
+    CURLcode ret = curl_easy_perform(handle);
+
+    curl_easy_cleanup(handle);
+    curl_slist_free_all(entries);
+
+    return ret;
+  }
+
+  const string kHost_{"spotify-lib.test"};  //!< Host only known by the cache.
+  LocalHttpServer server_;  //!< Server answering the requests.
+  string path_;             //!< Path of the session file.
+};
+
+/**
+ * @brief This tests validates the scenario when a host is resolved by a
+ * handle using the share. When this occurs, the other handles using it must
+ * find the address in the shared DNS cache, and the ones not using it must
+ * not.
+ */
+TEST_F(CurlShareTest, W_HostIsResolvedByOneHandle_S_ShareTheAddress) {
+  CurlShare share;
+
+  ASSERT_EQ(CURLE_OK, Request(share.Get(), true));
+
+  EXPECT_EQ(CURLE_OK, Request(share.Get(), false));
+  EXPECT_NE(CURLE_OK, Request(nullptr, false));
+  EXPECT_EQ(2u, server_.Heads().size());
+}
+
+/**
+ * @brief This tests validates the scenario when a share is made with and
+ * without a session file. When this occurs, the TLS sessions must only be
+ * kept in a store given a file, which requires libcurl to export them.
+ */
+TEST_F(CurlShareTest, W_SessionFileIsGiven_S_KeepTheSessionsInAStore) {
+  EXPECT_EQ(nullptr, CurlShare{}.Sessions());
+
+  try {
+    EXPECT_NE(nullptr, CurlShare{path_}.Sessions());
+  } catch (const runtime_error &) {
+    EXPECT_EQ(CURLE_NOT_BUILT_IN,
+              curl_easy_ssls_export(nullptr, nullptr, nullptr));
+  }
+}
+
+/**
+ * @brief This tests validates the scenario when a host is contacted twice
+ * through a share. When this occurs, the second handshake must resume the
+ * session of the first one.
+ */
+TEST_F(CurlShareTest, W_HostIsContactedTwice_S_ResumeTheTlsSession) {
+  CurlShare share;
+  LocalTlsServer server;
+
+  for (int i = 0; i < 2; i++) {
+    string uri = server.Uri("/");
+    CURL *handle = curl_easy_init();
+
+    curl_easy_setopt(handle, CURLOPT_URL, uri.c_str());
+    curl_easy_setopt(handle, CURLOPT_PROXY, "");
+    curl_easy_setopt(handle, CURLOPT_SHARE, share.Get());
+    curl_easy_setopt(handle, CURLOPT_CAINFO, server.CaFile().c_str());
+    curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION,
+                     +[](char *, size_t size, size_t nmemb, void *) {
+                       return size * nmemb;
+                     });
+
+    EXPECT_EQ(CURLE_OK, curl_easy_perform(handle));
+    curl_easy_cleanup(handle);
+  }
+
+  EXPECT_EQ(2u, server.Handshakes());
+  EXPECT_EQ(1u, server.Resumed());
+}
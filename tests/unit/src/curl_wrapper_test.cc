@@ -0,0 +1,433 @@
+/**
+ * @file
+ *
+ * @brief Curl wrapper test class implementation.
+ */
+#include "private/curl_wrapper.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "mock/local_http_server.h"
+#include "mock/metrics_sink_mock.h"
+
+using spotify_lib::CurlOptions;
+using spotify_lib::CurlWrapper;
+using spotify_lib::HttpError;
+using spotify_lib::RequestMetrics;
+using spotify_lib::test::LocalHttpServer;
+using spotify_lib::test::MetricsSinkMock;
+
+using std::atomic;
+using std::make_shared;
+using std::runtime_error;
+using std::size_t;
+using std::string;
+using std::thread;
+using std::vector;
+using std::chrono::milliseconds;
+using std::chrono::steady_clock;
+
+using testing::_;
+using testing::SaveArg;
+using testing::Test;
+
+class CurlWrapperTest : public Test {
+ public:
+  CurlWrapperTest() : server_{Reply} {}
+
+ protected:
+  /**
+   * @brief Build the reply of the server. The padded search replies are
+   * gzip encoded when the client accepts it.
+   *
+   * @param head Head of the request.
+   *
+   * @return The reply.
+   */
+  static string Reply(const string &head) {
+    if (head.compare(0, 11, "GET /padded") != 0) {
+      return LocalHttpServer::Ok("{\"tracks\":{\"items\":[]}}");
+    }
+
+    if (head.find("Accept-Encoding:") == string::npos ||
+        head.find("gzip") == string::npos) {
+      return LocalHttpServer::Ok(PaddedBody());
+    }
+
+    /* the padded body, gzip encoded. */
+    static const char kEncoded[] =
+        "\x1f\x8b\x08\x00\x00\x00\x00\x00\x02\x03\xab\x56\x2a\x29\x4a\x4c"
+        "\xce\x2e\x56\xb2\xaa\x56\xca\x2c\x49\xcd\x05\x32\xa2\x63\x75\x94"
+        "\x0a\x12\x53\x52\x32\xf3\xd2\x95\xac\x94\x12\x47\xc1\x28\x18\x05"
+        "\xa3\x60\x14\x8c\x82\x51\x30\xe4\x81\x52\x6d\x2d\x00\x41\xbf\x40"
+        "\x6c\xf4\x07\x00\x00";
+
+    return LocalHttpServer::Ok(string{kEncoded, sizeof(kEncoded) - 1},
+                               "Content-Encoding: gzip\r\n");
+  }
+
+  /**
+   * @brief Get the body of the padded search replies, before encoding.
+   *
+   * @return The body.
+   */
+  static string PaddedBody() {
+    return "{\"tracks\":{\"items\":[],\"padding\":\"" + string(2000, 'a') +
+           "\"}}";
+  }
+
+  /**
+   * @brief Build the wrapper settings.
+   *
+   * @param http2 Whether the HTTP/2 mode is on.
+   *
+   * @return The settings.
+   */
+  static CurlOptions Options(bool http2) {
+    CurlOptions options;
+
+    options.http2 = http2;
+    options.cache_bytes = 0;
+
+    return options;
+  }
+
+  /**
+   * @brief Build a reply rejecting the request.
+   *
+   * @param status Status of the reply.
+   * @param retry_after Retry-After header value, none if empty.
+   *
+   * @return The reply.
+   */
+  static string Rejected(int status, const string &retry_after) {
+    return "HTTP/1.1 " + std::to_string(status) + " Rejected\r\n" +
+           (retry_after.empty() ? "" : "Retry-After: " + retry_after + "\r\n") +
+           "Content-Length: 0\r\n\r\n";
+  }
+
+  /**
+   * @brief Check whether libcurl can speak HTTP/2.
+   *
+   * @return true if so, false otherwise.
+   */
+  static bool Http2Supported() {
+    return curl_version_info(CURLVERSION_NOW)->features & CURL_VERSION_HTTP2;
+  }
+
+  LocalHttpServer server_;  //!< Server answering the requests.
+};
+
+/**
+ * @brief This tests validates the scenario when the HTTP/2 mode is asked for.
+ * When this occurs, the wrapper must be built if libcurl supports HTTP/2, and
+ * refuse to otherwise.
+ */
+TEST_F(CurlWrapperTest, W_Http2ModeIsAskedFor_S_RequireLibcurlSupport) {
+  if (Http2Supported()) {
+    EXPECT_NO_THROW(CurlWrapper{Options(true)});
+  } else {
+    EXPECT_THROW(CurlWrapper{Options(true)}, runtime_error);
+  }
+}
+
+/**
+ * @brief This tests validates the scenario when blocking requests are made
+ * from several threads in HTTP/2 mode. When this occurs, each one must be
+ * answered through the event thread, the cleartext ones falling back to
+ * HTTP/1.1 without asking for an upgrade.
+ */
+TEST_F(CurlWrapperTest, W_Http2ModeIsOn_S_RunTheBlockingCallsOnTheEngine) {
+  if (!Http2Supported()) {
+    GTEST_SKIP();
+  }
+
+  CurlWrapper curl{Options(true)};
+  vector<thread> threads;
+  vector<string> results(8);
+
+  for (size_t i = 0; i < results.size(); i++) {
+    threads.emplace_back([this, &curl, &results, i] {
+      results[i] = curl.Get(server_.Uri("/search?q=" + std::to_string(i)), {})
+                       ["tracks"]["items"]
+                           .toStyledString();
+    });
+  }
+
+  for (auto &t : threads) {
+    t.join();
+  }
+
+  EXPECT_EQ(vector<string>(results.size(), "[]\n"), results);
+  EXPECT_EQ(results.size(), curl.Stats().requests);
+
+  for (auto &head : server_.Heads()) {
+    EXPECT_NE(string::npos, head.find(" HTTP/1.1\r\n"));
+    EXPECT_EQ(string::npos, head.find("Upgrade: h2c"));
+  }
+}
+
+/**
+ * @brief This tests validates the scenario when requests are made one after
+ * the other in HTTP/2 mode. When this occurs, they must all go over the
+ * connection kept by the event thread.
+ */
+TEST_F(CurlWrapperTest, W_Http2ModeIsOn_S_KeepTheEngineConnection) {
+  if (!Http2Supported()) {
+    GTEST_SKIP();
+  }
+
+  CurlWrapper curl{Options(true)};
+
+  for (int i = 0; i < 5; i++) {
+    curl.Get(server_.Uri("/search?q=" + std::to_string(i)), {});
+  }
+
+  EXPECT_EQ(5u, curl.Stats().requests);
+  EXPECT_EQ(1u, curl.Stats().connections);
+  EXPECT_EQ(1u, server_.Connections());
+}
+
+/**
+ * @brief This tests validates the scenario when a reply is requested with the
+ * compression on. When this occurs, the encodings supported must be offered,
+ * the reply decoded, and the bytes on the wire counted apart from the body.
+ */
+TEST_F(CurlWrapperTest, W_CompressionIsOn_S_AcceptEncodedReplies) {
+  CurlWrapper curl{Options(false)};
+
+  auto reply = curl.Get(server_.Uri("/padded"), {});
+  auto stats = curl.Stats();
+
+  EXPECT_EQ(2000u, reply["tracks"]["padding"].asString().size());
+  EXPECT_EQ(PaddedBody().size(), stats.body_bytes);
+  EXPECT_LT(stats.wire_bytes, stats.body_bytes / 4);
+  ASSERT_EQ(1u, server_.Heads().size());
+  EXPECT_NE(string::npos, server_.Heads()[0].find("Accept-Encoding:"));
+}
+
+/**
+ * @brief This tests validates the scenario when a reply is requested with the
+ * compression off. When this occurs, no encoding must be offered, and the
+ * whole body must be counted on the wire.
+ */
+TEST_F(CurlWrapperTest, W_CompressionIsOff_S_CountTheWholeBodyOnTheWire) {
+  auto options = Options(false);
+
+  options.compression = false;
+
+  CurlWrapper curl{options};
+
+  curl.Get(server_.Uri("/padded"), {});
+
+  auto stats = curl.Stats();
+
+  EXPECT_EQ(PaddedBody().size(), stats.body_bytes);
+  EXPECT_GT(stats.wire_bytes, stats.body_bytes);
+  ASSERT_EQ(1u, server_.Heads().size());
+  EXPECT_EQ(string::npos, server_.Heads()[0].find("Accept-Encoding:"));
+}
+
+/**
+ * @brief This tests validates the scenario when a request finishes with a
+ * metrics sink. When this occurs, the state of the concurrency limiter must be
+ * reported along with the request.
+ */
+TEST_F(CurlWrapperTest, W_RequestFinishes_S_ReportTheLimiterState) {
+  auto sink = make_shared<MetricsSinkMock>();
+  auto options = Options(false);
+  RequestMetrics metrics{};
+
+  options.metrics = sink;
+  options.limiter.initial_limit = 8;
+
+  EXPECT_CALL(*sink, OnRequest(_)).WillOnce(SaveArg<0>(&metrics));
+
+  CurlWrapper curl{options};
+
+  curl.Get(server_.Uri("/search"), {});
+
+  EXPECT_EQ(200, metrics.status);
+  EXPECT_EQ(curl.Stats().limit, metrics.limit);
+  EXPECT_GE(metrics.limit, 8u);
+  EXPECT_EQ(0u, metrics.queued);
+  EXPECT_EQ(0u, metrics.shed);
+}
+
+/**
+ * @brief This tests validates the scenario when a reply announces a body far
+ * larger than it sends. When this occurs, the length must only be taken as a
+ * bounded hint, and the request fail with an error rather than abort the
+ * process.
+ */
+TEST_F(CurlWrapperTest, W_ReplyAnnouncesAHugeBody_S_FailTheRequest) {
+  LocalHttpServer server{[](const string &) {
+    return string{"HTTP/1.1 200 OK\r\nContent-Type: application/json\r\n"
+                  "Content-Length: 4611686018427387904\r\n\r\n{\"tracks\""};
+  }};
+  auto options = Options(false);
+
+  options.timeout = milliseconds{500};
+  options.retry.max_retries = 0;
+
+  CurlWrapper curl{options};
+
+  EXPECT_THROW(curl.Get(server.Uri("/search"), {}), std::exception);
+}
+
+/**
+ * @brief This tests validates the scenario when a GET is rate limited with a
+ * Retry-After header. When this occurs, the request must be sent again once
+ * the delay expires, and its reply returned.
+ */
+TEST_F(CurlWrapperTest, W_GetIsRateLimited_S_RetryAfterTheDelay) {
+  atomic<int> requests{0};
+  LocalHttpServer server{[&requests](const string &) {
+    return requests++ == 0 ? Rejected(429, "1")
+                           : LocalHttpServer::Ok("{\"tracks\":{}}");
+  }};
+  CurlWrapper curl{Options(false)};
+  auto start = steady_clock::now();
+
+  auto reply = curl.Get(server.Uri("/search"), {});
+
+  EXPECT_TRUE(reply.isMember("tracks"));
+  EXPECT_GE(steady_clock::now() - start, milliseconds{900});
+  EXPECT_EQ(2, requests);
+  EXPECT_EQ(1u, curl.Stats().retries);
+}
+
+/**
+ * @brief This tests validates the scenario when a POST fails on the server
+ * side. When this occurs, it must not be sent again, the server may have
+ * handled it, unless it was turned down with a Retry-After delay.
+ */
+TEST_F(CurlWrapperTest, W_PostFails_S_OnlyRetryItWhenTurnedDown) {
+  atomic<int> requests{0};
+  LocalHttpServer failing{[&requests](const string &) {
+    requests++;
+    return Rejected(500, "");
+  }};
+  CurlWrapper curl{Options(false)};
+
+  EXPECT_THROW(curl.Post(failing.Uri("/token"), {}, {}), HttpError);
+  EXPECT_EQ(1, requests);
+
+  atomic<int> unavailable{0};
+  LocalHttpServer busy{[&unavailable](const string &) {
+    return unavailable++ == 0 ? Rejected(503, "1")
+                              : LocalHttpServer::Ok("{\"token\":\"a\"}");
+  }};
+
+  EXPECT_EQ("a", curl.Post(busy.Uri("/token"), {}, {})["token"].asString());
+  EXPECT_EQ(2, unavailable);
+}
+
+/**
+ * @brief This tests validates the scenario when cached replies are requested
+ * again. When this occurs, the requests must carry the validators of the
+ * cached replies, and a 304 reply return the cached value.
+ */
+TEST_F(CurlWrapperTest, W_CachedReplyIsNotModified_S_ReturnTheCachedValue) {
+  LocalHttpServer server{[](const string &head) {
+    if (head.find("If-None-Match: \"1\"") != string::npos ||
+        head.find("If-Modified-Since: Sat, 17 Oct 2026") != string::npos) {
+      return string{"HTTP/1.1 304 Not Modified\r\nContent-Length: 0\r\n\r\n"};
+    }
+
+    if (head.compare(0, 10, "GET /etag ") == 0) {
+      return LocalHttpServer::Ok("{\"tracks\":\"etag\"}", "ETag: \"1\"\r\n");
+    }
+
+    return LocalHttpServer::Ok(
+        "{\"tracks\":\"date\"}",
+        "Last-Modified: Sat, 17 Oct 2026 10:00:00 GMT\r\n");
+  }};
+  auto options = Options(false);
+
+  options.cache_bytes = 1024 * 1024;
+
+  CurlWrapper curl{options};
+
+  for (int i = 0; i < 2; i++) {
+    EXPECT_EQ("etag", curl.Get(server.Uri("/etag"), {})["tracks"].asString());
+    EXPECT_EQ("date", curl.Get(server.Uri("/date"), {})["tracks"].asString());
+  }
+
+  auto heads = server.Heads();
+
+  EXPECT_EQ(2u, curl.Stats().cache_hits);
+  ASSERT_EQ(4u, heads.size());
+  EXPECT_NE(string::npos, heads[2].find("If-None-Match: \"1\""));
+  EXPECT_NE(string::npos, heads[3].find("If-Modified-Since:"));
+}
+
+/**
+ * @brief This tests validates the scenario when a GET is slower than the
+ * recent ones with hedging on. When this occurs, a duplicate must be sent if
+ * the limiter has a free slot, its reply returned without waiting for the
+ * slow one, which is cancelled; without a free slot, no duplicate is sent.
+ */
+TEST_F(CurlWrapperTest, W_GetIsSlow_S_HedgeItWithinTheLimiter) {
+  atomic<bool> released{false};
+  atomic<int> slow{0};
+  LocalHttpServer server{[&released, &slow](const string &head) {
+    if (head.compare(0, 10, "GET /slow ") != 0) {
+      return LocalHttpServer::Ok("{\"which\":\"warm\"}");
+    }
+
+    /* the first copy of each slow request stalls for a second. */
+    if (slow++ % 2 == 0) {
+      for (int i = 0; i < 100 && !released; i++) {
+        std::this_thread::sleep_for(milliseconds{10});
+      }
+
+      return LocalHttpServer::Ok("{\"which\":\"first\"}");
+    }
+
+    return LocalHttpServer::Ok("{\"which\":\"hedge\"}");
+  }};
+
+  for (size_t limit : {8u, 1u}) {
+    auto options = Options(false);
+
+    options.hedge.enabled = true;
+    options.hedge.budget = 1;
+    options.limiter.initial_limit = limit;
+    options.limiter.min_limit = limit;
+    options.limiter.max_limit = limit;
+
+    CurlWrapper curl{options};
+
+    for (int i = 0; i < 20; i++) {
+      curl.Get(server.Uri("/warm"), {});
+    }
+
+    auto start = steady_clock::now();
+    auto reply = curl.Get(server.Uri("/slow"), {});
+
+    if (limit > 1) {
+      EXPECT_EQ("hedge", reply["which"].asString());
+      EXPECT_LT(steady_clock::now() - start, milliseconds{800});
+      EXPECT_EQ(1u, curl.Stats().hedged);
+    } else {
+      /* the slot of the slow request is the only one. */
+      EXPECT_EQ("first", reply["which"].asString());
+      EXPECT_EQ(0u, curl.Stats().hedged);
+    }
+
+    EXPECT_EQ(0u, curl.Stats().queued);
+    slow = 0;
+  }
+
+  released = true;
+}
@@ -0,0 +1,99 @@
+/**
+ * @file
+ *
+ * @brief Hedge policy test class implementation.
+ */
+#include "private/hedge_policy.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+
+using spotify_lib::HedgeOptions;
+using spotify_lib::HedgePolicy;
+
+using std::chrono::microseconds;
+using std::chrono::milliseconds;
+
+using testing::Test;
+
+class HedgePolicyTest : public Test {
+ protected:
+  /**
+   * @brief Build the hedging settings.
+   *
+   * @param budget Hedges allowed per request.
+   *
+   * @return The settings.
+   */
+  static HedgeOptions Options(double budget) {
+    HedgeOptions options;
+
+    options.enabled = true;
+    options.percentile = 90;
+    options.min_delay = milliseconds{1};
+    options.budget = budget;
+    options.samples = 10;
+
+    return options;
+  }
+};
+
+/**
+ * @brief This tests validates the scenario when the latencies of the requests
+ * are recorded. When this occurs, the policy must only hedge once there are
+ * enough samples, after the configured percentile of them.
+ */
+TEST_F(HedgePolicyTest, W_LatenciesAreRecorded_S_HedgeAfterThePercentile) {
+  HedgePolicy policy{Options(0.1)};
+
+  for (int i = 1; i < 10; i++) {
+    policy.Record(milliseconds{i});
+  }
+
+  EXPECT_EQ(policy.Delay(), microseconds::zero());
+
+  policy.Record(milliseconds{10});
+
+  EXPECT_EQ(policy.Delay(), milliseconds{9});
+}
+
+/**
+ * @brief This tests validates the scenario when the requests are fast. When
+ * this occurs, the policy must still wait for the minimum delay.
+ */
+TEST_F(HedgePolicyTest, W_RequestsAreFast_S_WaitTheMinimumDelay) {
+  HedgePolicy policy{Options(0.1)};
+
+  for (int i = 0; i < 10; i++) {
+    policy.Record(microseconds{10});
+  }
+
+  EXPECT_EQ(policy.Delay(), milliseconds{1});
+}
+
+/**
+ * @brief This tests validates the scenario when many requests are slow. When
+ * this occurs, the policy must stop hedging once the budget is spent.
+ */
+TEST_F(HedgePolicyTest, W_BudgetIsSpent_S_StopHedging) {
+  HedgePolicy policy{Options(0.1)};
+
+  for (int i = 0; i < 20; i++) {
+    policy.Record(milliseconds{1});
+  }
+
+  /* a tenth of the requests, plus one of slack. */
+  EXPECT_TRUE(policy.Spend());
+  EXPECT_TRUE(policy.Spend());
+  EXPECT_TRUE(policy.Spend());
+  EXPECT_FALSE(policy.Spend());
+  EXPECT_EQ(policy.Hedges(), 3u);
+
+  for (int i = 0; i < 10; i++) {
+    policy.Record(milliseconds{1});
+  }
+
+  EXPECT_TRUE(policy.Spend());
+  EXPECT_FALSE(policy.Spend());
+}
@@ -0,0 +1,101 @@
+/**
+ * @file
+ *
+ * @brief Json stream splitter test class implementation.
+ */
+#include "private/json_stream_splitter.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+using spotify_lib::JsonStreamSplitter;
+
+using std::size_t;
+using std::string;
+using std::vector;
+
+using testing::Test;
+
+class JsonStreamSplitterTest : public Test {
+ protected:
+  /**
+   * @brief Feed a document one byte at a time.
+   *
+   * @param doc The document.
+   *
+   * @return The elements handed out by the splitter.
+   */
+  vector<string> SplitByteByByte(const string &doc) const {
+    vector<string> elements;
+    JsonStreamSplitter splitter{
+        {"tracks", "items"}, [&elements](const char *data, size_t size) {
+          elements.emplace_back(data, size);
+        }};
+
+    for (auto c : doc) {
+      splitter.Feed(&c, 1);
+    }
+
+    return elements;
+  }
+};
+
+/**
+ * @brief This tests validates the scenario when the document arrives one byte
+ * at a time. When this occurs, the splitter must hand out each element of the
+ * target array exactly as it appears in the document, ignoring the brackets,
+ * braces and quotes inside strings.
+ */
+TEST_F(JsonStreamSplitterTest, W_DocumentArrivesByteByByte_S_HandOutElements) {
+  const string kDoc{
+      "{\"href\": \"x\", \"tracks\": {\"items\": [ {\"name\": \"a]}\\\"{\", "
+      "\"album\": {\"artists\": [{\"name\": \"b\"}]}}, {\"items\": [1]} ], "
+      "\"total\": 2}}"};
+  const vector<string> kExpected{
+      "{\"name\": \"a]}\\\"{\", \"album\": {\"artists\": [{\"name\": \"b\"}]}}",
+      "{\"items\": [1]}"};
+
+  EXPECT_EQ(SplitByteByByte(kDoc), kExpected);
+}
+
+/**
+ * @brief This tests validates the scenario when an array with the same member
+ * name appears out of the target path. When this occurs, the splitter must not
+ * hand out its elements.
+ */
+TEST_F(JsonStreamSplitterTest, W_ArrayOutOfThePath_S_IgnoreItsElements) {
+  const string kDoc{
+      "{\"items\": [{\"a\": 1}], \"albums\": {\"items\": [{\"b\": 2}]}, "
+      "\"tracks\": {\"items\": []}}"};
+
+  EXPECT_TRUE(SplitByteByByte(kDoc).empty());
+}
+
+/**
+ * @brief This tests validates the scenario when the target array holds scalar
+ * values. When this occurs, the splitter must hand out each value without the
+ * separators.
+ */
+TEST_F(JsonStreamSplitterTest, W_ArrayOfScalars_S_HandOutEachValue) {
+  const string kDoc{"{\"tracks\": {\"items\": [1, \"a,b\" ,true]}}"};
+  const vector<string> kExpected{"1", "\"a,b\"", "true"};
+
+  EXPECT_EQ(SplitByteByByte(kDoc), kExpected);
+}
+
+/**
+ * @brief This tests validates the scenario when the member names hold escape
+ * sequences. When this occurs, the splitter must decode them before matching
+ * the path, neither dropping the escaped characters nor matching a name which
+ * only differs by them.
+ */
+TEST_F(JsonStreamSplitterTest, W_MemberNamesAreEscaped_S_MatchThemDecoded) {
+  const string kDoc{
+      "{\"tracks\\\"\": {\"items\": [9]}, \"trac\\\\ks\": {\"items\": [8]}, "
+      "\"tr\\u0061cks\": {\"it\\/ems\": [7], \"\\u0069tems\": [1, \"\\\"2\"]}}"};
+  const vector<string> kExpected{"1", "\"\\\"2\""};
+
+  EXPECT_EQ(SplitByteByByte(kDoc), kExpected);
+}
@@ -0,0 +1,80 @@
+/**
+ * @file
+ *
+ * @brief Prepared request test class implementation.
+ */
+#include "private/prepared_request.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+using spotify_lib::PreparedRequest;
+
+using std::string;
+using std::vector;
+
+using testing::Test;
+
+class PreparedRequestTest : public Test {
+ protected:
+  /**
+   * @brief Collect the lines of the header list handed to libcurl.
+   *
+   * @param request The request.
+   *
+   * @return The header lines.
+   */
+  static vector<string> ListLines(const PreparedRequest &request) {
+    vector<string> lines;
+
+    for (auto node = request.Headers(); node; node = node->next) {
+      lines.emplace_back(node->data);
+    }
+
+    return lines;
+  }
+
+  PreparedRequest request_{"https://api.spotify.com/v1/search?q={}&type=track",
+                           {"Accept: application/json",
+                            "Authorization: Bearer {}"}}; //!< Request.
+};
+
+/**
+ * @brief This tests validates the scenario when a request is bound. When this
+ * occurs, the uri, the headers, the header list and the key must carry the
+ * query and the token.
+ */
+TEST_F(PreparedRequestTest, W_RequestIsBound_S_PatchTheVaryingParts) {
+  const vector<string> kHeaders{"Accept: application/json",
+                                "Authorization: Bearer token"};
+
+  request_.Bind("the umbrella", "token");
+
+  EXPECT_EQ(request_.Uri(),
+            "https://api.spotify.com/v1/search?q=the+umbrella&type=track");
+  EXPECT_EQ(request_.HeaderLines(), kHeaders);
+  EXPECT_EQ(ListLines(request_), kHeaders);
+  EXPECT_EQ(request_.Key(), request_.Uri() + "\n" + kHeaders[0] + "\n" +
+                                kHeaders[1]);
+  EXPECT_EQ(request_.Host(), "api.spotify.com");
+}
+
+/**
+ * @brief This tests validates the scenario when a request is bound again with
+ * parts no longer than before. When this occurs, the request must reuse its
+ * storage instead of allocating.
+ */
+TEST_F(PreparedRequestTest, W_RequestIsBoundAgain_S_ReuseTheStorage) {
+  request_.Bind("umbrella", "long-token");
+
+  auto uri = request_.Uri().data();
+  auto header = request_.HeaderLines()[1].data();
+
+  request_.Bind("rain", "token");
+
+  EXPECT_EQ(request_.Uri().data(), uri);
+  EXPECT_EQ(request_.HeaderLines()[1].data(), header);
+  EXPECT_EQ(ListLines(request_)[1], "Authorization: Bearer token");
+}
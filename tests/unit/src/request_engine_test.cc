@@ -0,0 +1,174 @@
+/**
+ * @file
+ *
+ * @brief Request engine test class implementation.
+ */
+#include "private/request_engine.h"
+
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <thread>
+
+using spotify_lib::EventHandler;
+using spotify_lib::EventLoop;
+using spotify_lib::RequestEngine;
+
+using std::make_shared;
+using std::shared_ptr;
+using std::size_t;
+using std::string;
+using std::chrono::milliseconds;
+
+using testing::Test;
+
+/**
+ * @brief Event loop driven by hand, it records the requests of the engine.
+ */
+class FakeEventLoop : public EventLoop {
+ public:
+  void Watch(EventHandler & /* handler */, int /* fd */,
+             int /* events */) override {
+    watches++;
+  }
+
+  void SetTimer(EventHandler & /* handler */,
+                milliseconds timeout) override {
+    this->timeout = timeout;
+  }
+
+  void Wake(EventHandler & /* handler */) override { wakes++; }
+
+  void Detach(EventHandler & /* handler */) override { detached = true; }
+
+  size_t watches{0};         //!< Calls to Watch.
+  size_t wakes{0};           //!< Calls to Wake.
+  milliseconds timeout{-1};  //!< Timeout of the armed timer.
+  bool detached{false};      //!< Whether the engine detached itself.
+};
+
+class RequestEngineTest : public Test {
+ public:
+  RequestEngineTest()
+      : loop_{make_shared<FakeEventLoop>()}, handle_{curl_easy_init()} {
+    char cwd[4096];
+
+    /* a local file, read by libcurl without any socket. */
+    uri_ = string{"file://"} + getcwd(cwd, sizeof(cwd)) +
+           "/tests/unit/mock/jsons/search_result_with_no_musics.json";
+
+    curl_easy_setopt(handle_, CURLOPT_URL, uri_.c_str());
+    curl_easy_setopt(handle_, CURLOPT_WRITEFUNCTION,
+                     +[](char *, size_t size, size_t nmemb, void *) {
+                       return size * nmemb;
+                     });
+  }
+
+  ~RequestEngineTest() { curl_easy_cleanup(handle_); }
+
+ protected:
+  shared_ptr<FakeEventLoop> loop_;  //!< Event loop of the engine.
+  CURL *handle_;                    //!< Handle of the transfer.
+  string uri_;                      //!< Uri of the transfer.
+};
+
+/**
+ * @brief This tests validates the scenario when a transfer is submitted to an
+ * engine running on an external event loop. When this occurs, the loop must
+ * be woken up and the transfer completed while the loop calls the engine,
+ * from the loop's thread.
+ */
+TEST_F(RequestEngineTest, W_TransferIsSubmittedToALoop_S_CompleteItFromTheLoop) {
+  RequestEngine engine{0, loop_};
+  CURLcode result = CURLE_FAILED_INIT;
+  std::thread::id completed_on;
+
+  engine.Submit(handle_, [&result, &completed_on](CURLcode ret) {
+    result = ret;
+    completed_on = std::this_thread::get_id();
+  });
+
+  EXPECT_EQ(1u, loop_->wakes);
+  EXPECT_EQ(1u, engine.InFlight());
+
+  engine.OnTimeout();
+
+  for (int i = 0; i < 100 && engine.InFlight(); i++) {
+    ASSERT_GE(loop_->timeout.count(), 0);
+    engine.OnTimeout();
+  }
+
+  EXPECT_EQ(0u, engine.InFlight());
+  EXPECT_EQ(CURLE_OK, result);
+  EXPECT_EQ(std::this_thread::get_id(), completed_on);
+}
+
+/**
+ * @brief This tests validates the scenario when a delayed transfer is
+ * submitted to an engine running on an external event loop. When this occurs,
+ * the loop's timer must be armed for the delay.
+ */
+TEST_F(RequestEngineTest, W_TransferIsDelayedOnALoop_S_ArmTheTimerForTheDelay) {
+  RequestEngine engine{0, loop_};
+
+  engine.Submit(handle_, [](CURLcode) {}, milliseconds{500});
+  engine.OnTimeout();
+
+  EXPECT_GT(loop_->timeout.count(), 400);
+  EXPECT_LE(loop_->timeout.count(), 501);
+  EXPECT_EQ(1u, engine.InFlight());
+}
+
+/**
+ * @brief This tests validates the scenario when an engine running on an
+ * external event loop is destroyed with a transfer in flight. When this
+ * occurs, the transfer must be aborted and the engine detached from the loop.
+ */
+TEST_F(RequestEngineTest, W_EngineIsDestroyedOnALoop_S_AbortAndDetach) {
+  CURLcode result = CURLE_OK;
+
+  {
+    RequestEngine engine{0, loop_};
+
+    engine.Submit(handle_, [&result](CURLcode ret) { result = ret; });
+  }
+
+  EXPECT_EQ(CURLE_ABORTED_BY_CALLBACK, result);
+  EXPECT_TRUE(loop_->detached);
+}
+
+/**
+ * @brief This tests validates the scenario when a transfer is cancelled after
+ * it completed, and its handle is submitted again before the cancellation is
+ * taken into account, as a hedge which lost at the same time as the winner.
+ * When this occurs, the new transfer must not be aborted.
+ */
+TEST_F(RequestEngineTest, W_CompletedTransferIsCancelledAndItsHandleReused_S_RunTheNewTransfer) {
+  RequestEngine engine{0, loop_};
+  CURLcode first = CURLE_FAILED_INIT;
+  CURLcode second = CURLE_FAILED_INIT;
+
+  auto ticket = engine.Submit(handle_, [&first](CURLcode ret) { first = ret; });
+
+  for (int i = 0; i < 100 && engine.InFlight(); i++) {
+    engine.OnTimeout();
+  }
+
+  ASSERT_EQ(CURLE_OK, first);
+
+  /* both queued before the engine is called again. */
+  engine.Cancel(ticket);
+  engine.Submit(handle_, [&second](CURLcode ret) { second = ret; });
+
+  for (int i = 0; i < 100 && engine.InFlight(); i++) {
+    engine.OnTimeout();
+  }
+
+  EXPECT_EQ(0u, engine.InFlight());
+  EXPECT_EQ(CURLE_OK, second);
+}
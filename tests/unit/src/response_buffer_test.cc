@@ -0,0 +1,100 @@
+/**
+ * @file
+ *
+ * @brief Response buffer test class implementation.
+ */
+#include "private/response_buffer.h"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <string>
+
+using spotify_lib::ResponseBuffer;
+
+using std::size_t;
+using std::string;
+
+using testing::Test;
+
+class ResponseBufferTest : public Test {
+ protected:
+  /**
+   * @brief Append a string to the buffer.
+   *
+   * @param text The string.
+   */
+  void Append(const string &text) { buffer_.Append(text.data(), text.size()); }
+
+  /**
+   * @brief Get the buffer contents.
+   *
+   * @return The contents.
+   */
+  string Contents() const { return string{buffer_.Data(), buffer_.Size()}; }
+
+  ResponseBuffer buffer_;  //!< Response buffer instance.
+};
+
+/**
+ * @brief This tests validates the scenario when a response arrives in several
+ * chunks. When this occurs, the buffer must hold them in order.
+ */
+TEST_F(ResponseBufferTest, W_ChunksAreAppended_S_HoldThemInOrder) {
+  Append("{\"tracks\":");
+  Append("{\"items\":[]}");
+  Append("}");
+
+  EXPECT_EQ("{\"tracks\":{\"items\":[]}}", Contents());
+}
+
+/**
+ * @brief This tests validates the scenario when the buffer is reset between
+ * requests. When this occurs, the contents must be discarded and the storage
+ * kept, so that the next response of the same size doesn't allocate.
+ */
+TEST_F(ResponseBufferTest, W_BufferIsReset_S_KeepTheCapacity) {
+  buffer_.Reserve(4096);
+
+  size_t capacity = buffer_.Capacity();
+  const char *storage = buffer_.Data();
+
+  Append(string(4096, 'a'));
+  buffer_.Reset();
+
+  EXPECT_EQ(0u, buffer_.Size());
+  EXPECT_EQ(capacity, buffer_.Capacity());
+
+  Append(string(4096, 'b'));
+
+  EXPECT_EQ(storage, buffer_.Data());
+  EXPECT_EQ(string(4096, 'b'), Contents());
+}
+
+/**
+ * @brief This tests validates the scenario when room is reserved for a
+ * response smaller than the storage. When this occurs, the capacity must be
+ * kept as is.
+ */
+TEST_F(ResponseBufferTest, W_SmallerResponseIsReserved_S_KeepTheCapacity) {
+  buffer_.Reserve(4096);
+
+  size_t capacity = buffer_.Capacity();
+
+  buffer_.Reserve(16);
+
+  EXPECT_EQ(capacity, buffer_.Capacity());
+  EXPECT_GE(capacity, 4096u);
+}
+
+/**
+ * @brief This tests validates the scenario when an unusually large response
+ * grew the buffer. When this occurs, its storage must be released on reset.
+ */
+TEST_F(ResponseBufferTest, W_LargeResponseIsReset_S_ReleaseTheStorage) {
+  Append(string(ResponseBuffer::kMaxRetainedCapacity + 1, 'a'));
+  buffer_.Reset();
+
+  EXPECT_EQ(0u, buffer_.Size());
+  EXPECT_EQ(0u, buffer_.Capacity());
+}
@@ -0,0 +1,126 @@
+/**
+ * @file
+ *
+ * @brief Response cache test class implementation.
+ */
+#include "private/response_cache.h"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+
+using spotify_lib::CachedResponse;
+using spotify_lib::ResponseCache;
+
+using std::make_shared;
+using std::shared_ptr;
+using std::size_t;
+using std::string;
+
+using testing::Test;
+
+class ResponseCacheTest : public Test {
+ protected:
+  /**
+   * @brief Build a cached response.
+   *
+   * @param etag ETag of the response.
+   * @param cost Accounted size of the response.
+   *
+   * @return The response.
+   */
+  static shared_ptr<const CachedResponse> Response(const string &etag,
+                                                   size_t cost) {
+    Json::Value value;
+
+    value["etag"] = etag;
+
+    return make_shared<CachedResponse>(CachedResponse{etag, "", value, cost});
+  }
+};
+
+/**
+ * @brief This tests validates the scenario when a response is stored and then
+ * looked up. When this occurs, the cache must return the stored response with
+ * its validators.
+ */
+TEST_F(ResponseCacheTest, W_ResponseIsStored_S_FindIt) {
+  ResponseCache cache{100};
+
+  cache.Store("a", Response("\"1\"", 10));
+
+  auto found = cache.Find("a");
+
+  ASSERT_NE(found, nullptr);
+  EXPECT_EQ(found->etag, "\"1\"");
+  EXPECT_EQ(found->value["etag"].asString(), "\"1\"");
+  EXPECT_EQ(cache.Find("b"), nullptr);
+}
+
+/**
+ * @brief This tests validates the scenario when the bound is exceeded. When
+ * this occurs, the cache must evict the least recently used responses first.
+ */
+TEST_F(ResponseCacheTest, W_BoundIsExceeded_S_EvictLeastRecentlyUsed) {
+  ResponseCache cache{30};
+
+  cache.Store("a", Response("a", 10));
+  cache.Store("b", Response("b", 10));
+  cache.Store("c", Response("c", 10));
+
+  /* "a" becomes the most recently used, "b" the least. */
+  cache.Find("a");
+  cache.Store("d", Response("d", 10));
+
+  EXPECT_NE(cache.Find("a"), nullptr);
+  EXPECT_EQ(cache.Find("b"), nullptr);
+  EXPECT_NE(cache.Find("c"), nullptr);
+  EXPECT_NE(cache.Find("d"), nullptr);
+  EXPECT_EQ(cache.Bytes(), 30u);
+  EXPECT_EQ(cache.Count(), 3u);
+}
+
+/**
+ * @brief This tests validates the scenario when a response is stored again or
+ * is larger than the bound. When this occurs, the cache must replace the old
+ * response, and drop it when the new one doesn't fit.
+ */
+TEST_F(ResponseCacheTest, W_ResponseIsReplaced_S_KeepOnlyTheNewOne) {
+  ResponseCache cache{30};
+
+  cache.Store("a", Response("1", 10));
+  cache.Store("a", Response("2", 20));
+
+  ASSERT_NE(cache.Find("a"), nullptr);
+  EXPECT_EQ(cache.Find("a")->etag, "2");
+  EXPECT_EQ(cache.Bytes(), 20u);
+
+  cache.Store("a", Response("3", 40));
+
+  EXPECT_EQ(cache.Find("a"), nullptr);
+  EXPECT_EQ(cache.Bytes(), 0u);
+}
+
+/**
+ * @brief This tests validates the scenario when the cost of a parsed response
+ * is estimated. When this occurs, it must exceed the size of the raw body,
+ * and grow with the contents of the response.
+ */
+TEST_F(ResponseCacheTest, W_CostIsEstimated_S_AccountForTheParsedValue) {
+  string raw = "{\"items\":[{\"name\":\"a\"},{\"name\":\"b\"}]}";
+  Json::Value value;
+  Json::Value larger;
+
+  /* the value of the raw body. */
+  value["items"][0]["name"] = "a";
+  value["items"][1]["name"] = "b";
+  larger = value;
+  larger["items"].append(value["items"][0]);
+
+  auto cost = ResponseCache::Cost("key", CachedResponse{"", "", value, 0});
+
+  EXPECT_GT(cost, raw.size());
+  EXPECT_GT(ResponseCache::Cost("key", CachedResponse{"", "", larger, 0}),
+            cost);
+}
@@ -0,0 +1,117 @@
+/**
+ * @file
+ *
+ * @brief Retry scheduler test class implementation.
+ */
+#include "private/retry_scheduler.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+
+using spotify_lib::RetryOptions;
+using spotify_lib::RetryScheduler;
+
+using std::chrono::milliseconds;
+using std::chrono::seconds;
+
+using testing::Test;
+
+class RetrySchedulerTest : public Test {
+ protected:
+  /**
+   * @brief Build the scheduler settings.
+   *
+   * @param rate Requests per second sent to a host.
+   * @param burst Requests sent to a host at once.
+   *
+   * @return The settings.
+   */
+  static RetryOptions Options(double rate, double burst) {
+    RetryOptions options;
+
+    options.max_retries = 2;
+    options.base_delay = milliseconds{100};
+    options.max_delay = milliseconds{300};
+    options.host_rate = rate;
+    options.host_burst = burst;
+
+    return options;
+  }
+};
+
+/**
+ * @brief This tests validates the scenario when the requests to a host go
+ * past its burst. When this occurs, the scheduler must delay each extra
+ * request by its share of the rate, without delaying the other hosts.
+ */
+TEST_F(RetrySchedulerTest, W_BurstIsExceeded_S_PaceTheRequests) {
+  RetryScheduler scheduler{Options(10, 2)};
+
+  EXPECT_EQ(scheduler.Admit("api.spotify.com"), RetryScheduler::Duration::zero());
+  EXPECT_EQ(scheduler.Admit("api.spotify.com"), RetryScheduler::Duration::zero());
+
+  auto third = scheduler.Admit("api.spotify.com");
+  auto fourth = scheduler.Admit("api.spotify.com");
+
+  EXPECT_GT(third, milliseconds{90});
+  EXPECT_LE(third, milliseconds{100});
+  EXPECT_GT(fourth, milliseconds{190});
+  EXPECT_LE(fourth, milliseconds{200});
+  EXPECT_EQ(scheduler.Admit("accounts.spotify.com"),
+            RetryScheduler::Duration::zero());
+}
+
+/**
+ * @brief This tests validates the scenario when the server replies with a
+ * Retry-After header. When this occurs, the scheduler must wait for that
+ * delay and park the host, so that the other requests to it wait as well.
+ */
+TEST_F(RetrySchedulerTest, W_RetryAfterIsGiven_S_ParkTheHost) {
+  auto options = Options(0, 0);
+
+  options.max_delay = seconds{5};
+
+  RetryScheduler scheduler{options};
+
+  EXPECT_EQ(scheduler.Retry("api.spotify.com", 0, seconds{2}), seconds{2});
+
+  EXPECT_GT(scheduler.Admit("api.spotify.com"), milliseconds{1900});
+  EXPECT_EQ(scheduler.Admit("accounts.spotify.com"),
+            RetryScheduler::Duration::zero());
+}
+
+/**
+ * @brief This tests validates the scenario when the server asks for a delay
+ * beyond the maximum one. When this occurs, the retry and the host's parking
+ * must be bounded by the maximum delay.
+ */
+TEST_F(RetrySchedulerTest, W_RetryAfterIsTooLong_S_BoundIt) {
+  RetryScheduler scheduler{Options(0, 0)};
+
+  EXPECT_EQ(scheduler.Retry("api.spotify.com", 0, seconds{3600}),
+            milliseconds{300});
+  EXPECT_LE(scheduler.Admit("api.spotify.com"), milliseconds{300});
+}
+
+/**
+ * @brief This tests validates the scenario when a request fails without a
+ * Retry-After header. When this occurs, the scheduler must wait for a
+ * jittered delay within the exponential bound, and stop after the retries.
+ */
+TEST_F(RetrySchedulerTest, W_RequestFails_S_BackOffWithJitter) {
+  RetryScheduler scheduler{Options(0, 0)};
+
+  for (int i = 0; i < 100; i++) {
+    EXPECT_LE(scheduler.Retry("host", 0, seconds{0}), milliseconds{100});
+    EXPECT_LE(scheduler.Retry("host", 1, seconds{0}), milliseconds{200});
+    EXPECT_LE(scheduler.Retry("host", 5, seconds{0}), milliseconds{300});
+  }
+
+  EXPECT_TRUE(scheduler.CanRetry(1));
+  EXPECT_FALSE(scheduler.CanRetry(2));
+  EXPECT_EQ(RetryScheduler::Host("https://api.spotify.com:443/v1/search?q=a"),
+            "api.spotify.com:443");
+  EXPECT_EQ(RetryScheduler::Host("https://accounts.spotify.com"),
+            "accounts.spotify.com");
+}
@@ -0,0 +1,92 @@
+/**
+ * @file
+ *
+ * @brief Search decoder test class implementation.
+ */
+#include "private/search_decoder.h"
+
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "types.h"
+
+using spotify_lib::JsoncppSearchDecoder;
+using spotify_lib::MusicInfo;
+
+using std::ifstream;
+using std::istreambuf_iterator;
+using std::runtime_error;
+using std::string;
+using std::vector;
+
+using testing::Test;
+
+class JsoncppSearchDecoderTest : public Test {
+ protected:
+  /**
+   * @brief Read a recorded search reply.
+   *
+   * @param path Path of the reply.
+   *
+   * @return The raw reply.
+   */
+  static string ReadReply(const string &path) {
+    ifstream json_file{path};
+
+    return string{istreambuf_iterator<char>{json_file},
+                  istreambuf_iterator<char>{}};
+  }
+
+  JsoncppSearchDecoder decoder_;  //!< Decoder instance.
+};
+
+/**
+ * @brief This tests validates the scenario when a raw search reply with
+ * several musics is decoded. When this occurs, the decoder must return the
+ * list of musics.
+ */
+TEST_F(JsoncppSearchDecoderTest, W_ReplyIsDecoded_S_ReturnTheListOfMusics) {
+  const vector<MusicInfo> kExpectedReturn{
+      {.name = "The Protocols Of Anti-Sound",
+       .artist = "Magrudergrind",
+       .uri = "spotify:track:2UNCakVkFNo9ClIHbnSBTx",
+       .duration = 107813},
+      {.name = "Protocols of Anti-Sound",
+       .artist = "Mommy's lil Monsterz",
+       .uri = "spotify:track:65ypeYc66Mikf6Hx061XqM",
+       .duration = 77000}};
+
+  auto reply =
+      ReadReply("tests/unit/mock/jsons/search_result_multiple_with_spaces.json");
+
+  EXPECT_EQ(decoder_.Decode(reply), kExpectedReturn);
+}
+
+/**
+ * @brief This tests validates the scenario when a single entry of a search
+ * reply is decoded. When this occurs, the decoder must return its music.
+ */
+TEST_F(JsoncppSearchDecoderTest, W_EntryIsDecoded_S_ReturnTheMusic) {
+  const string kItem{
+      "{\"name\": \"Umbrella\", \"uri\": \"spotify:track:x\", "
+      "\"duration_ms\": 1000, \"album\": {\"artists\": [{\"name\": \"A\"}, "
+      "{\"name\": \"B\"}]}}"};
+  const MusicInfo kExpectedReturn{
+      .name = "Umbrella", .artist = "A", .uri = "spotify:track:x",
+      .duration = 1000};
+
+  EXPECT_EQ(decoder_.DecodeItem(kItem.data(), kItem.size()), kExpectedReturn);
+}
+
+/**
+ * @brief This tests validates the scenario when a malformed reply is decoded.
+ * When this occurs, the decoder must throw the parsing error.
+ */
+TEST_F(JsoncppSearchDecoderTest, W_ReplyIsMalformed_S_ThrowParsingError) {
+  EXPECT_THROW(decoder_.Decode("{\"tracks\": {\"items\": [{"), runtime_error);
+}
@@ -7,32 +7,57 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <fstream>
+#include <iterator>
 #include <memory>
+#include <mutex>
+#include <thread>
 
 #include "spotify.h"
+#include "mock/batch_search_listener_mock.h"
 #include "mock/curl_wrapper_mock.h"
 #include "mock/search_listener_mock.h"
 #include "private/curl_wrapper.h"
 #include "types.h"
 
+using std::exception_ptr;
 using std::ifstream;
+using std::istreambuf_iterator;
+using std::make_exception_ptr;
 using std::make_shared;
+using std::lock_guard;
+using std::min;
+using std::mutex;
 using std::runtime_error;
 using std::shared_ptr;
+using std::size_t;
 using std::string;
+using std::thread;
+using std::to_string;
 using std::vector;
 
+using spotify_lib::ChunkCallback;
+using spotify_lib::JsonCallback;
+using spotify_lib::JsoncppSearchDecoder;
 using spotify_lib::Spotify;
 using spotify_lib::MusicInfo;
+using spotify_lib::PagingOptions;
 using spotify_lib::Searcher;
+using spotify_lib::test::BatchSearchListenerMock;
 using spotify_lib::test::CurlWrapperMock;
 using spotify_lib::test::SearchListenerMock;
 
 using Json::Value;
 
 using testing::_;
+using testing::AnyNumber;
+using testing::HasSubstr;
+using testing::Invoke;
+using testing::InvokeArgument;
 using testing::Return;
+using testing::Sequence;
+using testing::SizeIs;
 using testing::Test;
 using testing::Throw;
 
@@ -44,6 +69,86 @@ class MusicSearcherTest : public Test {
         lib_{nullptr, searcher_, nullptr} {}
 
  protected:
+  /**
+   * @brief Build a page of a search reply, with a track per result.
+   *
+   * @param offset Index of the first result.
+   * @param count Number of results.
+   * @param total Number of results of the whole search.
+   *
+   * @return The reply.
+   */
+  static Value MakePage(size_t offset, size_t count, size_t total) {
+    Value reply;
+
+    reply["tracks"]["total"] = static_cast<Json::UInt64>(total);
+    reply["tracks"]["items"] = Json::arrayValue;
+
+    for (size_t i = offset; i < offset + count; i++) {
+      Value item;
+
+      item["name"] = "Track " + to_string(i);
+      item["album"]["artists"][0]["name"] = "Artist";
+      item["uri"] = "spotify:track:" + to_string(i);
+      item["duration_ms"] = 1000;
+      reply["tracks"]["items"].append(item);
+    }
+
+    return reply;
+  }
+
+  /**
+   * @brief Run a paged search of seven results, in pages of three, whose
+   * last page is received before the second one.
+   *
+   * @param in_order Whether the pages are reported by offset.
+   * @param listener Event listener.
+   */
+  void SearchOutOfOrder(bool in_order, SearchListenerMock& listener) {
+    const string kUri{kMusicSearchBaseUri_ + "umbrella&type=track&limit=3"};
+    const vector<string> kReqHeaders{"Authorization: Bearer token"};
+    PagingOptions paging;
+    mutex lock;
+    vector<JsonCallback> callbacks;
+
+    paging.page_size = 3;
+    paging.in_order = in_order;
+
+    EXPECT_CALL(*curl_, Get(kUri, kReqHeaders))
+        .WillOnce(Return(MakePage(0, 3, 7)));
+    EXPECT_CALL(*curl_, GetAsync(kUri + "&offset=3", kReqHeaders, _))
+        .WillOnce(Invoke([&](const string&, const vector<string>&,
+                             const JsonCallback& callback) {
+          lock_guard<mutex> guard{lock};
+          callbacks.push_back(callback);
+        }));
+    EXPECT_CALL(*curl_, GetAsync(kMusicSearchBaseUri_ +
+                                     "umbrella&type=track&limit=1&offset=6",
+                                 kReqHeaders, _))
+        .WillOnce(Invoke([&](const string&, const vector<string>&,
+                             const JsonCallback& callback) {
+          lock_guard<mutex> guard{lock};
+          callbacks.push_back(callback);
+        }));
+
+    /* both pages are in flight at once, and complete in reverse. */
+    thread replier{[&] {
+      for (;;) {
+        lock_guard<mutex> guard{lock};
+
+        if (callbacks.size() == 2) {
+          break;
+        }
+      }
+
+      callbacks[1](exception_ptr{}, MakePage(6, 1, 7));
+      callbacks[0](exception_ptr{}, MakePage(3, 3, 7));
+    }};
+
+    lib_.SearchPaged(listener, "token", "umbrella", paging);
+    replier.join();
+  }
+
   shared_ptr<CurlWrapperMock> curl_;    //!< Curl wrapper mock instance.
   shared_ptr<Searcher> searcher_;  //!< Spotify music searcher instance.
   Spotify lib_;                             //!< Spotify instance.
@@ -254,3 +359,398 @@ TEST_F(MusicSearcherTest,
 
   lib_.Search(*listener, kAccessToken, kSearchName);
 }
+
+/**
+ * @brief This tests validates the scenario when the user try to search a valid
+ * music in the spotify API without blocking. When this occurs, the
+ * spotify_lib must return the list of found musics through the listener once
+ * the request completes.
+ */
+TEST_F(MusicSearcherTest,
+       W_UserSearchAsyncForAnExistentMusic_S_ReturnTheListOfMatches) {
+  /* test constants */
+  const string kSearchName{"staayyyle"};
+  const string kUri{kMusicSearchBaseUri_ + kSearchName +
+                    "&type=track&limit=10"};
+  const string kAccessToken{"ASUUHnbvBbHASddBSd87asdSA=DDDAa=UUl-=y"};
+  const vector<string> kReqHeaders{"Authorization: Bearer " + kAccessToken};
+  const vector<MusicInfo> kExpectedReturn{
+      {.name = "Staayyyle",
+       .artist = "Spazz",
+       .uri = "spotify:track:6jaY08cdgxbkVYMSSLR9kK",
+       .duration = 26146}};
+
+  /* build request reply */
+  Value reply;
+  {
+    ifstream json_file{
+        "tests/unit/mock/jsons/search_result_single_without_spaces.json",
+    };
+
+    json_file >> reply;
+  }
+
+  auto listener = make_shared<SearchListenerMock>();
+
+  EXPECT_CALL(*curl_, GetAsync(kUri, kReqHeaders, _))
+      .Times(1)
+      .WillOnce(InvokeArgument<2>(exception_ptr{}, reply));
+  EXPECT_CALL(*listener, OnSearchError(_)).Times(0);
+  EXPECT_CALL(*listener, OnPatternFound(kExpectedReturn)).Times(1);
+
+  lib_.SearchAsync(*listener, kAccessToken, kSearchName);
+}
+
+/**
+ * @brief This tests validates the scenario when the user try to search a music
+ * without blocking and the request fails. When this occurs, the spotify_lib
+ * must return the suitable error message through the listener.
+ */
+TEST_F(MusicSearcherTest,
+       W_UserSearchAsyncForAnExistentMusicWithError_S_ReturnErrorMessage) {
+  const string kSearchName{"umbrella"};
+  const string kErrorMessage{"some cool error message"};
+  const string kUri{kMusicSearchBaseUri_ + kSearchName +
+                    "&type=track&limit=10"};
+  const string kAccessToken{"ASUUHnbvBbHASddBSd87asdSA=DDDAa=UUl-=y"};
+  const vector<string> kReqHeaders{"Authorization: Bearer " + kAccessToken};
+
+  auto listener = make_shared<SearchListenerMock>();
+
+  EXPECT_CALL(*curl_, GetAsync(kUri, kReqHeaders, _))
+      .Times(1)
+      .WillOnce(InvokeArgument<2>(
+          make_exception_ptr(runtime_error(kErrorMessage)), Value{}));
+  EXPECT_CALL(*listener, OnSearchError(kErrorMessage)).Times(1);
+  EXPECT_CALL(*listener, OnPatternFound(_)).Times(0);
+
+  lib_.SearchAsync(*listener, kAccessToken, kSearchName);
+}
+
+/**
+ * @brief This tests validates the scenario when the user search a valid music
+ * in the spotify API parsing the reply as it arrives. When this occurs, the
+ * spotify_lib must report each music as soon as its entry is received, even
+ * when the entries are split across several chunks, and then the whole list
+ * through the listener.
+ */
+TEST_F(MusicSearcherTest,
+       W_UserSearchStreamingForAnExistentMusic_S_ReportEachMatchAndTheList) {
+  /* test constants */
+  const string kSearchName{"umbrella"};
+  const string kUri{kMusicSearchBaseUri_ + kSearchName +
+                    "&type=track&limit=10"};
+  const string kAccessToken{"ASUUHnbvBbHASddBSd87asdSA=DDDAa=UUl-=y"};
+  const vector<string> kReqHeaders{"Authorization: Bearer " + kAccessToken};
+  const size_t kChunkSize{7};
+  const vector<MusicInfo> kExpectedReturn{
+      {.name = "Umbrella",
+       .artist = "Rihanna",
+       .uri = "spotify:track:49FYlytm3dAAraYgpoJZux",
+       .duration = 275986},
+      {.name = "Umbrella",
+       .artist = "Laffey",
+       .uri = "spotify:track:0ORfekOSAhkcYgdTS4YK8f",
+       .duration = 122718},
+      {.name = "Umbrella",
+       .artist = "All Time Low",
+       .uri = "spotify:track:6ZUQhRkFJqiPsOucrXZwS6",
+       .duration = 229853}};
+
+  /* build request reply */
+  string reply;
+  {
+    ifstream json_file{
+        "tests/unit/mock/jsons/search_result_multiple.json",
+    };
+
+    reply.assign(istreambuf_iterator<char>{json_file},
+                 istreambuf_iterator<char>{});
+  }
+
+  auto listener = make_shared<SearchListenerMock>();
+  Sequence order;
+
+  EXPECT_CALL(*curl_, GetStream(kUri, kReqHeaders, _))
+      .Times(1)
+      .WillOnce(Invoke([&reply, kChunkSize](const string&,
+                                            const vector<string>&,
+                                            const ChunkCallback& on_chunk) {
+        for (size_t i = 0; i < reply.size(); i += kChunkSize) {
+          on_chunk(reply.data() + i, min(kChunkSize, reply.size() - i));
+        }
+      }));
+  EXPECT_CALL(*listener, OnSearchError(_)).Times(0);
+
+  for (auto& music : kExpectedReturn) {
+    EXPECT_CALL(*listener, OnMusicFound(music)).Times(1).InSequence(order);
+  }
+
+  EXPECT_CALL(*listener, OnPatternFound(kExpectedReturn))
+      .Times(1)
+      .InSequence(order);
+
+  lib_.SearchStreaming(*listener, kAccessToken, kSearchName);
+}
+
+/**
+ * @brief This tests validates the scenario when the user search a music parsing
+ * the reply as it arrives and the request fails. When this occurs, the
+ * spotify_lib must return the suitable error message through the listener.
+ */
+TEST_F(MusicSearcherTest,
+       W_UserSearchStreamingForAnExistentMusicWithError_S_ReturnErrorMessage) {
+  const string kSearchName{"umbrella"};
+  const string kErrorMessage{"some cool error message"};
+  const string kUri{kMusicSearchBaseUri_ + kSearchName +
+                    "&type=track&limit=10"};
+  const string kAccessToken{"ASUUHnbvBbHASddBSd87asdSA=DDDAa=UUl-=y"};
+  const vector<string> kReqHeaders{"Authorization: Bearer " + kAccessToken};
+
+  auto listener = make_shared<SearchListenerMock>();
+
+  EXPECT_CALL(*curl_, GetStream(kUri, kReqHeaders, _))
+      .Times(1)
+      .WillOnce(Throw(runtime_error(kErrorMessage)));
+  EXPECT_CALL(*listener, OnMusicFound(_)).Times(0);
+  EXPECT_CALL(*listener, OnSearchError(kErrorMessage)).Times(1);
+  EXPECT_CALL(*listener, OnPatternFound(_)).Times(0);
+
+  lib_.SearchStreaming(*listener, kAccessToken, kSearchName);
+}
+
+/**
+ * @brief This tests validates the scenario when the user search a valid music
+ * with a decoder plugged into the searcher. When this occurs, the spotify_lib
+ * must hand the raw reply over to the decoder and return the list of found
+ * musics through the listener.
+ */
+TEST_F(MusicSearcherTest,
+       W_UserSearchWithPluggedDecoder_S_ReturnTheListOfMatches) {
+  const string kSearchName{"staayyyle"};
+  const string kUri{kMusicSearchBaseUri_ + kSearchName +
+                    "&type=track&limit=10"};
+  const string kAccessToken{"ASUUHnbvBbHASddBSd87asdSA=DDDAa=UUl-=y"};
+  const vector<string> kReqHeaders{"Authorization: Bearer " + kAccessToken};
+  const vector<MusicInfo> kExpectedReturn{
+      {.name = "Staayyyle",
+       .artist = "Spazz",
+       .uri = "spotify:track:6jaY08cdgxbkVYMSSLR9kK",
+       .duration = 26146}};
+
+  /* build request reply */
+  string reply;
+  {
+    ifstream json_file{
+        "tests/unit/mock/jsons/search_result_single_without_spaces.json",
+    };
+
+    reply.assign(istreambuf_iterator<char>{json_file},
+                 istreambuf_iterator<char>{});
+  }
+
+  auto listener = make_shared<SearchListenerMock>();
+  Spotify lib{nullptr,
+              make_shared<Searcher>(curl_,
+                                    make_shared<JsoncppSearchDecoder>()),
+              nullptr};
+
+  EXPECT_CALL(*curl_, Get(_, _)).Times(0);
+  EXPECT_CALL(*curl_, GetRaw(kUri, kReqHeaders))
+      .Times(1)
+      .WillOnce(Return(reply));
+  EXPECT_CALL(*listener, OnSearchError(_)).Times(0);
+  EXPECT_CALL(*listener, OnPatternFound(kExpectedReturn)).Times(1);
+
+  lib.Search(*listener, kAccessToken, kSearchName);
+}
+
+/**
+ * @brief This tests validates the scenario when the searcher is warmed up.
+ * When this occurs, the connections to the search service must be opened
+ * through the curl wrapper.
+ */
+TEST_F(MusicSearcherTest, W_SearcherIsWarmedUp_S_ConnectToTheSearchService) {
+  EXPECT_CALL(*curl_, Warmup(vector<string>{kMusicSearchBaseUri_}, 1)).Times(1);
+
+  searcher_->Warmup(1);
+}
+
+/**
+ * @brief This tests validates the scenario when the user searches every page
+ * of a result, reported by offset. When this occurs, the pages after the first
+ * one must be requested at once, and reported by offset even if received out
+ * of order.
+ */
+TEST_F(MusicSearcherTest, W_UserSearchesEveryPageInOrder_S_ReportThemByOffset) {
+  SearchListenerMock listener;
+  Sequence sequence;
+
+  EXPECT_CALL(listener, OnPageFound(0, _)).InSequence(sequence);
+  EXPECT_CALL(listener, OnPageFound(3, _)).InSequence(sequence);
+  EXPECT_CALL(listener, OnPageFound(6, _)).InSequence(sequence);
+  EXPECT_CALL(listener, OnPatternFound(
+                            JsoncppSearchDecoder::ToMusics(MakePage(0, 7, 7))))
+      .InSequence(sequence);
+  EXPECT_CALL(listener, OnSearchError(_)).Times(0);
+
+  SearchOutOfOrder(true, listener);
+}
+
+/**
+ * @brief This tests validates the scenario when the user searches every page
+ * of a result, reported as they complete. When this occurs, the pages must be
+ * reported as received, and the whole result by offset.
+ */
+TEST_F(MusicSearcherTest,
+       W_UserSearchesEveryPageAsTheyComplete_S_ReportThemAsReceived) {
+  SearchListenerMock listener;
+  Sequence sequence;
+
+  EXPECT_CALL(listener, OnPageFound(0, _)).InSequence(sequence);
+  EXPECT_CALL(listener, OnPageFound(6, _)).InSequence(sequence);
+  EXPECT_CALL(listener, OnPageFound(3, _)).InSequence(sequence);
+  EXPECT_CALL(listener, OnPatternFound(
+                            JsoncppSearchDecoder::ToMusics(MakePage(0, 7, 7))))
+      .InSequence(sequence);
+  EXPECT_CALL(listener, OnSearchError(_)).Times(0);
+
+  SearchOutOfOrder(false, listener);
+}
+
+/**
+ * @brief This tests validates the scenario when a page of a paged search
+ * fails. When this occurs, the spotify_lib must report the failure through the
+ * listener, without the result.
+ */
+TEST_F(MusicSearcherTest, W_PageOfAPagedSearchFails_S_ReturnFailure) {
+  const string kUri{kMusicSearchBaseUri_ + "umbrella&type=track&limit=50"};
+  SearchListenerMock listener;
+
+  EXPECT_CALL(*curl_, Get(kUri, _)).WillOnce(Return(MakePage(0, 50, 120)));
+  EXPECT_CALL(*curl_, GetAsync(kUri + "&offset=50", _, _))
+      .WillOnce(InvokeArgument<2>(exception_ptr{}, MakePage(50, 50, 120)));
+  EXPECT_CALL(*curl_, GetAsync(kMusicSearchBaseUri_ +
+                                   "umbrella&type=track&limit=20&offset=100",
+                               _, _))
+      .WillOnce(InvokeArgument<2>(
+          make_exception_ptr(runtime_error("page failed!")), Value{}));
+  EXPECT_CALL(listener, OnPageFound(_, _)).Times(AnyNumber());
+  EXPECT_CALL(listener, OnPatternFound(_)).Times(0);
+  EXPECT_CALL(listener, OnSearchError("page failed!")).Times(1);
+
+  lib_.SearchPaged(listener, "token", "umbrella", PagingOptions{});
+}
+
+/**
+ * @brief This tests validates the scenario when the user asks for pages and
+ * results beyond the bounds of the API. When this occurs, the pages must be
+ * of 50 results, and no more than 1000 results must be requested.
+ */
+TEST_F(MusicSearcherTest, W_PagingExceedsTheApiBounds_S_ClampIt) {
+  const string kUri{kMusicSearchBaseUri_ + "umbrella&type=track&limit=50"};
+  SearchListenerMock listener;
+  PagingOptions paging;
+
+  paging.page_size = 80;
+  paging.max_results = 5000;
+
+  EXPECT_CALL(*curl_, Get(kUri, _)).WillOnce(Return(MakePage(0, 50, 3000)));
+  EXPECT_CALL(*curl_, GetAsync(_, _, _)).Times(0);
+  EXPECT_CALL(*curl_, GetAsync(HasSubstr("&limit=50&offset="), _, _))
+      .Times(18)
+      .WillRepeatedly(
+          InvokeArgument<2>(exception_ptr{}, MakePage(0, 50, 3000)));
+  EXPECT_CALL(*curl_, GetAsync(kUri + "&offset=950", _, _))
+      .WillOnce(InvokeArgument<2>(exception_ptr{}, MakePage(950, 50, 3000)));
+  EXPECT_CALL(listener, OnPageFound(_, _)).Times(20);
+  EXPECT_CALL(listener, OnPatternFound(SizeIs(1000))).Times(1);
+  EXPECT_CALL(listener, OnSearchError(_)).Times(0);
+
+  lib_.SearchPaged(listener, "token", "umbrella", paging);
+}
+
+/**
+ * @brief This tests validates the scenario when the user searches a batch of
+ * queries, one of them failing. When this occurs, each query must be reported
+ * with its index, the failure along with the results of the other ones.
+ */
+TEST_F(MusicSearcherTest, W_UserSearchesABatch_S_ReportEachQueryByIndex) {
+  const vector<string> kReqHeaders{"Authorization: Bearer token"};
+  const auto kUmbrellaResult =
+      JsoncppSearchDecoder::ToMusics(MakePage(0, 3, 3));
+  const auto kRoarResult = JsoncppSearchDecoder::ToMusics(MakePage(0, 1, 1));
+  BatchSearchListenerMock listener;
+
+  EXPECT_CALL(*curl_, GetAsync(kMusicSearchBaseUri_ +
+                                   "umbrella&type=track&limit=10",
+                               kReqHeaders, _))
+      .WillOnce(InvokeArgument<2>(exception_ptr{}, MakePage(0, 3, 3)));
+  EXPECT_CALL(*curl_, GetAsync(kMusicSearchBaseUri_ +
+                                   "cheap+thrills&type=track&limit=10",
+                               kReqHeaders, _))
+      .WillOnce(InvokeArgument<2>(
+          make_exception_ptr(runtime_error("search failed!")), Value{}));
+  EXPECT_CALL(*curl_, GetAsync(kMusicSearchBaseUri_ +
+                                   "roar&type=track&limit=10",
+                               kReqHeaders, _))
+      .WillOnce(InvokeArgument<2>(exception_ptr{}, MakePage(0, 1, 1)));
+  EXPECT_CALL(listener, OnQueryFound(0, kUmbrellaResult)).Times(1);
+  EXPECT_CALL(listener, OnQueryError(1, "search failed!")).Times(1);
+  EXPECT_CALL(listener, OnQueryFound(2, kRoarResult)).Times(1);
+
+  lib_.SearchBatch(listener, "token", {"umbrella", "cheap thrills", "roar"});
+}
+
+/**
+ * @brief This tests validates the scenario when the user searches a batch
+ * larger than the bound of searches in flight. When this occurs, no more
+ * searches than the bound must be in flight at once, each completion sending
+ * the next one.
+ */
+TEST_F(MusicSearcherTest,
+       W_UserSearchesALargeBatch_S_BoundTheSearchesInFlight) {
+  const size_t kQueries = 6;
+  BatchSearchListenerMock listener;
+  mutex lock;
+  vector<JsonCallback> callbacks;
+  size_t in_flight = 0;
+  size_t max_in_flight = 0;
+
+  EXPECT_CALL(*curl_, GetAsync(_, _, _))
+      .Times(kQueries)
+      .WillRepeatedly(Invoke([&](const string&, const vector<string>&,
+                                 const JsonCallback& callback) {
+        lock_guard<mutex> guard{lock};
+
+        callbacks.push_back(callback);
+        max_in_flight = std::max(max_in_flight, ++in_flight);
+      }));
+  EXPECT_CALL(listener, OnQueryFound(_, _)).Times(kQueries);
+  EXPECT_CALL(listener, OnQueryError(_, _)).Times(0);
+
+  /* completes the searches one at a time, as they're sent. */
+  thread replier{[&] {
+    for (size_t completed = 0; completed < kQueries;) {
+      JsonCallback callback;
+
+      {
+        lock_guard<mutex> guard{lock};
+
+        if (callbacks.size() == completed) {
+          continue;
+        }
+
+        callback = callbacks[completed++];
+        in_flight--;
+      }
+
+      callback(exception_ptr{}, MakePage(0, 1, 1));
+    }
+  }};
+
+  lib_.SearchBatch(listener, "token", vector<string>(kQueries, "umbrella"), 2);
+  replier.join();
+
+  EXPECT_EQ(2u, max_in_flight);
+}
@@ -0,0 +1,94 @@
+/**
+ * @file
+ *
+ * @brief Simdjson search decoder test class implementation.
+ */
+#include "private/simdjson_search_decoder.h"
+
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "private/search_decoder.h"
+#include "types.h"
+
+using spotify_lib::JsoncppSearchDecoder;
+using spotify_lib::MusicInfo;
+using spotify_lib::SimdjsonSearchDecoder;
+
+using std::ifstream;
+using std::istreambuf_iterator;
+using std::runtime_error;
+using std::string;
+using std::vector;
+
+using testing::Test;
+
+class SimdjsonSearchDecoderTest : public Test {
+ protected:
+  /**
+   * @brief Read a recorded search reply.
+   *
+   * @param path Path of the reply.
+   *
+   * @return The raw reply.
+   */
+  static string ReadReply(const string &path) {
+    ifstream json_file{path};
+
+    return string{istreambuf_iterator<char>{json_file},
+                  istreambuf_iterator<char>{}};
+  }
+
+  SimdjsonSearchDecoder decoder_;  //!< Decoder instance.
+};
+
+/**
+ * @brief This tests validates the scenario when the recorded search replies
+ * are decoded. When this occurs, the decoder must return the same musics as
+ * the jsoncpp decoder.
+ */
+TEST_F(SimdjsonSearchDecoderTest, W_RecordedRepliesAreDecoded_S_MatchJsoncpp) {
+  const vector<string> kReplies{
+      "tests/unit/mock/jsons/search_result_multiple.json",
+      "tests/unit/mock/jsons/search_result_multiple_with_spaces.json",
+      "tests/unit/mock/jsons/search_result_single_without_spaces.json",
+      "tests/unit/mock/jsons/search_result_with_no_musics.json"};
+  JsoncppSearchDecoder reference;
+
+  for (auto &path : kReplies) {
+    auto reply = ReadReply(path);
+
+    EXPECT_EQ(decoder_.Decode(reply), reference.Decode(reply)) << path;
+  }
+}
+
+/**
+ * @brief This tests validates the scenario when an entry with escaped strings
+ * and without some of the fields is decoded. When this occurs, the decoder
+ * must unescape the strings and leave the missing fields empty.
+ */
+TEST_F(SimdjsonSearchDecoderTest, W_EntryHasEscapesAndMissingFields_S_Decode) {
+  const string kItem{
+      "{\"uri\": \"spotify:track:x\", \"name\": \"Caf\\u00e9 \\\"live\\\"\", "
+      "\"album\": {\"artists\": []}}"};
+  const MusicInfo kExpectedReturn{
+      .name = "Caf\xc3\xa9 \"live\"", .artist = "", .uri = "spotify:track:x",
+      .duration = 0};
+
+  EXPECT_EQ(decoder_.DecodeItem(kItem.data(), kItem.size()), kExpectedReturn);
+}
+
+/**
+ * @brief This tests validates the scenario when a malformed reply is decoded.
+ * When this occurs, the decoder must throw the parsing error.
+ */
+TEST_F(SimdjsonSearchDecoderTest, W_ReplyIsMalformed_S_ThrowParsingError) {
+  EXPECT_THROW(decoder_.Decode("[1, 2]"), runtime_error);
+  EXPECT_THROW(decoder_.Decode("{\"tracks\": {\"items\": [{\"name\": }]}}"),
+               runtime_error);
+}
@@ -0,0 +1,277 @@
+/**
+ * @file
+ *
+ * @brief Singleflight test class implementation.
+ */
+#include "private/singleflight.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "private/call_context.h"
+
+using spotify_lib::CallAbortedError;
+using spotify_lib::CallContext;
+using spotify_lib::CallScope;
+using spotify_lib::CancellationToken;
+using spotify_lib::Singleflight;
+
+using std::atomic;
+using std::promise;
+using std::runtime_error;
+using std::size_t;
+using std::string;
+using std::thread;
+using std::vector;
+using std::chrono::milliseconds;
+using std::chrono::steady_clock;
+
+using testing::Test;
+
+class SingleflightTest : public Test {
+ protected:
+  /**
+   * @brief Issue the same call from several threads at once. The first call
+   * only finishes once all the others joined it.
+   *
+   * @param result Result of the first call, empty to throw instead.
+   * @param results Results got by each thread, or the error messages.
+   */
+  void Run(const string &result, vector<string> *results) {
+    for (size_t i = 0; i < results->size(); i++) {
+      threads_.emplace_back([this, &result, results, i] {
+        try {
+          (*results)[i] = flights_.Do("key", [this, &result] {
+            calls_++;
+
+            while (flights_.Coalesced() < kThreads_ - 1) {
+              std::this_thread::yield();
+            }
+
+            if (result.empty()) {
+              throw runtime_error("some cool error message");
+            }
+
+            return result;
+          });
+        } catch (const runtime_error &e) {
+          (*results)[i] = e.what();
+        }
+      });
+    }
+
+    for (auto &t : threads_) {
+      t.join();
+    }
+  }
+
+  const size_t kThreads_{8};         //!< Number of callers.
+  Singleflight<string> flights_;     //!< Singleflight instance.
+  atomic<int> calls_{0};             //!< Calls actually run.
+  vector<thread> threads_;           //!< Caller threads.
+};
+
+/**
+ * @brief This tests validates the scenario when several threads make the same
+ * call at once. When this occurs, the call must run only once and every thread
+ * must get its result.
+ */
+TEST_F(SingleflightTest, W_SameCallIsConcurrent_S_RunItOnceAndShareResult) {
+  vector<string> results(kThreads_);
+
+  Run("result", &results);
+
+  EXPECT_EQ(calls_, 1);
+  EXPECT_EQ(flights_.Coalesced(), kThreads_ - 1);
+  EXPECT_EQ(results, vector<string>(kThreads_, "result"));
+}
+
+/**
+ * @brief This tests validates the scenario when several threads make the same
+ * call at once and it fails. When this occurs, every thread must get the
+ * error.
+ */
+TEST_F(SingleflightTest, W_SharedCallFails_S_EveryCallerGetsTheError) {
+  vector<string> results(kThreads_);
+
+  Run("", &results);
+
+  EXPECT_EQ(calls_, 1);
+  EXPECT_EQ(results, vector<string>(kThreads_, "some cool error message"));
+}
+
+/**
+ * @brief This tests validates the scenario when the same call is made again
+ * after the previous one finished. When this occurs, the call must run again.
+ */
+TEST_F(SingleflightTest, W_CallIsRepeatedAfterwards_S_RunItAgain) {
+  int runs = 0;
+
+  flights_.Do("key", [&runs] { return std::to_string(++runs); });
+
+  EXPECT_EQ(flights_.Do("key", [&runs] { return std::to_string(++runs); }),
+            "2");
+  EXPECT_EQ(flights_.Coalesced(), 0u);
+}
+
+/**
+ * @brief This tests validates the scenario when the same call is made over and
+ * over from several threads. When this occurs, each caller must get the result
+ * of a call still in flight when it arrived, never the one of a call whose
+ * result was already handed out.
+ */
+TEST_F(SingleflightTest, W_CallsKeepComing_S_NeverJoinAFinishedCall) {
+  atomic<int> runs{0};
+  atomic<int> delivered{0};
+  atomic<int> stale{0};
+
+  for (size_t i = 0; i < kThreads_; i++) {
+    threads_.emplace_back([this, &runs, &delivered, &stale] {
+      for (int n = 0; n < 5000; n++) {
+        int before = delivered;
+        int result = std::stoi(
+            flights_.Do("key", [&runs] { return std::to_string(++runs); }));
+
+        if (result <= before) {
+          stale++;
+        }
+
+        /* the calls run one after the other, the latest one delivered has
+         * the greatest result. */
+        while (before < result &&
+               !delivered.compare_exchange_weak(before, result)) {
+        }
+      }
+    });
+  }
+
+  for (auto &t : threads_) {
+    t.join();
+  }
+
+  EXPECT_EQ(stale, 0);
+}
+
+/**
+ * @brief This tests validates the scenario when a caller joins a call which
+ * lasts past the caller's deadline. When this occurs, the caller must give up
+ * at its deadline while the call goes on.
+ */
+TEST_F(SingleflightTest, W_JoinedCallOutlastsTheDeadline_S_GiveUpInTime) {
+  promise<void> started;
+  promise<void> release;
+  auto released = release.get_future().share();
+
+  threads_.emplace_back([this, &started, released] {
+    flights_.Do("key", [&started, released] {
+      started.set_value();
+      released.wait();
+      return string{"result"};
+    });
+  });
+
+  started.get_future().wait();
+
+  CallContext context;
+
+  context.deadline = steady_clock::now() + milliseconds{50};
+
+  {
+    CallScope scope{context};
+
+    EXPECT_THROW(flights_.Do("key", [] { return string{"own result"}; }),
+                 CallAbortedError);
+  }
+
+  EXPECT_EQ(flights_.Coalesced(), 1u);
+
+  release.set_value();
+  threads_.back().join();
+}
+
+/**
+ * @brief This tests validates the scenario when asynchronous calls join a call
+ * in flight. When this occurs, the call must run only once and every caller,
+ * sync or async, must get its result once it finishes.
+ */
+TEST_F(SingleflightTest, W_AsyncCallsJoinACall_S_RunItOnceAndShareResult) {
+  Singleflight<string>::Callback done;
+  vector<string> results;
+  auto collect = [&results](std::exception_ptr error, const string &value) {
+    EXPECT_FALSE(error);
+    results.push_back(value);
+  };
+  auto call = [this, &done](const Singleflight<string>::Callback &finish) {
+    calls_++;
+    done = finish;
+  };
+
+  flights_.DoAsync("key", call, collect);
+  flights_.DoAsync("key", call, collect);
+
+  threads_.emplace_back([this] {
+    EXPECT_EQ(flights_.Do("key", [] { return string{"own result"}; }),
+              "result");
+  });
+
+  while (flights_.Coalesced() < 2) {
+    std::this_thread::yield();
+  }
+
+  done(nullptr, "result");
+  threads_.back().join();
+
+  EXPECT_EQ(calls_, 1);
+  EXPECT_EQ(results, vector<string>(2, "result"));
+}
+
+/**
+ * @brief This tests validates the scenario when an asynchronous call joins a
+ * call aborted by its own caller. When this occurs, the joined caller must run
+ * the call again instead of getting the error.
+ */
+TEST_F(SingleflightTest, W_JoinedCallIsAborted_S_RunItAgainAsync) {
+  vector<Singleflight<string>::Callback> done;
+  vector<string> results;
+  auto call = [this, &done](const Singleflight<string>::Callback &finish) {
+    calls_++;
+    done.push_back(finish);
+  };
+
+  auto cancellation = std::make_shared<CancellationToken>();
+
+  {
+    CallScope scope{CallContext{"auth", steady_clock::time_point::max(),
+                                cancellation}};
+
+    flights_.DoAsync("key", call,
+                     [](std::exception_ptr error, const string &) {
+                       EXPECT_TRUE(error);
+                     });
+  }
+
+  flights_.DoAsync("key", call,
+                   [&results](std::exception_ptr error, const string &value) {
+                     EXPECT_FALSE(error);
+                     results.push_back(value);
+                   });
+
+  cancellation->Cancel();
+  done[0](std::make_exception_ptr(CallAbortedError{"call cancelled"}), "");
+
+  ASSERT_EQ(done.size(), 2u);
+
+  done[1](nullptr, "result");
+
+  EXPECT_EQ(calls_, 2);
+  EXPECT_EQ(results, vector<string>{"result"});
+}
@@ -0,0 +1,222 @@
+/**
+ * @file
+ *
+ * @brief TLS session store test class implementation.
+ */
+#include "private/tls_session_store.h"
+
+#include <gtest/gtest.h>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+
+#include "mock/local_tls_server.h"
+#include "private/curl_share.h"
+
+using spotify_lib::CurlShare;
+using spotify_lib::test::LocalTlsServer;
+
+using std::ifstream;
+using std::istringstream;
+using std::ofstream;
+using std::size_t;
+using std::string;
+using std::strstr;
+
+using testing::Test;
+
+class TlsSessionStoreTest : public Test {
+ public:
+  TlsSessionStoreTest() {
+    char path[] = "/tmp/tls_session_store_XXXXXX";
+
+    close(mkstemp(path));
+    unlink(path);
+    path_ = path;
+  }
+
+  ~TlsSessionStoreTest() {
+    unlink(path_.c_str());
+    unlink((path_ + ".lock").c_str());
+  }
+
+ protected:
+  /**
+   * @brief Check whether libcurl exports its TLS sessions.
+   *
+   * @return true if so, false otherwise.
+   */
+  static bool ExportSupported() {
+    auto names = curl_version_info(CURLVERSION_NOW)->feature_names;
+
+    for (size_t i = 0; names && names[i]; i++) {
+      if (!strstr(names[i], "SSLS-EXPORT")) {
+        continue;
+      }
+
+      return true;
+    }
+
+    return false;
+  }
+
+  /**
+   * @brief Request a server through a share handle.
+   *
+   * @param share The share.
+   * @param server The server.
+   *
+   * @return Result of the transfer.
+   */
+  static CURLcode Request(const CurlShare &share,
+                          const LocalTlsServer &server) {
+    string uri = server.Uri("/");
+    CURL *handle = curl_easy_init();
+
+    curl_easy_setopt(handle, CURLOPT_URL, uri.c_str());
+    curl_easy_setopt(handle, CURLOPT_PROXY, "");
+    curl_easy_setopt(handle, CURLOPT_SHARE, share.Get());
+    curl_easy_setopt(handle, CURLOPT_CAINFO, server.CaFile().c_str());
+    curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION,
+                     +[](char *, size_t size, size_t nmemb, void *) {
+                       return size * nmemb;
+                     });
+
+    CURLcode ret = curl_easy_perform(handle);
+
+    curl_easy_cleanup(handle);
+
+    return ret;
+  }
+
+  LocalTlsServer server_;  //!< Server answering the requests.
+  string path_;            //!< Path of the store file.
+};
+
+/**
+ * @brief This tests validates the scenario when a session is saved by a
+ * store. When this occurs, a share opened later on the same file must resume
+ * it on its first handshake, and the file must only be readable by its owner.
+ */
+TEST_F(TlsSessionStoreTest, W_SessionIsSaved_S_ResumeItAfterARestart) {
+  if (!ExportSupported()) {
+    GTEST_SKIP();
+  }
+
+  struct stat info;
+
+  {
+    CurlShare share{path_};
+
+    ASSERT_EQ(CURLE_OK, Request(share, server_));
+  }
+
+  {
+    CurlShare share{path_};
+
+    EXPECT_LT(0u, share.Sessions()->Imported());
+    ASSERT_EQ(CURLE_OK, Request(share, server_));
+  }
+
+  EXPECT_EQ(2u, server_.Handshakes());
+  EXPECT_EQ(1u, server_.Resumed());
+  ASSERT_EQ(0, stat(path_.c_str(), &info));
+  EXPECT_EQ(0600u, info.st_mode & 0777u);
+}
+
+/**
+ * @brief This tests validates the scenario when another port of the same host
+ * is contacted after a restart. When this occurs, the session of the first
+ * port must not be offered to it.
+ */
+TEST_F(TlsSessionStoreTest, W_OtherPortIsContacted_S_DontOfferTheSession) {
+  if (!ExportSupported()) {
+    GTEST_SKIP();
+  }
+
+  LocalTlsServer other;
+
+  {
+    CurlShare share{path_};
+
+    ASSERT_EQ(CURLE_OK, Request(share, server_));
+  }
+
+  CurlShare share{path_};
+
+  ASSERT_EQ(CURLE_OK, Request(share, other));
+  ASSERT_EQ(CURLE_OK, Request(share, server_));
+
+  EXPECT_EQ(0u, other.Resumed());
+  EXPECT_EQ(1u, server_.Resumed());
+}
+
+/**
+ * @brief This tests validates the scenario when two stores share a file. When
+ * this occurs, the sessions saved by each one must be kept in the file.
+ */
+TEST_F(TlsSessionStoreTest, W_StoresShareAFile_S_MergeTheirSessions) {
+  if (!ExportSupported()) {
+    GTEST_SKIP();
+  }
+
+  LocalTlsServer other;
+
+  {
+    CurlShare first{path_};
+    CurlShare second{path_};
+
+    ASSERT_EQ(CURLE_OK, Request(first, server_));
+    ASSERT_EQ(CURLE_OK, Request(second, other));
+  }
+
+  CurlShare share{path_};
+
+  ASSERT_EQ(CURLE_OK, Request(share, server_));
+  ASSERT_EQ(CURLE_OK, Request(share, other));
+
+  EXPECT_EQ(1u, server_.Resumed());
+  EXPECT_EQ(1u, other.Resumed());
+}
+
+/**
+ * @brief This tests validates the scenario when a stored session has expired.
+ * When this occurs, it must not be imported.
+ */
+TEST_F(TlsSessionStoreTest, W_SessionHasExpired_S_DontImportIt) {
+  if (!ExportSupported()) {
+    GTEST_SKIP();
+  }
+
+  {
+    CurlShare share{path_};
+
+    ASSERT_EQ(CURLE_OK, Request(share, server_));
+  }
+
+  ifstream in{path_};
+  istringstream lines{string{std::istreambuf_iterator<char>{in}, {}}};
+  string expired;
+  string shmac;
+  long expiry;
+  string session;
+
+  while (lines >> shmac >> expiry >> session) {
+    expired += shmac + " 1 " + session + '\n';
+  }
+
+  ASSERT_FALSE(expired.empty());
+  ofstream{path_} << expired;
+
+  CurlShare share{path_};
+
+  EXPECT_EQ(0u, share.Sessions()->Imported());
+}
@@ -0,0 +1,79 @@
+/**
+ * @file
+ *
+ * @brief Token cache test class implementation.
+ */
+#include "private/token_cache.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+
+using spotify_lib::TokenCache;
+
+using std::chrono::minutes;
+using std::chrono::seconds;
+using std::chrono::steady_clock;
+
+using testing::Test;
+
+class TokenCacheTest : public Test {
+ protected:
+  TokenCache cache_;  //!< Token cache instance.
+};
+
+/**
+ * @brief This tests validates the scenario when a token is found early in its
+ * lifetime. When this occurs, it must be returned without a refresh.
+ */
+TEST_F(TokenCacheTest, W_TokenIsFresh_S_ReturnItWithoutARefresh) {
+  bool refresh = true;
+
+  cache_.Store("id", "credentials", "token", seconds{3600},
+               steady_clock::now());
+
+  EXPECT_EQ("token", cache_.Find("id", "credentials", &refresh));
+  EXPECT_FALSE(refresh);
+}
+
+/**
+ * @brief This tests validates the scenario when a token is found late in its
+ * lifetime by several callers. When this occurs, it must be returned to all of
+ * them and only the first one must be told to refresh it, until the refresh
+ * is abandoned.
+ */
+TEST_F(TokenCacheTest, W_TokenIsDueForARefresh_S_RefreshItOnce) {
+  bool refresh = false;
+
+  cache_.Store("id", "credentials", "token", seconds{3600},
+               steady_clock::now() - minutes{50});
+
+  EXPECT_EQ("token", cache_.Find("id", "credentials", &refresh));
+  EXPECT_TRUE(refresh);
+  EXPECT_EQ("token", cache_.Find("id", "credentials", &refresh));
+  EXPECT_FALSE(refresh);
+
+  cache_.Abandon("id");
+
+  EXPECT_EQ("token", cache_.Find("id", "credentials", &refresh));
+  EXPECT_TRUE(refresh);
+}
+
+/**
+ * @brief This tests validates the scenario when a token is about to expire,
+ * or is looked up with other credentials. When this occurs, it must not be
+ * returned.
+ */
+TEST_F(TokenCacheTest, W_TokenIsExpiringOrOfOthers_S_DontReturnIt) {
+  bool refresh = true;
+
+  cache_.Store("id", "credentials", "token", seconds{3600},
+               steady_clock::now() - seconds{3590});
+  cache_.Store("other", "credentials", "token", seconds{3600},
+               steady_clock::now());
+
+  EXPECT_EQ("", cache_.Find("id", "credentials", &refresh));
+  EXPECT_FALSE(refresh);
+  EXPECT_EQ("", cache_.Find("other", "other credentials", &refresh));
+  EXPECT_EQ("", cache_.Find("unknown", "credentials", &refresh));
+}
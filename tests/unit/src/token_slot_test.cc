@@ -0,0 +1,220 @@
+/**
+ * @file
+ *
+ * @brief Token slot test class implementation.
+ */
+#include "private/token_slot.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <future>
+#include <string>
+#include <thread>
+
+using spotify_lib::CachedToken;
+using spotify_lib::TokenSlot;
+
+using std::future;
+using std::promise;
+using std::string;
+using std::thread;
+using std::chrono::hours;
+using std::chrono::minutes;
+using std::chrono::steady_clock;
+
+using testing::Test;
+
+class TokenSlotTest : public Test {
+ protected:
+  /**
+   * @brief Make a token.
+   *
+   * @param credentials Credentials the token was granted to.
+   * @param value The token.
+   * @param refresh_at Start of its refresh, from now.
+   *
+   * @return The token, valid for an hour.
+   */
+  static CachedToken MakeToken(const string& credentials, const string& value,
+                               steady_clock::duration refresh_at) {
+    auto now = steady_clock::now();
+
+    return CachedToken{credentials, value, now + refresh_at, now + hours{1},
+                       false};
+  }
+
+  TokenSlot slot_;  //!< Token slot instance.
+};
+
+/**
+ * @brief This tests validates the scenario when a slot is read before and
+ * after a token is published. When this occurs, nothing must be read before,
+ * and the token and its credentials after.
+ */
+TEST_F(TokenSlotTest, W_TokenIsPublished_S_ReadIt) {
+  string client_id;
+  string client_secret;
+
+  EXPECT_EQ("", slot_.Read());
+  EXPECT_FALSE(slot_.Credentials(&client_id, &client_secret));
+
+  slot_.Publish("id", "secret", MakeToken("credentials", "token", hours{1}));
+
+  EXPECT_EQ("token", slot_.Read());
+  EXPECT_TRUE(slot_.Credentials(&client_id, &client_secret));
+  EXPECT_EQ("id", client_id);
+  EXPECT_EQ("secret", client_secret);
+}
+
+/**
+ * @brief This tests validates the scenario when a token is renewed. When this
+ * occurs, the renewed token must be read if it belongs to the client of the
+ * current one, and ignored otherwise.
+ */
+TEST_F(TokenSlotTest, W_TokenIsRenewed_S_OnlyReplaceTheSameClients) {
+  slot_.Publish("id", "secret", MakeToken("credentials", "token", hours{1}));
+  slot_.Renew(MakeToken("other credentials", "other token", hours{1}));
+
+  EXPECT_EQ("token", slot_.Read());
+
+  slot_.Renew(MakeToken("credentials", "renewed token", hours{1}));
+
+  EXPECT_EQ("renewed token", slot_.Read());
+}
+
+/**
+ * @brief This tests validates the scenario when a token is due for a refresh.
+ * When this occurs, a single caller must claim the refresh until the renewed
+ * token is published.
+ */
+TEST_F(TokenSlotTest, W_TokenIsDueForARefresh_S_ClaimItOnce) {
+  slot_.Publish("id", "secret", MakeToken("credentials", "token", hours{1}));
+
+  EXPECT_FALSE(slot_.ClaimRefresh());
+
+  slot_.Publish("id", "secret", MakeToken("credentials", "token", -minutes{1}));
+
+  EXPECT_TRUE(slot_.ClaimRefresh());
+  EXPECT_FALSE(slot_.ClaimRefresh());
+
+  slot_.Renew(MakeToken("credentials", "renewed token", -minutes{1}));
+
+  EXPECT_TRUE(slot_.ClaimRefresh());
+}
+
+/**
+ * @brief This tests validates the scenario when a token is published while
+ * another thread reads the slot. When this occurs, the other thread must read
+ * the new token from then on.
+ */
+TEST_F(TokenSlotTest, W_TokenIsPublishedWhileRead_S_ReadTheNewOne) {
+  promise<void> published;
+  string after;
+
+  slot_.Publish("id", "secret", MakeToken("credentials", "token", hours{1}));
+
+  thread reader{[this, &after](future<void> renewed) {
+                  /* the thread keeps a reference to the entry read. */
+                  slot_.Read();
+                  renewed.wait();
+                  after = slot_.Read();
+                },
+                published.get_future()};
+
+  slot_.Renew(MakeToken("credentials", "renewed token", hours{1}));
+  published.set_value();
+  reader.join();
+
+  EXPECT_EQ("renewed token", after);
+}
+
+/**
+ * @brief This tests validates the scenario when two slots are read in turn.
+ * When this occurs, the token read from one must stay valid while the other
+ * one is read.
+ */
+TEST_F(TokenSlotTest, W_SlotsAreReadInTurn_S_KeepEachToken) {
+  TokenSlot other;
+
+  slot_.Publish("id", "secret", MakeToken("credentials", "token", hours{1}));
+  other.Publish("other id", "other secret",
+                MakeToken("other credentials", "other token", hours{1}));
+
+  const string& token = slot_.Read();
+  const string& other_token = other.Read();
+
+  EXPECT_EQ("token", token);
+  EXPECT_EQ("other token", other_token);
+  EXPECT_EQ("token", slot_.Read());
+  EXPECT_EQ(&token, &slot_.Read());
+}
+
+/**
+ * @brief This tests validates the scenario when the refresh of a token fails.
+ * When this occurs, the refresh must be claimed again once the delay given
+ * back expires, unless another client's token was published.
+ */
+TEST_F(TokenSlotTest, W_RefreshFails_S_ClaimItAgainLater) {
+  slot_.Publish("id", "secret", MakeToken("credentials", "token", -minutes{1}));
+
+  EXPECT_TRUE(slot_.ClaimRefresh());
+
+  slot_.RetryRefresh("other id", "other secret", minutes{0});
+
+  EXPECT_FALSE(slot_.ClaimRefresh());
+
+  slot_.RetryRefresh("id", "secret", minutes{1});
+
+  EXPECT_FALSE(slot_.ClaimRefresh());
+
+  slot_.RetryRefresh("id", "secret", -minutes{1});
+
+  EXPECT_TRUE(slot_.ClaimRefresh());
+}
+
+/**
+ * @brief This tests validates the scenario when a thread which read a slot
+ * exits. When this occurs, the slot must release the thread's reference to
+ * the token.
+ */
+TEST_F(TokenSlotTest, W_ReaderThreadExits_S_ReleaseItsReference) {
+  string read;
+
+  slot_.Publish("id", "secret", MakeToken("credentials", "token", hours{1}));
+
+  thread reader{[this, &read] { read = slot_.Read(); }};
+
+  reader.join();
+
+  EXPECT_EQ("token", read);
+  EXPECT_EQ(0u, slot_.ReaderCount());
+
+  slot_.Read();
+
+  EXPECT_EQ(1u, slot_.ReaderCount());
+}
+
+/**
+ * @brief This tests validates the scenario when slots are created, read and
+ * destroyed in turn on a thread. When this occurs, each one must read its own
+ * token, and the slot still alive must keep reading its token.
+ */
+TEST_F(TokenSlotTest, W_SlotsAreDestroyedAfterARead_S_KeepReadingTheOthers) {
+  slot_.Publish("id", "secret", MakeToken("credentials", "token", hours{1}));
+
+  EXPECT_EQ("token", slot_.Read());
+
+  for (int i = 0; i < 100; i++) {
+    TokenSlot other;
+    string value = "token " + std::to_string(i);
+
+    other.Publish("other id", "other secret",
+                  MakeToken("other credentials", value, hours{1}));
+
+    EXPECT_EQ(value, other.Read());
+    EXPECT_EQ(1u, other.ReaderCount());
+  }
+
+  EXPECT_EQ("token", slot_.Read());
+}
@@ -0,0 +1,106 @@
+/**
+ * @file
+ *
+ * @brief Token store test class implementation.
+ */
+#include "private/token_store.h"
+
+#include <gtest/gtest.h>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+
+using spotify_lib::StoredToken;
+using spotify_lib::TokenStore;
+
+using std::runtime_error;
+using std::string;
+using std::chrono::hours;
+using std::chrono::seconds;
+using std::chrono::system_clock;
+
+using testing::Test;
+
+class TokenStoreTest : public Test {
+ public:
+  TokenStoreTest() {
+    char path[] = "/tmp/token_store_XXXXXX";
+
+    close(mkstemp(path));
+    unlink(path);
+    path_ = path;
+  }
+
+  ~TokenStoreTest() { unlink(path_.c_str()); }
+
+ protected:
+  string path_;  //!< Path of the store file.
+};
+
+/**
+ * @brief This tests validates the scenario when a token is saved by a store.
+ * When this occurs, a store opened later on the same file must find it with
+ * the same credentials, and the file must only be readable by its owner.
+ */
+TEST_F(TokenStoreTest, W_TokenIsSaved_S_FindItFromAnotherStore) {
+  StoredToken found;
+  struct stat info;
+
+  TokenStore{path_}.Save("id", "credentials",
+                         StoredToken{"token", system_clock::now(),
+                                     seconds{3600}});
+
+  TokenStore store{path_};
+
+  ASSERT_TRUE(store.Find("id", "credentials", &found));
+  EXPECT_EQ("token", found.value);
+  EXPECT_EQ(3600, found.lifetime.count());
+  ASSERT_EQ(0, stat(path_.c_str(), &info));
+  EXPECT_EQ(0600u, info.st_mode & 0777u);
+}
+
+/**
+ * @brief This tests validates the scenario when a stored token is looked up
+ * with other credentials, or has expired. When this occurs, it must not be
+ * found.
+ */
+TEST_F(TokenStoreTest, W_TokenIsOfOthersOrExpired_S_DontFindIt) {
+  TokenStore store{path_};
+  StoredToken found;
+
+  store.Save("id", "credentials",
+             StoredToken{"token", system_clock::now(), seconds{3600}});
+  store.Save("expired", "credentials",
+             StoredToken{"token", system_clock::now() - hours{2},
+                         seconds{3600}});
+
+  EXPECT_FALSE(store.Find("id", "other credentials", &found));
+  EXPECT_FALSE(store.Find("expired", "credentials", &found));
+  EXPECT_FALSE(store.Find("unknown", "credentials", &found));
+}
+
+/**
+ * @brief This tests validates the scenario when the path of the store is a
+ * link or isn't a regular file. When this occurs, the store must refuse to
+ * open it.
+ */
+TEST_F(TokenStoreTest, W_PathIsALinkOrDirectory_S_RefuseIt) {
+  string target = path_ + ".target";
+
+  ASSERT_EQ(0, symlink(target.c_str(), path_.c_str()));
+
+  EXPECT_THROW(TokenStore{path_}, runtime_error);
+  EXPECT_NE(0, access(target.c_str(), F_OK));
+
+  unlink(path_.c_str());
+  ASSERT_EQ(0, mkdir(path_.c_str(), 0700));
+
+  EXPECT_THROW(TokenStore{path_}, runtime_error);
+
+  rmdir(path_.c_str());
+}